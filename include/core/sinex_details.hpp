@@ -10,6 +10,7 @@
 #define __SINEX_FILE_DETAILS_HPP__
 
 #include "datetime/calendar.hpp"
+#include "sinex_perfect_hash.hpp"
 #include <algorithm>
 #include <cstring>
 
@@ -25,7 +26,7 @@ constexpr int max_sinex_chars = 128;
 constexpr const int max_domes_chars = 9;
 
 /** @brief Blocks allowed in a SINEX file */
-const char *const block_names[] = {
+constexpr const char *block_names[] = {
     "FILE/REFERENCE", "FILE/COMMENT", "INPUT/HISTORY", "INPUT/FILES",
     "INPUT/ACKNOWLEDGEMENTS", "NUTATION/DATA", "PRECESSION/DATA", "SOURCE/ID",
     "SITE/ID", "SITE/DATA", "SITE/RECEIVER", "SITE/ANTENNA",
@@ -51,7 +52,7 @@ const char *const block_names[] = {
 constexpr int block_names_size = sizeof(block_names) / sizeof(char *);
 
 /** @brief Parameter types allowed in SINEX files */
-const char *const parameter_types[] = {
+constexpr const char *parameter_types[] = {
     "STAX",   /* station X coordinate, m */
     "STAY",   /* station Y coordinate, m */
     "STAZ",   /* station Z coordinate, m */
@@ -132,6 +133,77 @@ constexpr int parameter_types_size = sizeof(parameter_types) / sizeof(char *);
 
 namespace details {
 
+/** @brief Perfect hash table of parameter_types */
+constexpr auto parameter_types_table = make_perfect_hash<9>(parameter_types);
+static_assert(parameter_types_table.multiplier,
+              "No perfect hash function found for parameter_types");
+
+/** @brief Perfect hash table of block_names */
+constexpr auto block_names_table = make_perfect_hash<8>(block_names);
+static_assert(block_names_table.multiplier,
+              "No perfect hash function found for block_names");
+
+} /* namespace details */
+
+/** @brief Id of a parameter type, i.e. its index in the parameter_types
+ *         array.
+ *
+ * @param[in] ptype The parameter type (does not have to be null-terminated)
+ * @param[in] len   Number of characters in ptype
+ * @return The index of ptype in parameter_types or -1 if ptype is not a
+ *         valid parameter type
+ */
+inline int parameter_type_id(const char *ptype, int len) noexcept {
+  return details::parameter_types_table.find(ptype, len);
+}
+
+/** @brief Id of a block name, i.e. its index in the block_names array.
+ *
+ * @param[in] block The block name (does not have to be null-terminated)
+ * @param[in] len   Number of characters in block
+ * @return The index of block in block_names or -1 if block is not a valid
+ *         block name
+ */
+inline int block_name_id(const char *block, int len) noexcept {
+  return details::block_names_table.find(block, len);
+}
+
+namespace details {
+
+/** @brief Length of the leading token of str, i.e. number of characters up
+ *         to the first whitespace or null-terminating character, considering
+ *         at most n characters.
+ */
+inline int token_length(const char *str, int n) noexcept {
+  int len = 0;
+  while (len < n && str[len] && str[len] != ' ')
+    ++len;
+  return len;
+}
+
+/** @brief Match a block header (i.e. the part of the line following the '+'
+ *         character) to a block name.
+ *
+ * Trailing whitespaces are ignored. If the header is not exactly a block
+ * name, any block name it starts with is matched.
+ *
+ * @param[in] str The block header (null-terminated)
+ * @return The index of the block in block_names or -1 if no block matched
+ */
+inline int match_block_header(const char *str) noexcept {
+  int len = std::strlen(str);
+  while (len && (str[len - 1] == ' ' || str[len - 1] == '\r'))
+    --len;
+  const int idx = block_name_id(str, len);
+  if (idx >= 0)
+    return idx;
+  for (int i = 0; i < block_names_size; i++) {
+    if (!std::strncmp(str, block_names[i], std::strlen(block_names[i])))
+      return i;
+  }
+  return -1;
+}
+
 /** @brief Match a given string to any string in parameter_types array
  *
  * @param[in] ptype String to match (does not have to be null-terminated).
@@ -147,10 +219,18 @@ namespace details {
  *   considered; e.g.
  *   ptype = "STAX" will match "STAX", but so will "STAXX", "STAX " and
  *   "STAXfoobar"
+ *   If the leading token of ptype (up to the first whitespace) is itself a
+ *   parameter type, it is preferred over any shorter one, i.e. "XPOR " will
+ *   match "XPOR" (not "XPO").
  */
 inline bool parameter_type_exists_impl(const char *ptype, int &index,
                                        std::false_type) noexcept {
-  index = -1;
+  /* the (leading) token of ptype is a parameter type */
+  index = parameter_type_id(ptype, token_length(ptype, 8));
+  if (index >= 0)
+    return true;
+
+  /* any parameter type that is a prefix of ptype */
   auto it =
       std::find_if(parameter_types, parameter_types + parameter_types_size,
                    [&](const char *const str) {
@@ -203,14 +283,10 @@ inline const char *ltrim_cpy(char *__restrict__ dest,
  */
 inline bool parameter_type_exists_impl(const char *ptype, int &index,
                                        std::true_type) noexcept {
-  index = -1;
-  auto it = std::find_if(
-      parameter_types, parameter_types + parameter_types_size,
-      [&](const char *const str) { return !std::strcmp(ptype, str); });
-  if (it == parameter_types + parameter_types_size)
-    return false;
-  index = std::distance(parameter_types, it);
-  return true;
+  /* parameter types are at most 6 characters long */
+  const int len = token_length(ptype, 8);
+  index = (!ptype[len]) ? parameter_type_id(ptype, len) : -1;
+  return index >= 0;
 }
 
 /** @brief Choose a policy for comparing strings against parameter_type */
@@ -0,0 +1,298 @@
+/** @file
+ * Compile-time descriptions of fixed-column SINEX record lines, and field
+ * extractors generated off from them. These are implementation details and
+ * should not be needed by the end-user.
+ *
+ * Each SINEX data line format is described once, as a layout struct holding
+ * one Field<Offset, Width> type per field (offsets are 0-based, i.e. column
+ * 1 of the format specification is offset 0). Parsers then extract each
+ * field via its descriptor; offsets and widths are compile-time constants,
+ * so that extraction compiles to straight-line code, bounded by the line
+ * length (computed once per line).
+ */
+
+#ifndef __SINEX_FILE_FIELDS_HPP__
+#define __SINEX_FILE_FIELDS_HPP__
+
+#include "sinex_blocks.hpp"
+#include "sinex_float.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <type_traits>
+
+namespace dso::sinex::details {
+
+/** @brief A fixed-column field of a SINEX line */
+template <int Offset, int Width> struct Field {
+  static constexpr int offset = Offset;
+  static constexpr int width = Width;
+  /** One past the last character of the field */
+  static constexpr int end = Offset + Width;
+  static_assert(Offset >= 0 && Width > 0 && end < max_sinex_chars,
+                "Invalid SINEX field");
+};
+
+/** @brief Copy a character field to dest, as is.
+ *
+ * Exactly F::width characters are written to dest; if the line ends before
+ * the field does, the remaining characters are set to '\0'. Never fails.
+ */
+template <typename F>
+inline int field_chars(const char *line, int len, char *dest) noexcept {
+  if (len >= F::end) {
+    /* common case; constant-size copy */
+    std::memcpy(dest, line + F::offset, F::width);
+    return 0;
+  }
+  const int n = std::max(0, len - F::offset);
+  std::memcpy(dest, line + F::offset, n);
+  std::memset(dest + n, '\0', F::width - n);
+  return 0;
+}
+
+/** @brief Copy a character field to dest, omitting leading whitespaces.
+ *
+ * The (non-whitespace) characters of the field are copied at the start of
+ * dest and the remaining characters (up to F::width) are set to '\0'. Never
+ * fails.
+ */
+template <typename F>
+inline int field_chars_ltrim(const char *line, int len, char *dest) noexcept {
+  const char *s = line + F::offset;
+  const char *e = line + std::max(F::offset, std::min(F::end, len));
+  while (s < e && *s == ' ')
+    ++s;
+  const int n = e - s;
+  std::memcpy(dest, s, n);
+  std::memset(dest + n, '\0', F::width - n);
+  return 0;
+}
+
+/** @brief Parse a numeric field (any type std::from_chars accepts).
+ *
+ * Leading whitespaces are skipped. Numbers are allowed to extend past the
+ * nominal field width (some software writes e.g. negative E21.15 values in
+ * 22 columns), hence parsing stops at the first character that is not part
+ * of the number, or at the end of the line. Doubles are decoded via
+ * from_chars_fixed (same result as std::from_chars, faster for the fixed
+ * formats used in SINEX).
+ *
+ * @param[in,out] pos If given, parsing starts at the field offset or at pos,
+ *                whichever comes last; at output, pos points one past the
+ *                number parsed. Use it to parse consecutive numeric fields
+ *                that may be shifted by a preceding, overlong number.
+ * @return Anything other than zero denotes an error, i.e. the field is
+ *         missing or holds no valid number.
+ */
+template <typename F, typename T>
+inline int field_number(const char *line, int len, T &val,
+                        const char *&pos) noexcept {
+  if (len <= F::offset)
+    return 1;
+  const char *s = std::max(line + F::offset, pos);
+  const char *e = line + len;
+  while (s < e && *s == ' ')
+    ++s;
+  std::from_chars_result res;
+  if constexpr (std::is_same_v<T, double>)
+    res = from_chars_fixed(s, e, val);
+  else
+    res = std::from_chars(s, e, val);
+  pos = res.ptr;
+  return res.ec != std::errc{};
+}
+
+template <typename F, typename T>
+inline int field_number(const char *line, int len, T &val) noexcept {
+  const char *pos = line;
+  return field_number<F>(line, len, val, pos);
+}
+
+/** @brief Parse a single-character Observation Code field.
+ * @return Anything other than zero denotes an error
+ */
+template <typename F>
+inline int field_obscode(const char *line, int len,
+                         SinexObservationCode &code) noexcept {
+  static_assert(F::width == 1, "Observation Code is a single character");
+  return (len <= F::offset) ||
+         char_to_SinexObservationCode(line[F::offset], code);
+}
+
+/** @brief Parse a single-character Constraint Code field.
+ * @return Anything other than zero denotes an error
+ */
+template <typename F>
+inline int field_constraint(const char *line, int len,
+                            SinexConstraintCode &code) noexcept {
+  static_assert(F::width == 1, "Constraint Code is a single character");
+  return (len <= F::offset) ||
+         char_to_SinexConstraintCode(line[F::offset], code);
+}
+
+/** @brief Parse a YY:DDD:SSSSS date field (see parse_sinex_date).
+ * @return Anything other than zero denotes an error
+ */
+template <typename F>
+inline int field_date(const char *line, int len,
+                      const dso::datetime<dso::nanoseconds> &default_epoch,
+                      dso::datetime<dso::nanoseconds> &t) noexcept {
+  static_assert(F::width == 12, "SINEX dates are 12 characters wide");
+  return (len < F::end) ||
+         parse_sinex_date(line + F::offset, default_epoch, t);
+}
+
+/** @brief Parse a number of date fields (e.g. DataStart and DataEnd) in one
+ *         sweep (see parse_sinex_dates); defaults and outputs are given in
+ *         the order of the fields.
+ * @return Anything other than zero denotes an error
+ */
+template <typename... F>
+inline int field_dates(
+    const char *line, int len,
+    const dso::datetime<dso::nanoseconds> *const (&defaults)[sizeof...(F)],
+    dso::datetime<dso::nanoseconds> *const (&t)[sizeof...(F)]) noexcept {
+  static_assert(((F::width == 12) && ...),
+                "SINEX dates are 12 characters wide");
+  if (len < std::max({F::end...}))
+    return 1;
+  const char *const dtstrs[] = {(line + F::offset)...};
+  return parse_sinex_dates(sizeof...(F), dtstrs, defaults, t);
+}
+
+/** @brief Line layouts of SINEX blocks (offsets are 0-based) */
+namespace layout {
+
+/* Common leading fields of per-site records */
+using SiteCode = Field<1, 4>;
+using PointCode = Field<6, 2>;
+using SolnId = Field<9, 4>;
+using ObsCode = Field<14, 1>;
+using DataStart = Field<16, 12>;
+using DataEnd = Field<29, 12>;
+
+/** SITE/ID
+ * *CODE PT __DOMES__ T _STATION DESCRIPTION__ APPROX_LON_ APPROX_LAT_ ...
+ */
+struct SiteId {
+  using SiteCode = layout::SiteCode;
+  using PointCode = layout::PointCode;
+  using Domes = Field<9, 9>;
+  using ObsCode = Field<19, 1>;
+  using Description = Field<21, 22>;
+  using LonDeg = Field<44, 3>;
+  using LonMin = Field<48, 2>;
+  using LonSec = Field<51, 4>;
+  using LatDeg = Field<56, 3>;
+  using LatMin = Field<60, 2>;
+  using LatSec = Field<63, 4>;
+  using Height = Field<68, 7>;
+};
+
+/** SOLUTION/EPOCHS
+ * *CODE PT SOLN T _DATA_START_ __DATA_END__ _MEAN_EPOCH_
+ */
+struct SolutionEpoch {
+  using SiteCode = layout::SiteCode;
+  using PointCode = layout::PointCode;
+  using SolnId = layout::SolnId;
+  using ObsCode = layout::ObsCode;
+  using DataStart = layout::DataStart;
+  using DataEnd = layout::DataEnd;
+  using MeanEpoch = Field<42, 12>;
+};
+
+/** SOLUTION/ESTIMATE
+ * *INDEX TYPE__ CODE PT SOLN _REF_EPOCH__ UNIT S __ESTIMATED VALUE____ ...
+ */
+struct SolutionEstimate {
+  using Index = Field<1, 5>;
+  using ParameterType = Field<7, 6>;
+  using SiteCode = Field<14, 4>;
+  using PointCode = Field<19, 2>;
+  using SolnId = Field<22, 4>;
+  using RefEpoch = Field<27, 12>;
+  using Units = Field<40, 4>;
+  using Constraint = Field<45, 1>;
+  using Estimate = Field<47, 21>;
+  using StdDeviation = Field<69, 11>;
+};
+
+/** SITE/ECCENTRICITY
+ * *CODE PT SOLN T _DATA START_ __DATA_END__ AXE __ARP-BENCHMARK_(M)_______
+ */
+struct SiteEccentricity {
+  using SiteCode = layout::SiteCode;
+  using PointCode = layout::PointCode;
+  using SolnId = layout::SolnId;
+  using ObsCode = layout::ObsCode;
+  using DataStart = layout::DataStart;
+  using DataEnd = layout::DataEnd;
+  using RefSystem = Field<42, 3>;
+  using Ecc1 = Field<46, 8>;
+  using Ecc2 = Field<55, 8>;
+  using Ecc3 = Field<64, 8>;
+};
+
+/** SITE/ANTENNA
+ * *CODE PT SOLN T _DATA START_ __DATA_END__ ____ANTENNA_TYPE____ _S/N_
+ */
+struct SiteAntenna {
+  using SiteCode = layout::SiteCode;
+  using PointCode = layout::PointCode;
+  using SolnId = layout::SolnId;
+  using ObsCode = layout::ObsCode;
+  using DataStart = layout::DataStart;
+  using DataEnd = layout::DataEnd;
+  using AntType = Field<42, 20>;
+  using AntSerial = Field<63, 5>;
+};
+
+/** SITE/RECEIVER
+ * *CODE PT SOLN T _DATA START_ __DATA_END__ ___RECEIVER_TYPE____ _S/N_ ...
+ */
+struct SiteReceiver {
+  using SiteCode = layout::SiteCode;
+  using PointCode = layout::PointCode;
+  using SolnId = layout::SolnId;
+  using ObsCode = layout::ObsCode;
+  using DataStart = layout::DataStart;
+  using DataEnd = layout::DataEnd;
+  using RecType = Field<42, 20>;
+  using RecSerial = Field<63, 5>;
+  using RecFirmware = Field<69, 11>;
+};
+
+/** SOLUTION/DATA_REJECT
+ * *CODE PT SOLN T _DATA_START_ __DATA_END__ M A COMMENTS
+ */
+struct DataReject {
+  using SiteCode = layout::SiteCode;
+  using PointCode = layout::PointCode;
+  using SolnId = layout::SolnId;
+  using ObsCode = layout::ObsCode;
+  using DataStart = layout::DataStart;
+  using DataEnd = layout::DataEnd;
+  using ColM = Field<42, 1>;
+  using ColA = Field<44, 1>;
+  /** Free-format; only as many characters as DataReject can hold */
+  using Comments = Field<46, 48>;
+};
+
+/** SOLUTION/MATRIX_ESTIMATE (and the rest of the SOLUTION/MATRIX_* blocks)
+ * *PARA1 PARA2 ____PARA2+0__________ ____PARA2+1__________ ____PARA2+2___...
+ */
+struct MatrixEstimate {
+  using Row = Field<1, 5>;
+  using Column = Field<7, 5>;
+  using Value1 = Field<13, 21>;
+  using Value2 = Field<35, 21>;
+  using Value3 = Field<57, 21>;
+};
+
+} /* namespace layout */
+
+} /* namespace dso::sinex::details */
+
+#endif
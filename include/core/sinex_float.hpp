@@ -0,0 +1,213 @@
+/** @file
+ * Fast decoding of floating point numbers written in fixed Fortran formats
+ * (e.g. E21.15, E11.6 or E21.14), as found in SOLUTION/ESTIMATE and
+ * SOLUTION/MATRIX_* blocks. These are implementation details and should not
+ * be needed by the end-user.
+ */
+
+#ifndef __SINEX_FILE_FIXED_FLOAT_HPP__
+#define __SINEX_FILE_FIXED_FLOAT_HPP__
+
+#include <cfloat>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+
+/* The fast path needs exact double arithmetic, little-endian byte order and
+ * the GCC/Clang builtins; otherwise std::from_chars is used */
+#if FLT_EVAL_METHOD == 0 && defined(__GNUC__) && defined(__BYTE_ORDER__) &&  \
+    (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define SINEX_FIXED_FLOAT_FAST_PATH
+#endif
+
+namespace dso::sinex::details {
+
+#ifdef SINEX_FIXED_FLOAT_FAST_PATH
+namespace fixed_float {
+
+/** @brief Exact powers of ten, representable as doubles */
+constexpr double exact_powers_of_ten[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+/** @brief Powers of ten, as integers */
+constexpr std::uint64_t integer_powers_of_ten[] = {
+    1ULL,      10ULL,      100ULL,      1000ULL,     10000ULL,
+    100000ULL, 1000000ULL, 10000000ULL, 100000000ULL};
+
+/** @brief Number of leading (i.e. least significant bytes) digits in the 8
+ *         characters packed in chunk; all bytes are tested at once.
+ */
+inline int leading_digits(std::uint64_t chunk) noexcept {
+  /* non-zero bytes denote non-digits; a carry may only originate off a
+   * non-digit byte (>= 0xFA) and only affects the bytes following it */
+  const std::uint64_t v =
+      ((chunk & 0xF0F0F0F0F0F0F0F0ULL) ^ 0x3030303030303030ULL) |
+      (((chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) ^
+       0x3030303030303030ULL);
+  const std::uint64_t nz =
+      (((v & 0x7F7F7F7F7F7F7F7FULL) + 0x7F7F7F7F7F7F7F7FULL) | v) &
+      0x8080808080808080ULL;
+  return (nz) ? (__builtin_ctzll(nz) >> 3) : 8;
+}
+
+/** @brief Convert 8 digits, packed in chunk (first digit in the least
+ *         significant byte), to an integer; SWAR, i.e. all digits are
+ *         processed at once, in three multiplications.
+ */
+inline std::uint32_t eight_digits(std::uint64_t chunk) noexcept {
+  chunk -= 0x3030303030303030ULL;
+  chunk = (chunk * 10) + (chunk >> 8);
+  return (std::uint32_t)(((chunk & 0x000000FF000000FFULL) *
+                              (100 + (1000000ULL << 32)) +
+                          ((chunk >> 16) & 0x000000FF000000FFULL) *
+                              (1 + (10000ULL << 32))) >>
+                         32);
+}
+
+/** @brief Load 8 characters, starting at p, into an integer (first
+ *         character in the least significant byte)
+ */
+inline std::uint64_t load_chunk(const char *p) noexcept {
+  std::uint64_t chunk;
+  std::memcpy(&chunk, p, 8);
+  return chunk;
+}
+
+/** @brief Convert the k (< 8) leading digits of chunk to an integer; the
+ *         digits are shifted to the end of the chunk and padded with '0's.
+ */
+inline std::uint32_t leading_digits_value(std::uint64_t chunk,
+                                          int k) noexcept {
+  return (k) ? eight_digits((chunk << (8 * (8 - k))) |
+                            (0x3030303030303030ULL >> (8 * k)))
+             : 0;
+}
+
+/** @brief The fast path of from_chars_fixed; s points to the first
+ *         character after the (optional) sign and at least 32 characters
+ *         should be readable off s.
+ *
+ * @return One past the last character parsed, or nullptr if the number is
+ *         not of the supported form.
+ */
+inline const char *parse_fixed(const char *s, bool negative,
+                               double &val) noexcept {
+  /* integral digits (usually just one), followed by '.' */
+  std::uint64_t m = 0;
+  const char *q = s;
+  while ((unsigned)(*q - '0') < 10u && q - s < 8)
+    m = m * 10 + (*q++ - '0');
+  const int ki = q - s;
+  if (!ki || ki == 8 || *q != '.')
+    return nullptr;
+  ++q;
+
+  /* fractional digits, at most 15 (i.e. two chunks) */
+  std::uint64_t chunk = load_chunk(q);
+  int kf = leading_digits(chunk);
+  if (kf == 8) {
+    m = m * 100000000ULL + eight_digits(chunk);
+    chunk = load_chunk(q + 8);
+    const int k = leading_digits(chunk);
+    if (k == 8)
+      return nullptr;
+    m = m * integer_powers_of_ten[k] + leading_digits_value(chunk, k);
+    kf += k;
+  } else {
+    if (!kf)
+      return nullptr;
+    m = m * integer_powers_of_ten[kf] + leading_digits_value(chunk, kf);
+  }
+  q += kf;
+  int exp10 = -kf;
+
+  /* optional exponent, of one or two digits */
+  if (*q == 'E' || *q == 'e') {
+    const char *r = q + 1;
+    const bool eneg = (*r == '-');
+    r += (*r == '-' || *r == '+');
+    const bool d0 = (unsigned)(r[0] - '0') < 10u;
+    const bool d1 = (unsigned)(r[1] - '0') < 10u;
+    if (!d0 || (d1 && (unsigned)(r[2] - '0') < 10u))
+      return nullptr;
+    const int e = (d1) ? (r[0] - '0') * 10 + (r[1] - '0') : (r[0] - '0');
+    exp10 += (eneg) ? -e : e;
+    q = r + 1 + d1;
+  }
+
+  /* Clinger's fast path */
+  if (ki + kf > 19 || m > (1ULL << 53) || exp10 < -22 || exp10 > 22)
+    return nullptr;
+  double d = (double)m;
+  d = (exp10 < 0) ? d / exact_powers_of_ten[-exp10]
+                  : d * exact_powers_of_ten[exp10];
+  val = (negative) ? -d : d;
+  return q;
+}
+
+} /* namespace fixed_float */
+#endif
+
+/** @brief Same as std::from_chars(first, last, val) for doubles (i.e.
+ *         std::chars_format::general), bit-exact, but faster for numbers
+ *         written in fixed Fortran formats, i.e. [-]d.ddd[E[+-]dd] with at
+ *         most 7 integral, 15 fractional and 19 significant digits.
+ *
+ * The fractional digits of such numbers are decoded without branching on
+ * individual characters: they are classified and converted 8 characters at
+ * a time (SWAR) into a 64-bit integer mantissa. When the mantissa is at
+ * most 2^53 and the power of ten at most 22 in magnitude, a single
+ * multiplication or division of exact doubles gives the correctly rounded
+ * result (Clinger's fast path). Anything else is delegated to
+ * std::from_chars.
+ */
+inline std::from_chars_result from_chars_fixed(const char *first,
+                                               const char *last,
+                                               double &val) noexcept {
+#ifdef SINEX_FIXED_FLOAT_FAST_PATH
+  using namespace fixed_float;
+  if (first < last) {
+    const bool negative = (*first == '-');
+    const char *p = first + negative;
+    /* near the end of the range, parse off a padded copy */
+    char buf[32] = {};
+    const char *s = p;
+    if (last - p < 32)
+      s = static_cast<const char *>(std::memcpy(buf, p, last - p));
+    const char *q = parse_fixed(s, negative, val);
+    if (q)
+      return {p + (q - s), std::errc{}};
+  }
+#endif
+  return std::from_chars(first, last, val);
+}
+
+/** @brief Decode (up to) n consecutive, whitespace-separated fixed-format
+ *         numbers, e.g. the E21.14 values of a matrix block line.
+ *
+ * @param[in,out] first Start of the first field; on return, one past the
+ *            last character of the last value decoded (unchanged if none)
+ * @param[in] last  End of the character range (e.g. line end)
+ * @param[out] vals Array of (at least) n doubles
+ * @param[in] n     Max number of values to decode
+ * @return Number of values decoded; less than n if the range ends (or a
+ *         field fails to decode) before n values are read
+ */
+inline int from_chars_fixed(const char *&first, const char *last,
+                            double *vals, int n) noexcept {
+  for (int i = 0; i < n; i++) {
+    const char *s = first;
+    while (s < last && *s == ' ')
+      ++s;
+    const auto res = from_chars_fixed(s, last, vals[i]);
+    if (res.ec != std::errc{})
+      return i;
+    first = res.ptr;
+  }
+  return n;
+}
+
+} /* namespace dso::sinex::details */
+
+#endif
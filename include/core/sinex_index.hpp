@@ -0,0 +1,77 @@
+/** @file
+ * Persistent (on-disk) block index for SINEX files. The index is stored in a
+ * sidecar file (i.e. 'file.snx.idx' for 'file.snx') and holds the block
+ * table (see dso::sinex::SinexBlockPosition) and per-block summaries (see
+ * dso::sinex::SinexBlockSummary), so that re-opening a SINEX file does not
+ * need a full pass through its contents.
+ *
+ * An index is only considered valid if the SINEX file size, modification
+ * time and content hash match the ones recorded when the index was written.
+ * Note that the content hash is computed over the first and last 64KiB of
+ * the file (not all of it), so that validation does not cost a full read.
+ *
+ * Index files are written to a temporary file and (atomically) renamed to
+ * their final name, so that concurrent readers/writers (e.g. multiple
+ * processes opening the same SINEX file) never see a partially written
+ * index. These are implementation details and should not be needed by the
+ * end-user.
+ */
+
+#ifndef __SINEX_FILE_BLOCK_INDEX_DETAILS_HPP__
+#define __SINEX_FILE_BLOCK_INDEX_DETAILS_HPP__
+
+#include "core/sinex_io.hpp"
+#include "sinex_blocks.hpp"
+#include <string>
+#include <vector>
+
+namespace dso::sinex::details {
+
+/** @brief Filename of the index file for a given SINEX file */
+inline std::string block_index_filename(const std::string &snx_fn) {
+  return snx_fn + ".idx";
+}
+
+/** @brief Compute the summary of a block.
+ *
+ * @param[in] cursor A cursor placed at the first line of the block payload
+ * @param[in] blk The block to summarize
+ * @param[out] summary Summary information for the block
+ * @return Anything other than zero denotes an error
+ */
+int summarize_block(LineCursor &cursor, const SinexBlockPosition &blk,
+                    SinexBlockSummary &summary) noexcept;
+
+/** @brief Load the block index of a SINEX file (if any).
+ *
+ * Block positions are validated against the size of the SINEX content,
+ * i.e. each block should satisfy 0 <= mpos < mdata <= mend <= size, and
+ * blocks should be in ascending order, without overlapping.
+ *
+ * @param[in] snx_fn The SINEX filename
+ * @param[in] size Number of bytes of the SINEX content the block positions
+ *            refer to (i.e. the size of the decompressed file)
+ * @param[out] blocks The block table read off from the index
+ * @param[out] summaries Block summaries, one for each entry in blocks
+ * @return Zero if a valid index was loaded; anything else denotes that the
+ *         index is missing, stale or corrupt (in this case, blocks and
+ *         summaries are cleared).
+ */
+int read_block_index(const char *snx_fn, std::size_t size,
+                     std::vector<SinexBlockPosition> &blocks,
+                     std::vector<SinexBlockSummary> &summaries) noexcept;
+
+/** @brief Write the block index of a SINEX file.
+ *
+ * @param[in] snx_fn The SINEX filename
+ * @param[in] blocks The block table of the SINEX file
+ * @param[in] summaries Block summaries, one for each entry in blocks
+ * @return Anything other than zero denotes an error
+ */
+int write_block_index(const char *snx_fn,
+                      const std::vector<SinexBlockPosition> &blocks,
+                      const std::vector<SinexBlockSummary> &summaries) noexcept;
+
+} /* namespace dso::sinex::details */
+
+#endif
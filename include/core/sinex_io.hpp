@@ -0,0 +1,377 @@
+/** @file
+ * Low-level I/O utilities used by the dso::Sinex class to access the raw
+ * SINEX bytes, either through a (read-only) memory mapping of the file or
+ * through positional reads off from a file descriptor. These are
+ * implementation details and should not be needed by the end-user.
+ */
+
+#ifndef __SINEX_FILE_IO_DETAILS_HPP__
+#define __SINEX_FILE_IO_DETAILS_HPP__
+
+#include "core/sinex_details.hpp"
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <istream>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace dso::sinex::details {
+
+/** @brief Compression formats recognized (via their magic bytes) */
+enum class Compression { None, Gzip, UnixZ };
+
+/** @brief Detect the compression format of a buffer, using its first bytes.
+ * Gzip data start with 0x1f 0x8b, Unix compress (.Z) data with 0x1f 0x9d.
+ */
+inline Compression detect_compression(const char *begin,
+                                      const char *end) noexcept {
+  if (end - begin < 2 || (unsigned char)begin[0] != 0x1f)
+    return Compression::None;
+  if ((unsigned char)begin[1] == 0x8b)
+    return Compression::Gzip;
+  if ((unsigned char)begin[1] == 0x9d)
+    return Compression::UnixZ;
+  return Compression::None;
+}
+
+/** @brief Detect the compression format of a file (using its first bytes) */
+Compression detect_compression(const char *fn) noexcept;
+
+/** @brief Decompress a gzip (or zlib) buffer; concatenated gzip members are
+ *        decompressed one after the other.
+ * @param[in] begin Start of compressed data
+ * @param[in] end One-past-the-end of compressed data
+ * @param[out] out The decompressed bytes
+ * @return Anything other than zero denotes an error
+ */
+int gunzip(const char *begin, const char *end,
+           std::vector<char> &out) noexcept;
+
+/** @brief Decompress a Unix compress (.Z, LZW) buffer.
+ * @param[in] begin Start of compressed data (including the 3-byte header)
+ * @param[in] end One-past-the-end of compressed data
+ * @param[out] out The decompressed bytes
+ * @return Anything other than zero denotes an error
+ */
+int unlzw(const char *begin, const char *end, std::vector<char> &out) noexcept;
+
+/** @class MappedFile
+ * A read-only, private memory mapping of a whole file (RAII). The mapping is
+ * created via map() and released at destruction (or via unmap()).
+ *
+ * Instead of a file, an instance can also expose bytes already in memory:
+ * either a buffer owned by the caller (via view(); no copy is made) or a
+ * buffer handed over to the instance (via adopt()).
+ *
+ * Compressed files (gzip or Unix compress) are transparently decompressed
+ * to an internal buffer at map() (or view()/adopt()); the instance then
+ * exposes the decompressed bytes.
+ */
+class MappedFile {
+  const char *m_data = nullptr;
+  std::size_t m_size = 0;
+  /* memory mapping (only used for uncompressed files, via map()) */
+  void *m_mapping = nullptr;
+  std::size_t m_mapping_size = 0;
+  /* bytes handed over via adopt() */
+  std::string m_owned;
+  /* decompressed bytes (only used for compressed files) */
+  std::vector<char> m_buffer;
+  Compression m_compression = Compression::None;
+
+  /** @brief Expose the bytes [data, data+size), decompressing them (to
+   *        m_buffer) if needed.
+   */
+  int attach(const char *data, std::size_t size) noexcept;
+
+public:
+  MappedFile() noexcept = default;
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+  ~MappedFile() noexcept { unmap(); }
+
+  /** @brief Map the file fn to memory, decompressing it if needed.
+   * @return Anything other than zero denotes an error; in this case the
+   *         instance is left un-mapped.
+   */
+  int map(const char *fn) noexcept;
+
+  /** @brief Expose the caller-owned bytes [data, data+size), decompressing
+   *        them if needed. Uncompressed bytes are not copied, so they must
+   *        outlive the instance (or the next call to unmap()).
+   * @return Anything other than zero denotes an error; in this case the
+   *         instance is left un-mapped.
+   */
+  int view(const char *data, std::size_t size) noexcept;
+
+  /** @brief Take over the buffer bytes and expose its contents,
+   *        decompressing them if needed.
+   * @return Anything other than zero denotes an error; in this case the
+   *         instance is left un-mapped.
+   */
+  int adopt(std::string &&bytes) noexcept;
+
+  /** @brief Release the mapping (and any buffers held) */
+  void unmap() noexcept;
+
+  /** @brief Check if the instance holds a valid mapping */
+  bool is_mapped() const noexcept { return m_data != nullptr; }
+
+  /** @brief Compression format of the underlying file */
+  Compression compression() const noexcept { return m_compression; }
+
+  /** @brief Start of the mapped bytes */
+  const char *begin() const noexcept { return m_data; }
+
+  /** @brief One-past-the-end of the mapped bytes */
+  const char *end() const noexcept { return m_data + m_size; }
+
+  /** @brief Number of mapped bytes (i.e. size of the (decompressed) file) */
+  std::size_t size() const noexcept { return m_size; }
+}; /* MappedFile */
+
+/** @class InputFile
+ * A file opened for reading (RAII), accessed only via positional reads
+ * (i.e. pread). Since no file offset is shared, any number of readers (e.g.
+ * LineCursor instances in different threads) can use the same instance
+ * concurrently.
+ */
+class InputFile {
+  int m_fd = -1;
+  std::size_t m_size = 0;
+
+public:
+  InputFile() noexcept = default;
+  InputFile(const InputFile &) = delete;
+  InputFile &operator=(const InputFile &) = delete;
+  ~InputFile() noexcept { close(); }
+
+  /** @brief Open the file fn for reading.
+   * @return Anything other than zero denotes an error; in this case the
+   *         instance is left closed.
+   */
+  int open(const char *fn) noexcept;
+
+  /** @brief Close the file (if open) */
+  void close() noexcept;
+
+  /** @brief Check if the instance holds an open file */
+  bool is_open() const noexcept { return m_fd >= 0; }
+
+  /** @brief The file descriptor (or -1 if closed) */
+  int fd() const noexcept { return m_fd; }
+
+  /** @brief Size of the file in bytes (at the time it was opened) */
+  std::size_t size() const noexcept { return m_size; }
+}; /* InputFile */
+
+/** @class LineCursor
+ * Sequentially read SINEX lines, either off from an input stream, off from
+ * a memory range [begin, end) or off from a byte range of a file (via
+ * positional reads, buffered in chunks owned by the cursor). Lines are
+ * copied (without the newline character) to a user-supplied,
+ * null-terminated buffer of size (at least) max_sinex_chars, so that the
+ * same line parsers can be used regardless of the data source. A cursor can
+ * be bounded to a given range of lines or bytes (e.g. the payload of a
+ * block), in which case getline() signals the end of the range exactly as it
+ * would signal the end of input.
+ *
+ * Cursors do not share any state with each other, so different cursors over
+ * the same memory range or file can be used concurrently.
+ */
+class LineCursor {
+  std::istream *m_stream = nullptr;
+  const char *m_cur = nullptr;
+  const char *m_end = nullptr;
+  long m_lines_left = std::numeric_limits<long>::max();
+  /* positional reads: file descriptor, next offset to read, end of range */
+  int m_fd = -1;
+  std::size_t m_offset = 0;
+  std::size_t m_offset_end = 0;
+  /* buffered chunk of the file; [m_cur, m_end) points into it */
+  std::vector<char> m_buffer;
+
+  /** @brief Move the unread bytes to the start of m_buffer and append the
+   *        next chunk of the file range to them.
+   * @return Anything other than zero denotes an error
+   */
+  int fill() noexcept;
+
+  /** @brief Next newline character in [m_cur, m_end) (or nullptr) */
+  const char *next_newline() const noexcept {
+    return (m_cur < m_end) ? static_cast<const char *>(
+                                 std::memchr(m_cur, '\n', m_end - m_cur))
+                           : nullptr;
+  }
+
+public:
+  LineCursor() noexcept = default;
+  /* [m_cur, m_end) may point into m_buffer; moving keeps it valid, copying
+   * would not */
+  LineCursor(const LineCursor &) = delete;
+  LineCursor &operator=(const LineCursor &) = delete;
+  LineCursor(LineCursor &&) noexcept = default;
+  LineCursor &operator=(LineCursor &&) noexcept = default;
+
+  /** @brief Read lines off from an (already placed) input stream */
+  explicit LineCursor(std::istream &is) noexcept : m_stream(&is) {}
+
+  /** @brief Read (at most) num_lines lines off from an (already placed)
+   * input stream.
+   */
+  LineCursor(std::istream &is, long num_lines) noexcept
+      : m_stream(&is), m_lines_left(num_lines) {}
+
+  /** @brief Read lines off from the memory range [begin, end) */
+  LineCursor(const char *begin, const char *end) noexcept
+      : m_cur(begin), m_end(end) {}
+
+  /** @brief Read lines off from the byte range [begin, end) of file (using
+   *        positional reads).
+   */
+  LineCursor(const InputFile &file, std::size_t begin,
+             std::size_t end) noexcept
+      : m_fd(file.fd()), m_offset(begin), m_offset_end(end) {}
+
+  /** @brief Copy next line to line.
+   *
+   * Mimics std::istream::getline(line, max_sinex_chars): the newline
+   * character is not stored and a line with max_sinex_chars or more
+   * characters is considered an error.
+   *
+   * @param[out] line A buffer of at least max_sinex_chars characters; at
+   *             output it holds the (null-terminated) line read.
+   * @return True if a line was read; false at end of input (or range) or on
+   *         error. Use done() to tell the two apart.
+   */
+  bool getline(char *line) noexcept {
+    if (m_stream) {
+      if (m_lines_left <= 0 || !m_stream->getline(line, max_sinex_chars))
+        return false;
+      --m_lines_left;
+      return true;
+    }
+    const char *nl = next_newline();
+    /* incomplete line in buffer; read in next chunk */
+    if ((!nl) && m_offset < m_offset_end) {
+      if (fill())
+        return false;
+      nl = next_newline();
+    }
+    if (m_cur >= m_end)
+      return false;
+    const char *eol = nl ? nl : m_end;
+    const std::size_t sz = eol - m_cur;
+    if (sz >= static_cast<std::size_t>(max_sinex_chars))
+      return false;
+    std::memcpy(line, m_cur, sz);
+    line[sz] = '\0';
+    m_cur = nl ? nl + 1 : m_end;
+    return true;
+  }
+
+  /** @brief True if all lines of a bounded range have been read */
+  bool done() const noexcept {
+    return m_stream ? (m_lines_left == 0)
+                    : ((m_cur >= m_end) && (m_offset >= m_offset_end));
+  }
+
+  /** @brief File offset of the next line to be read; only meaningful for
+   *         cursors reading off from a file.
+   */
+  std::size_t offset() const noexcept {
+    return m_offset - (std::size_t)(m_end - m_cur);
+  }
+}; /* LineCursor */
+
+/** @brief Parse chunks of a block (see dso::Sinex::goto_block_chunks)
+ *         concurrently, one thread per chunk.
+ *
+ * The i-th chunk is parsed via parse(i, cursor, out), where out is a
+ * default-constructed Out instance, except for the first chunk which is
+ * parsed (in the calling thread) directly into result. The results of the
+ * other chunks are then merged in chunk (i.e. file) order via
+ * merge(result, out), so that result is identical to what parsing the
+ * chunks one after the other would give.
+ *
+ * @return The sum of the values returned by parse (anything other than
+ *         zero denotes an error), or non-zero if threads could not be
+ *         launched.
+ */
+template <typename Out, typename Parse, typename Merge>
+int parse_chunks(std::vector<LineCursor> &cursors, Out &result,
+                 Parse &&parse, Merge &&merge) noexcept {
+  if (cursors.size() <= 1)
+    return cursors.empty() ? 0 : parse(std::size_t(0), cursors[0], result);
+  try {
+    const std::size_t n = cursors.size();
+    std::vector<Out> outs(n);
+    std::vector<int> errors(n, 0);
+    std::vector<std::thread> threads;
+    threads.reserve(n);
+    std::size_t launched = 1;
+    try {
+      for (; launched < n; launched++)
+        threads.emplace_back([&, i = launched]() {
+          errors[i] = parse(i, cursors[i], outs[i]);
+        });
+    } catch (std::exception &) {
+      /* failed to launch a thread; parse the remaining chunks here */
+    }
+    for (std::size_t i = launched; i < n; i++)
+      errors[i] = parse(i, cursors[i], outs[i]);
+    errors[0] = parse(std::size_t(0), cursors[0], result);
+    for (auto &t : threads)
+      t.join();
+    int error = 0;
+    for (std::size_t i = 0; i < n; i++) {
+      error += errors[i];
+      if (i && !error)
+        merge(result, outs[i]);
+    }
+    return error;
+  } catch (std::exception &e) {
+    fprintf(stderr,
+            "[ERROR] Failed parsing block chunks; %s (traceback: %s)\n",
+            e.what(), __func__);
+    return 1;
+  }
+}
+
+/** @class BlockMarker
+ * A line starting with one of the characters '+' (block header), '-' (block
+ * trailer) or '%' (file header/trailer), as collected by
+ * scan_block_markers().
+ */
+struct BlockMarker {
+  std::size_t moffset; /* offset of line start from begining of buffer */
+  long mline;          /* line number (0-based) */
+  char mtype;          /* first character of line, i.e. '+', '-' or '%' */
+}; /* BlockMarker */
+
+/** @brief Collect all block marker lines in a SINEX buffer.
+ *
+ * The buffer is scanned for newline characters using SIMD instructions (when
+ * available, else byte-by-byte) and, for large buffers, it is split into
+ * chunks that are scanned concurrently. Chunk boundaries need not coincide
+ * with line boundaries; results are merged in buffer order.
+ *
+ * @param[in] begin Start of buffer
+ * @param[in] end One-past-the-end of buffer
+ * @param[out] markers Block markers found, in order of appearance
+ * @param[out] num_lines Number of lines in buffer
+ * @param[in] num_threads Max number of threads to use; if zero, the number
+ *            is chosen based on the buffer size and the hardware.
+ * @return Anything other than zero denotes an error
+ */
+int scan_block_markers(const char *begin, const char *end,
+                       std::vector<BlockMarker> &markers, long &num_lines,
+                       int num_threads = 0) noexcept;
+
+} /* namespace dso::sinex::details */
+
+#endif
@@ -0,0 +1,219 @@
+/** @file
+ * Parsers for single SINEX data lines (i.e. block records). These are used
+ * by the dso::Sinex block parsers as well as by dso::SinexStreamReader, and
+ * should not be needed by the end-user.
+ */
+
+#ifndef __SINEX_FILE_LINE_PARSERS_HPP__
+#define __SINEX_FILE_LINE_PARSERS_HPP__
+
+#include "core/sinex_fields.hpp"
+#include "sinex_blocks.hpp"
+
+namespace dso::sinex::details {
+
+/** @brief Parse a SITE/ID record line.
+ * @param[in] line A (null-terminated) SITE/ID data line
+ * @param[out] sid The parsed record
+ * @return Anything other than zero denotes an error
+ */
+int parse_site_id_line(const char *line, SiteId &sid) noexcept;
+
+/** @brief Parse a SOLUTION/EPOCHS record line.
+ * @param[in] line A (null-terminated) SOLUTION/EPOCHS data line
+ * @param[in] sinex_data_start Data start time of the SINEX file; used to
+ *            resolve '00:000:00000' start dates
+ * @param[in] sinex_data_end Data end time of the SINEX file; used to
+ *            resolve '00:000:00000' stop dates
+ * @param[out] entry The parsed record
+ * @return Anything other than zero denotes an error
+ */
+int parse_epoch_line(const char *line,
+                     const dso::datetime<dso::nanoseconds> &sinex_data_start,
+                     const dso::datetime<dso::nanoseconds> &sinex_data_end,
+                     SolutionEpoch &entry) noexcept;
+
+/** @brief Of two SOLUTION/EPOCHS records of a site, keep the one with the
+ *         interval closest to t (i.e. the one including t, else the one
+ *         starting first if t is before both, or the one ending last if t
+ *         is after both).
+ * @param[in] t The epoch of interest
+ * @param[in] entry A (new) record for the site
+ * @param[in,out] kept The record kept so far for the site; replaced by
+ *            entry, if that is closer to t
+ * @return Anything other than zero denotes an error, i.e. the closest
+ *         record cannot be decided
+ */
+int keep_closest_epoch(const dso::datetime<dso::nanoseconds> &t,
+                       const SolutionEpoch &entry,
+                       SolutionEpoch &kept) noexcept;
+
+/** @brief Parse a SOLUTION/ESTIMATE record line.
+ * @param[in] line A (null-terminated) SOLUTION/ESTIMATE data line
+ * @param[out] est The parsed record
+ * @param[in] sinex_data_start Data start time of the SINEX file; used to
+ *            resolve '00:000:00000' dates
+ * @return Anything other than zero denotes an error
+ */
+int parse_solution_estimate_line(
+    const char *line, SolutionEstimate &est,
+    const dso::datetime<dso::nanoseconds> &sinex_data_start) noexcept;
+
+/** @brief Parse a SITE/RECEIVER record line.
+ * @param[in] line A (null-terminated) SITE/RECEIVER data line
+ * @param[out] rec The parsed record
+ * @param[in] sinex_data_start Data start time of the SINEX file; used to
+ *            resolve '00:000:00000' start dates
+ * @param[in] sinex_data_stop Data end time of the SINEX file; used to
+ *            resolve '00:000:00000' stop dates
+ * @return Anything other than zero denotes an error
+ */
+int parse_site_receiver_line(
+    const char *line, SiteReceiver &rec,
+    const dso::datetime<dso::nanoseconds> &sinex_data_start,
+    const dso::datetime<dso::nanoseconds> &sinex_data_stop) noexcept;
+
+/** @brief Parse a SITE/ANTENNA record line.
+ * @param[in] line A (null-terminated) SITE/ANTENNA data line
+ * @param[out] ant The parsed record
+ * @param[in] sinex_data_start Data start time of the SINEX file; used to
+ *            resolve '00:000:00000' start dates
+ * @param[in] sinex_data_stop Data end time of the SINEX file; used to
+ *            resolve '00:000:00000' stop dates
+ * @return Anything other than zero denotes an error
+ */
+int parse_site_antenna_line(
+    const char *line, SiteAntenna &ant,
+    const dso::datetime<dso::nanoseconds> &sinex_data_start,
+    const dso::datetime<dso::nanoseconds> &sinex_data_stop) noexcept;
+
+/** @brief Parse a SITE/ECCENTRICITY record line.
+ * @param[in] line A (null-terminated) SITE/ECCENTRICITY data line
+ * @param[out] ecc The parsed record
+ * @param[in] sinex_data_start Data start time of the SINEX file; used to
+ *            resolve '00:000:00000' start dates
+ * @param[in] sinex_data_stop Data end time of the SINEX file; used to
+ *            resolve '00:000:00000' stop dates
+ * @return Anything other than zero denotes an error
+ */
+int parse_site_eccentricity_line(
+    const char *line, SiteEccentricity &ecc,
+    const dso::datetime<dso::nanoseconds> &sinex_data_start,
+    const dso::datetime<dso::nanoseconds> &sinex_data_stop) noexcept;
+
+/** @brief Parse a SOLUTION/DATA_REJECT record line.
+ * @param[in] line A (null-terminated) SOLUTION/DATA_REJECT data line
+ * @param[out] rintrv The parsed record
+ * @param[in] sinex_data_start Data start time of the SINEX file; used to
+ *            resolve '00:000:00000' start dates
+ * @param[in] sinex_data_stop Data end time of the SINEX file; used to
+ *            resolve '00:000:00000' stop dates
+ * @return Anything other than zero denotes an error
+ */
+int parse_data_reject_line(
+    const char *line, DataReject &rintrv,
+    const dso::datetime<dso::nanoseconds> &sinex_data_start,
+    const dso::datetime<dso::nanoseconds> &sinex_data_stop) noexcept;
+
+/** @brief Parse a SOLUTION/MATRIX_* record line, i.e. a row index and a
+ *         column index, followed by the values of (up to) three consecutive
+ *         elements of the row. Trailing values may be omitted.
+ * @param[in] line A (null-terminated) SOLUTION/MATRIX_* data line
+ * @param[out] row Row index (PARA1), as written (i.e. 1-based)
+ * @param[out] col Column index of the first value (PARA2), as written
+ * @param[out] vals Array of (at least) three doubles; the values of elements
+ *            (row, col), (row, col+1) and (row, col+2)
+ * @param[out] num_vals Number of values in the line (1 to 3)
+ * @return Anything other than zero denotes an error
+ */
+int parse_matrix_line(const char *line, int &row, int &col, double *vals,
+                      int &num_vals) noexcept;
+
+/** @brief Compile-time description of the records of a block, i.e. the
+ *         block name, the line layout (line_layout, see layout::) and a
+ *         line parser taking the data start and stop times of the SINEX
+ *         file (used to resolve '00:000:00000' dates). Views (e.g.
+ *         SiteIdView) have is_view set and no line parser.
+ */
+template <typename T> struct record_traits;
+
+template <> struct record_traits<SiteId> {
+  static constexpr const char *block_name = "SITE/ID";
+  static constexpr bool is_view = false;
+  using line_layout = layout::SiteId;
+  static int parse(const char *line, SiteId &rec,
+                   const dso::datetime<dso::nanoseconds> &,
+                   const dso::datetime<dso::nanoseconds> &) noexcept {
+    return parse_site_id_line(line, rec);
+  }
+};
+
+template <> struct record_traits<SiteReceiver> {
+  static constexpr const char *block_name = "SITE/RECEIVER";
+  static constexpr bool is_view = false;
+  using line_layout = layout::SiteReceiver;
+  static int parse(const char *line, SiteReceiver &rec,
+                   const dso::datetime<dso::nanoseconds> &start,
+                   const dso::datetime<dso::nanoseconds> &stop) noexcept {
+    return parse_site_receiver_line(line, rec, start, stop);
+  }
+};
+
+template <> struct record_traits<SiteAntenna> {
+  static constexpr const char *block_name = "SITE/ANTENNA";
+  static constexpr bool is_view = false;
+  using line_layout = layout::SiteAntenna;
+  static int parse(const char *line, SiteAntenna &rec,
+                   const dso::datetime<dso::nanoseconds> &start,
+                   const dso::datetime<dso::nanoseconds> &stop) noexcept {
+    return parse_site_antenna_line(line, rec, start, stop);
+  }
+};
+
+template <> struct record_traits<SiteEccentricity> {
+  static constexpr const char *block_name = "SITE/ECCENTRICITY";
+  static constexpr bool is_view = false;
+  using line_layout = layout::SiteEccentricity;
+  static int parse(const char *line, SiteEccentricity &rec,
+                   const dso::datetime<dso::nanoseconds> &start,
+                   const dso::datetime<dso::nanoseconds> &stop) noexcept {
+    return parse_site_eccentricity_line(line, rec, start, stop);
+  }
+};
+
+template <> struct record_traits<SolutionEpoch> {
+  static constexpr const char *block_name = "SOLUTION/EPOCHS";
+  static constexpr bool is_view = false;
+  using line_layout = layout::SolutionEpoch;
+  static int parse(const char *line, SolutionEpoch &rec,
+                   const dso::datetime<dso::nanoseconds> &start,
+                   const dso::datetime<dso::nanoseconds> &stop) noexcept {
+    return parse_epoch_line(line, start, stop, rec);
+  }
+};
+
+template <> struct record_traits<SolutionEstimate> {
+  static constexpr const char *block_name = "SOLUTION/ESTIMATE";
+  static constexpr bool is_view = false;
+  using line_layout = layout::SolutionEstimate;
+  static int parse(const char *line, SolutionEstimate &rec,
+                   const dso::datetime<dso::nanoseconds> &start,
+                   const dso::datetime<dso::nanoseconds> &) noexcept {
+    return parse_solution_estimate_line(line, rec, start);
+  }
+};
+
+template <> struct record_traits<DataReject> {
+  static constexpr const char *block_name = "SOLUTION/DATA_REJECT";
+  static constexpr bool is_view = false;
+  using line_layout = layout::DataReject;
+  static int parse(const char *line, DataReject &rec,
+                   const dso::datetime<dso::nanoseconds> &start,
+                   const dso::datetime<dso::nanoseconds> &stop) noexcept {
+    return parse_data_reject_line(line, rec, start, stop);
+  }
+};
+
+} /* namespace dso::sinex::details */
+
+#endif
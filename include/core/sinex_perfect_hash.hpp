@@ -0,0 +1,130 @@
+/** @file
+ * Compile-time generated perfect hash tables for the (fixed) vocabularies of
+ * SINEX files, i.e. parameter types and block names. These are
+ * implementation details and should not be needed by the end-user.
+ *
+ * Each word of a vocabulary is reduced to a 64-bit key; the table is then
+ * addressed by the top bits of key * multiplier, where the multiplier is
+ * searched for (at compile time) so that no two words of the vocabulary
+ * share a slot. A lookup thus costs one multiplication, one table access
+ * and one comparison against the (only) candidate word.
+ */
+
+#ifndef __SINEX_FILE_PERFECT_HASH_HPP__
+#define __SINEX_FILE_PERFECT_HASH_HPP__
+
+#include <cstdint>
+#include <cstring>
+
+namespace dso::sinex::details {
+
+/** @brief Pack (at most) the first n characters of str in a 64-bit integer
+ *         (first character in the least significant byte), stopping at the
+ *         first null-terminating character.
+ */
+constexpr std::uint64_t pack_word(const char *str, int n) noexcept {
+  std::uint64_t key = 0;
+  for (int i = 0; i < n && i < 8 && str[i]; i++)
+    key |= (std::uint64_t)(unsigned char)str[i] << (8 * i);
+  return key;
+}
+
+/** @brief 64-bit key of a word of len characters; mixes its first and last
+ *         (at most) 8 characters and its length. For words of up to 8
+ *         characters, the key is just the packed characters.
+ */
+constexpr std::uint64_t word_key(const char *str, int len) noexcept {
+  if (len <= 8)
+    return pack_word(str, len);
+  const std::uint64_t first = pack_word(str, 8);
+  const std::uint64_t last = pack_word(str + len - 8, 8);
+  return first ^ ((last << 29) | (last >> 35)) ^
+         ((std::uint64_t)len * 0x9E3779B97F4A7C15ULL);
+}
+
+/** @brief Length of a (null-terminated) string, usable at compile time */
+constexpr int word_length(const char *str) noexcept {
+  int len = 0;
+  while (str[len])
+    ++len;
+  return len;
+}
+
+/** @class PerfectHashTable
+ * A perfect hash table for a vocabulary of N words: 2^Bits slots, holding
+ * the index (within the vocabulary) of the word hashed to each slot, or -1
+ * for empty slots.
+ */
+template <int Bits, int N> struct PerfectHashTable {
+  static_assert(Bits > 0 && Bits <= 12, "Invalid perfect hash table size");
+  static_assert(N < 128, "Vocabulary too large for perfect hash table");
+  static constexpr int size = 1 << Bits;
+  /** Multiplier; 0 if no perfect hash function was found */
+  std::uint64_t multiplier = 0;
+  std::int8_t slots[size] = {};
+  /** Key and length of each word */
+  std::uint64_t keys[N] = {};
+  int lengths[N] = {};
+  /** The vocabulary */
+  const char *const *words = nullptr;
+
+  /** @brief Slot of a key */
+  constexpr int slot(std::uint64_t key) const noexcept {
+    return (int)((key * multiplier) >> (64 - Bits));
+  }
+
+  /** @brief Index of the word (str, of len characters) in the vocabulary,
+   *         or -1 if str is not part of it.
+   */
+  int find(const char *str, int len) const noexcept {
+    const std::uint64_t key = word_key(str, len);
+    const int i = slots[slot(key)];
+    return ((i >= 0) && (keys[i] == key) && (lengths[i] == len) &&
+            ((len <= 8) || !std::memcmp(str, words[i], len)))
+               ? i
+               : -1;
+  }
+};
+
+/** @brief Build (at compile time) a perfect hash table for a vocabulary of
+ *         N (distinct) words, given as an array of null-terminated strings.
+ *
+ * Candidate (odd) multipliers are drawn off a splitmix64 sequence, until
+ * one maps all words to distinct slots. On failure, the multiplier of the
+ * table returned is 0.
+ */
+template <int Bits, int N>
+constexpr PerfectHashTable<Bits, N>
+make_perfect_hash(const char *const (&words)[N]) noexcept {
+  PerfectHashTable<Bits, N> table;
+  table.words = words;
+  for (int i = 0; i < N; i++) {
+    table.lengths[i] = word_length(words[i]);
+    table.keys[i] = word_key(words[i], table.lengths[i]);
+  }
+
+  std::uint64_t state = 0x2545F4914F6CDD1DULL;
+  for (int attempt = 0; attempt < 100000; attempt++) {
+    state += 0x9E3779B97F4A7C15ULL;
+    std::uint64_t z = state;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    table.multiplier = (z ^ (z >> 31)) | 1ULL;
+    for (int s = 0; s < table.size; s++)
+      table.slots[s] = -1;
+    bool perfect = true;
+    for (int i = 0; i < N && perfect; i++) {
+      const int s = table.slot(table.keys[i]);
+      perfect = (table.slots[s] < 0);
+      table.slots[s] = (std::int8_t)i;
+    }
+    if (perfect)
+      return table;
+  }
+  table.multiplier = 0;
+  return table;
+}
+
+} /* namespace dso::sinex::details */
+
+#endif
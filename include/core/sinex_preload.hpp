@@ -0,0 +1,39 @@
+/** @file
+ * Storage for blocks parsed in the background (see dso::Sinex::preload).
+ * These are implementation details and should not be needed by the
+ * end-user.
+ */
+
+#ifndef __SINEX_FILE_PRELOAD_HPP__
+#define __SINEX_FILE_PRELOAD_HPP__
+
+#include "sinex_blocks.hpp"
+#include <future>
+#include <tuple>
+#include <vector>
+
+namespace dso::sinex::details {
+
+/** @brief All records of a block, parsed in the background. If error is
+ *        not zero, parsing failed and records should not be used.
+ */
+template <typename T> struct PreloadedBlock {
+  std::vector<T> records;
+  int error = 0;
+};
+
+/** @brief One (future) preloaded block per record type; a future is only
+ *        valid if the respective block was requested for preloading.
+ */
+using PreloadedBlocks =
+    std::tuple<std::shared_future<PreloadedBlock<SiteId>>,
+               std::shared_future<PreloadedBlock<SiteReceiver>>,
+               std::shared_future<PreloadedBlock<SiteAntenna>>,
+               std::shared_future<PreloadedBlock<SiteEccentricity>>,
+               std::shared_future<PreloadedBlock<SolutionEpoch>>,
+               std::shared_future<PreloadedBlock<SolutionEstimate>>,
+               std::shared_future<PreloadedBlock<DataReject>>>;
+
+} /* namespace dso::sinex::details */
+
+#endif
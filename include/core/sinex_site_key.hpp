@@ -0,0 +1,226 @@
+/** @file
+ * Packed site keys and a (open-addressing) hash map to match SINEX record
+ * lines against a list of sites, in constant time per line. These are
+ * implementation details and should not be needed by the end-user.
+ */
+
+#ifndef __SINEX_FILE_SITE_KEY_HPP__
+#define __SINEX_FILE_SITE_KEY_HPP__
+
+#include "sinex_blocks.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace dso::sinex::details {
+
+/** @brief Pack (at most) n characters of str in an integer, one character
+ *        per byte (first character in the least significant byte).
+ * Packing stops at a null character, so that two keys compare equal exactly
+ * when std::strncmp(str1, str2, n) does.
+ */
+inline std::uint64_t pack_chars(const char *str, int n) noexcept {
+  std::uint64_t key = 0;
+  for (int i = 0; i < n && str[i]; i++)
+    key |= (std::uint64_t)(unsigned char)str[i] << (8 * i);
+  return key;
+}
+
+/** @brief Packed SITE CODE [A4] plus POINT CODE [A2] (48 bits) */
+inline std::uint64_t site_key(const char *site_code,
+                              const char *point_code) noexcept {
+  return pack_chars(site_code, 4) | (pack_chars(point_code, 2) << 32);
+}
+
+/** @brief Packed SITE CODE [A4] plus DOMES [A9] (60 bits).
+ *
+ * The DOMES number is expected in the format NNNNNLNNN, where N is a digit
+ * and L is 'S' (site) or 'M' (marker); it is packed in 28 bits.
+ *
+ * @return False if the DOMES cannot be packed (i.e. is not in the expected
+ *         format); key is not set in this case.
+ */
+inline bool site_domes_key(const char *site_code, const char *domes,
+                           std::uint64_t &key) noexcept {
+  std::uint64_t num = 0;
+  for (int i = 0; i < 9; i++) {
+    if (i == 5) {
+      if (domes[i] != 'S' && domes[i] != 'M')
+        return false;
+      num = num * 2 + (domes[i] == 'M');
+    } else {
+      if (domes[i] < '0' || domes[i] > '9')
+        return false;
+      num = num * 10 + (domes[i] - '0');
+    }
+  }
+  key = pack_chars(site_code, 4) | (num << 32);
+  return true;
+}
+
+/** @class SiteKeyMap
+ * An open-addressing (linear probing) hash map from packed site keys to
+ * (non-negative) integer values, e.g. indexes into a vector of records.
+ *
+ * The same key can be inserted more than once; lookups visit entries of the
+ * same key in order of insertion, so that find_if() returns the same entry
+ * std::find_if() would, when run over the records in insertion order.
+ */
+class SiteKeyMap {
+  std::vector<std::uint64_t> m_keys;
+  std::vector<int> m_values; /* -1 marks an empty slot */
+  std::size_t m_mask = 0;
+  std::size_t m_size = 0;
+
+  static std::size_t hash(std::uint64_t key) noexcept {
+    /* splitmix64 finalizer */
+    key ^= key >> 30;
+    key *= 0xbf58476d1ce4e5b9ULL;
+    key ^= key >> 27;
+    key *= 0x94d049bb133111ebULL;
+    key ^= key >> 31;
+    return (std::size_t)key;
+  }
+
+  /** @brief Grow the table to capacity slots and re-insert all entries */
+  void rehash(std::size_t capacity) {
+    std::vector<std::uint64_t> keys;
+    std::vector<int> values;
+    keys.swap(m_keys);
+    values.swap(m_values);
+    m_keys.resize(capacity);
+    m_values.assign(capacity, -1);
+    m_mask = capacity - 1;
+    m_size = 0;
+    /* entries of the same key lie in the same cluster, in order of
+     * insertion; re-insert clusters front-to-back (i.e. starting off from an
+     * empty slot) to keep that order */
+    const std::size_t old_mask = keys.size() - 1;
+    std::size_t start = 0;
+    while (values[start] >= 0)
+      start = (start + 1) & old_mask;
+    for (std::size_t n = 0, i = start; n < keys.size();
+         n++, i = (i + 1) & old_mask) {
+      if (values[i] >= 0)
+        insert(keys[i], values[i]);
+    }
+  }
+
+public:
+  /** @brief Constructor; allocate storage for (at least) n entries */
+  explicit SiteKeyMap(std::size_t n = 0) {
+    std::size_t capacity = 16;
+    while (capacity < 2 * n)
+      capacity *= 2;
+    m_keys.resize(capacity);
+    m_values.assign(capacity, -1);
+    m_mask = capacity - 1;
+  }
+
+  /** @brief Build a map of the site keys (SITE CODE plus POINT CODE) of a
+   *        vector of records; values are indexes into the vector.
+   * @tparam T A record type with site_code() and point_code() methods, e.g.
+   *         sinex::SiteId or sinex::SolutionEstimate
+   */
+  template <typename T>
+  static SiteKeyMap of_sites(const std::vector<T> &vec) {
+    SiteKeyMap map(vec.size());
+    for (std::size_t i = 0; i < vec.size(); i++)
+      map.insert(site_key(vec[i].site_code(), vec[i].point_code()), (int)i);
+    return map;
+  }
+
+  /** @brief Number of entries in the map */
+  std::size_t size() const noexcept { return m_size; }
+
+  /** @brief Insert an entry; the same key can be inserted multiple times */
+  void insert(std::uint64_t key, int value) {
+    if (2 * (m_size + 1) > m_keys.size())
+      rehash(2 * m_keys.size());
+    std::size_t i = hash(key) & m_mask;
+    while (m_values[i] >= 0)
+      i = (i + 1) & m_mask;
+    m_keys[i] = key;
+    m_values[i] = value;
+    ++m_size;
+  }
+
+  /** @brief Find the first entry (in order of insertion) with the given key,
+   *         for which pred(value) returns true.
+   * @return The value of the entry, or -1 if no such entry exists
+   */
+  template <typename F>
+  int find_if(std::uint64_t key, F &&pred) const noexcept {
+    for (std::size_t i = hash(key) & m_mask; m_values[i] >= 0;
+         i = (i + 1) & m_mask) {
+      if (m_keys[i] == key && pred(m_values[i]))
+        return m_values[i];
+    }
+    return -1;
+  }
+
+  /** @brief Find the first entry (in order of insertion) with the given key
+   * @return The value of the entry, or -1 if no such entry exists
+   */
+  int find(std::uint64_t key) const noexcept {
+    return find_if(key, [](int) { return true; });
+  }
+
+  /** @brief Check if the map holds an entry with the given key */
+  bool contains(std::uint64_t key) const noexcept { return find(key) >= 0; }
+}; /* SiteKeyMap */
+
+/** @class SiteIdFilter
+ * Match SITE/ID records against a list of sites of interest, given as
+ * strings of the form "DIOB" or "DIOB 12602S012" (if use_domes is set). A
+ * record matches, exactly when SiteId::issame() returns true for any of the
+ * strings given.
+ */
+class SiteIdFilter {
+  /** Packed keys of the sites of interest */
+  SiteKeyMap m_keys;
+  /** "CODE DOMES" strings with a DOMES that cannot be packed */
+  std::vector<std::string> m_unpacked;
+  bool m_use_domes;
+  bool m_all;
+
+public:
+  /** @brief Constructor; if sites is empty, all records match */
+  SiteIdFilter(const std::vector<const char *> &sites, bool use_domes)
+      : m_keys(sites.size()), m_use_domes(use_domes), m_all(sites.empty()) {
+    for (const char *site : sites) {
+      if (!use_domes) {
+        m_keys.insert(pack_chars(site, 4), 0);
+      } else if (std::strlen(site) >= 14) {
+        std::uint64_t key;
+        if (site_domes_key(site, site + 5, key))
+          m_keys.insert(key, 0);
+        else
+          m_unpacked.emplace_back(site);
+      }
+    }
+  }
+
+  /** @brief Check if a SITE/ID record is of interest */
+  bool matches(const SiteId &site) const noexcept {
+    if (m_all)
+      return true;
+    if (!m_use_domes)
+      return m_keys.contains(pack_chars(site.site_code(), 4));
+    std::uint64_t key;
+    if (site_domes_key(site.site_code(), site.domes(), key))
+      return m_keys.contains(key);
+    /* a DOMES that cannot be packed can only match an unpacked one */
+    for (const auto &s : m_unpacked) {
+      if (site.issame<SiteMatchPolicyType::USEDOMES>(s.c_str()))
+        return true;
+    }
+    return false;
+  }
+}; /* SiteIdFilter */
+
+} /* namespace dso::sinex::details */
+
+#endif
@@ -5,8 +5,22 @@
 #ifndef __SINEX_FILE_PARSER_HPP__
 #define __SINEX_FILE_PARSER_HPP__
 
+#include "core/sinex_io.hpp"
+#include "core/sinex_preload.hpp"
 #include "sinex_blocks.hpp"
+#include "sinex_estimate_columns.hpp"
+#include "sinex_matrix.hpp"
+#include "sinex_parameter_index.hpp"
+#include "sinex_tiled_matrix.hpp"
+#include "sinex_query.hpp"
+#include "sinex_views.hpp"
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <string_view>
 #include <type_traits>
+#include <utility>
 #include <vector>
 #include "geodesy/transformations.hpp"
 #ifdef DEBUG
@@ -16,10 +30,60 @@
 
 namespace dso {
 
+/** @brief Choose how a dso::Sinex instance accesses the underlying file.
+ *
+ * Stream: The file is accessed via positional reads (i.e. pread) off from a
+ *         file descriptor opened at construction; block parsers read the
+ *         byte range of a block in chunks, line by line.
+ * MemoryMap: The file is mapped (read-only) to memory once, at construction;
+ *         block indexing and block parsers work on pointer ranges of the
+ *         mapped bytes, with no per-line stream calls. If the file cannot be
+ *         mapped (e.g. it is not a regular file), the instance falls back to
+ *         Stream mode.
+ *
+ * Compressed files (gzip, i.e. '.snx.gz', or Unix compress, i.e. '.snx.Z';
+ * detected by their magic bytes) are decompressed to an internal buffer at
+ * construction and always use MemoryMap mode.
+ */
+enum class SinexIoMode { Stream, MemoryMap };
+
+/** @brief Choose if a dso::Sinex instance uses a persistent block index.
+ *
+ * The block index is a sidecar file (i.e. 'file.snx.idx' for 'file.snx')
+ * holding the block table and per-block summaries (see
+ * dso::sinex::SinexBlockSummary). It is only used if it matches the SINEX
+ * file's size, modification time and (partial) content hash.
+ *
+ * None: No index is used; blocks are marked at every construction.
+ * ReadOnly: Load the index if it exists and is valid, else mark blocks; an
+ *         index is never written.
+ * ReadWrite: Load the index if it exists and is valid, else mark blocks and
+ *         (re-)write the index. Failing to write the index is not an error.
+ */
+enum class SinexIndexPolicy { None, ReadOnly, ReadWrite };
+
+/** @brief Tag selecting the dso::Sinex constructors that take SINEX content
+ *         already in memory, rather than a filename; see
+ *         dso::Sinex::from_buffer.
+ */
+struct SinexBufferTag {
+  explicit SinexBufferTag() = default;
+};
+inline constexpr SinexBufferTag sinex_buffer{};
+
 /** An (input) SINEX class
  *
  * This class acts as an interface for reading/parsing SINEX files and
- * extracting all relevant information
+ * extracting all relevant information.
+ *
+ * The block table is built at construction and never modified afterwards;
+ * every query reads its block via its own cursor. Hence, all (const) query
+ * methods of a single instance can be called concurrently, from any number
+ * of threads.
+ *
+ * Blocks can optionally be parsed in the background, right after
+ * construction (see preload()); queries on such blocks then only wait for
+ * the block they need.
  */
 class Sinex {
 private:
@@ -27,8 +91,12 @@ private:
 
   /** SINEX filename */
   std::string m_filename;
-  /** input stream (opened at c'tor) */
-  std::ifstream m_stream;
+  /** input file (opened at c'tor, only used in SinexIoMode::Stream) */
+  sinex::details::InputFile m_file;
+  /** memory mapping of the file (only used in SinexIoMode::MemoryMap) */
+  sinex::details::MappedFile m_map;
+  /** I/O mode actually used by the instance */
+  SinexIoMode m_mode;
   /** format version */
   float m_version;
   /** agency creating the file [A3] */
@@ -50,40 +118,193 @@ private:
   /** Number of parameters estimated in this SINEX file */
   long m_num_estimates;
   /** Markers for easily accesing blocks. The entries here mark SINEX
-   * block-positions and block-types. When placing the stream at a the
-   * m_blocks[n], that means that:
-   * We place the (input) stream poisition at m_blocks[n].mpos, i.e. the end
-   * of the previous line, prior to the start of the new block (this means
-   * that the next line to be read is the starting of a new block, e.g.
-   * '+SOLUTION/EPOCHS'). Next line to be read is start of block described by
-   * m_blocks[n].mtype.
+   * block-positions and block-types. For each block m_blocks[n] (of type
+   * m_blocks[n].mtype), we record the offset of the block header line (e.g.
+   * '+SOLUTION/EPOCHS') in mpos, the offset of the first payload line in
+   * mdata, the offset of the trailer line (e.g. '-SOLUTION/EPOCHS') in mend
+   * and the number of payload lines in mlines.
    */
   std::vector<sinex::SinexBlockPosition> m_blocks;
+  /** Summaries of blocks, one entry per m_blocks entry; these are either
+   * loaded from the block index or computed on demand (else empty).
+   * Computing them on demand is guarded by m_summaries_mtx.
+   */
+  mutable std::vector<sinex::SinexBlockSummary> m_summaries;
+  mutable std::mutex m_summaries_mtx;
+  /** True if m_blocks were loaded off from a block index file */
+  bool m_index_loaded = false;
+  /** Blocks parsed in the background (see preload()). Declared last, so
+   * that it is destroyed first: releasing the shared state of an
+   * std::async task waits for the task to finish, hence no task outlives
+   * the members it reads.
+   */
+  sinex::details::PreloadedBlocks m_preloaded;
 
   /** @brief Parse first SINEX line (header) and assign instance's member vars
    */
   int parse_first_line() noexcept;
 
   /** @brief Read the SINEX file through, and mark all positions of interest
-   *       (i.e. start of blocks).
+   *       (i.e. start and end of blocks).
    * This function will fill in the m_blocks vector and perform a basic
-   * sanity check of the SINEX file. Note that m_blocks does not contain
-   * positions of the 'start of a block line', but rather positions of
-   * 'eol before a new block line'.
+   * sanity check of the SINEX file (every block should be closed by a
+   * matching trailer line, before the next one starts).
    * This function should only be called once, at the instance's ctor.
    */
   int mark_blocks() noexcept;
 
-  /** @brief Go (i.e. place the stream) at the the start of a block in a SINEX
-   *        instance.
+  /** @brief Check that the block table (as loaded off from a block index)
+   *        points to block marker lines, i.e. that the bytes at each
+   *        block's mpos and mend are '+' and '-' respectively.
+   * @return Anything other than zero denotes an invalid block table
+   */
+  int check_block_markers() const noexcept;
+
+  /** @brief mark_blocks() implementation for SinexIoMode::Stream */
+  int mark_blocks_stream() noexcept;
+
+  /** @brief mark_blocks() implementation for SinexIoMode::MemoryMap; block
+   * marker lines are collected via sinex::details::scan_block_markers().
+   */
+  int mark_blocks_mapped() noexcept;
+
+  /** @brief Compute block summaries, one entry for each block in m_blocks.
+   * @param[out] summaries One sinex::SinexBlockSummary per m_blocks entry
+   */
+  int summarize_blocks(
+      std::vector<sinex::SinexBlockSummary> &summaries) const noexcept;
+
+  /** @brief Place a line cursor at the the start of a block's payload in a
+   *        SINEX instance.
    * Asserts that the mark_blocks() function has already been called. Example:
-   * if (goto_block("SOLUTION/EPOCHS")) return 1;
-   * Now, next line to be read is: "+SOLUTION/EPOCHS"
+   * sinex::details::LineCursor cursor;
+   * if (goto_block("SOLUTION/EPOCHS", cursor)) return 1;
+   * Now, next line to be read (via cursor) is the first line after
+   * "+SOLUTION/EPOCHS" (i.e. the header line is skipped).
    *
    * @param[in] A valid SINEX block (see e.g. dso::sinex::block_names[]);
    *            expects a NULL terminated C-string.
+   * @param[out] cursor A cursor to read the block lines from. In Stream mode
+   *            this reads the block's byte range off from the instance's
+   *            file (via positional reads), in MemoryMap mode off from the
+   *            mapped bytes. Cursors are independent of each other, so any
+   *            number of them can be used concurrently.
+   */
+  int goto_block(const char *block,
+                 sinex::details::LineCursor &cursor) const noexcept;
+
+  /** @brief Place a line cursor at the start of the payload of block blk
+   *        (an m_blocks entry); see goto_block().
+   */
+  int block_cursor(const sinex::SinexBlockPosition &blk,
+                   sinex::details::LineCursor &cursor) const noexcept;
+
+  /** @brief Split the payload of a block on line boundaries into chunks of
+   *        about equal size, and place a line cursor at the start of each
+   *        (see goto_block()). Reading the cursors in order yields exactly
+   *        the lines of the block.
+   * @param[in] block A valid SINEX block name, e.g. "SOLUTION/ESTIMATE"
+   * @param[in] num_threads Max number of chunks; if zero, the number is
+   *            chosen based on the hardware. Small blocks are not split.
+   * @param[out] cursors One cursor per chunk, in file order (at least one)
+   */
+  int goto_block_chunks(
+      const char *block, int num_threads,
+      std::vector<sinex::details::LineCursor> &cursors) const noexcept;
+
+  /** @brief Read the data lines of a number of blocks in one sweep.
+   *
+   * This is the query plan for queries needing records off from more than
+   * one block: blocks are read in the order they appear in the file
+   * (regardless of the order given), each one front to back, exactly once;
+   * hence the file is only ever read forward. Handlers should thus not rely
+   * on the order of blocks (e.g. SOLUTION/EPOCHS before SOLUTION/ESTIMATE).
+   *
+   * @param[in] blocks Names of the blocks to read, e.g.
+   *            {"SOLUTION/EPOCHS", "SOLUTION/ESTIMATE"}
+   * @param[in] handler A callable of signature int(int block, const char
+   *            *line), called for every data (i.e. non-comment) line, with
+   *            block the index of the line's block in blocks; anything
+   *            other than zero returned ends the sweep (as an error)
+   * @return Anything other than zero denotes an error (e.g. a block does
+   *         not exist, or the handler failed)
+   */
+  template <typename Handler>
+  int sweep_blocks(const std::vector<const char *> &blocks,
+                   Handler &&handler) const noexcept {
+    /* plan: the blocks, in file order */
+    std::vector<std::pair<std::streamoff, int>> plan;
+    try {
+      plan.reserve(blocks.size());
+      for (int i = 0; i < (int)blocks.size(); i++) {
+        const auto it = find_block(blocks[i]);
+        if (it == m_blocks.cend()) {
+          fprintf(stderr,
+                  "[ERROR] Failed to find block %s in SINEX file %s "
+                  "(traceback: %s)\n",
+                  blocks[i], m_filename.c_str(), __func__);
+          return 1;
+        }
+        plan.emplace_back((std::streamoff)it->mdata, i);
+      }
+    } catch (std::exception &) {
+      return 1;
+    }
+    std::sort(plan.begin(), plan.end());
+
+    char line[sinex::max_sinex_chars];
+    for (const auto &step : plan) {
+      sinex::details::LineCursor cursor;
+      if (block_cursor(*find_block(blocks[step.second]), cursor))
+        return 1;
+      while (cursor.getline(line)) {
+        if (*line != '*' && handler(step.second, (const char *)line))
+          return 1;
+      }
+      if (!cursor.done()) {
+        fprintf(stderr,
+                "[ERROR] Failed reading block \'%s\' of SINEX file %s "
+                "(traceback: %s)\n",
+                blocks[step.second], m_filename.c_str(), __func__);
+        return 1;
+      }
+    }
+    return 0;
+  }
+
+  /** @brief Get the (mapped) bytes of a block's payload, i.e. [begin, end)
+   *        spans all lines between the block's header and trailer. Only
+   *        available in SinexIoMode::MemoryMap.
+   * @return Anything other than zero denotes an error (e.g. the block does
+   *         not exist, or the instance is not in SinexIoMode::MemoryMap).
    */
-  int goto_block(const char *block) noexcept;
+  int block_bytes(const char *block, const char *&begin,
+                  const char *&end) const noexcept;
+
+  /** @brief Start parsing the block of record type T in the background, if
+   *        block is its name (see sinex::details::record_traits).
+   * @param[in] block A SINEX block name, e.g. "SOLUTION/ESTIMATE"
+   * @param[in] launch If false, only check the block name
+   * @return True if block is the block of record type T
+   */
+  template <typename T>
+  bool launch_preload(const char *block, bool launch) noexcept;
+
+  /** @brief Get the records of the block of record type T, if the block was
+   *        preloaded (see preload()) and the query accepts all records;
+   *        waits for the block to be parsed.
+   * @return A pointer to the records, or nullptr if they should be parsed
+   *         on demand (i.e. not preloaded, preloading failed, or the query
+   *         needs the raw lines).
+   */
+  template <typename T>
+  const std::vector<T> *
+  preloaded_block(const sinex::QueryPredicate &query) const noexcept {
+    const std::vector<T> *records;
+    if ((!query.accepts_all()) || preloaded_records(records))
+      return nullptr;
+    return records;
+  }
 
   /** @brief Given a block name, find the relevant entry in the m_blocks
    *        vector.
@@ -92,13 +313,22 @@ private:
    *         if no such block exists in the SINEX file).
    */
   std::vector<sinex::SinexBlockPosition>::const_iterator
-  find_block(const char *blk) noexcept {
+  find_block(const char *blk) const noexcept {
     return std::find_if(m_blocks.cbegin(), m_blocks.cend(),
                         [&](const sinex::SinexBlockPosition &sbp) {
                           return !std::strcmp(sbp.mtype, blk);
                         });
   }
 
+  /** @brief The SOLUTION/MATRIX_ESTIMATE block of the given type to parse
+   *        (the L block if it exists, else the U block), and the matrix
+   *        dimension (i.e. the number of estimates in the header).
+   * @return The block name, or nullptr on error
+   */
+  const char *matrix_estimate_block(sinex::MatrixType type,
+                                    sinex::MatrixTriangle &triangle,
+                                    int &n) const noexcept;
+
   /** @brief Get SOLUTION/EPOCHS for given sites and epoch
    *
    * Parse the SINEX block SOLUTION/EPOCHS and return a vector of
@@ -121,12 +351,19 @@ private:
    * @param[out] out_vec A vector of sinex::SolutionEpoch instances for some
    *              or all of the sites contained in site_vec, valid for the
    *              time given (i.e. t)
+   * @param[in] query Conditions on the records to collect; evaluated on
+   *            the raw columns of each line, before decoding it (see
+   *            sinex::QueryPredicate)
+   * @param[out] stats If given, the number of lines skipped and decoded is
+   *            added to it
    * @return Anything other than zero denotes an error
    */
   int parse_solution_epoch_noextrapolate(
       const std::vector<sinex::SiteId> &site_vec,
       const dso::datetime<dso::nanoseconds> &t,
-      std::vector<dso::sinex::SolutionEpoch> &out_vec) noexcept;
+      std::vector<dso::sinex::SolutionEpoch> &out_vec,
+      const sinex::QueryPredicate &query,
+      sinex::QueryStats *stats) const noexcept;
 
   /** @brief Get SOLUTION/EPOCHS records
    *
@@ -155,17 +392,251 @@ private:
    *              sinex::SolutionEpoch instances may not satisfy
    *              SOLUTION_ID_START <= t < SOLUTION_ID_STOP, but will be the
    *              closest ones to the time given (i.e. t).
+   * @param[in] query Conditions on the records to collect; evaluated on
+   *            the raw columns of each line, before decoding it (see
+   *            sinex::QueryPredicate)
+   * @param[out] stats If given, the number of lines skipped and decoded is
+   *            added to it
    * @return Anything other than zero denotes an error
    */
   int parse_solution_epoch_extrapolate(
       const std::vector<sinex::SiteId> &site_vec,
       const dso::datetime<dso::nanoseconds> &t,
-      std::vector<dso::sinex::SolutionEpoch> &out_vec) noexcept;
+      std::vector<dso::sinex::SolutionEpoch> &out_vec,
+      const sinex::QueryPredicate &query,
+      sinex::QueryStats *stats) const noexcept;
 
 public:
   /** return the SINEX filename */
   std::string filename() const noexcept { return m_filename; }
 
+  /** return the I/O mode used by the instance */
+  SinexIoMode io_mode() const noexcept { return m_mode; }
+
+  /** return true if the blocks were loaded off from a block index file */
+  bool block_index_loaded() const noexcept { return m_index_loaded; }
+
+  /** return the blocks marked in the SINEX file */
+  const std::vector<sinex::SinexBlockPosition> &blocks() const noexcept {
+    return m_blocks;
+  }
+
+  /** return the start time of the data used in the SINEX solution */
+  const dso::datetime<dso::nanoseconds> &data_start() const noexcept {
+    return m_data_start;
+  }
+
+  /** return the end time of the data used in the SINEX solution */
+  const dso::datetime<dso::nanoseconds> &data_stop() const noexcept {
+    return m_data_stop;
+  }
+
+  /** @brief Get (zero-copy) views of all records of a block.
+   *
+   * The block is chosen by the view type, i.e. View::block_name (e.g.
+   * sinex::SiteIdView for SITE/ID). No line is decoded (or even located)
+   * here; records are located on iteration and fields are decoded only
+   * when accessed, via the view. Use View::materialize to get the
+   * respective owning instance (e.g. sinex::SiteId) of a record.
+   *
+   * Views point into the mapped bytes of the file, so this is only
+   * available in SinexIoMode::MemoryMap, and views are only valid for the
+   * lifetime of the instance.
+   *
+   * @param[out] records A range of views, one per data record (i.e.
+   *             non-comment line) of the block.
+   * @return Anything other than zero denotes an error (e.g. the block does
+   *         not exist).
+   */
+  template <typename View>
+  int view_block(sinex::RecordRange<View> &records) const noexcept {
+    const char *begin, *end;
+    if (block_bytes(View::block_name, begin, end))
+      return 1;
+    records = sinex::RecordRange<View>(begin, end);
+    return 0;
+  }
+
+  /** @brief Scan a block, handing its records to a visitor one at a time.
+   *
+   * The block is chosen by the record type T, which is either a record
+   * class (e.g. sinex::SolutionEstimate for SOLUTION/ESTIMATE) or a view
+   * (e.g. sinex::SolutionEstimateView; only in SinexIoMode::MemoryMap).
+   * Records are decoded one by one into a single instance, which is passed
+   * to the visitor; nothing is stored. The visitor returns
+   * sinex::VisitAction::Stop to end the scan right away (the rest of the
+   * block is not read), e.g.
+   *
+   * bool found = false;
+   * snx.visit_block<dso::sinex::SolutionEstimate>(
+   *     [&](const dso::sinex::SolutionEstimate &est) {
+   *       found = !std::strcmp(est.parameter_type(), "VELZ");
+   *       return found ? dso::sinex::VisitAction::Stop
+   *                    : dso::sinex::VisitAction::Continue;
+   *     },
+   *     dso::sinex::QueryPredicate().sites({"DIOA"}).soln_ids({"3"}));
+   *
+   * @param[in] visitor A callable of signature
+   *            sinex::VisitAction(const T &); it should not throw.
+   * @param[in] query Conditions on the records to visit; evaluated on the
+   *            raw columns of each line, before decoding it (see
+   *            sinex::QueryPredicate)
+   * @param[out] stats If given, the number of lines skipped and visited is
+   *            added to it (as lines_skipped and lines_decoded)
+   * @return Anything other than zero denotes an error; stopping the scan
+   *         (via the visitor) is not an error.
+   */
+  template <typename T, typename Visitor>
+  int visit_block(Visitor &&visitor,
+                  const sinex::QueryPredicate &query = sinex::QueryPredicate(),
+                  sinex::QueryStats *stats = nullptr) const noexcept {
+    using Traits = sinex::details::record_traits<T>;
+    using L = typename Traits::line_layout;
+    char line[sinex::max_sinex_chars];
+    sinex::QueryStats qstats;
+
+    if constexpr (Traits::is_view) {
+      sinex::RecordRange<T> records;
+      if (view_block(records))
+        return 1;
+      for (const auto view : records) {
+        /* views are not null-terminated; copy the line to check the query */
+        if (!query.accepts_all()) {
+          const std::size_t sz =
+              std::min(view.line().size(), sizeof(line) - 1);
+          std::memcpy(line, view.line().data(), sz);
+          line[sz] = '\0';
+          if (!query.accepts<L>(line, sz, m_data_start, m_data_stop)) {
+            ++qstats.lines_skipped;
+            continue;
+          }
+        }
+        ++qstats.lines_decoded;
+        if (visitor(view) == sinex::VisitAction::Stop)
+          break;
+      }
+      if (stats)
+        *stats += qstats;
+      return 0;
+    } else {
+      sinex::details::LineCursor cursor;
+      if (goto_block(Traits::block_name, cursor))
+        return 1;
+
+      T record;
+      bool stop = false;
+      int error = 0;
+      while ((!stop) && cursor.getline(line)) {
+        if (*line != '*') { /* non-comment line */
+          if (!query.accepts<L>(line, m_data_start, m_data_stop)) {
+            ++qstats.lines_skipped;
+            continue;
+          }
+          ++qstats.lines_decoded;
+          if (Traits::parse(line, record, m_data_start, m_data_stop)) {
+            ++error;
+            break;
+          }
+          stop = (visitor(static_cast<const T &>(record)) ==
+                  sinex::VisitAction::Stop);
+        }
+      }
+
+      if (stats)
+        *stats += qstats;
+
+      /* check for parsing errors */
+      if (error) {
+        fprintf(stderr,
+                "[ERROR] Failed parsing block %s of SINEX file %s; erronuous "
+                "line was: \'%s\' (traceback: %s)\n",
+                Traits::block_name, m_filename.c_str(), line, __func__);
+        return 1;
+      }
+
+      /* unless stopped, check that the whole block was read */
+      if ((!stop) && (!cursor.done())) {
+        fprintf(stderr,
+                "[ERROR] Failed reading block \'%s\' of SINEX file %s "
+                "(traceback: %s)\n",
+                Traits::block_name, m_filename.c_str(), __func__);
+        return 1;
+      }
+      return 0;
+    }
+  }
+
+  /** @brief Parse blocks in the background (opt-in).
+   *
+   * Each block is parsed as a whole, in its own task (thread), into its
+   * record type (e.g. sinex::SiteId for SITE/ID); the call returns right
+   * away. Later queries on a preloaded block (e.g. parse_block_site_id())
+   * wait for that block only, and then select off the parsed records
+   * instead of reading the block again. Queries given a (non-trivial)
+   * sinex::QueryPredicate still read the block, and do not wait; queries
+   * served off preloaded records do not update sinex::QueryStats.
+   *
+   * Call it right after construction; it must not be called concurrently
+   * with queries on the instance. Blocks already preloaded are skipped.
+   * Blocks that fail to parse in the background are parsed (and errors
+   * reported) on demand, as if never preloaded.
+   *
+   * @param[in] blocks Names of blocks to preload; any of SITE/ID,
+   *            SITE/RECEIVER, SITE/ANTENNA, SITE/ECCENTRICITY,
+   *            SOLUTION/EPOCHS, SOLUTION/ESTIMATE and SOLUTION/DATA_REJECT
+   * @return Anything other than zero denotes an error (i.e. a block cannot
+   *         be preloaded or does not exist); then, nothing is preloaded.
+   */
+  int preload(const std::vector<const char *> &blocks) noexcept;
+
+  /** @brief Get all records of a preloaded block (see preload()).
+   *
+   * The block is chosen by the record type T, e.g. sinex::SiteId for
+   * SITE/ID. Waits until the block is parsed. The records are owned by the
+   * instance (and never modified), so they are valid for its lifetime.
+   *
+   * @param[out] records Points to the records of the block, one per data
+   *            record (i.e. non-comment line), in file order
+   * @return Anything other than zero denotes an error (i.e. the block was
+   *         not preloaded, or parsing it failed)
+   */
+  template <typename T>
+  int preloaded_records(const std::vector<T> *&records) const noexcept {
+    const auto &future =
+        std::get<std::shared_future<sinex::details::PreloadedBlock<T>>>(
+            m_preloaded);
+    if (!future.valid())
+      return 1;
+    try {
+      const auto &block = future.get();
+      if (block.error)
+        return 1;
+      records = &block.records;
+    } catch (std::exception &) {
+      return 1;
+    }
+    return 0;
+  }
+
+  /** @brief Get summary information for a block.
+   *
+   * If the instance did not load a block index, summaries are computed on
+   * the first call (which costs a pass through all blocks).
+   *
+   * @param[in] block A valid SINEX block name, e.g. "SOLUTION/ESTIMATE"
+   * @param[out] num_records Number of data records (i.e. non-comment lines)
+   *             in the block
+   * @param[out] first Earliest epoch recorded in the block; set to
+   *             datetime::min() if the block holds no epochs.
+   * @param[out] last Latest epoch recorded in the block; set to
+   *             datetime::max() if the block holds no epochs.
+   * @return Anything other than zero denotes an error (e.g. the block does
+   *         not exist).
+   */
+  int block_summary(const char *block, long &num_records,
+                    dso::datetime<dso::nanoseconds> &first,
+                    dso::datetime<dso::nanoseconds> &last) const noexcept;
+
   /** @brief Get SITE/ID records for given sites.
    *
    * Parse the SITE/ID block of the SINEX file and collect info for given
@@ -190,33 +661,61 @@ public:
    * @param[out] site_vec A vector containing one SiteId entry for each of the
    *            the sites that were matched (i.e. it could be that
    *            size(sites) != size(site_vec)
+   * @param[in] query Conditions on the records to collect; evaluated on
+   *            the raw columns of each line, before decoding it (see
+   *            sinex::QueryPredicate)
+   * @param[out] stats If given, the number of lines skipped and decoded is
+   *            added to it
    * @return Anything other than 0 denotes an error
    */
-  int parse_block_site_id(const std::vector<const char *> &sites,
-                          bool use_domes,
-                          std::vector<sinex::SiteId> &site_vec) noexcept;
+  int parse_block_site_id(
+      const std::vector<const char *> &sites, bool use_domes,
+      std::vector<sinex::SiteId> &site_vec,
+      const sinex::QueryPredicate &query = sinex::QueryPredicate(),
+      sinex::QueryStats *stats = nullptr) const noexcept;
 
   /** @brief Parse the (whole) SITE/ID block of the SINEX and return all info
    * @param[out] site_vec A vector containing one SiteId entry for each of the
    *            the sites that are included in the block.
+   * @param[in] query Conditions on the records to collect; evaluated on
+   *            the raw columns of each line, before decoding it (see
+   *            sinex::QueryPredicate)
+   * @param[out] stats If given, the number of lines skipped and decoded is
+   *            added to it
    * @return Anything other than 0 denotes an error
    */
-  int parse_block_site_id(std::vector<sinex::SiteId> &site_vec) noexcept {
-    return parse_block_site_id(std::vector<const char *>(), false, site_vec);
+  int parse_block_site_id(
+      std::vector<sinex::SiteId> &site_vec,
+      const sinex::QueryPredicate &query = sinex::QueryPredicate(),
+      sinex::QueryStats *stats = nullptr) const noexcept {
+    return parse_block_site_id(std::vector<const char *>(), false, site_vec,
+                               query, stats);
   }
 
   /** @brief Parse the whole SITE/RECEIVER Block off from the SINEX instance.
    * @param[out] site_vec A vector of sinex::SiteReceiver instances, one
    *               entry for each block line.
+   * @param[in] query Conditions on the records to collect; evaluated on
+   *            the raw columns of each line, before decoding it (see
+   *            sinex::QueryPredicate)
+   * @param[out] stats If given, the number of lines skipped and decoded is
+   *            added to it
    * @return Anything other than zero denotes an error
    */
   int parse_block_site_receiver(
-      std::vector<sinex::SiteReceiver> &site_vec) noexcept;
+      std::vector<sinex::SiteReceiver> &site_vec,
+      const sinex::QueryPredicate &query = sinex::QueryPredicate(),
+      sinex::QueryStats *stats = nullptr) const noexcept;
 
   /** @brief Parse the whole SITE/ANTENNA Block off from the SINEX instance.
    *
    * @param[out] site_vec A vector of sinex::SiteAntenna instances, one
    *               entry for each block line.
+   * @param[in] query Conditions on the records to collect; evaluated on
+   *            the raw columns of each line, before decoding it (see
+   *            sinex::QueryPredicate)
+   * @param[out] stats If given, the number of lines skipped and decoded is
+   *            added to it
    * @return Anything other than zero denotes an error
    */
   int parse_block_site_antenna(
@@ -225,7 +724,9 @@ public:
       const dso::datetime<dso::nanoseconds> from =
           dso::datetime<dso::nanoseconds>::min(),
       const dso::datetime<dso::nanoseconds> to =
-          dso::datetime<dso::nanoseconds>::max()) noexcept;
+          dso::datetime<dso::nanoseconds>::max(),
+      const sinex::QueryPredicate &query = sinex::QueryPredicate(),
+      sinex::QueryStats *stats = nullptr) const noexcept;
 
   /** @brief Get SOLUTION/ESTIMATE records for given sites.
    *
@@ -243,11 +744,24 @@ public:
    *             one sites_vec entry, there will be a few entries in
    *             estimates_vec, depending on available parameters and validity
    *             intervals.
+   * @param[in] query Conditions on the records to collect; evaluated on
+   *            the raw columns of each line, before decoding it (see
+   *            sinex::QueryPredicate)
+   * @param[out] stats If given, the number of lines skipped and decoded is
+   *            added to it
+   * @param[in] num_threads Max number of threads to parse the block with;
+   *            the block is split on line boundaries in chunks that are
+   *            parsed concurrently, and records are collected in file order
+   *            (i.e. exactly as when parsing serially). If zero, the number
+   *            is chosen based on the hardware. Small blocks are parsed in
+   *            one chunk.
    * @return Anything other than zero denotes an error
    */
   int parse_block_solution_estimate(
       const std::vector<sinex::SiteId> &sites_vec,
-      std::vector<sinex::SolutionEstimate> &estimates_vec) noexcept;
+      std::vector<sinex::SolutionEstimate> &estimates_vec,
+      const sinex::QueryPredicate &query = sinex::QueryPredicate(),
+      sinex::QueryStats *stats = nullptr, int num_threads = 1) const noexcept;
 
   /** Get SOLUTION/ESTIMATE records for given sites and epoch.
    *
@@ -281,12 +795,42 @@ public:
    *            call).
    * @param[out] estimates The collected SOLUTION/ESTIMATE records for the
    *             given site list, valid (in some way) at epoch t.
+   * @param[in] query Conditions on the records to collect; evaluated on
+   *            the raw columns of each line, before decoding it (see
+   *            sinex::QueryPredicate)
+   * @param[out] stats If given, the number of lines skipped and decoded is
+   *            added to it
    * @return Anything other than zero denotes an error
    */
   int parse_block_solution_estimate(
       const std::vector<sinex::SiteId> &sites,
       const dso::datetime<dso::nanoseconds> &t, bool allow_extrapolation,
-      std::vector<sinex::SolutionEstimate> &estimates) noexcept;
+      std::vector<sinex::SolutionEstimate> &estimates,
+      const sinex::QueryPredicate &query = sinex::QueryPredicate(),
+      sinex::QueryStats *stats = nullptr) const noexcept;
+
+  /** @brief Get all SOLUTION/ESTIMATE records, in columnar form.
+   *
+   * Parse the whole SOLUTION/ESTIMATE block and store all of its records
+   * (for all sites and parameter types) in a sinex::SolutionEstimateColumns
+   * instance. Records can then be filtered by site and/or parameter type
+   * via sinex::SolutionEstimateColumns::select.
+   *
+   * @param[out] columns The block records, in order of appearance
+   * @param[in] query Conditions on the records to collect; evaluated on
+   *            the raw columns of each line, before decoding it (see
+   *            sinex::QueryPredicate)
+   * @param[out] stats If given, the number of lines skipped and decoded is
+   *            added to it
+   * @param[in] num_threads Max number of threads to parse the block with
+   *            (see the sinex::SiteId overload); rows are always in file
+   *            order.
+   * @return Anything other than zero denotes an error
+   */
+  int parse_block_solution_estimate(
+      sinex::SolutionEstimateColumns &columns,
+      const sinex::QueryPredicate &query = sinex::QueryPredicate(),
+      sinex::QueryStats *stats = nullptr, int num_threads = 1) const noexcept;
 
   /** @brief Parse the SOLUTION/DATA_REJECT Block for given sites and date.
    *
@@ -321,6 +865,11 @@ public:
    *             before this date will not be collected (inclusive).
    * @to[in]    Stop period of interest. Rejection intervals that start after
    *             this date will not be considered (inclusive).
+   * @param[in] query Conditions on the records to collect; evaluated on
+   *            the raw columns of each line, before decoding it (see
+   *            sinex::QueryPredicate)
+   * @param[out] stats If given, the number of lines skipped and decoded is
+   *            added to it
    * @return Anything other than zero denotes an error
    */
   int parse_block_data_reject(
@@ -329,7 +878,9 @@ public:
       const dso::datetime<dso::nanoseconds> from =
           dso::datetime<dso::nanoseconds>::min(),
       const dso::datetime<dso::nanoseconds> to =
-          dso::datetime<dso::nanoseconds>::max()) noexcept;
+          dso::datetime<dso::nanoseconds>::max(),
+      const sinex::QueryPredicate &query = sinex::QueryPredicate(),
+      sinex::QueryStats *stats = nullptr) const noexcept;
 
   /** @brief Read and parse the SITE/ECCENTRICITY block off from the SINEX
    * instance.
@@ -352,6 +903,11 @@ public:
    *            DATA_STOP, in case a record is valid up to
    *            (DATA_STOP-allowed_offset). See \t t.
    * @param[in] allowed_offset See \t t and \t allow_extrapolation
+   * @param[in] query Conditions on the records to collect; evaluated on
+   *            the raw columns of each line, before decoding it (see
+   *            sinex::QueryPredicate)
+   * @param[out] stats If given, the number of lines skipped and decoded is
+   *            added to it
    * @return Anything other than 0 denotes an error
    */
   int parse_block_site_eccentricity(
@@ -359,7 +915,84 @@ public:
       const dso::datetime<dso::nanoseconds> &t,
       std::vector<sinex::SiteEccentricity> &out_vec,
       bool allow_extrapolation = true,
-      FractionalSeconds allowed_offset = FractionalSeconds(2e0)) noexcept;
+      FractionalSeconds allowed_offset = FractionalSeconds(2e0),
+      const sinex::QueryPredicate &query = sinex::QueryPredicate(),
+      sinex::QueryStats *stats = nullptr) const noexcept;
+
+  /** @brief Parse a SOLUTION/MATRIX_ESTIMATE block into packed symmetric
+   *         storage.
+   *
+   * The block "SOLUTION/MATRIX_ESTIMATE L <type>" is parsed if it exists,
+   * else "SOLUTION/MATRIX_ESTIMATE U <type>"; either way, the full
+   * (symmetric) matrix is available off from the result. Its dimension is
+   * the number of estimated parameters, as given in the header line; row
+   * and column i (0-based) correspond to the SOLUTION/ESTIMATE record with
+   * index i+1. Elements not written in the block are zero.
+   *
+   * @param[in] type The kind of matrix (i.e. CORR, COVA or INFO)
+   * @param[out] matrix The matrix, resized to n x n (n being the number of
+   *            estimates)
+   * @param[in] num_threads Max number of threads used to parse the block
+   *            (see goto_block_chunks); if zero, it is chosen based on the
+   *            hardware.
+   * @return Anything other than 0 denotes an error
+   */
+  int parse_block_matrix_estimate(sinex::MatrixType type,
+                                  sinex::SymmetricMatrix &matrix,
+                                  int num_threads = 1) const noexcept;
+
+  /** @brief Extract the covariance (or correlation, or information) matrix
+   *         of some parameters off from a SOLUTION/MATRIX_ESTIMATE block.
+   *
+   * The rows/columns of the parameters are given by the indexes of their
+   * SOLUTION/ESTIMATE records (i.e. sinex::SolutionEstimate::index()), e.g.
+   * as collected for some sites via parse_block_solution_estimate. The
+   * block is read in a single pass, skipping (without decoding) the lines of
+   * any other row; only the k x k sub-matrix of interest is kept in memory.
+   *
+   * @param[in] type The kind of matrix (i.e. CORR, COVA or INFO)
+   * @param[in] estimates The SOLUTION/ESTIMATE records of the parameters
+   * @param[out] matrix A k x k matrix (k being the size of estimates), where
+   *            matrix(a,b) is the element of the parameters estimates[a]
+   *            and estimates[b]
+   * @param[in] num_threads Max number of threads used to parse the block
+   *            (see goto_block_chunks); if zero, it is chosen based on the
+   *            hardware.
+   * @return Anything other than 0 denotes an error
+   */
+  int parse_block_matrix_estimate(
+      sinex::MatrixType type,
+      const std::vector<sinex::SolutionEstimate> &estimates,
+      Eigen::MatrixXd &matrix, int num_threads = 1) const noexcept;
+
+  /** @brief Parse a SOLUTION/MATRIX_ESTIMATE block into a tile file, for
+   *         matrices too large to hold in memory.
+   *
+   * Same as the overload above, but the matrix is written to a (new) tile
+   * file (see sinex::TiledSymmetricMatrix). Since the block is written row
+   * by row, a row (or column, for the upper triangle) of tiles is filled
+   * in memory and then written to the file; this band of tiles takes about
+   * n * tile_size * 8 bytes and counts against ram_budget, i.e. while
+   * parsing, the tile cache is left with the rest of the budget. If the
+   * budget cannot hold the band plus one tile, no band is used and every
+   * element is written via the tile cache (which is slower).
+   *
+   * @param[in] type The kind of matrix (i.e. CORR, COVA or INFO)
+   * @param[in] tile_fn Filename of the tile file to create (an existing
+   *            file is overwritten)
+   * @param[out] matrix The matrix, open on the tile file (for reading and
+   *            writing)
+   * @param[in] tile_size Number of rows/columns of each tile
+   * @param[in] ram_budget Max memory (in bytes) used for parsing, i.e. for
+   *            the band and the cached tiles; once parsed, the matrix's
+   *            tile cache gets all of it
+   * @return Anything other than 0 denotes an error
+   */
+  int parse_block_matrix_estimate(
+      sinex::MatrixType type, const char *tile_fn,
+      sinex::TiledSymmetricMatrix &matrix,
+      int tile_size = sinex::default_tile_size,
+      std::size_t ram_budget = sinex::default_tile_cache_bytes) const noexcept;
 
   /** @brief SOLUTION/EPOCHS for given sites and epoch.
    *
@@ -379,15 +1012,25 @@ public:
    *              lay within its specified observation interval).
    * @param[out] out_vec A vector of sinex::SolutionEpoch instances for some
    *              or all of the sites contained in site_vec
+   * @param[in] query Conditions on the records to collect; evaluated on
+   *            the raw columns of each line, before decoding it (see
+   *            sinex::QueryPredicate)
+   * @param[out] stats If given, the number of lines skipped and decoded is
+   *            added to it
    * @return Anything other than zero denotes an error
    */
   int parse_solution_epoch(
       const std::vector<sinex::SiteId> &site_vec,
       const dso::datetime<dso::nanoseconds> &t, bool allow_extrapolation,
-      std::vector<dso::sinex::SolutionEpoch> &out_vec) noexcept {
+      std::vector<dso::sinex::SolutionEpoch> &out_vec,
+      const sinex::QueryPredicate &query = sinex::QueryPredicate(),
+      sinex::QueryStats *stats = nullptr) const noexcept {
     return (allow_extrapolation)
-               ? this->parse_solution_epoch_extrapolate(site_vec, t, out_vec)
-               : this->parse_solution_epoch_noextrapolate(site_vec, t, out_vec);
+               ? this->parse_solution_epoch_extrapolate(site_vec, t, out_vec,
+                                                        query, stats)
+               : this->parse_solution_epoch_noextrapolate(site_vec, t,
+                                                          out_vec, query,
+                                                          stats);
   }
 
   /* TODO obsolete */
@@ -404,6 +1047,11 @@ public:
     char msolnid[5] = {'\0'};
     /* coordinates in [m] in [X,Y,Z] components */
     double x, y, z;
+    /* standard deviations in [m] of [X,Y,Z] and their covariance matrix in
+     * [m^2]; only filled in if covariance propagation is requested (else
+     * they are zero) */
+    double sx = 0e0, sy = 0e0, sz = 0e0;
+    Eigen::Matrix3d cov = Eigen::Matrix3d::Zero();
     SiteCoordinateResults(const sinex::SiteId &s, const char *solnid, double mx,
                           double my, double mz) noexcept
         : msite(s), x(mx), y(my), z(mz) {
@@ -430,6 +1078,9 @@ public:
    * and "VELZ", and all of them should be present in the SINEX file. A strict
    * linear model is assumed here (e.g. PDS parameters will not be considered
    * even if present).
+   * SOLUTION/EPOCHS and SOLUTION/ESTIMATE are read in one sweep (see
+   * sweep_blocks()), collecting the records of each site in an index, so
+   * that per-site lookups take constant time.
    *
    * @param[in] sites A vector of sinex::SiteId instances to match against,
    *               using the SITE CODE and POINT CODE fields.
@@ -442,15 +1093,117 @@ public:
   int linear_extrapolate_coordinates(
       const std::vector<sinex::SiteId> &sites,
       const dso::datetime<dso::nanoseconds> &t,
-      std::vector<SiteCoordinateResults> &crd) noexcept;
+      std::vector<SiteCoordinateResults> &crd) const noexcept {
+    return linear_extrapolate(sites, t, nullptr, crd);
+  }
+
+  /** @brief Extrapolate coordinate estimates for a given epoch, along with
+   *         their covariance matrices.
+   *
+   * Same as above, but the 6x6 covariance matrix of the STA/VEL parameters
+   * of each site is fetched off from @p matrix (via the parameter indexes
+   * of SOLUTION/ESTIMATE) and propagated to the extrapolated coordinates
+   * (see sinex::propagate_sta_vel_covariance), filling in the standard
+   * deviations and covariance matrix of each SiteCoordinateResults.
+   * The matrix is not parsed here, so that it can be reused for any
+   * number of epochs.
+   *
+   * @param[in] sites A vector of sinex::SiteId instances to match against,
+   *               using the SITE CODE and POINT CODE fields.
+   * @param[in] t The epoch to extrapolate coordinates to.
+   * @param[in] matrix The covariance matrix of the estimates, see
+   *               parse_block_matrix_estimate() with
+   *               sinex::MatrixType::Covariance
+   * @param[out] crd A vector holding extrapolation results
+   * @return Anything other than zero denotes an error, including parameters
+   *               that are not in @p matrix.
+   */
+  int linear_extrapolate_coordinates(
+      const std::vector<sinex::SiteId> &sites,
+      const dso::datetime<dso::nanoseconds> &t,
+      const sinex::SymmetricMatrix &matrix,
+      std::vector<SiteCoordinateResults> &crd) const noexcept {
+    return linear_extrapolate(sites, t, &matrix, crd);
+  }
 
+private:
+  /** @brief Extrapolate coordinates (and, if @p matrix is not null,
+   *         propagate their covariance); see
+   *         linear_extrapolate_coordinates()
+   */
+  int linear_extrapolate(
+      const std::vector<sinex::SiteId> &sites,
+      const dso::datetime<dso::nanoseconds> &t,
+      const sinex::SymmetricMatrix *matrix,
+      std::vector<SiteCoordinateResults> &crd) const noexcept;
+
+public:
   /** @brief Constructor (may throw). This will:
    * 1. Assign filename,
-   * 2. open the stream,
+   * 2. map the file to memory, or open the file (depending on mode),
    * 3. parse_first_line() to assign member vars,
-   * 4. call mark_blocks() to fill in m_blocks
+   * 4. load m_blocks off from the block index, or call mark_blocks() to fill
+   *    them in (depending on index_policy)
+   *
+   * @param[in] fn The SINEX filename
+   * @param[in] mode How to access the file; see SinexIoMode
+   * @param[in] index_policy Use of a persistent block index; see
+   *            SinexIndexPolicy
    */
-  Sinex(const char *fn);
+  Sinex(const char *fn, SinexIoMode mode = SinexIoMode::MemoryMap,
+        SinexIndexPolicy index_policy = SinexIndexPolicy::None);
+
+  /** @brief Constructor off from SINEX content already in memory (may
+   * throw). The instance uses SinexIoMode::MemoryMap, working directly on
+   * the bytes given (i.e. no copy is made); hence, data must outlive the
+   * instance. Compressed content (gzip or Unix compress) is decompressed to
+   * an internal buffer.
+   *
+   * The tag keeps content from being mistaken for a filename (and vice
+   * versa); see also from_buffer().
+   *
+   * @param[in] data The SINEX content
+   * @param[in] name A name for the content, used in place of a filename
+   *            (e.g. in error messages and by filename())
+   */
+  Sinex(SinexBufferTag, std::string_view data,
+        const char *name = "(memory)");
+
+  /** @brief Constructor off from SINEX content already in memory, taking
+   * over the buffer (may throw). Same as the std::string_view constructor,
+   * but the instance owns the bytes (which are moved, not copied).
+   *
+   * @param[in] data The SINEX content
+   * @param[in] name A name for the content, used in place of a filename
+   *            (e.g. in error messages and by filename())
+   */
+  Sinex(SinexBufferTag, std::string &&data, const char *name = "(memory)");
+
+  /** @brief A Sinex instance off from SINEX content already in memory (may
+   *         throw); see the SinexBufferTag constructors. A view of the
+   *         content is kept, hence data must outlive the instance.
+   */
+  static Sinex from_buffer(std::string_view data,
+                           const char *name = "(memory)") {
+    return Sinex(sinex_buffer, data, name);
+  }
+  static Sinex from_buffer(const char *data, const char *name = "(memory)") {
+    return Sinex(sinex_buffer, std::string_view(data), name);
+  }
+
+  /** @brief A Sinex instance off from SINEX content already in memory,
+   *         taking over the buffer (may throw)
+   */
+  static Sinex from_buffer(std::string &&data,
+                           const char *name = "(memory)") {
+    return Sinex(sinex_buffer, std::move(data), name);
+  }
+
+  /** @brief Not allowed, to avoid mistaking a filename held in an
+   * std::string (lvalue or temporary) for SINEX content, or vice versa; use
+   * either Sinex(fn.c_str()) or Sinex::from_buffer(content).
+   */
+  Sinex(const std::string &, const char * = nullptr) = delete;
 
   /** @brief Copy not allowed */
   Sinex(const Sinex &) = delete;
@@ -459,10 +1212,7 @@ public:
   Sinex &operator=(const Sinex &) = delete;
 
   /** @brief Destructor */
-  ~Sinex() noexcept {
-    if (m_stream.is_open())
-      m_stream.close();
-  }
+  ~Sinex() noexcept {}
 
 }; /* Sinex */
 
@@ -21,12 +21,34 @@
 namespace dso {
 
 namespace sinex {
-/** @class SinexBlockPosition A data block within a SINEX file */
+/** @class SinexBlockPosition A data block within a SINEX file
+ *
+ * All positions are (byte) offsets from the begining of the file:
+ * +BLOCK       <- mpos
+ *  data line   <- mdata
+ *  ...            (mlines lines, including comments)
+ * -BLOCK       <- mend
+ */
 struct SinexBlockPosition {
-  std::ifstream::pos_type mpos; /* position from file begining */
-  const char *mtype;            /* block description */
+  std::ifstream::pos_type mpos;  /* position from file begining */
+  const char *mtype;             /* block description */
+  std::ifstream::pos_type mdata; /* start of block payload (first data line) */
+  std::ifstream::pos_type mend;  /* start of block trailer line ('-BLOCK') */
+  long mlines;                   /* number of lines in payload */
 }; /* SinexBlockPosition */
 
+/** @class SinexBlockSummary Summary information of a data block
+ *
+ * Epochs are stored in their SINEX format, i.e. 'YY:DOY:SSSSS'; they are
+ * collected only for blocks that hold epoch fields (e.g. SOLUTION/EPOCHS,
+ * SOLUTION/ESTIMATE, SITE/RECEIVER, ...) and are left empty otherwise.
+ */
+struct SinexBlockSummary {
+  long mrecords;   /* number of data records (i.e. excluding comments) */
+  char mfirst[13]; /* earliest epoch recorded in block */
+  char mlast[13];  /* latest epoch recorded in block */
+}; /* SinexBlockSummary */
+
 /** Enum class to hold SINEX Observation Codes.
  * Within SINEX files, this is a single character indicating the technique(s)
  * used to arrive at the solutions obtained in this SINEX file. It should be
@@ -59,6 +81,57 @@ SinexObservationCode char_to_SinexObservationCode(char c);
 /** @brief char to SinexConstraintCode (may throw) */
 SinexConstraintCode char_to_SinexConstraintCode(char c);
 
+/** @brief char to SinexObservationCode (noexcept)
+ * @return Anything other than zero denotes an invalid code; code is not set
+ *         in this case.
+ */
+inline int char_to_SinexObservationCode(char c,
+                                        SinexObservationCode &code) noexcept {
+  switch (c) {
+  case 'C':
+    code = SinexObservationCode::COMBINED;
+    return 0;
+  case 'D':
+    code = SinexObservationCode::DORIS;
+    return 0;
+  case 'L':
+    code = SinexObservationCode::SLR;
+    return 0;
+  case 'M':
+    code = SinexObservationCode::LLR;
+    return 0;
+  case 'P':
+    code = SinexObservationCode::GNSS;
+    return 0;
+  case 'R':
+    code = SinexObservationCode::VLBI;
+    return 0;
+  default:
+    return 1;
+  }
+}
+
+/** @brief char to SinexConstraintCode (noexcept)
+ * @return Anything other than zero denotes an invalid code; code is not set
+ *         in this case.
+ */
+inline int char_to_SinexConstraintCode(char c,
+                                       SinexConstraintCode &code) noexcept {
+  switch (c) {
+  case '0':
+    code = SinexConstraintCode::FIXED;
+    return 0;
+  case '1':
+    code = SinexConstraintCode::SIGNIFICANT;
+    return 0;
+  case '2':
+    code = SinexConstraintCode::UNCONSTRAINED;
+    return 0;
+  default:
+    return 1;
+  }
+}
+
 /** @brief Size (in chars) in various, commonly used fields NOT including
  * null-terminating character
  */
@@ -421,7 +494,8 @@ class SolutionEstimate {
   static constexpr const int soln_id_at = 8;    /* [8,12] including NULL */
   static constexpr const int units_at = 13;     /* [13,17] including NULL */
   char charbuf__[32] = {'\0'};
-  const char *m_parameter_type;
+  /** Index of the Parameter Type in dso::sinex::parameter_types[] (or -1) */
+  int m_parameter_type{-1};
 
   /** Estimated Parameters Index: Index of estimated parameters. [I5] */
   int m_index;
@@ -443,10 +517,24 @@ class SolutionEstimate {
 public:
   /** Parameter Type: Identification of the type of parameter. [A6]
    * This is a pointer to the respective type in the
-   * dso::sinex::parameter_types[] array
+   * dso::sinex::parameter_types[] array (or nullptr if not set)
    */
-  const char *parameter_type() const noexcept { return m_parameter_type; }
-  void set_parameter_type(const char *s) noexcept { m_parameter_type = s; }
+  const char *parameter_type() const noexcept {
+    return (m_parameter_type >= 0) ? parameter_types[m_parameter_type]
+                                   : nullptr;
+  }
+  /** @brief Set the Parameter Type; s should be one of
+   *         dso::sinex::parameter_types[] (else it is unset)
+   */
+  void set_parameter_type(const char *s) noexcept {
+    m_parameter_type = (s) ? sinex::parameter_type_id(s, std::strlen(s)) : -1;
+  }
+
+  /** Parameter Type id, i.e. index in dso::sinex::parameter_types[] (or -1
+   * if not set); use it to compare parameter types
+   */
+  int parameter_type_id() const noexcept { return m_parameter_type; }
+  void set_parameter_type_id(int id) noexcept { m_parameter_type = id; }
 
   /** @brief Get constraint code */
   SinexConstraintCode constraint() const noexcept { return m_constraint; }
@@ -733,6 +821,10 @@ public:
  * If the datetime string has the value of "00:000:00000", then t will get
  * the value of tdefault (usually implying, start/end of SINEX).
  *
+ * Fixed-width strings (i.e. with all leading zeros) are resolved
+ * arithmetically, without allocations or exceptions; others are first
+ * scanned for the numeric values.
+ *
  * @param[in] dtstr The datetime string. Can have any number of leading zeros
  * @param[in] tdefault Default t value in case the datetime string is
  *                     "00:000:00000"
@@ -743,6 +835,22 @@ int parse_sinex_date(const char *dtstr,
                      const dso::datetime<dso::nanoseconds> &tdefault,
                      dso::datetime<dso::nanoseconds> &t) noexcept;
 
+/** @brief Parse a number of SINEX datetime strings (e.g. all date fields of
+ *         a line) in one sweep.
+ *
+ * Same as calling parse_sinex_date for each string, with its own default
+ * value.
+ *
+ * @param[in] n         Number of datetime strings
+ * @param[in] dtstrs    The datetime strings
+ * @param[in] tdefaults Default values, one per datetime string
+ * @param[out] t        The datetime instances recorded in dtstrs
+ * @return Number of datetime strings that could not be parsed
+ */
+int parse_sinex_dates(int n, const char *const dtstrs[],
+                      const dso::datetime<dso::nanoseconds> *const tdefaults[],
+                      dso::datetime<dso::nanoseconds> *const t[]) noexcept;
+
 } /* namespace sinex */
 } /* namespace dso */
 
@@ -0,0 +1,148 @@
+/** @file
+ * Columnar (struct-of-arrays) storage of SOLUTION/ESTIMATE records.
+ */
+
+#ifndef __SINEX_FILE_ESTIMATE_COLUMNS_HPP__
+#define __SINEX_FILE_ESTIMATE_COLUMNS_HPP__
+
+#include "core/sinex_site_key.hpp"
+#include "sinex_blocks.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace dso::sinex {
+
+/** @class SolutionEstimateColumns
+ *
+ * Hold (a set of) SOLUTION/ESTIMATE records in columns, i.e. one array per
+ * field, instead of a vector of dso::sinex::SolutionEstimate. Scanning the
+ * records for a given site and/or parameter type only touches the (packed)
+ * site key and parameter type columns, which are compact integer arrays;
+ * values are then extracted (gathered) for the selected rows only.
+ *
+ * Columns:
+ * site_keys()       SITE CODE plus POINT CODE, packed via
+ *                   sinex::details::site_key
+ * parameter_types() Index of the parameter type in sinex::parameter_types
+ *                   (-1 if not matched)
+ * soln_ids()        SOLN_ID as integer (sinex::NONINT_SOLN_ID if not numeric)
+ * epoch_mjd()       Epoch, as (integral) MJD
+ * epoch_nsec()      Epoch, as nanoseconds of day
+ * estimates()       Parameter estimate
+ * std_deviations()  Parameter standard deviation
+ * The remaining fields (index, SOLN_ID string, units and constraint code)
+ * are kept in separate, rarely accessed columns, so that any row can be
+ * converted back to a dso::sinex::SolutionEstimate (see record()).
+ *
+ * Example:
+ * std::vector<std::uint32_t> rows;
+ * columns.select(sinex::details::site_key("DIOB", "A "),
+ *                columns.parameter_type_index("STAX"), rows);
+ * std::vector<double> x;
+ * columns.gather(columns.estimates(), rows, x);
+ */
+class SolutionEstimateColumns {
+private:
+  std::vector<std::uint64_t> m_site_key;
+  std::vector<std::int16_t> m_parameter_type;
+  std::vector<int> m_soln_id;
+  std::vector<int> m_epoch_mjd;
+  std::vector<std::int64_t> m_epoch_nsec;
+  std::vector<double> m_estimate;
+  std::vector<double> m_std_deviation;
+  /* cold columns, only needed to re-construct records */
+  std::vector<int> m_index;
+  std::vector<std::uint32_t> m_soln_id_chars;
+  std::vector<std::uint32_t> m_units;
+  std::vector<SinexConstraintCode> m_constraint;
+
+public:
+  /** @brief Wildcard site key for select() */
+  static constexpr std::uint64_t any_site = ~std::uint64_t(0);
+  /** @brief Wildcard parameter type for select() */
+  static constexpr int any_parameter_type = -2;
+
+  /** @brief Index of a parameter type in sinex::parameter_types, e.g.
+   *         parameter_type_index("STAX"); -1 if not a valid type.
+   */
+  static int parameter_type_index(const char *ptype) noexcept {
+    int index;
+    return parameter_type_exists(ptype, index) ? index : -1;
+  }
+
+  /** @brief Number of records (rows) */
+  std::size_t size() const noexcept { return m_estimate.size(); }
+  bool empty() const noexcept { return m_estimate.empty(); }
+
+  /** @brief Remove all records */
+  void clear() noexcept;
+
+  /** @brief Allocate storage for (at least) n records */
+  void reserve(std::size_t n);
+
+  /** @brief Append a record */
+  void push_back(const SolutionEstimate &est);
+
+  /** @brief Append all records of other, in order */
+  void append(const SolutionEstimateColumns &other);
+
+  /** @brief Re-construct the record at row i */
+  SolutionEstimate record(std::size_t i) const noexcept;
+
+  /** @brief Re-construct all records, in order */
+  void to_records(std::vector<SolutionEstimate> &records) const;
+
+  /** @brief Select rows matching a site and a parameter type.
+   *
+   * @param[in] site_key Packed SITE CODE plus POINT CODE (see
+   *            sinex::details::site_key) or any_site
+   * @param[in] parameter_type Index of parameter type in
+   *            sinex::parameter_types (see parameter_type_index()) or
+   *            any_parameter_type
+   * @param[out] rows Indexes of matching rows, in increasing order
+   * @return Number of rows selected
+   */
+  std::size_t select(std::uint64_t site_key, int parameter_type,
+                     std::vector<std::uint32_t> &rows) const;
+
+  /** @brief Extract values of a column for the given rows, e.g.
+   *         gather(estimates(), rows, values)
+   */
+  template <typename T>
+  static void gather(const std::vector<T> &column,
+                     const std::vector<std::uint32_t> &rows,
+                     std::vector<T> &values) {
+    values.resize(rows.size());
+    for (std::size_t i = 0; i < rows.size(); i++)
+      values[i] = column[rows[i]];
+  }
+
+  /* column access */
+  const std::vector<std::uint64_t> &site_keys() const noexcept {
+    return m_site_key;
+  }
+  const std::vector<std::int16_t> &parameter_types() const noexcept {
+    return m_parameter_type;
+  }
+  const std::vector<int> &soln_ids() const noexcept { return m_soln_id; }
+  const std::vector<int> &epoch_mjd() const noexcept { return m_epoch_mjd; }
+  const std::vector<std::int64_t> &epoch_nsec() const noexcept {
+    return m_epoch_nsec;
+  }
+  const std::vector<double> &estimates() const noexcept { return m_estimate; }
+  const std::vector<double> &std_deviations() const noexcept {
+    return m_std_deviation;
+  }
+  const std::vector<int> &indexes() const noexcept { return m_index; }
+
+  /** @brief Epoch of the record at row i */
+  dso::datetime<dso::nanoseconds> epoch(std::size_t i) const noexcept {
+    return dso::datetime<dso::nanoseconds>(
+        dso::modified_julian_day(m_epoch_mjd[i]),
+        dso::nanoseconds(m_epoch_nsec[i]));
+  }
+}; /* SolutionEstimateColumns */
+
+} /* namespace dso::sinex */
+
+#endif
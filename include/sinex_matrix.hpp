@@ -0,0 +1,144 @@
+/** @file
+ * Packed storage of symmetric matrices, as found in SOLUTION/MATRIX_*
+ * blocks.
+ */
+
+#ifndef __SINEX_FILE_SYMMETRIC_MATRIX_HPP__
+#define __SINEX_FILE_SYMMETRIC_MATRIX_HPP__
+
+#include "Eigen/Core"
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace dso::sinex {
+
+/** @brief Kind of values in a SOLUTION/MATRIX_ESTIMATE block, i.e. the
+ *         last word of the block name (CORR, COVA or INFO).
+ *
+ * Correlation: correlations; the diagonal holds standard deviations
+ * Covariance: variances/covariances
+ * Information: the inverse of the covariance matrix
+ */
+enum class MatrixType { Correlation, Covariance, Information };
+
+/** @brief Triangle of a symmetric matrix written in a SOLUTION/MATRIX_*
+ *         block, i.e. the 'L' or 'U' in the block name.
+ */
+enum class MatrixTriangle { Lower, Upper };
+
+/** @brief Name of a SOLUTION/MATRIX_ESTIMATE block, e.g.
+ *         "SOLUTION/MATRIX_ESTIMATE L COVA"
+ */
+const char *matrix_estimate_block_name(MatrixTriangle triangle,
+                                       MatrixType type) noexcept;
+
+/** @class SymmetricMatrix
+ *
+ * A symmetric n x n matrix, holding only its lower triangle, packed
+ * row-wise in n(n+1)/2 doubles, i.e. elements (0,0), (1,0), (1,1), (2,0),
+ * ... Element (i,j) (0-based, in either order) is at index
+ * packed_index(i, j) of data(). Compared to a dense matrix, this takes half
+ * the memory.
+ *
+ * The packed elements are available to Eigen without copying (see
+ * packed()); Eigen has no packed symmetric type though, so converting to a
+ * (dense) Eigen matrix copies (see dense()).
+ */
+class SymmetricMatrix {
+private:
+  std::vector<double> m_data;
+  int m_dim = 0;
+
+public:
+  /** @brief Number of (packed) elements of an n x n symmetric matrix */
+  static constexpr std::size_t packed_size(int n) noexcept {
+    return (std::size_t)n * (n + 1) / 2;
+  }
+
+  /** @brief Index of element (i,j) in packed storage (0-based indexes,
+   *         given in either order)
+   */
+  static constexpr std::size_t packed_index(int i, int j) noexcept {
+    return (i < j) ? packed_index(j, i) : (std::size_t)i * (i + 1) / 2 + j;
+  }
+
+  /** @brief An empty (0 x 0) matrix */
+  SymmetricMatrix() noexcept = default;
+
+  /** @brief An n x n matrix, with all elements set to zero (may throw) */
+  explicit SymmetricMatrix(int n) : m_data(packed_size(n), 0e0), m_dim(n) {}
+
+  /** @brief Resize to n x n, setting all elements to zero (may throw) */
+  void resize(int n) {
+    m_data.assign(packed_size(n), 0e0);
+    m_dim = n;
+  }
+
+  /** @brief Number of rows (equal to the number of columns) */
+  int rows() const noexcept { return m_dim; }
+  int cols() const noexcept { return m_dim; }
+
+  /** @brief Number of elements stored, i.e. n(n+1)/2 */
+  std::size_t size() const noexcept { return m_data.size(); }
+
+  /** @brief Element (i,j), 0-based; (i,j) and (j,i) are the same element */
+  double operator()(int i, int j) const noexcept {
+    return m_data[packed_index(i, j)];
+  }
+  double &operator()(int i, int j) noexcept {
+    return m_data[packed_index(i, j)];
+  }
+
+  /** @brief The packed elements (see packed_index()) */
+  const double *data() const noexcept { return m_data.data(); }
+  double *data() noexcept { return m_data.data(); }
+
+  /** @brief The packed elements as an Eigen vector; no copy is made, the
+   *         map is valid as long as the matrix is not resized.
+   */
+  Eigen::Map<const Eigen::VectorXd> packed() const noexcept {
+    return Eigen::Map<const Eigen::VectorXd>(m_data.data(), m_data.size());
+  }
+  Eigen::Map<Eigen::VectorXd> packed() noexcept {
+    return Eigen::Map<Eigen::VectorXd>(m_data.data(), m_data.size());
+  }
+
+  /** @brief Copy to a dense Eigen matrix (both triangles are filled) */
+  void to_dense(Eigen::MatrixXd &dense) const;
+  Eigen::MatrixXd dense() const {
+    Eigen::MatrixXd m;
+    to_dense(m);
+    return m;
+  }
+
+  /** @brief Copy the sub-matrix of the given rows/columns (0-based) to a
+   *         dense Eigen matrix, i.e. dense(k,l) = (*this)(idx[k], idx[l])
+   */
+  void to_dense(const std::vector<int> &idx, Eigen::MatrixXd &dense) const;
+}; /* SymmetricMatrix */
+
+/** @brief Propagate the covariance matrices of the STA/VEL parameters of n
+ *         sites to their positions at some epoch, i.e. for the linear model
+ *         X = X0 + V dt, compute J C J^T where J = [I, diag(dt)].
+ *
+ * Input and output are stored as structure of arrays, i.e. element e of
+ * site k is at [e * n + k], so that each element is computed for all sites
+ * in one (vectorizable) loop.
+ *
+ * @param[in] n Number of sites
+ * @param[in] sta_vel The 21 * n (packed) elements of the 6x6 covariance
+ *            matrices, in the order STAX, STAY, STAZ, VELX, VELY, VELZ;
+ *            element e is SymmetricMatrix::packed_index(i, j) of (i,j)
+ * @param[in] dt The 3 * n time differences (t - t0), one per component
+ *            (X, Y, Z), in the time unit of the velocities (e.g. years)
+ * @param[out] xyz The 6 * n (packed) elements of the 3x3 covariance
+ *            matrices of X, Y, Z
+ */
+void propagate_sta_vel_covariance(int n, const double *__restrict__ sta_vel,
+                                  const double *__restrict__ dt,
+                                  double *__restrict__ xyz) noexcept;
+
+} /* namespace dso::sinex */
+
+#endif
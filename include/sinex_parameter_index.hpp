@@ -0,0 +1,139 @@
+/** @file
+ * Map between estimated parameters, i.e. (site, solution, parameter type),
+ * and their indexes in SOLUTION/ESTIMATE and the SOLUTION/MATRIX_* blocks.
+ */
+
+#ifndef __SINEX_FILE_PARAMETER_INDEX_HPP__
+#define __SINEX_FILE_PARAMETER_INDEX_HPP__
+
+#include "Eigen/Core"
+#include "core/sinex_site_key.hpp"
+#include "sinex_blocks.hpp"
+#include "sinex_matrix.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace dso::sinex {
+
+/** @class ParameterIndex
+ *
+ * An index of SOLUTION/ESTIMATE records, from (SITE CODE, POINT CODE,
+ * SOLN, parameter type) to the parameter index (i.e. the row/column of the
+ * parameter in the SOLUTION/MATRIX_* blocks), and back.
+ *
+ * Records are grouped per site and solution (SOLN); a (site, solution) pair
+ * is found via a single hash lookup, and holds the indexes of its STAX,
+ * STAY, STAZ, VELX, VELY and VELZ parameters directly, so that the 6x6
+ * covariance matrix of a site's position and velocity can be fetched off
+ * from a parsed matrix without any searching.
+ *
+ * Solution ids are matched as in the SINEX lines, i.e. the SOLN field [A4]
+ * (e.g. "   1").
+ */
+class ParameterIndex {
+private:
+  /* parameters of a (site, solution) pair */
+  struct Entry {
+    int sta_vel[6]; /* indexes of STAX, ..., VELZ (or 0 if missing) */
+    int begin, end; /* range in m_params */
+  };
+  /* a parameter of an Entry */
+  struct Parameter {
+    int parameter_type_id;
+    int index;
+  };
+
+  /* packed (distinct) solution ids; the position is the solution's ordinal
+   * in the (site, solution) keys */
+  std::vector<std::uint32_t> m_solns;
+  std::vector<Entry> m_entries;
+  std::vector<Parameter> m_params;
+  /* (site, solution) key to index in m_entries */
+  details::SiteKeyMap m_map;
+  /* the records indexed */
+  std::vector<SolutionEstimate> m_records;
+  /* for each parameter index, the record in m_records (or -1) */
+  std::vector<int> m_by_index;
+
+  /** @brief The key of a (site, solution) pair, or 0 if the solution is not
+   *         indexed
+   */
+  std::uint64_t key(const char *site_code, const char *point_code,
+                    const char *soln_id) const noexcept;
+
+  /** @brief The entry of a (site, solution) pair, or nullptr */
+  const Entry *entry(const char *site_code, const char *point_code,
+                     const char *soln_id) const noexcept;
+
+public:
+  /** @brief Build the index off from SOLUTION/ESTIMATE records, e.g. the
+   *         ones of some (or all) sites, as collected via
+   *         dso::Sinex::parse_block_solution_estimate. Any previous content
+   *         is discarded.
+   * @return Anything other than zero denotes an error (e.g. an invalid
+   *         parameter index)
+   */
+  int build(const std::vector<SolutionEstimate> &estimates) noexcept;
+
+  /** @brief Number of records (parameters) indexed */
+  std::size_t size() const noexcept { return m_records.size(); }
+
+  /** @brief Index of a parameter (1-based, as in the SINEX file).
+   * @param[in] site_code The SITE CODE
+   * @param[in] point_code The POINT CODE
+   * @param[in] soln_id The SOLN [A4], e.g. "   1"
+   * @param[in] parameter_type_id The parameter type, see
+   *            dso::sinex::parameter_type_id
+   * @return The parameter index, or -1 if no such parameter is indexed
+   */
+  int index(const char *site_code, const char *point_code,
+            const char *soln_id, int parameter_type_id) const noexcept;
+  int index(const SiteId &site, const char *soln_id,
+            int parameter_type_id) const noexcept {
+    return index(site.site_code(), site.point_code(), soln_id,
+                 parameter_type_id);
+  }
+
+  /** @brief The SOLUTION/ESTIMATE record of the parameter with the given
+   *         index (1-based), i.e. the reverse of index().
+   * @return A pointer to the record, or nullptr if no such parameter is
+   *         indexed
+   */
+  const SolutionEstimate *parameter(int index) const noexcept {
+    return (index > 0 && index < (int)m_by_index.size() &&
+            m_by_index[index] >= 0)
+               ? &m_records[m_by_index[index]]
+               : nullptr;
+  }
+
+  /** @brief Indexes (1-based) of the STAX, STAY, STAZ, VELX, VELY and VELZ
+   *         parameters of a site, for the given solution.
+   * @return A pointer to the six indexes, or nullptr if not all of them
+   *         are indexed
+   */
+  const int *sta_vel_indexes(const char *site_code, const char *point_code,
+                             const char *soln_id) const noexcept;
+  const int *sta_vel_indexes(const SiteId &site,
+                             const char *soln_id) const noexcept {
+    return sta_vel_indexes(site.site_code(), site.point_code(), soln_id);
+  }
+
+  /** @brief The 6x6 covariance matrix of the STAX, STAY, STAZ, VELX, VELY
+   *         and VELZ parameters of a site, for the given solution.
+   * @param[in] site The site
+   * @param[in] soln_id The SOLN [A4], e.g. "   1"
+   * @param[in] matrix The (full) covariance matrix, see
+   *            dso::Sinex::parse_block_matrix_estimate
+   * @param[out] cov The 6x6 covariance matrix, in the order STAX, STAY,
+   *            STAZ, VELX, VELY, VELZ
+   * @return Anything other than zero denotes an error, i.e. the parameters
+   *         are not indexed or not in the matrix
+   */
+  int sta_vel_covariance(const SiteId &site, const char *soln_id,
+                         const SymmetricMatrix &matrix,
+                         Eigen::Matrix<double, 6, 6> &cov) const noexcept;
+}; /* ParameterIndex */
+
+} /* namespace dso::sinex */
+
+#endif
@@ -0,0 +1,289 @@
+/** @file
+ * Query predicates, i.e. conditions on the records of SINEX blocks, which
+ * the dso::Sinex block parsers evaluate on the raw (fixed-column) fields of
+ * each record line, before decoding it.
+ */
+
+#ifndef __SINEX_FILE_QUERY_HPP__
+#define __SINEX_FILE_QUERY_HPP__
+
+#include "core/sinex_fields.hpp"
+#include "core/sinex_site_key.hpp"
+#include "sinex_blocks.hpp"
+#include <algorithm>
+#include <bitset>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace dso::sinex {
+
+/** @class QueryStats
+ * Number of record lines (i.e. non-comment lines) a block parser skipped
+ * (rejected off their raw fields) versus the ones it decoded.
+ */
+struct QueryStats {
+  long lines_skipped = 0;
+  long lines_decoded = 0;
+
+  QueryStats &operator+=(const QueryStats &other) noexcept {
+    lines_skipped += other.lines_skipped;
+    lines_decoded += other.lines_decoded;
+    return *this;
+  }
+}; /* QueryStats */
+
+/** @brief Return value of visitors (see dso::Sinex::visit_block): go on
+ *         with the next record, or end the scan.
+ */
+enum class VisitAction { Continue, Stop };
+
+namespace details {
+
+/* Check if a line layout (see layout::) includes a given field */
+template <typename L, typename = void>
+struct has_parameter_type : std::false_type {};
+template <typename L>
+struct has_parameter_type<L, std::void_t<typename L::ParameterType>>
+    : std::true_type {};
+
+template <typename L, typename = void> struct has_soln_id : std::false_type {};
+template <typename L>
+struct has_soln_id<L, std::void_t<typename L::SolnId>> : std::true_type {};
+
+template <typename L, typename = void> struct has_obscode : std::false_type {};
+template <typename L>
+struct has_obscode<L, std::void_t<typename L::ObsCode>> : std::true_type {};
+
+template <typename L, typename = void>
+struct has_data_interval : std::false_type {};
+template <typename L>
+struct has_data_interval<
+    L, std::void_t<typename L::DataStart, typename L::DataEnd>>
+    : std::true_type {};
+
+template <typename L, typename = void>
+struct has_ref_epoch : std::false_type {};
+template <typename L>
+struct has_ref_epoch<L, std::void_t<typename L::RefEpoch>> : std::true_type {};
+
+/** @brief Omit leading and trailing whitespaces of [begin, end) */
+inline void trim(const char *&begin, const char *&end) noexcept {
+  while (begin < end && *begin == ' ')
+    ++begin;
+  while (end > begin && end[-1] == ' ')
+    --end;
+}
+
+/** @brief Pack the characters [begin, end), omitting leading and trailing
+ *         whitespaces (at most 8 characters are packed).
+ */
+inline std::uint64_t pack_trimmed(const char *begin, const char *end) noexcept {
+  trim(begin, end);
+  return pack_chars(begin, std::min(8, (int)(end - begin)));
+}
+
+} /* namespace details */
+
+/** @class QueryPredicate
+ * A set of conditions on SINEX records, all of which must hold for a record
+ * to be collected by a block parser (e.g. dso::Sinex::parse_block_site_id).
+ * Conditions are added (and combined) via the setters, e.g.
+ *
+ * auto query = dso::sinex::QueryPredicate()
+ *                  .sites({"DIOA", "DIOB"})
+ *                  .parameter_types({"STAX", "STAY", "STAZ"})
+ *                  .techniques({dso::sinex::SinexObservationCode::DORIS})
+ *                  .window(t1, t2);
+ *
+ * A default-constructed instance accepts every record.
+ *
+ * Block parsers evaluate the predicate on the raw columns of each record
+ * line, before decoding any of its fields; the cheapest conditions are
+ * checked first, i.e.: parameter type (a perfect hash lookup of the 6-char
+ * column), site code and solution id (packed characters), observation code
+ * (one character) and, last, time window (which needs decoding dates).
+ *
+ * Conditions on fields that a block does not have are ignored, e.g. the
+ * parameter type for any block other than SOLUTION/ESTIMATE, or the
+ * observation code for SOLUTION/ESTIMATE.
+ */
+class QueryPredicate {
+  /* packed SITE CODEs (sorted); empty means any */
+  std::vector<std::uint64_t> m_sites;
+  /* packed SOLN_IDs, without whitespaces (sorted); empty means any */
+  std::vector<std::uint64_t> m_soln_ids;
+  /* parameter types, indexed by their id; unused if m_any_type is set */
+  std::bitset<parameter_types_size> m_types;
+  bool m_any_type = true;
+  /* observation codes, one bit per SinexObservationCode */
+  unsigned m_techniques = ~0u;
+  /* time window */
+  bool m_any_time = true;
+  dso::datetime<dso::nanoseconds> m_from =
+      dso::datetime<dso::nanoseconds>::min();
+  dso::datetime<dso::nanoseconds> m_to =
+      dso::datetime<dso::nanoseconds>::max();
+
+  static void add_sorted(std::vector<std::uint64_t> &vec, std::uint64_t key) {
+    vec.insert(std::lower_bound(vec.begin(), vec.end(), key), key);
+  }
+
+public:
+  /** @brief Only accept records of the given SITE CODEs (e.g. "DIOA"); only
+   *         the first 4 characters of each string are considered.
+   */
+  QueryPredicate &sites(const std::vector<const char *> &codes) {
+    for (const char *c : codes)
+      add_sorted(m_sites, details::pack_chars(c, 4));
+    return *this;
+  }
+
+  /** @brief Only accept records of the given parameter types (e.g. "STAX");
+   *         leading and trailing whitespaces are not considered.
+   * @throw std::invalid_argument if any of the strings is not a valid
+   *         parameter type; the predicate is then left unchanged.
+   */
+  QueryPredicate &parameter_types(const std::vector<const char *> &types) {
+    std::bitset<parameter_types_size> ids;
+    for (const char *t : types) {
+      const char *begin = t, *end = t + std::strlen(t);
+      details::trim(begin, end);
+      const int id = parameter_type_id(begin, end - begin);
+      if (id < 0)
+        throw std::invalid_argument(
+            std::string("[ERROR] Invalid parameter type in query: \"") + t +
+            "\"");
+      ids.set(id);
+    }
+    m_types |= ids;
+    m_any_type = false;
+    return *this;
+  }
+
+  /** @brief Only accept records of the given SOLN_IDs (e.g. "1"); leading
+   *         and trailing whitespaces are not considered.
+   */
+  QueryPredicate &soln_ids(const std::vector<const char *> &ids) {
+    for (const char *s : ids)
+      add_sorted(m_soln_ids, details::pack_trimmed(s, s + std::strlen(s)));
+    return *this;
+  }
+
+  /** @brief Only accept records of the given observation codes */
+  QueryPredicate &techniques(const std::vector<SinexObservationCode> &codes) {
+    m_techniques = 0u;
+    for (auto c : codes)
+      m_techniques |= (1u << (int)c);
+    return *this;
+  }
+
+  /** @brief Only accept records valid within [from, to], i.e. records with
+   *         a data interval (DATA_START, DATA_END) that overlaps [from, to],
+   *         or (for SOLUTION/ESTIMATE) with an epoch within [from, to].
+   */
+  QueryPredicate &window(const dso::datetime<dso::nanoseconds> &from,
+                         const dso::datetime<dso::nanoseconds> &to) {
+    m_any_time = false;
+    m_from = from;
+    m_to = to;
+    return *this;
+  }
+
+  /** @brief Check if the predicate accepts every record */
+  bool accepts_all() const noexcept {
+    return m_sites.empty() && m_soln_ids.empty() && m_any_type &&
+           (m_techniques == ~0u) && m_any_time;
+  }
+
+  /** @brief Evaluate the predicate on a raw record line.
+   *
+   * @tparam L The line layout of the block (e.g.
+   *         details::layout::SolutionEstimate)
+   * @param[in] line The (null-terminated) record line
+   * @param[in] len Number of characters in line
+   * @param[in] data_start Data start time of the SINEX file; used to
+   *            resolve '00:000:00000' start dates
+   * @param[in] data_stop Data end time of the SINEX file; used to resolve
+   *            '00:000:00000' end dates
+   * @return True if the record is accepted. A record with a field that
+   *         cannot be decoded is accepted, so that the block parser reports
+   *         it.
+   */
+  template <typename L>
+  bool
+  accepts(const char *line, int len,
+          const dso::datetime<dso::nanoseconds> &data_start,
+          const dso::datetime<dso::nanoseconds> &data_stop) const noexcept {
+    using namespace details;
+    if constexpr (has_parameter_type<L>::value) {
+      using F = typename L::ParameterType;
+      if (!m_any_type && len >= F::end) {
+        const char *begin = line + F::offset, *end = line + F::end;
+        trim(begin, end);
+        int id = parameter_type_id(begin, end - begin);
+        /* if not an exact match, resolve it as the block parser does; if
+         * that fails too, the line is left for the parser to report */
+        if ((id >= 0 ||
+             parameter_type_exists<ParameterMatchPolicyType::NonStrict>(
+                 begin, id)) &&
+            !m_types.test(id))
+          return false;
+      }
+    }
+    if (!m_sites.empty() && len >= L::SiteCode::end &&
+        !std::binary_search(m_sites.begin(), m_sites.end(),
+                            pack_chars(line + L::SiteCode::offset, 4)))
+      return false;
+    if constexpr (has_soln_id<L>::value) {
+      using F = typename L::SolnId;
+      if (!m_soln_ids.empty() && len >= F::end &&
+          !std::binary_search(m_soln_ids.begin(), m_soln_ids.end(),
+                              pack_trimmed(line + F::offset, line + F::end)))
+        return false;
+    }
+    if constexpr (has_obscode<L>::value) {
+      SinexObservationCode code;
+      if ((m_techniques != ~0u) &&
+          !field_obscode<typename L::ObsCode>(line, len, code) &&
+          !(m_techniques & (1u << (int)code)))
+        return false;
+    }
+    if constexpr (has_data_interval<L>::value) {
+      using F1 = typename L::DataStart;
+      using F2 = typename L::DataEnd;
+      dso::datetime<dso::nanoseconds> start, stop;
+      if (!m_any_time &&
+          !field_date<F1>(line, len, data_start, start) &&
+          !field_date<F2>(line, len, data_stop, stop) &&
+          ((stop < m_from) || (start > m_to)))
+        return false;
+    } else if constexpr (has_ref_epoch<L>::value) {
+      dso::datetime<dso::nanoseconds> t;
+      if (!m_any_time &&
+          !field_date<typename L::RefEpoch>(line, len, data_start, t) &&
+          ((t < m_from) || (t > m_to)))
+        return false;
+    }
+    return true;
+  }
+
+  /** @brief Evaluate the predicate on a raw, null-terminated record line;
+   *         the line length is only computed if there is any condition to
+   *         check.
+   */
+  template <typename L>
+  bool
+  accepts(const char *line, const dso::datetime<dso::nanoseconds> &data_start,
+          const dso::datetime<dso::nanoseconds> &data_stop) const noexcept {
+    return accepts_all() ||
+           accepts<L>(line, std::strlen(line), data_start, data_stop);
+  }
+}; /* QueryPredicate */
+
+} /* namespace dso::sinex */
+
+#endif
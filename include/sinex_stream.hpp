@@ -0,0 +1,153 @@
+/** @file
+ * Forward-only, single-pass reading of SINEX files, for inputs that cannot
+ * be seeked (e.g. pipes or the standard input).
+ */
+
+#ifndef __SINEX_FILE_STREAM_READER_HPP__
+#define __SINEX_FILE_STREAM_READER_HPP__
+
+#include "core/sinex_site_key.hpp"
+#include "sinex_blocks.hpp"
+#include <istream>
+#include <string>
+#include <vector>
+
+namespace dso {
+
+/** @brief Blocks that can be collected by a dso::SinexStreamReader */
+enum class SinexStreamBlock : unsigned {
+  SiteId = 1u << 0,
+  SolutionEpochs = 1u << 1,
+  SolutionEstimate = 1u << 2
+};
+
+/** @class SinexStreamReader
+ *
+ * Read a SINEX file in one sequential pass, without ever seeking back.
+ * Contrary to dso::Sinex (which marks the blocks of the file and parses them
+ * on request), the blocks and sites of interest are registered before
+ * reading; all relevant records are then collected while the input is read
+ * through. Only the records collected are kept in memory, hence the input
+ * can be of any size and come from any std::istream (e.g. std::cin, as in
+ * 'zcat file.snx.gz | consumer').
+ *
+ * Sites are matched as in dso::Sinex::parse_block_site_id. SOLUTION/EPOCHS
+ * and SOLUTION/ESTIMATE records are matched against the SITE/ID records
+ * collected (SITE CODE and POINT CODE) if the SITE/ID block has already been
+ * read, else against the SITE CODEs of the sites of interest. If no sites
+ * are given, all records of the blocks of interest are collected.
+ *
+ * Example:
+ * dso::SinexStreamReader reader({"DIOA", "DIOB"});
+ * reader.collect(dso::SinexStreamBlock::SiteId)
+ *     .collect(dso::SinexStreamBlock::SolutionEstimate);
+ * if (reader.read(std::cin)) return 1;
+ * for (const auto &est : reader.solution_estimates()) ...
+ */
+class SinexStreamReader {
+private:
+  /** Sites of interest (empty for all sites) */
+  std::vector<std::string> m_sites;
+  /** SITE/ID records of interest */
+  sinex::details::SiteIdFilter m_filter;
+  /** Packed SITE CODEs of the sites of interest */
+  sinex::details::SiteKeyMap m_site_codes;
+  /** Packed SITE CODE plus POINT CODE of the SITE/ID records collected */
+  sinex::details::SiteKeyMap m_site_id_keys;
+  /** Blocks of interest (SinexStreamBlock flags) */
+  unsigned m_blocks = 0;
+  /** Blocks of interest encountered in the input (SinexStreamBlock flags) */
+  unsigned m_blocks_read = 0;
+  /** Start time of the data used in the SINEX solution */
+  dso::datetime<dso::nanoseconds> m_data_start;
+  /** End time of the data used in the SINEX solution */
+  dso::datetime<dso::nanoseconds> m_data_stop;
+  /** Records collected */
+  std::vector<sinex::SiteId> m_site_ids;
+  std::vector<sinex::SolutionEpoch> m_epochs;
+  std::vector<sinex::SolutionEstimate> m_estimates;
+
+  /** @brief Parse the SINEX header line (only the data span is kept) */
+  int parse_header(const char *line) noexcept;
+
+  /** @brief Check if a SOLUTION/EPOCHS or SOLUTION/ESTIMATE record of given
+   *        site is to be collected.
+   * @param[in] site Start of the SITE CODE field (followed by a whitespace
+   *            character and the POINT CODE field).
+   */
+  bool site_of_interest(const char *site) const noexcept;
+
+  /** @brief Parse a data line of the block of interest block */
+  int parse_line(SinexStreamBlock block, const char *line) noexcept;
+
+public:
+  /** @brief Constructor
+   * @param[in] sites Sites of interest; strings of the form e.g. "DIOB" or
+   *            "DIOB 12602S012" (if use_domes is true). If empty, all sites
+   *            are of interest.
+   * @param[in] use_domes Also match DOMES numbers for SITE/ID records.
+   */
+  explicit SinexStreamReader(
+      const std::vector<const char *> &sites = std::vector<const char *>(),
+      bool use_domes = false);
+
+  /** @brief Register a block of interest; records of the block will be
+   *         collected at read().
+   */
+  SinexStreamReader &collect(SinexStreamBlock block) noexcept {
+    m_blocks |= static_cast<unsigned>(block);
+    return *this;
+  }
+
+  /** @brief Read the SINEX input through (once), collecting records of the
+   *         blocks of interest.
+   *
+   * Any records collected by a previous call are cleared. The input is read
+   * sequentially up to (and including) the '%ENDSNX' line.
+   *
+   * @param[in] is The input stream, placed at the start of the SINEX header
+   * @param[in] name A name for the input, used in error messages
+   * @return Anything other than zero denotes an error
+   */
+  int read(std::istream &is, const char *name = "(stream)") noexcept;
+
+  /** @brief Same as read(std::istream&), reading off from the file fn; if
+   *         fn is "-", the standard input is read.
+   */
+  int read(const char *fn) noexcept;
+
+  /** @brief Check if a block of interest was found (and read) in the input */
+  bool block_read(SinexStreamBlock block) const noexcept {
+    return m_blocks_read & static_cast<unsigned>(block);
+  }
+
+  /** @brief Start time of the data used in the SINEX solution */
+  dso::datetime<dso::nanoseconds> data_start() const noexcept {
+    return m_data_start;
+  }
+
+  /** @brief End time of the data used in the SINEX solution */
+  dso::datetime<dso::nanoseconds> data_stop() const noexcept {
+    return m_data_stop;
+  }
+
+  /** @brief SITE/ID records collected */
+  const std::vector<sinex::SiteId> &site_ids() const noexcept {
+    return m_site_ids;
+  }
+
+  /** @brief SOLUTION/EPOCHS records collected */
+  const std::vector<sinex::SolutionEpoch> &solution_epochs() const noexcept {
+    return m_epochs;
+  }
+
+  /** @brief SOLUTION/ESTIMATE records collected */
+  const std::vector<sinex::SolutionEstimate> &
+  solution_estimates() const noexcept {
+    return m_estimates;
+  }
+}; /* SinexStreamReader */
+
+} /* namespace dso */
+
+#endif
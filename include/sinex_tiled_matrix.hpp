@@ -0,0 +1,212 @@
+/** @file
+ * Out-of-core storage of (large) symmetric matrices, as found in
+ * SOLUTION/MATRIX_* blocks, in a memory-mapped file of tiles.
+ */
+
+#ifndef __SINEX_FILE_TILED_SYMMETRIC_MATRIX_HPP__
+#define __SINEX_FILE_TILED_SYMMETRIC_MATRIX_HPP__
+
+#include "Eigen/Core"
+#include <algorithm>
+#include <cstddef>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace dso::sinex {
+
+/** @brief Default size (rows/columns) of the tiles of a
+ *         TiledSymmetricMatrix; a tile takes 512 KB.
+ */
+constexpr int default_tile_size = 256;
+
+/** @brief Default memory budget of the tile cache of a TiledSymmetricMatrix
+ *         (in bytes).
+ */
+constexpr std::size_t default_tile_cache_bytes = 256 * 1024 * 1024;
+
+/** @class TiledSymmetricMatrix
+ *
+ * A symmetric n x n matrix kept in a binary file, split in square tiles of
+ * t x t elements. Only the tiles of the lower triangle are stored, i.e. tile
+ * (I,J) with I >= J; tile (I,J) holds elements (i,j) with i in
+ * [I*t, (I+1)*t) and j in [J*t, (J+1)*t). Each tile is stored column-major
+ * (hence it can be used as an Eigen matrix without copying); tiles on the
+ * diagonal hold both triangles, and tiles on the edges are padded with
+ * zeros.
+ *
+ * Tiles are memory-mapped individually, on demand, and kept mapped in a
+ * cache; the number of mapped tiles is limited by a memory budget (the
+ * least recently used tile is unmapped when the budget is exceeded). Hence,
+ * any number of elements can be accessed using a fixed amount of memory;
+ * the operating system pages the tiles in and out of the file as needed.
+ *
+ * Functions that (may) access tiles can fail (e.g. if the file cannot be
+ * mapped), hence, following the rest of the library, return an int status.
+ * Pointers to tiles remain valid until the next access to some other tile
+ * (which may evict them from the cache). Instances are not thread-safe,
+ * even for const access, since the cache is updated on every access.
+ *
+ * When a tile file is filled off a SINEX block (see
+ * dso::Sinex::parse_block_matrix_estimate), the memory budget also covers
+ * the row of tiles being filled; the cache gets what is left of it.
+ *
+ * The file layout is a header page, followed by the tiles in packed
+ * row-wise order, i.e. (0,0), (1,0), (1,1), (2,0), ... Each tile occupies a
+ * whole number of pages.
+ */
+class TiledSymmetricMatrix {
+private:
+  /* a tile in the cache; index is the packed tile index */
+  struct CachedTile {
+    std::size_t index;
+    double *data;
+  };
+
+  std::string m_filename;
+  int m_fd = -1;
+  bool m_writable = false;
+  int m_dim = 0;
+  int m_tile_size = 0;
+  int m_num_tiles = 0; /* tiles per row/column */
+  std::size_t m_tile_bytes = 0;
+  std::size_t m_data_offset = 0;
+  std::size_t m_max_cached = 1;
+  /* mapped tiles, most recently used first */
+  mutable std::list<CachedTile> m_lru;
+  mutable std::unordered_map<std::size_t, std::list<CachedTile>::iterator>
+      m_cached;
+
+  /** @brief Set the cache budget (at least one tile is always cached) */
+  void set_budget(std::size_t ram_budget) noexcept;
+
+  /** @brief Get the (mapped) tile of packed index idx, mapping it (and
+   *         evicting the least recently used tile) if needed.
+   */
+  double *tile_data(std::size_t idx) const noexcept;
+
+  /** @brief Unmap all cached tiles */
+  void evict_all() const noexcept;
+
+public:
+  /** @brief Number of tiles in the lower triangle of an n x n tile grid */
+  static constexpr std::size_t packed_tiles(int n) noexcept {
+    return (std::size_t)n * (n + 1) / 2;
+  }
+
+  /** @brief Packed index of tile (I,J), given in either order */
+  static constexpr std::size_t packed_tile_index(int I, int J) noexcept {
+    return (I < J) ? packed_tile_index(J, I)
+                   : (std::size_t)I * (I + 1) / 2 + J;
+  }
+
+  TiledSymmetricMatrix() noexcept = default;
+  TiledSymmetricMatrix(const TiledSymmetricMatrix &) = delete;
+  TiledSymmetricMatrix &operator=(const TiledSymmetricMatrix &) = delete;
+  ~TiledSymmetricMatrix() noexcept { close(); }
+
+  /** @brief Create a (new) tile file for an n x n matrix, with all
+   *         elements set to zero. The file is opened for reading and
+   *         writing; an existing file is overwritten.
+   * @param[in] fn Filename of the tile file
+   * @param[in] n Dimension of the matrix
+   * @param[in] tile_size Number of rows/columns of each tile
+   * @param[in] ram_budget Max memory (in bytes) of the cached tiles
+   * @return Anything other than zero denotes an error
+   */
+  int create(const char *fn, int n, int tile_size = default_tile_size,
+             std::size_t ram_budget = default_tile_cache_bytes) noexcept;
+
+  /** @brief Open an existing tile file (see create()).
+   * @param[in] fn Filename of the tile file
+   * @param[in] ram_budget Max memory (in bytes) of the cached tiles
+   * @param[in] writable Open the file for writing as well
+   * @return Anything other than zero denotes an error
+   */
+  int open(const char *fn,
+           std::size_t ram_budget = default_tile_cache_bytes,
+           bool writable = false) noexcept;
+
+  /** @brief Write any changes back to the file and close it */
+  void close() noexcept;
+
+  /** @brief Write changes of the cached tiles back to the file */
+  int flush() const noexcept;
+
+  /** @brief Check if the instance holds an open tile file */
+  bool is_open() const noexcept { return m_fd >= 0; }
+
+  /** @brief Filename of the tile file */
+  const std::string &filename() const noexcept { return m_filename; }
+
+  /** @brief Number of rows (equal to the number of columns) */
+  int rows() const noexcept { return m_dim; }
+  int cols() const noexcept { return m_dim; }
+
+  /** @brief Number of rows/columns of each tile */
+  int tile_size() const noexcept { return m_tile_size; }
+
+  /** @brief Number of tiles per row (or column) of the matrix */
+  int num_tiles() const noexcept { return m_num_tiles; }
+
+  /** @brief Number of rows (or columns) of the I-th row (or column) of
+   *         tiles not in the padding, i.e. t for all but (maybe) the last.
+   */
+  int tile_rows(int I) const noexcept {
+    return std::min(m_tile_size, m_dim - I * m_tile_size);
+  }
+
+  /** @brief Max number of tiles kept mapped */
+  std::size_t max_cached_tiles() const noexcept { return m_max_cached; }
+
+  /** @brief Number of tiles currently mapped */
+  std::size_t cached_tiles() const noexcept { return m_lru.size(); }
+
+  /** @brief Tile (I,J), I >= J, as a column-major t x t array; the
+   *         elements of the padding are zero. E.g. as an Eigen matrix:
+   *         Eigen::Map<const Eigen::MatrixXd>(tile(I,J), t, t).
+   *         Writing to a tile (via the non-const overload) needs a
+   *         writable file.
+   * @return A pointer to the tile (valid until another tile is accessed), or
+   *         nullptr on error.
+   */
+  const double *tile(int I, int J) const noexcept;
+  double *tile(int I, int J) noexcept;
+
+  /** @brief Write tile (I,J), I >= J, i.e. t x t column-major elements, to
+   *         the file (bypassing the cache). Tiles on the diagonal should
+   *         hold both triangles.
+   * @return Anything other than zero denotes an error
+   */
+  int write_tile(int I, int J, const double *data) noexcept;
+
+  /** @brief Get element (i,j), 0-based, given in either order
+   * @return Anything other than zero denotes an error
+   */
+  int get(int i, int j, double &val) const noexcept;
+
+  /** @brief Set element (i,j) (and hence (j,i)), 0-based
+   * @return Anything other than zero denotes an error
+   */
+  int set(int i, int j, double val) noexcept;
+
+  /** @brief Copy the sub-matrix of the given rows/columns (0-based) to a
+   *         dense Eigen matrix, i.e. dense(k,l) = (idx[k], idx[l]). Each
+   *         tile holding requested elements is accessed once.
+   * @return Anything other than zero denotes an error
+   */
+  int to_dense(const std::vector<int> &idx,
+               Eigen::MatrixXd &dense) const noexcept;
+
+  /** @brief Compute y = A * x (A being this matrix), one tile at a time.
+   * @param[in] x An n x m matrix
+   * @param[out] y The n x m result
+   * @return Anything other than zero denotes an error
+   */
+  int multiply(const Eigen::MatrixXd &x, Eigen::MatrixXd &y) const noexcept;
+}; /* TiledSymmetricMatrix */
+
+} /* namespace dso::sinex */
+
+#endif
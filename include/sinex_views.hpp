@@ -0,0 +1,351 @@
+/** @file
+ * Lightweight, non-owning views of SINEX records. A view points into the
+ * (memory mapped) bytes of a record line and decodes fields only when they
+ * are accessed; it can be explicitly converted (materialized) to the
+ * respective owning class of sinex_blocks.hpp.
+ *
+ * Views are only valid as long as the bytes they point to, i.e. for the
+ * lifetime of the dso::Sinex instance they were taken from.
+ */
+
+#ifndef __SINEX_FILE_RECORD_VIEWS_HPP__
+#define __SINEX_FILE_RECORD_VIEWS_HPP__
+
+#include "core/sinex_fields.hpp"
+#include "core/sinex_lines.hpp"
+#include "core/sinex_site_key.hpp"
+#include "sinex_blocks.hpp"
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <string_view>
+
+namespace dso::sinex {
+
+namespace details {
+
+/** @brief A character field of a line of len characters, as is (i.e. with
+ *         any whitespaces); clipped if the line ends before the field does.
+ */
+template <typename F>
+inline std::string_view field_view(const char *line, int len) noexcept {
+  if (len <= F::offset)
+    return std::string_view();
+  return std::string_view(line + F::offset,
+                          (len >= F::end) ? F::width : len - F::offset);
+}
+
+/** @brief A SINEX date field (see field_date); the date string is copied
+ *         to a (null-terminated) buffer, so that decoding never reads past
+ *         the end of the line.
+ */
+template <typename F>
+inline int field_date_copy(const char *line, int len,
+                           const dso::datetime<dso::nanoseconds> &tdefault,
+                           dso::datetime<dso::nanoseconds> &t) noexcept {
+  if (len < F::end)
+    return 1;
+  char buf[F::width + 1];
+  std::memcpy(buf, line + F::offset, F::width);
+  buf[F::width] = '\0';
+  return parse_sinex_date(buf, tdefault, t);
+}
+
+} /* namespace details */
+
+/** @class SiteIdView
+ * A view of a SITE/ID record line; see dso::sinex::SiteId for the fields.
+ * Character fields are returned as they appear in the line (i.e. padded
+ * with whitespaces), numeric fields are decoded on each call.
+ */
+class SiteIdView {
+  using L = details::layout::SiteId;
+  const char *m_line = nullptr;
+  int m_len = 0;
+
+public:
+  /** @brief The block holding such records */
+  static constexpr const char *block_name = "SITE/ID";
+
+  SiteIdView() noexcept = default;
+
+  /** @brief View the line [line, line+len) (no newline character) */
+  SiteIdView(const char *line, int len) noexcept : m_line(line), m_len(len) {}
+
+  /** @brief The (whole) record line */
+  std::string_view line() const noexcept {
+    return std::string_view(m_line, m_len);
+  }
+
+  /** Site Code [A4] */
+  std::string_view site_code() const noexcept {
+    return details::field_view<L::SiteCode>(m_line, m_len);
+  }
+
+  /** Point Code [A2] */
+  std::string_view point_code() const noexcept {
+    return details::field_view<L::PointCode>(m_line, m_len);
+  }
+
+  /** Unique Monument Identification (DOMES) [A9] */
+  std::string_view domes() const noexcept {
+    return details::field_view<L::Domes>(m_line, m_len);
+  }
+
+  /** Station Description [A22] */
+  std::string_view description() const noexcept {
+    return details::field_view<L::Description>(m_line, m_len);
+  }
+
+  /** @brief Decode the Observation Code
+   * @return Anything other than zero denotes an error
+   */
+  int obscode(SinexObservationCode &code) const noexcept {
+    return details::field_obscode<L::ObsCode>(m_line, m_len, code);
+  }
+
+  /** @brief Decode the approximate longitude, in [rad]
+   * @return Anything other than zero denotes an error
+   */
+  int longitude(double &lon) const noexcept;
+
+  /** @brief Decode the approximate latitude, in [rad]
+   * @return Anything other than zero denotes an error
+   */
+  int latitude(double &lat) const noexcept;
+
+  /** @brief Decode the approximate height, in [m]
+   * @return Anything other than zero denotes an error
+   */
+  int height(double &hgt) const noexcept {
+    return details::field_number<L::Height>(m_line, m_len, hgt);
+  }
+
+  /** @brief Decode all fields to an (owning) dso::sinex::SiteId instance,
+   *         exactly as dso::Sinex::parse_block_site_id would.
+   * @return Anything other than zero denotes an error
+   */
+  int materialize(SiteId &sid) const noexcept;
+}; /* SiteIdView */
+
+/** @class SolutionEstimateView
+ * A view of a SOLUTION/ESTIMATE record line; see
+ * dso::sinex::SolutionEstimate for the fields. Character fields are
+ * returned as they appear in the line (i.e. padded with whitespaces),
+ * numeric fields are decoded on each call.
+ */
+class SolutionEstimateView {
+  using L = details::layout::SolutionEstimate;
+  const char *m_line = nullptr;
+  int m_len = 0;
+
+public:
+  /** @brief The block holding such records */
+  static constexpr const char *block_name = "SOLUTION/ESTIMATE";
+
+  SolutionEstimateView() noexcept = default;
+
+  /** @brief View the line [line, line+len) (no newline character) */
+  SolutionEstimateView(const char *line, int len) noexcept
+      : m_line(line), m_len(len) {}
+
+  /** @brief The (whole) record line */
+  std::string_view line() const noexcept {
+    return std::string_view(m_line, m_len);
+  }
+
+  /** @brief Decode the Estimated Parameters Index
+   * @return Anything other than zero denotes an error
+   */
+  int index(int &idx) const noexcept {
+    return details::field_number<L::Index>(m_line, m_len, idx);
+  }
+
+  /** Parameter Type [A6] */
+  std::string_view parameter_type() const noexcept {
+    return details::field_view<L::ParameterType>(m_line, m_len);
+  }
+
+  /** @brief Parameter Type id, i.e. index in dso::sinex::parameter_types[]
+   *         (or -1 if the field does not hold a valid parameter type).
+   */
+  int parameter_type_id() const noexcept;
+
+  /** Site Code [A4] */
+  std::string_view site_code() const noexcept {
+    return details::field_view<L::SiteCode>(m_line, m_len);
+  }
+
+  /** Point Code [A2] */
+  std::string_view point_code() const noexcept {
+    return details::field_view<L::PointCode>(m_line, m_len);
+  }
+
+  /** Solution ID [A4] */
+  std::string_view soln_id() const noexcept {
+    return details::field_view<L::SolnId>(m_line, m_len);
+  }
+
+  /** Parameter Units [A4] */
+  std::string_view units() const noexcept {
+    return details::field_view<L::Units>(m_line, m_len);
+  }
+
+  /** @brief SITE CODE plus POINT CODE, packed (see
+   *         dso::sinex::details::site_key); compare it against the site key
+   *         of a dso::sinex::SiteId to match records to sites.
+   */
+  std::uint64_t site_key() const noexcept {
+    if (m_len >= L::PointCode::end)
+      return details::site_key(m_line + L::SiteCode::offset,
+                               m_line + L::PointCode::offset);
+    char buf[L::PointCode::end] = {'\0'};
+    std::memcpy(buf, m_line, m_len);
+    return details::site_key(buf + L::SiteCode::offset,
+                             buf + L::PointCode::offset);
+  }
+
+  /** @brief Decode the Epoch (Time) at which the estimate is valid.
+   * @param[in] tdefault Epoch to use if the field is '00:000:00000'
+   *            (i.e. the data start time of the SINEX file)
+   * @return Anything other than zero denotes an error
+   */
+  int epoch(const dso::datetime<dso::nanoseconds> &tdefault,
+            dso::datetime<dso::nanoseconds> &t) const noexcept {
+    return details::field_date_copy<L::RefEpoch>(m_line, m_len, tdefault, t);
+  }
+
+  /** @brief Decode the Constraint Code
+   * @return Anything other than zero denotes an error
+   */
+  int constraint(SinexConstraintCode &code) const noexcept {
+    return details::field_constraint<L::Constraint>(m_line, m_len, code);
+  }
+
+  /** @brief Decode the Parameter Estimate
+   * @return Anything other than zero denotes an error
+   */
+  int estimate(double &val) const noexcept {
+    return details::field_number<L::Estimate>(m_line, m_len, val);
+  }
+
+  /** @brief Decode the Parameter Standard Deviation
+   * @return Anything other than zero denotes an error
+   */
+  int std_deviation(double &val) const noexcept {
+    return details::field_number<L::StdDeviation>(m_line, m_len, val);
+  }
+
+  /** @brief Decode all fields to an (owning) dso::sinex::SolutionEstimate
+   *         instance, exactly as dso::Sinex::parse_block_solution_estimate
+   *         would.
+   * @param[in] sinex_data_start Data start time of the SINEX file; used to
+   *            resolve '00:000:00000' dates
+   * @return Anything other than zero denotes an error
+   */
+  int materialize(
+      const dso::datetime<dso::nanoseconds> &sinex_data_start,
+      SolutionEstimate &est) const noexcept;
+}; /* SolutionEstimateView */
+
+/** @class RecordRange
+ * A (forward) range over the data records (i.e. non-comment lines) of a
+ * block payload held in memory, yielding one View (e.g. SiteIdView) per
+ * record. Lines are located on iteration; nothing is decoded or copied.
+ *
+ * Example:
+ * dso::sinex::RecordRange<dso::sinex::SiteIdView> sites;
+ * if (snx.view_block(sites)) return 1;
+ * for (const auto site : sites)
+ *   printf("%.4s %.9s\n", site.site_code().data(), site.domes().data());
+ */
+template <typename View> class RecordRange {
+  const char *m_begin = nullptr;
+  const char *m_end = nullptr;
+
+public:
+  class iterator {
+    const char *m_cur = nullptr;
+    const char *m_eol = nullptr;
+    const char *m_end = nullptr;
+
+    /* end of the line starting at m_cur (i.e. its newline character, or
+     * m_end) */
+    const char *eol() const noexcept {
+      const char *nl = static_cast<const char *>(
+          std::memchr(m_cur, '\n', m_end - m_cur));
+      return nl ? nl : m_end;
+    }
+
+    /* skip comment lines, starting at m_cur */
+    void settle() noexcept {
+      while (m_cur < m_end) {
+        m_eol = eol();
+        if (*m_cur != '*')
+          return;
+        m_cur = (m_eol < m_end) ? m_eol + 1 : m_end;
+      }
+      m_eol = m_end;
+    }
+
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = View;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = View;
+
+    iterator() noexcept = default;
+    iterator(const char *begin, const char *end) noexcept
+        : m_cur(begin), m_end(end) {
+      settle();
+    }
+
+    View operator*() const noexcept { return View(m_cur, m_eol - m_cur); }
+
+    iterator &operator++() noexcept {
+      m_cur = (m_eol < m_end) ? m_eol + 1 : m_end;
+      settle();
+      return *this;
+    }
+    iterator operator++(int) noexcept {
+      iterator it(*this);
+      ++(*this);
+      return it;
+    }
+
+    bool operator==(const iterator &other) const noexcept {
+      return m_cur == other.m_cur;
+    }
+    bool operator!=(const iterator &other) const noexcept {
+      return m_cur != other.m_cur;
+    }
+  }; /* iterator */
+
+  RecordRange() noexcept = default;
+
+  /** @brief Records of the block payload [begin, end) */
+  RecordRange(const char *begin, const char *end) noexcept
+      : m_begin(begin), m_end(end) {}
+
+  iterator begin() const noexcept { return iterator(m_begin, m_end); }
+  iterator end() const noexcept { return iterator(m_end, m_end); }
+}; /* RecordRange */
+
+namespace details {
+template <> struct record_traits<SiteIdView> {
+  static constexpr const char *block_name = SiteIdView::block_name;
+  static constexpr bool is_view = true;
+  using line_layout = layout::SiteId;
+};
+
+template <> struct record_traits<SolutionEstimateView> {
+  static constexpr const char *block_name = SolutionEstimateView::block_name;
+  static constexpr bool is_view = true;
+  using line_layout = layout::SolutionEstimate;
+};
+} /* namespace details */
+
+} /* namespace dso::sinex */
+
+#endif
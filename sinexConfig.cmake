@@ -1,3 +1,6 @@
 include(CMakeFindDependencyMacro)
 # find_dependency(xxx 2.0)
+find_dependency(Threads)
+find_dependency(ZLIB)
+find_dependency(Eigen3)
 include(${CMAKE_CURRENT_LIST_DIR}/sinexTargets.cmake)
@@ -1,22 +1,170 @@
 #include "datetime/calendar.hpp"
 #include "sinex.hpp"
+#include "core/sinex_fields.hpp"
+#include "core/sinex_lines.hpp"
+#include "core/sinex_site_key.hpp"
 #include "sinex_blocks.hpp"
-#include <limits>
+#include <algorithm>
+#include <cmath>
 
-constexpr const double EMPTY = std::numeric_limits<double>::min();
+namespace {
+/* parameters of the linear model; positions at even indexes, each followed
+ * by the respective velocity */
+constexpr const char *params[] = {"STAX", "VELX", "STAY",
+                                  "VELY", "STAZ", "VELZ"};
 
-int dso::Sinex::linear_extrapolate_coordinates(
+/* estimates of the linear model parameters of one solution of a site */
+struct SolutionParameters {
+  char soln_id[dso::sinex::SOLN_ID_CHAR_SIZE + 1] = {'\0'};
+  double value[6];
+  dso::datetime<dso::nanoseconds> epoch[6];
+  /* parameter indexes, i.e. rows/columns in SOLUTION/MATRIX_* blocks */
+  int index[6];
+  /* bit i is set if value[i] and epoch[i] are collected */
+  unsigned found = 0;
+  bool has(int i) const noexcept { return found & (1u << i); }
+};
+
+/* records of a site, collected while sweeping the blocks */
+struct SiteRecords {
+  /* SOLUTION/EPOCHS record with the interval closest to t (if any) */
+  dso::sinex::SolutionEpoch epoch;
+  bool has_epoch = false;
+  /* parameters, one entry per solution */
+  std::vector<SolutionParameters> solns;
+
+  const SolutionParameters *find(const char *soln_id) const noexcept {
+    for (const auto &s : solns)
+      if (!std::strncmp(s.soln_id, soln_id, dso::sinex::SOLN_ID_CHAR_SIZE))
+        return &s;
+    return nullptr;
+  }
+
+  /* store parameter i of estimate est (first one found is kept) */
+  void collect(int i, const dso::sinex::SolutionEstimate &est) {
+    auto it = std::find_if(solns.begin(), solns.end(),
+                           [&](const SolutionParameters &s) {
+                             return !std::strncmp(
+                                 s.soln_id, est.soln_id(),
+                                 dso::sinex::SOLN_ID_CHAR_SIZE);
+                           });
+    if (it == solns.end()) {
+      solns.emplace_back();
+      it = solns.end() - 1;
+      std::strncpy(it->soln_id, est.soln_id(), dso::sinex::SOLN_ID_CHAR_SIZE);
+    }
+    if (!it->has(i)) {
+      it->value[i] = est.estimate();
+      it->epoch[i] = est.epoch();
+      it->index[i] = est.index();
+      it->found |= (1u << i);
+    }
+  }
+};
+
+/* index (in params) of the parameter of a SOLUTION/ESTIMATE line, off from
+ * its raw PARAMETER TYPE field; -1 if not a parameter of the linear model */
+int parameter_of(const char *line, const int *pid) noexcept {
+  using F = dso::sinex::details::layout::SolutionEstimate::ParameterType;
+  if (std::memchr(line, '\0', F::end))
+    return -1;
+  const char *begin = line + F::offset, *end = line + F::end;
+  dso::sinex::details::trim(begin, end);
+  const int id = dso::sinex::parameter_type_id(begin, end - begin);
+  for (int i = 0; i < 6; i++)
+    if (id == pid[i])
+      return i;
+  return -1;
+}
+} /* anonymous namespace */
+
+int dso::Sinex::linear_extrapolate(
     const std::vector<sinex::SiteId> &sites,
     const dso::datetime<dso::nanoseconds> &t,
-    std::vector<dso::Sinex::SiteCoordinateResults> &crd) noexcept {
+    const sinex::SymmetricMatrix *matrix,
+    std::vector<dso::Sinex::SiteCoordinateResults> &crd) const noexcept {
   if (!crd.empty())
     crd.clear();
   crd.reserve(sites.size());
 
-  /* get (all recorded) estimates for each of the sites given */
-  std::vector<dso::sinex::SolutionEstimate> sols;
-  if (this->parse_block_solution_estimate(sites, t,
-                                          /*allow_extrapolation*/ true, sols)) {
+  int pid[6];
+  for (int i = 0; i < 6; i++)
+    pid[i] = sinex::parameter_type_id(params[i], std::strlen(params[i]));
+
+  /* sites of interest (indexes into sites), keyed by SITE CODE and POINT
+   * CODE; records collected for each of them */
+  const auto sites_map = sinex::details::SiteKeyMap::of_sites(sites);
+  std::vector<SiteRecords> records;
+  /* if propagating covariances: the 6x6 STA/VEL covariance matrices
+   * (packed, 21 elements) and the time differences (3 components) of all
+   * sites, as structure of arrays; see sinex::propagate_sta_vel_covariance */
+  const int n = sites.size();
+  std::vector<double> sta_vel, dts, xyz_cov;
+  try {
+    records.resize(sites.size());
+    if (matrix) {
+      sta_vel.resize(21 * n);
+      dts.resize(3 * n);
+      xyz_cov.resize(6 * n);
+    }
+  } catch (std::exception &) {
+    return 1;
+  }
+
+  /* if SOLUTION/EPOCHS precedes SOLUTION/ESTIMATE in the file (as it
+   * normally does), the solution of each site is known by the time its
+   * estimates are swept; only lines of that solution need to be decoded */
+  const auto epochs_blk = find_block("SOLUTION/EPOCHS");
+  const auto estimates_blk = find_block("SOLUTION/ESTIMATE");
+  const bool epochs_first = (epochs_blk != m_blocks.cend()) &&
+                            (estimates_blk != m_blocks.cend()) &&
+                            (epochs_blk->mdata < estimates_blk->mdata);
+
+  /* one sweep over SOLUTION/EPOCHS and SOLUTION/ESTIMATE (in file order);
+   * for each site, keep the epoch record closest to t and the linear model
+   * parameters of (the chosen, or else all of) its solutions */
+  sinex::SolutionEpoch entry;
+  sinex::SolutionEstimate est;
+  if (sweep_blocks(
+          {"SOLUTION/EPOCHS", "SOLUTION/ESTIMATE"},
+          [&](int block, const char *line) noexcept {
+            if (block == 0) {
+              const int i =
+                  sites_map.find(sinex::details::site_key(line + 1, line + 6));
+              if (i < 0)
+                return 0;
+              if (sinex::details::parse_epoch_line(line, m_data_start,
+                                                   m_data_stop, entry))
+                return 1;
+              if (!records[i].has_epoch) {
+                records[i].epoch = entry;
+                records[i].has_epoch = true;
+                return 0;
+              }
+              return sinex::details::keep_closest_epoch(t, entry,
+                                                        records[i].epoch);
+            }
+            const int i =
+                sites_map.find(sinex::details::site_key(line + 14, line + 19));
+            if (i < 0 ||
+                (epochs_first &&
+                 ((!records[i].has_epoch) ||
+                  std::strncmp(records[i].epoch.soln_id(), line + 22,
+                               sinex::SOLN_ID_CHAR_SIZE))))
+              return 0;
+            const int p = parameter_of(line, pid);
+            if (p < 0)
+              return 0;
+            if (sinex::details::parse_solution_estimate_line(line, est,
+                                                             m_data_start))
+              return 1;
+            try {
+              records[i].collect(p, est);
+            } catch (std::exception &) {
+              return 1;
+            }
+            return 0;
+          })) {
     fprintf(stderr,
             "[ERROR] Failed parsing site solution from SINEX file %s "
             "(traceback: %s)\n",
@@ -24,112 +172,92 @@ int dso::Sinex::linear_extrapolate_coordinates(
     return 1;
   }
 
-  const char *p[] = {"STAX", "VELX", "STAY", "VELY", "STAZ", "VELZ"};
-  double xyz[3];
-
   /* loop through all sites (i.e. SiteId's) */
-  for (auto site = sites.cbegin(); site != sites.end(); ++site) {
-    /* initialize coordinates to a dummy value */
-    xyz[0] = xyz[1] = xyz[2] = EMPTY;
-    char solnid[sinex::SOLN_ID_CHAR_SIZE + 1] = {'\0'};
+  for (int k = 0; k < n; k++) {
+    const auto &site = sites[k];
+    /* records of the site (constant time lookup) and parameters of the
+     * solution chosen via SOLUTION/EPOCHS */
+    const auto &rec = records[sites_map.find(
+        sinex::details::site_key(site.site_code(), site.point_code()))];
+    const SolutionParameters *sol =
+        rec.has_epoch ? rec.find(rec.epoch.soln_id()) : nullptr;
+
+    double xyz[3];
     /* loop through site components */
     for (int xcomponent = 0; xcomponent < 6; xcomponent += 2) {
-      const char *sta = p[xcomponent];     // e.g. "STAX"
-      const char *vel = p[xcomponent + 1]; // e.g. "VELX"
-      /* find estimates for position component */
-      auto xit = std::find_if(
-          sols.begin(), sols.end(), [&](const dso::sinex::SolutionEstimate &s) {
-            return ((!std::strncmp(site->point_code(), s.point_code(),
-                                   sinex::POINT_CODE_CHAR_SIZE) &&
-                     !std::strncmp(site->site_code(), s.site_code(),
-                                   sinex::SITE_CODE_CHAR_SIZE)) &&
-                    !std::strncmp(sta, s.parameter_type(),
-                                  sinex::PARAMETER_TYPE_CHAR_SIZE));
-          });
-      /* find estimates for velocity component */
-      auto vit = std::find_if(
-          sols.begin(), sols.end(), [&](const dso::sinex::SolutionEstimate &s) {
-            return ((!std::strncmp(site->point_code(), s.point_code(),
-                                   sinex::POINT_CODE_CHAR_SIZE) &&
-                     !std::strncmp(site->site_code(), s.site_code(),
-                                   sinex::SITE_CODE_CHAR_SIZE)) &&
-                    !std::strncmp(vel, s.parameter_type(),
-                                  sinex::PARAMETER_TYPE_CHAR_SIZE));
-          });
+      const char *sta = params[xcomponent];     // e.g. "STAX"
+      const char *vel = params[xcomponent + 1]; // e.g. "VELX"
+      const bool hx = sol && sol->has(xcomponent);
+      const bool hv = sol && sol->has(xcomponent + 1);
       /* we should have both terms of the linear model */
-      if (xit == sols.end() || vit == sols.end()) {
-        if (xit == sols.end() && vit == sols.end()) {
-          fprintf(
-              stderr,
-              "[ERROR] Failed to find both %s and %s parameter for site %s %s; "
-              "SINEX: %s "
-              "(traceback: %s)\n",
-              sta, vel, site->site_code(), site->point_code(),
-              m_filename.c_str(), __func__);
-          return 1;
-        } else if (xit != sols.end() && vit == sols.end()) {
-          fprintf(stderr,
-                  "[ERROR] Found only %s but not %s parameter for site %s %s; "
-                  "SINEX: %s "
-                  "(traceback: %s)\n",
-                  sta, vel, site->site_code(), site->point_code(),
-                  m_filename.c_str(), __func__);
-          return 1;
-        } else if (xit == sols.end() && vit != sols.end()) {
-          fprintf(stderr,
-                  "[ERROR] Found only %s but not %s parameter for site %s %s; "
-                  "SINEX: %s "
-                  "(traceback: %s)\n",
-                  vel, sta, site->site_code(), site->point_code(),
-                  m_filename.c_str(), __func__);
-          return 1;
-        }
-      } else if (std::strcmp(xit->soln_id(), vit->soln_id())) {
-        /* solution IDs should be the same for X0 and Vx */
+      if (!hx && !hv) {
         fprintf(stderr,
-                "[ERROR] Solution IDs for position and velocity do not match! "
-                "Got \'%s\' vs \'%s\' for site %s, %s, components %s, %s. "
-                "SINEX: %s (traceback: %s)\n",
-                xit->soln_id(), vit->soln_id(), site->site_code(),
-                site->point_code(), sta, vel, m_filename.c_str(), __func__);
+                "[ERROR] Failed to find both %s and %s parameter for site %s "
+                "%s; SINEX: %s (traceback: %s)\n",
+                sta, vel, site.site_code(), site.point_code(),
+                m_filename.c_str(), __func__);
         return 1;
-      } else if (solnid[0] && (std::strcmp(xit->soln_id(), solnid))) {
-        /* if we already have a solution id (e.g. from X compoenent) it should
-         *  stay the same here (e.g. for Y component).
-         */
+      } else if (!hx || !hv) {
         fprintf(stderr,
-                "[ERROR] Solution IDs do not match for different components! "
-                "Got \'%s\' vs \'%s\' for site %s, %s, components %s, %s. "
+                "[ERROR] Found only %s but not %s parameter for site %s %s; "
                 "SINEX: %s (traceback: %s)\n",
-                xit->soln_id(), solnid, site->site_code(), site->point_code(),
-                sta, vel, m_filename.c_str(), __func__);
-      } else {
-        /* ok, we have coordinates and velocity for component */
-        const double x0 = xit->estimate();
-        const double vx = vit->estimate();
-        const auto dt =
-            t.diff<dso::DateTimeDifferenceType::FractionalYears>(xit->epoch());
-        auto val = x0 + vx * dt.years();
-        xyz[xcomponent / 2] = val;
-        std::strcpy(solnid, xit->soln_id());
+                hx ? sta : vel, hx ? vel : sta, site.site_code(),
+                site.point_code(), m_filename.c_str(), __func__);
+        return 1;
       }
+      /* ok, we have coordinates and velocity for component */
+      const double x0 = sol->value[xcomponent];
+      const double vx = sol->value[xcomponent + 1];
+      const auto dt = t.diff<dso::DateTimeDifferenceType::FractionalYears>(
+          sol->epoch[xcomponent]);
+      xyz[xcomponent / 2] = x0 + vx * dt.years();
+      if (matrix)
+        dts[(xcomponent / 2) * n + k] = dt.years();
     } /* end looping components for the site */
 
-    /* did we collect all components ? */
-    if ((xyz[0] == EMPTY) || (xyz[1] == EMPTY) || (xyz[2] == EMPTY)) {
-      fprintf(stderr,
-              "[ERROR] Failed retrieving components for site %s %s; "
-              "SINEX: %s "
-              "(traceback: %s)\n",
-              site->site_code(), site->point_code(), m_filename.c_str(),
-              __func__);
-      return 1;
+    if (matrix) {
+      /* STA/VEL covariance matrix, in the order STAX, STAY, STAZ, VELX,
+       * VELY, VELZ (params is ordered STAX, VELX, STAY, ...) */
+      int idx[6];
+      for (int c = 0; c < 3; c++) {
+        idx[c] = sol->index[2 * c];
+        idx[c + 3] = sol->index[2 * c + 1];
+      }
+      if (*std::max_element(idx, idx + 6) > matrix->rows() ||
+          *std::min_element(idx, idx + 6) < 1) {
+        fprintf(stderr,
+                "[ERROR] Parameters of site %s %s not in %dx%d covariance "
+                "matrix; SINEX: %s (traceback: %s)\n",
+                site.site_code(), site.point_code(), matrix->rows(),
+                matrix->cols(), m_filename.c_str(), __func__);
+        return 1;
+      }
+      for (int i = 0; i < 6; i++)
+        for (int j = 0; j <= i; j++)
+          sta_vel[sinex::SymmetricMatrix::packed_index(i, j) * n + k] =
+              (*matrix)(idx[i] - 1, idx[j] - 1);
     }
 
     /* append to result vector */
-    crd.emplace_back(dso::Sinex::SiteCoordinateResults(*site, solnid, xyz[0],
-                                                       xyz[1], xyz[2]));
+    crd.emplace_back(dso::Sinex::SiteCoordinateResults(site, sol->soln_id,
+                                                       xyz[0], xyz[1], xyz[2]));
   } /* end looping sites */
 
+  if (matrix) {
+    /* propagate the covariance matrices of all sites in one batch */
+    sinex::propagate_sta_vel_covariance(n, sta_vel.data(), dts.data(),
+                                        xyz_cov.data());
+    for (int k = 0; k < n; k++) {
+      auto &c = crd[k];
+      for (int i = 0; i < 3; i++)
+        for (int j = 0; j <= i; j++)
+          c.cov(i, j) = c.cov(j, i) =
+              xyz_cov[sinex::SymmetricMatrix::packed_index(i, j) * n + k];
+      c.sx = std::sqrt(c.cov(0, 0));
+      c.sy = std::sqrt(c.cov(1, 1));
+      c.sz = std::sqrt(c.cov(2, 2));
+    }
+  }
+
   return 0;
 }
@@ -1,68 +1,51 @@
 #include "sinex.hpp"
+#include "core/sinex_fields.hpp"
+#include "core/sinex_lines.hpp"
+#include "core/sinex_site_key.hpp"
 #include <cstdlib>
 
-namespace {
-/* @brief Max line in SOLUTION/DATA_REJECT block */
-constexpr int max_lines_in_block = 100000;
-/* @brief Start index for CODE in a SOLUTION/DATA_REJECT line */
-constexpr const int scode_start = 1;
-/* @brief Start index for PT in a SOLUTION/DATA_REJECT line */
-constexpr const int spt_start = 6;
-/* @brief Start index for SOLN in a SOLUTION/DATA_REJECT line */
-constexpr const int ssoln_start = 9;
-/* @brief Start index for T in a SOLUTION/DATA_REJECT line */
-constexpr const int st_start = 14;
-/* @brief Start index for M in a SOLUTION/DATA_REJECT line */
-constexpr const int sm_start = 42;
-/* @brief Start index for A in a SOLUTION/DATA_REJECT line */
-constexpr const int sa_start = 44;
-/* @brief Start index for DATA_START in a SOLUTION/DATA_REJECT line */
-constexpr const int sdata_start_start = 16;
-/* @brief Start index for DATA_SEND in a SOLUTION/DATA_REJECT line */
-constexpr const int sdata_end_start = 29;
-/* @brief Start index for COMMENTS in a SOLUTION/DATA_REJECT line */
-constexpr const int scomments_start = 46;
-
-int parse_data_reject_line(
+int dso::sinex::details::parse_data_reject_line(
     const char *line, dso::sinex::DataReject &rintrv,
     const dso::datetime<dso::nanoseconds> &sinex_data_start,
     const dso::datetime<dso::nanoseconds> &sinex_data_stop) noexcept {
+  using L = layout::DataReject;
+
+  const int len = std::strlen(line);
   int error = 0;
-  std::memcpy(rintrv.site_code(), line + scode_start, 4);
-  std::memcpy(rintrv.point_code(), line + spt_start, 2);
-  std::memcpy(rintrv.soln_id(), line + ssoln_start, 4);
-  try {
-    rintrv.m_obscode = dso::sinex::char_to_SinexObservationCode(line[st_start]);
-  } catch (std::exception &) {
+  field_chars<L::SiteCode>(line, len, rintrv.site_code());
+  field_chars<L::PointCode>(line, len, rintrv.point_code());
+  field_chars<L::SolnId>(line, len, rintrv.soln_id());
+  if (field_obscode<L::ObsCode>(line, len, rintrv.m_obscode)) {
     fprintf(stderr,
             "[ERROR] Erronuous SINEX Observation Code \'%c\' (traceback: %s)\n",
-            line[st_start], __func__);
+            (len > L::ObsCode::offset) ? line[L::ObsCode::offset] : ' ',
+            __func__);
     ++error;
   }
-  rintrv.colm() = line[sm_start];
-  rintrv.cola() = line[sa_start];
+  field_chars<L::ColM>(line, len, &rintrv.colm());
+  field_chars<L::ColA>(line, len, &rintrv.cola());
 
-  error += dso::sinex::parse_sinex_date(line + sdata_start_start,
-                                        sinex_data_start, rintrv.start);
-  error += dso::sinex::parse_sinex_date(line + sdata_end_start, sinex_data_stop,
-                                        rintrv.stop);
+  error += field_dates<L::DataStart, L::DataEnd>(
+      line, len, {&sinex_data_start, &sinex_data_stop},
+      {&rintrv.start, &rintrv.stop});
   if (error) {
     fprintf(stderr,
             "[ERROR] Failed to parse date from line: \"%s\" (traceback: %s)\n",
             line, __func__);
   }
 
-  std::strcpy(rintrv.comment(), line + scomments_start);
+  field_chars<L::Comments>(line, len, rintrv.comment());
 
   return error;
 }
-} /* anonymous namespace */
 
 int dso::Sinex::parse_block_data_reject(
     const std::vector<sinex::SiteId> &site_vec,
     std::vector<sinex::DataReject> &out_vec,
     const dso::datetime<dso::nanoseconds> from,
-    const dso::datetime<dso::nanoseconds> to) noexcept {
+    const dso::datetime<dso::nanoseconds> to,
+    const sinex::QueryPredicate &query,
+    sinex::QueryStats *stats) const noexcept {
 
   /* clear the vector, allocate storage */
   if (!out_vec.empty())
@@ -70,64 +53,71 @@ int dso::Sinex::parse_block_data_reject(
   if (out_vec.capacity() < site_vec.size())
     out_vec.reserve(out_vec.size());
 
+  /* sites of interest, keyed by SITE CODE and POINT CODE */
+  const auto sites = sinex::details::SiteKeyMap::of_sites(site_vec);
+
+  /* the record's interval is whithin limits (ranges overlap) */
+  auto overlaps = [&](const sinex::DataReject &r) {
+    return dso::intervals_overlap<
+        dso::nanoseconds, dso::datetime_ranges::OverlapComparissonType::Strict>(
+        from, to, r.start, r.stop);
+  };
+
+  /* select off the records of a preloaded block, if any */
+  if (const auto *records = preloaded_block<sinex::DataReject>(query)) {
+    for (const auto &r : *records)
+      if (sites.contains(
+              sinex::details::site_key(r.site_code(), r.point_code())) &&
+          overlaps(r))
+        out_vec.push_back(r);
+    return 0;
+  }
+
   /* go to SOLUTION/ESTIMATE block */
-  if (goto_block("SOLUTION/DATA_REJECT"))
+  sinex::details::LineCursor cursor;
+  if (goto_block("SOLUTION/DATA_REJECT", cursor))
     return 1;
 
-  /* next line to be read should be '+SOLUTION/DATA_REJECT' */
+  /* cursor is placed at the first line of the block payload */
   char line[sinex::max_sinex_chars];
-  m_stream.getline(line, sinex::max_sinex_chars);
-  if (!m_stream.good() || std::strcmp(line, "+SOLUTION/DATA_REJECT")) {
-    fprintf(stderr,
-            "[ERROR] Expected \"%s\" line, found: \"%s\" (traceback: %s)\n",
-            "+SOLUTION/DATA_REJECT", line, __func__);
-    return 1;
-  }
 
   /* read in DataReject's untill end of block */
-  std::size_t ln_count = 0;
   int error = 0;
   dso::sinex::DataReject drIntrvl;
-  while (m_stream.getline(line, sinex::max_sinex_chars) &&
-         (++ln_count < max_lines_in_block) && (!error)) {
-    /* end of block; break */
-    if (!std::strncmp(line, "-SOLUTION/DATA_REJECT", 21))
-      break;
-
+  sinex::QueryStats qstats;
+  while (cursor.getline(line) && (!error)) {
     if (*line != '*') { /* non-comment line */
 
-      /* check if the site is of interest, aka included in site_vec */
-      auto it = std::find_if(
-          site_vec.cbegin(), site_vec.cend(), [&](const sinex::SiteId &site) {
-            return !std::strncmp(site.site_code(), line + scode_start, 4) &&
-                   !std::strncmp(site.point_code(), line + spt_start, 2);
-          });
-
-      /* the station is in the list */
-      if (it != site_vec.cend()) {
+      /* check if the site is of interest, aka included in site_vec, and
+       * the query on the raw line */
+      if (!sites.contains(sinex::details::site_key(line + 1, line + 6)) ||
+          !query.accepts<sinex::details::layout::DataReject>(
+              line, m_data_start, m_data_stop)) {
+        ++qstats.lines_skipped;
+      } else {
+        ++qstats.lines_decoded;
         /* parse line */
-        error =
-            parse_data_reject_line(line, drIntrvl, m_data_start, m_data_stop);
+        error = sinex::details::parse_data_reject_line(
+            line, drIntrvl, m_data_start, m_data_stop);
         /* if the record's interval is whithin limits (ranges overlap) */
-        if (dso::intervals_overlap<
-                dso::nanoseconds,
-                dso::datetime_ranges::OverlapComparissonType::Strict>(
-                from, to, drIntrvl.start, drIntrvl.stop)) {
+        if (overlaps(drIntrvl)) {
           /* add to list */
           out_vec.emplace_back(drIntrvl);
         }
       }
 
     } /* non-comment line */
-    ++ln_count;
   } /* end of block */
 
-  /* check for infinite loop */
-  if (ln_count >= max_lines_in_block) {
+  if (stats)
+    *stats += qstats;
+
+  /* check that the whole block was read */
+  if ((!error) && (!cursor.done())) {
     fprintf(stderr,
-            "[ERROR] Read in %8zu lines and no \'%s\' line found .... smthng "
-            "is wrong! (traceback: %s)\n",
-            ln_count, "-SOLUTION/DATA_REJECT", __func__);
+            "[ERROR] Failed reading block \'%s\' of SINEX file %s "
+            "(traceback: %s)\n",
+            "SOLUTION/DATA_REJECT", m_filename.c_str(), __func__);
     return 1;
   }
 
@@ -1,5 +1,6 @@
 #include "dpod.hpp"
 #include "sinex.hpp"
+#include "core/sinex_site_key.hpp"
 #include <charconv>
 #include <cstdio>
 #include <fstream>
@@ -131,6 +132,13 @@ std::vector<dso::Sinex::SiteCoordinateResults> dso::get_dpod_freq_corr(
   for (auto it = scpy.begin(); it != scpy.end(); ++it)
     it->x = it->y = it->z = 0e0;
 
+  /* sites of interest, keyed by SITE CODE and POINT CODE */
+  sinex::details::SiteKeyMap sites(scpy.size());
+  for (std::size_t i = 0; i < scpy.size(); i++)
+    sites.insert(sinex::details::site_key(scpy[i].msite.site_code(),
+                                          scpy[i].msite.point_code()),
+                 (int)i);
+
   /* fractional day of year and phase at epoch */
   const auto ymd_ = t.as_ydoy();
   const int idoy_ = ymd_.dy().as_underlying_type();
@@ -150,18 +158,13 @@ std::vector<dso::Sinex::SiteCoordinateResults> dso::get_dpod_freq_corr(
     /* skip lines starting with '#', else parse */
     if (line[0] != '#') {
       /* find mathing site & SOLN_ID in scpy (if any) */
-      auto it = std::find_if(
-          scpy.begin(), scpy.end(),
-          [&](const dso::Sinex::SiteCoordinateResults &site) {
-            return ((!std::strncmp(site.msite.site_code(), line + 1,
-                                   sinex::SITE_CODE_CHAR_SIZE) &&
-                     !std::strncmp(site.msite.point_code(), line + 6,
-                                   sinex::POINT_CODE_CHAR_SIZE)) &&
-                    (!std::strncmp(site.msite.domes(), line + 9,
-                                   sinex::DOMES_CHAR_SIZE) &&
-                     !std::strncmp(site.soln_id(), line + 18,
-                                   sinex::SOLN_ID_CHAR_SIZE)));
-          });
+      const auto key = sinex::details::site_key(line + 1, line + 6);
+      int idx = sites.find_if(key, [&](int i) {
+        return !std::strncmp(scpy[i].msite.domes(), line + 9,
+                             sinex::DOMES_CHAR_SIZE) &&
+               !std::strncmp(scpy[i].soln_id(), line + 18,
+                             sinex::SOLN_ID_CHAR_SIZE);
+      });
       /* Here is a subtle point:
        * Sometimes, the SOLN_ID's in the dpod_freq file(s) do not exactly
        * match the ones given in the respective SINEX file (aka dpod*.snx).
@@ -169,28 +172,20 @@ std::vector<dso::Sinex::SiteCoordinateResults> dso::get_dpod_freq_corr(
        * as [   1]. So, if we matched nothing, let's check if we can find
        * a mathing site comparing the SOLN_ID fields as integers.
        */
-      if (it == scpy.end()) {
+      if (idx < 0) {
         int sint = 2 * dso::sinex::NONINT_SOLN_ID;
         std::from_chars(skipws(line + 18), line + 18 + sinex::SOLN_ID_CHAR_SIZE,
                         sint);
-        it = std::find_if(
-            scpy.begin(), scpy.end(),
-            [&](const dso::Sinex::SiteCoordinateResults &site) {
-              return ((!std::strncmp(site.msite.site_code(), line + 1,
-                                     sinex::SITE_CODE_CHAR_SIZE) &&
-                       !std::strncmp(site.msite.point_code(), line + 6,
-                                     sinex::POINT_CODE_CHAR_SIZE)) &&
-                      (!std::strncmp(site.msite.domes(), line + 9,
-                                     sinex::DOMES_CHAR_SIZE) &&
-                       /*!std::strncmp(site.msolnid, line + 18,
-                          sinex::SOLN_ID_CHAR_SIZE)*/
-                       (site.soln_id_int() == sint)));
-            });
+        idx = sites.find_if(key, [&](int i) {
+          return !std::strncmp(scpy[i].msite.domes(), line + 9,
+                               sinex::DOMES_CHAR_SIZE) &&
+                 (scpy[i].soln_id_int() == sint);
+        });
       }
 
       /* the station is in the list */
-      if (it != scpy.cend()) {
-
+      if (idx >= 0) {
+        auto it = scpy.begin() + idx;
         error += resolve_freq_cor_data_line(line, ccmp, data);
         if (!error) {
           const double valmm =
@@ -0,0 +1,383 @@
+#include "sinex.hpp"
+#include "core/sinex_fields.hpp"
+#include "core/sinex_lines.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+/* @brief Check the matrix indexes of a line, i.e. elements (row, col) to
+ * (row, col+num_vals-1), 1-based, of an n x n matrix; these should be in
+ * the lower (or upper) triangle.
+ */
+int check_matrix_line(const char *line, int row, int col, int num_vals,
+                      int n, bool lower, const char *block) noexcept {
+  const int last = col + num_vals - 1;
+  if (row < 1 || row > n || col < 1 || last > n ||
+      (lower ? (last > row) : (col < row))) {
+    fprintf(stderr,
+            "[ERROR] Invalid matrix element (%d,%d) in SINEX line \"%s\" "
+            "of block %s (traceback: %s)\n",
+            row, last, line, block, __func__);
+    return 1;
+  }
+  return 0;
+}
+} /* anonymous namespace */
+
+int dso::sinex::details::parse_matrix_line(const char *line, int &row,
+                                           int &col, double *vals,
+                                           int &num_vals) noexcept {
+  using L = layout::MatrixEstimate;
+  int len = std::strlen(line);
+  /* ignore trailing whitespace (incl. DOS line endings) */
+  while (len && (line[len - 1] == ' ' || line[len - 1] == '\r'))
+    --len;
+
+  num_vals = 0;
+  const char *pos = line;
+  if (field_number<L::Row>(line, len, row, pos) ||
+      field_number<L::Column>(line, len, col, pos)) {
+    fprintf(stderr,
+            "[ERROR] Failed parsing matrix indexes in SINEX line \"%s\" "
+            "(traceback: %s)\n",
+            line, __func__);
+    return 1;
+  }
+
+  /* one to three values; the last two may be missing. Anything left after
+   * the values decoded (e.g. a field that fails to decode) is an error */
+  const char *end = line + len;
+  pos = std::max(line + L::Value1::offset, pos);
+  if (pos < end)
+    num_vals = from_chars_fixed(pos, end, vals, 3);
+  if (!num_vals || pos < end) {
+    fprintf(stderr,
+            "[ERROR] Failed parsing matrix values in SINEX line \"%s\" "
+            "(traceback: %s)\n",
+            line, __func__);
+    return 1;
+  }
+
+  return 0;
+}
+
+const char *
+dso::Sinex::matrix_estimate_block(sinex::MatrixType type,
+                                  sinex::MatrixTriangle &triangle,
+                                  int &n) const noexcept {
+  /* the lower or upper triangle may be given; prefer the lower one */
+  triangle = sinex::MatrixTriangle::Lower;
+  const char *block = sinex::matrix_estimate_block_name(triangle, type);
+  if (find_block(block) == m_blocks.cend()) {
+    triangle = sinex::MatrixTriangle::Upper;
+    block = sinex::matrix_estimate_block_name(triangle, type);
+  }
+
+  /* matrix dimension, from the header */
+  n = m_num_estimates;
+  if (n <= 0) {
+    fprintf(stderr,
+            "[ERROR] Invalid number of estimates (%d) in header of SINEX file "
+            "%s (traceback: %s)\n",
+            n, m_filename.c_str(), __func__);
+    return nullptr;
+  }
+  return block;
+}
+
+int dso::Sinex::parse_block_matrix_estimate(sinex::MatrixType type,
+                                            sinex::SymmetricMatrix &matrix,
+                                            int num_threads) const noexcept {
+  sinex::MatrixTriangle triangle;
+  int n;
+  const char *block = matrix_estimate_block(type, triangle, n);
+  if (!block)
+    return 1;
+
+  /* split the block in chunks (one, unless parsing in parallel) */
+  std::vector<sinex::details::LineCursor> cursors;
+  if (goto_block_chunks(block, num_threads, cursors))
+    return 1;
+
+  try {
+    matrix.resize(n);
+  } catch (std::exception &e) {
+    fprintf(stderr,
+            "[ERROR] Failed allocating %dx%d matrix; %s (traceback: %s)\n", n,
+            n, e.what(), __func__);
+    return 1;
+  }
+
+  /* every line holds distinct elements, hence chunks write to disjoint
+   * parts of the matrix; nothing to merge */
+  const bool lower = (triangle == sinex::MatrixTriangle::Lower);
+  auto parse_chunk = [&](std::size_t, sinex::details::LineCursor &cursor,
+                         long &) noexcept {
+    char line[sinex::max_sinex_chars];
+    double vals[3];
+    int row, col, num_vals;
+    while (cursor.getline(line)) {
+      if (*line == '*')
+        continue;
+      if (sinex::details::parse_matrix_line(line, row, col, vals, num_vals))
+        return 1;
+      if (check_matrix_line(line, row, col, num_vals, n, lower, block))
+        return 1;
+      double *p = matrix.data() +
+                  sinex::SymmetricMatrix::packed_index(row - 1, col - 1);
+      if (lower) {
+        /* consecutive elements of a row are consecutive in packed storage */
+        std::copy(vals, vals + num_vals, p);
+      } else {
+        for (int k = 0; k < num_vals; k++)
+          matrix(row - 1, col - 1 + k) = vals[k];
+      }
+    }
+    return 0;
+  };
+  long dummy = 0;
+  int error = sinex::details::parse_chunks(cursors, dummy, parse_chunk,
+                                           [](long &, const long &) {});
+
+  /* check that the whole block was read */
+  if ((!error) && std::any_of(cursors.cbegin(), cursors.cend(),
+                              [](const sinex::details::LineCursor &c) {
+                                return !c.done();
+                              })) {
+    fprintf(stderr,
+            "[ERROR] Failed reading block \'%s\' of SINEX file %s "
+            "(traceback: %s)\n",
+            block, m_filename.c_str(), __func__);
+    return 1;
+  }
+
+  if (error) {
+    fprintf(stderr, "[ERROR] Failed parsing SINEX file %s (traceback: %s)\n",
+            m_filename.c_str(), __func__);
+    return 1;
+  }
+
+  return 0;
+}
+
+int dso::Sinex::parse_block_matrix_estimate(
+    sinex::MatrixType type,
+    const std::vector<sinex::SolutionEstimate> &estimates,
+    Eigen::MatrixXd &matrix, int num_threads) const noexcept {
+  sinex::MatrixTriangle triangle;
+  int n;
+  const char *block = matrix_estimate_block(type, triangle, n);
+  if (!block)
+    return 1;
+
+  /* for each matrix row (1-based), the first of the estimates with this
+   * index (or -1); the rest (if any) are chained via next */
+  const int k = estimates.size();
+  std::vector<int> first, next;
+  try {
+    first.assign(n + 1, -1);
+    next.assign(k, -1);
+    matrix.setZero(k, k);
+  } catch (std::exception &e) {
+    fprintf(stderr, "[ERROR] Failed allocating memory; %s (traceback: %s)\n",
+            e.what(), __func__);
+    return 1;
+  }
+  for (int a = k - 1; a >= 0; a--) {
+    const int idx = estimates[a].index();
+    if (idx < 1 || idx > n) {
+      fprintf(stderr,
+              "[ERROR] Invalid parameter index %d for %dx%d matrix of SINEX "
+              "file %s (traceback: %s)\n",
+              idx, n, n, m_filename.c_str(), __func__);
+      return 1;
+    }
+    next[a] = first[idx];
+    first[idx] = a;
+  }
+
+  std::vector<sinex::details::LineCursor> cursors;
+  if (goto_block_chunks(block, num_threads, cursors))
+    return 1;
+
+  /* each line holds distinct elements, hence chunks write to disjoint
+   * parts of the matrix; nothing to merge */
+  const bool lower = (triangle == sinex::MatrixTriangle::Lower);
+  auto parse_chunk = [&](std::size_t, sinex::details::LineCursor &cursor,
+                         long &) noexcept {
+    using L = sinex::details::layout::MatrixEstimate;
+    char line[sinex::max_sinex_chars];
+    double vals[3];
+    int row, col, num_vals;
+    while (cursor.getline(line)) {
+      if (*line == '*')
+        continue;
+      /* skip lines of other (valid) rows, decoding just the row index;
+       * anything else is left for the checks below to report */
+      const int len = std::strlen(line);
+      if (!sinex::details::field_number<L::Row>(line, len, row) &&
+          (row >= 1 && row <= n && first[row] < 0))
+        continue;
+      if (sinex::details::parse_matrix_line(line, row, col, vals,
+                                            num_vals) ||
+          check_matrix_line(line, row, col, num_vals, n, lower, block))
+        return 1;
+      for (int v = 0; v < num_vals; v++) {
+        const int c = col + v;
+        if (first[c] < 0)
+          continue;
+        for (int a = first[row]; a >= 0; a = next[a]) {
+          for (int b = first[c]; b >= 0; b = next[b]) {
+            matrix(a, b) = vals[v];
+            matrix(b, a) = vals[v];
+          }
+        }
+      }
+    }
+    return 0;
+  };
+  long dummy = 0;
+  int error = sinex::details::parse_chunks(cursors, dummy, parse_chunk,
+                                           [](long &, const long &) {});
+
+  /* check that the whole block was read */
+  if ((!error) && std::any_of(cursors.cbegin(), cursors.cend(),
+                              [](const sinex::details::LineCursor &c) {
+                                return !c.done();
+                              })) {
+    fprintf(stderr,
+            "[ERROR] Failed reading block \'%s\' of SINEX file %s "
+            "(traceback: %s)\n",
+            block, m_filename.c_str(), __func__);
+    return 1;
+  }
+
+  if (error) {
+    fprintf(stderr, "[ERROR] Failed parsing SINEX file %s (traceback: %s)\n",
+            m_filename.c_str(), __func__);
+    return 1;
+  }
+
+  return 0;
+}
+
+int dso::Sinex::parse_block_matrix_estimate(
+    sinex::MatrixType type, const char *tile_fn,
+    sinex::TiledSymmetricMatrix &matrix, int tile_size,
+    std::size_t ram_budget) const noexcept {
+  sinex::MatrixTriangle triangle;
+  int n;
+  const char *block = matrix_estimate_block(type, triangle, n);
+  if (!block)
+    return 1;
+
+  sinex::details::LineCursor cursor;
+  if (goto_block(block, cursor))
+    return 1;
+
+  /* Lines are written row by row, so the tiles of a row (lower triangle)
+   * or column (upper triangle) of tiles are completed one after the other.
+   * These are filled in memory (band) and written to the file once
+   * complete. Lines out of order, i.e. of rows before the current band, are
+   * written via the tile cache. The band is part of the memory budget; if
+   * it does not fit (along with at least one cached tile), all elements are
+   * written via the tile cache. */
+  const int t = tile_size;
+  const std::size_t tile_elements = (t > 0) ? (std::size_t)t * t : 0;
+  const std::size_t band_bytes =
+      (t > 0) ? ((std::size_t)n + t - 1) / t * tile_elements * sizeof(double)
+              : 0;
+  const bool use_band =
+      ram_budget >= band_bytes + tile_elements * sizeof(double);
+  if (matrix.create(tile_fn, n, tile_size,
+                    use_band ? ram_budget - band_bytes : ram_budget))
+    return 1;
+
+  const int nt = matrix.num_tiles();
+  std::vector<double> band;
+  try {
+    if (use_band)
+      band.assign(nt * tile_elements, 0e0);
+  } catch (std::exception &e) {
+    fprintf(stderr,
+            "[ERROR] Failed allocating %d tiles of %dx%d elements; %s "
+            "(traceback: %s)\n",
+            nt, t, t, e.what(), __func__);
+    matrix.close();
+    return 1;
+  }
+  const bool lower = (triangle == sinex::MatrixTriangle::Lower);
+  int current = -1;
+  auto write_band = [&]() noexcept {
+    int error = 0;
+    for (int K = 0; K < nt && current >= 0 && !error; K++) {
+      if (lower ? (K > current) : (K < current))
+        continue;
+      const double *p = band.data() + K * tile_elements;
+      error = lower ? matrix.write_tile(current, K, p)
+                    : matrix.write_tile(K, current, p);
+    }
+    std::fill(band.begin(), band.end(), 0e0);
+    return error;
+  };
+
+  char line[sinex::max_sinex_chars];
+  double vals[3];
+  int row, col, num_vals, error = 0;
+  while (!error && cursor.getline(line)) {
+    if (*line == '*')
+      continue;
+    error = sinex::details::parse_matrix_line(line, row, col, vals,
+                                              num_vals) ||
+            check_matrix_line(line, row, col, num_vals, n, lower, block);
+    if (use_band && !error && (row - 1) / t > current) {
+      error = write_band();
+      current = (row - 1) / t;
+    }
+    for (int k = 0; k < num_vals && !error; k++) {
+      if (!use_band || (row - 1) / t < current) {
+        error = matrix.set(row - 1, col - 1 + k, vals[k]);
+        continue;
+      }
+      /* element (r,c), r >= c, of the lower triangle */
+      const int r = lower ? (row - 1) : (col - 1 + k);
+      const int c = lower ? (col - 1 + k) : (row - 1);
+      double *p = band.data() + (lower ? c / t : r / t) * tile_elements;
+      p[(c % t) * t + r % t] = vals[k];
+      /* tiles on the diagonal hold both triangles */
+      if (r / t == c / t)
+        p[(r % t) * t + c % t] = vals[k];
+    }
+  }
+  if (!error)
+    error = write_band();
+
+  if ((!error) && (!cursor.done())) {
+    fprintf(stderr,
+            "[ERROR] Failed reading block \'%s\' of SINEX file %s "
+            "(traceback: %s)\n",
+            block, m_filename.c_str(), __func__);
+    error = 1;
+  }
+
+  if (error || matrix.flush()) {
+    fprintf(stderr, "[ERROR] Failed parsing SINEX file %s (traceback: %s)\n",
+            m_filename.c_str(), __func__);
+    matrix.close();
+    return 1;
+  }
+
+  /* release the band and re-open, leaving the whole budget to the cache */
+  if (use_band) {
+    std::vector<double>().swap(band);
+    matrix.close();
+    if (matrix.open(tile_fn, ram_budget, true)) {
+      fprintf(stderr,
+              "[ERROR] Failed re-opening tile file %s (traceback: %s)\n",
+              tile_fn, __func__);
+      return 1;
+    }
+  }
+
+  return 0;
+}
@@ -1,4 +1,5 @@
 #include "sinex.hpp"
+#include <array>
 #include <charconv>
 #include <cstdio>
 
@@ -6,17 +7,91 @@ using SecIntType = typename dso::nanoseconds::underlying_type;
 constexpr const SecIntType S2NS =
     dso::nanoseconds::template sec_factor<SecIntType>();
 
-int dso::sinex::parse_sinex_date(
-    const char *str, const dso::datetime<dso::nanoseconds> &tdefault,
-    dso::datetime<dso::nanoseconds> &t) noexcept {
+namespace {
+/* @brief Check if year (in the Gregorian calendar) is a leap year */
+constexpr bool is_leap(int year) noexcept {
+  return !(year % 4) && ((year % 100) || !(year % 400));
+}
+
+/* @brief MJD of January 1st of a (Gregorian, positive) year; computed off
+ * the number of days (including leap days) preceding it
+ */
+constexpr int mjd_of_jan1(int year) noexcept {
+  const int y = year - 1;
+  return 365 * y + y / 4 - y / 100 + y / 400 - 678575;
+}
+
+/* @brief A (two-digit) SINEX year resolved to a full year */
+constexpr int full_year(int yy) noexcept {
+  return yy + ((yy <= 50) ? 2000 : 1900);
+}
+
+/* @brief Cumulative-days table, i.e. MJD of January 1st and number of days
+ * in year, for each of the (two-digit) SINEX years YY = 00, ..., 99
+ */
+struct YearEntry {
+  int mjd_jan1;
+  int days;
+};
+constexpr std::array<YearEntry, 100> make_yy_table() noexcept {
+  std::array<YearEntry, 100> table{};
+  for (int yy = 0; yy < 100; yy++)
+    table[yy] = {mjd_of_jan1(full_year(yy)), 365 + is_leap(full_year(yy))};
+  return table;
+}
+constexpr std::array<YearEntry, 100> yy_table = make_yy_table();
+
+/* @brief Decode a fixed-width "YY:DDD:SSSSS" date string.
+ *
+ * @return 0 on success, anything else if str is not of the fixed format
+ *         (str is only read up to the first mismatch).
+ */
+inline int decode_fixed(const char *str, int &yy, int &doy,
+                        long &sec) noexcept {
+  const auto digit = [](char c) noexcept { return (unsigned)(c - '0') < 10u; };
+  if (!(digit(str[0]) && digit(str[1]) && str[2] == ':' && digit(str[3]) &&
+        digit(str[4]) && digit(str[5]) && str[6] == ':' && digit(str[7]) &&
+        digit(str[8]) && digit(str[9]) && digit(str[10]) && digit(str[11]) &&
+        !digit(str[12])))
+    return 1;
+  yy = (str[0] - '0') * 10 + (str[1] - '0');
+  doy = (str[3] - '0') * 100 + (str[4] - '0') * 10 + (str[5] - '0');
+  sec = (str[7] - '0') * 10000L + (str[8] - '0') * 1000L +
+        (str[9] - '0') * 100L + (str[10] - '0') * 10L + (str[11] - '0');
+  return 0;
+}
+
+/* @brief Resolve a datetime off the (SINEX) year, day of year and seconds
+ * of day; the MJD is computed arithmetically (no exceptions).
+ *
+ * @param[in] year MJD of January 1st and number of days of the (full) year
+ * @return Anything other than zero denotes an invalid date
+ */
+inline int resolve_date(int yy, YearEntry year, int doy, long sec,
+                        const dso::datetime<dso::nanoseconds> &tdefault,
+                        dso::datetime<dso::nanoseconds> &t) noexcept {
+  if (!yy && !doy && !sec) {
+    t = tdefault;
+    return 0;
+  }
+  if ((doy < 1) || (doy > year.days))
+    return 1;
+  t = dso::datetime<dso::nanoseconds>(
+      dso::modified_julian_day(year.mjd_jan1 + doy - 1),
+      dso::nanoseconds(sec * S2NS));
+  return 0;
+}
+
+/* @brief Resolve a date string of any (non-fixed) width, e.g. with missing
+ * leading zeros.
+ */
+int parse_sinex_date_generic(const char *str,
+                             const dso::datetime<dso::nanoseconds> &tdefault,
+                             dso::datetime<dso::nanoseconds> &t) noexcept {
   int yr, doy;
   long sec = 0;
   int error = 0;
 
-  /* skip leading whitespaces */
-  while (*str && *str == ' ')
-    ++str;
-
   /* end of string */
   const char *end = str + std::strlen(str);
 
@@ -38,21 +113,60 @@ int dso::sinex::parse_sinex_date(
     return error;
   }
 
-  t = tdefault;
-  if (!((yr == 0) && (doy == 0) && (sec == 0))) {
-    yr += (yr <= 50) ? 2000 : 1900;
-    /* resolve datetime */
-    try {
-      t = dso::datetime<dso::nanoseconds>(dso::year(yr), dso::day_of_year(doy),
-                                          dso::nanoseconds(sec * S2NS));
-    } catch (std::exception &e) {
+  const bool valid_year = (yr >= 0) && (yr < 8000);
+  if (!valid_year ||
+      resolve_date(yr,
+                   {mjd_of_jan1(full_year(yr)), 365 + is_leap(full_year(yr))},
+                   doy, sec, tdefault, t)) {
+    fprintf(stderr,
+            "[ERROR] Failed to resolve SINEX date from string \"%s\" "
+            "(traceback: %s)\n",
+            str, __func__);
+    return 1;
+  }
+
+  return 0;
+}
+} /* anonymous namespace */
+
+int dso::sinex::parse_sinex_date(
+    const char *str, const dso::datetime<dso::nanoseconds> &tdefault,
+    dso::datetime<dso::nanoseconds> &t) noexcept {
+  /* skip leading whitespaces */
+  while (*str && *str == ' ')
+    ++str;
+
+  /* fast path: fixed-width YY:DDD:SSSSS */
+  int yy, doy;
+  long sec;
+  if (!decode_fixed(str, yy, doy, sec)) {
+    if (resolve_date(yy, yy_table[yy], doy, sec, tdefault, t)) {
       fprintf(stderr,
-              "[ERROR] Failed to resolve SINEX date from string \"%s\" "
+              "[ERROR] Failed to resolve SINEX date from string \"%.12s\" "
               "(traceback: %s)\n",
               str, __func__);
       return 1;
     }
+    return 0;
   }
 
-  return 0;
+  return parse_sinex_date_generic(str, tdefault, t);
+}
+
+int dso::sinex::parse_sinex_dates(
+    int n, const char *const dtstrs[],
+    const dso::datetime<dso::nanoseconds> *const tdefaults[],
+    dso::datetime<dso::nanoseconds> *const t[]) noexcept {
+  /* decode and resolve all (fixed-width) date strings in one sweep; any
+   * string not of the fixed format (or invalid) is handed to
+   * parse_sinex_date */
+  int error = 0;
+  for (int i = 0; i < n; i++) {
+    int yy, doy;
+    long sec;
+    if (decode_fixed(dtstrs[i], yy, doy, sec) ||
+        resolve_date(yy, yy_table[yy], doy, sec, *tdefaults[i], *t[i]))
+      error += (parse_sinex_date(dtstrs[i], *tdefaults[i], *t[i]) != 0);
+  }
+  return error;
 }
@@ -1,108 +1,122 @@
 #include "sinex.hpp"
+#include "core/sinex_fields.hpp"
+#include "core/sinex_lines.hpp"
+#include "core/sinex_site_key.hpp"
 #include <cstdlib>
 
-constexpr int max_lines_in_block = 10000;
+int dso::sinex::details::parse_site_antenna_line(
+    const char *line, dso::sinex::SiteAntenna &ant,
+    const dso::datetime<dso::nanoseconds> &sinex_data_start,
+    const dso::datetime<dso::nanoseconds> &sinex_data_stop) noexcept {
+  using L = layout::SiteAntenna;
+  const int len = std::strlen(line);
+  int error = 0;
+
+  field_chars<L::SiteCode>(line, len, ant.site_code());
+  field_chars<L::PointCode>(line, len, ant.point_code());
+  field_chars<L::SolnId>(line, len, ant.soln_id());
+  if (field_obscode<L::ObsCode>(line, len, ant.m_obscode)) {
+    fprintf(stderr,
+            "[ERROR] Erronuous SINEX Observation Code \'%c\' (traceback: %s)\n",
+            (len > L::ObsCode::offset) ? line[L::ObsCode::offset] : ' ',
+            __func__);
+    ++error;
+  }
+
+  error += field_dates<L::DataStart, L::DataEnd>(
+      line, len, {&sinex_data_start, &sinex_data_stop},
+      {&ant.m_start, &ant.m_stop});
+  if (error) {
+    fprintf(stderr,
+            "[ERROR] Failed to parse date from line: \"%s\" (traceback: %s)\n",
+            line, __func__);
+  }
+
+  field_chars_ltrim<L::AntType>(line, len, ant.ant_type());
+  field_chars_ltrim<L::AntSerial>(line, len, ant.ant_serial());
+
+  return error;
+}
 
 int dso::Sinex::parse_block_site_antenna(
     const std::vector<sinex::SiteId> &site_vec,
     std::vector<sinex::SiteAntenna> &out_vec,
     const dso::datetime<dso::nanoseconds> from,
-    const dso::datetime<dso::nanoseconds> to) noexcept {
+    const dso::datetime<dso::nanoseconds> to,
+    const sinex::QueryPredicate &query,
+    sinex::QueryStats *stats) const noexcept {
 
-  using sinex::details::ltrim_cpy;
+  using L = sinex::details::layout::SiteAntenna;
 
   /* clear the vector */
   if (!out_vec.empty())
     out_vec.clear();
 
+  /* sites of interest, keyed by SITE CODE and POINT CODE */
+  const auto sites = sinex::details::SiteKeyMap::of_sites(site_vec);
+
+  /* validity interval and antenna interval overlap */
+  auto overlaps = [&](const sinex::SiteAntenna &a) {
+    return dso::intervals_overlap<
+        dso::nanoseconds,
+        dso::datetime_ranges::OverlapComparissonType::AllowEdgesOverlap>(
+        a.m_start, a.m_stop, from, to);
+  };
+
+  /* select off the records of a preloaded block, if any */
+  if (const auto *records = preloaded_block<sinex::SiteAntenna>(query)) {
+    for (const auto &a : *records)
+      if (sites.contains(
+              sinex::details::site_key(a.site_code(), a.point_code())) &&
+          overlaps(a))
+        out_vec.push_back(a);
+    return 0;
+  }
+
   /* go to SITE/ANTENNA block */
-  if (goto_block("SITE/ANTENNA"))
+  sinex::details::LineCursor cursor;
+  if (goto_block("SITE/ANTENNA", cursor))
     return 1;
 
-  /* next line to be read should be '+SITE/ANTENNA' */
+  /* cursor is placed at the first line of the block payload */
   char line[sinex::max_sinex_chars];
-  m_stream.getline(line, sinex::max_sinex_chars);
-  if (!m_stream.good() || std::strcmp(line, "+SITE/ANTENNA")) {
-    fprintf(stderr,
-            "[ERROR] Expected \"%s\" line, found: \"%s\" (traceback: %s)\n",
-            "+SITE/ANTENNA", line, __func__);
-    return 1;
-  }
 
   /* read in SiteAntenna's untill end of block */
-  std::size_t ln_count = 0;
+  sinex::SiteAntenna ant;
+  sinex::QueryStats qstats;
   int error = 0;
-  while (m_stream.getline(line, sinex::max_sinex_chars) &&
-         (++ln_count < max_lines_in_block) && (!error)) {
-    /* end of block; return */
-    if (!std::strncmp(line, "-SITE/ANTENNA", 14))
-      break;
+  while (cursor.getline(line) && (!error)) {
     if (*line != '*') { /* non-comment line */
 
-      /* first check site name */
-      auto it = std::find_if(
-          site_vec.cbegin(), site_vec.cend(), [&](const sinex::SiteId &site) {
-            return !std::strncmp(site.site_code(), line + 1,
-                                 sinex::SITE_CODE_CHAR_SIZE) &&
-                   !std::strncmp(site.point_code(), line + 6,
-                                 sinex::POINT_CODE_CHAR_SIZE);
-          });
-
-      /* the station is in the list */
-      if (it != site_vec.cend()) {
-
-        /* second, resolve time interval */
-        dso::datetime<dso::nanoseconds> intrv_start, intrv_stop;
-        error += sinex::parse_sinex_date(line + 16, m_data_start, intrv_start);
-        error += sinex::parse_sinex_date(line + 29, m_data_stop, intrv_stop);
-        if (error) {
-          fprintf(stderr,
-                  "[ERROR] Failed to parse date from line: \"%s\" (traceback: "
-                  "%s)\n",
-                  line, __func__);
-        }
+      /* first check site name (the station is in the list) and the query
+       * on the raw line */
+      if (!sites.contains(sinex::details::site_key(line + 1, line + 6)) ||
+          !query.accepts<L>(line, m_data_start, m_data_stop)) {
+        ++qstats.lines_skipped;
+      } else {
+        ++qstats.lines_decoded;
+
+        /* parse the record line */
+        error += sinex::details::parse_site_antenna_line(
+            line, ant, m_data_start, m_data_stop);
 
         /* if validity interval and antenna interval overlap */
-        if (dso::intervals_overlap<
-                dso::nanoseconds, dso::datetime_ranges::OverlapComparissonType::
-                                      AllowEdgesOverlap>(
-                intrv_start, intrv_stop, from, to)) {
-
-          out_vec.emplace_back(sinex::SiteAntenna{});
-          auto vecit = out_vec.end() - 1;
-
-          // ltrim_cpy(vecit->site_code(), line + 1, 4);
-          // ltrim_cpy(vecit->point_code(), line + 6, 2);
-          // ltrim_cpy(vecit->soln_id(), line + 9, 4);
-          std::memcpy(vecit->site_code(), line + 1, sinex::SITE_CODE_CHAR_SIZE);
-          std::memcpy(vecit->point_code(), line + 6,
-                      sinex::POINT_CODE_CHAR_SIZE);
-          std::memcpy(vecit->soln_id(), line + 9, sinex::SOLN_ID_CHAR_SIZE);
-          try {
-            vecit->m_obscode =
-                dso::sinex::char_to_SinexObservationCode(line[14]);
-          } catch (std::exception &) {
-            fprintf(
-                stderr,
-                "[ERROR] Erronuous SINEX Observation Code \'%c\' (traceback: "
-                "%s)\n",
-                line[14], __func__);
-            ++error;
-          }
-
-          ltrim_cpy(vecit->ant_type(), line + 42, 20);
-          ltrim_cpy(vecit->ant_serial(), line + 63, 5);
+        if (!error && overlaps(ant)) {
+          out_vec.push_back(ant);
         } /* intervals overlap */
       } /* station in the list */
     } /* non-comment line */
   } /* end parsing block */
 
-  /* check for infinite loop */
-  if (ln_count >= max_lines_in_block) {
+  if (stats)
+    *stats += qstats;
+
+  /* check that the whole block was read */
+  if ((!error) && (!cursor.done())) {
     fprintf(stderr,
-            "[ERROR] Read in %8zu lines and no \'%s\' line found .... smthng "
-            "is wrong! (traceback :%s)\n",
-            ln_count, "-SITE/RECEIVER", __func__);
+            "[ERROR] Failed reading block \'%s\' of SINEX file %s "
+            "(traceback: %s)\n",
+            "SITE/ANTENNA", m_filename.c_str(), __func__);
     return 1;
   }
 
@@ -1,45 +1,39 @@
 #include "sinex.hpp"
-#include <charconv>
+#include "core/sinex_fields.hpp"
+#include "core/sinex_lines.hpp"
+#include "core/sinex_site_key.hpp"
 #include <cstdlib>
 
-namespace {
-
-const char *skip_ws(const char *line) noexcept {
-  while (*line && *line == ' ')
-    ++line;
-  return line;
-}
-
 /* Example Line:
  * Code PT SOLN T Data_start__ Data_end____ AXE Up______ North___ East____
  * ADEA  A    1 D 93:003:00000 98:084:11545 UNE   0.5100   0.0000   0.0000
  */
-int parse_eccentricity_line(
+int dso::sinex::details::parse_site_eccentricity_line(
     const char *line, dso::sinex::SiteEccentricity &ecc,
     const dso::datetime<dso::nanoseconds> &sinex_data_start,
     const dso::datetime<dso::nanoseconds> &sinex_data_stop) noexcept {
+  using L = layout::SiteEccentricity;
+
   /* don't even bother for sizes < 70 */
   const int sz = std::strlen(line);
   if (sz < 70)
     return 1;
 
   /* copy Site/Point Codes, Solution ID and Observation Code */
-  std::memcpy(ecc.site_code(), line + 1, 4 * sizeof(char));
-  std::memcpy(ecc.point_code(), line + 6, 2 * sizeof(char));
-  std::memcpy(ecc.soln_id(), line + 9, 4 * sizeof(char));
-  try {
-    ecc.m_obscode = dso::sinex::char_to_SinexObservationCode(line[14]);
-  } catch (std::exception &) {
+  field_chars<L::SiteCode>(line, sz, ecc.site_code());
+  field_chars<L::PointCode>(line, sz, ecc.point_code());
+  field_chars<L::SolnId>(line, sz, ecc.soln_id());
+  if (field_obscode<L::ObsCode>(line, sz, ecc.m_obscode)) {
     fprintf(stderr,
             "[ERROR] Erronuous SINEX Observation Code \'%c\' (traceback: %s)\n",
-            line[19], __func__);
+            line[L::ObsCode::offset], __func__);
     return 1;
   }
 
   /* start/end dates */
   int error = 0;
-  error += dso::sinex::parse_sinex_date(line + 16, sinex_data_start, ecc.start);
-  error += dso::sinex::parse_sinex_date(line + 29, sinex_data_stop, ecc.stop);
+  error += field_dates<L::DataStart, L::DataEnd>(
+      line, sz, {&sinex_data_start, &sinex_data_stop}, {&ecc.start, &ecc.stop});
   if (error) {
     fprintf(stderr,
             "[ERROR] Failed to parse date from line: \"%s\" (traceback: %s)\n",
@@ -47,27 +41,24 @@ int parse_eccentricity_line(
   }
 
   /* ref system */
-  std::memcpy(ecc.ref_system(), line + 42, 3 * sizeof(char));
+  field_chars<L::RefSystem>(line, sz, ecc.ref_system());
 
   /* parse eccentricities */
-  const char *start = line + 42 + 3;
+  const char *pos = line;
   error = 0;
-  for (int i = 0; i < 3; i++) {
-    auto fc = std::from_chars(skip_ws(start), line + sz, ecc.eccentricity(i));
-    error += (fc.ec != std::errc{});
-    start = fc.ptr;
-  }
+  error += field_number<L::Ecc1>(line, sz, ecc.eccentricity(0), pos);
+  error += field_number<L::Ecc2>(line, sz, ecc.eccentricity(1), pos);
+  error += field_number<L::Ecc3>(line, sz, ecc.eccentricity(2), pos);
 
   return error;
 }
 
-} /* unnamed namespace */
-
 int dso::Sinex::parse_block_site_eccentricity(
     const std::vector<sinex::SiteId> &site_vec,
     const dso::datetime<dso::nanoseconds> &t,
     std::vector<sinex::SiteEccentricity> &out_vec, bool allow_extrapolation,
-    dso::FractionalSeconds fsec) noexcept {
+    dso::FractionalSeconds fsec, const sinex::QueryPredicate &query,
+    sinex::QueryStats *stats) const noexcept {
 
   /* clear the vector, and allocate */
   if (!out_vec.empty())
@@ -79,34 +70,58 @@ int dso::Sinex::parse_block_site_eccentricity(
   if (t > m_data_stop && (!allow_extrapolation))
     return 0;
 
+  /* sites of interest, keyed by SITE CODE and POINT CODE */
+  const auto sites = sinex::details::SiteKeyMap::of_sites(site_vec);
+
+  /* collect a record if the station is in the list (aka included in
+   * site_vec) and its validity interval fits */
+  auto collect = [&](const sinex::SiteEccentricity &secc) {
+    if (t >= secc.start &&
+        ((t < secc.stop) ||
+         ((t >= secc.stop) &&
+          (m_data_stop.diff<dso::DateTimeDifferenceType::FractionalSeconds>(
+               secc.stop) < fsec) &&
+          (allow_extrapolation)))) {
+      if (sites.contains(
+              sinex::details::site_key(secc.site_code(), secc.point_code())))
+        out_vec.push_back(secc);
+    }
+  };
+
+  /* select off the records of a preloaded block, if any */
+  if (const auto *records =
+          preloaded_block<sinex::SiteEccentricity>(query)) {
+    for (const auto &secc : *records)
+      collect(secc);
+    return 0;
+  }
+
   /* go to SOLUTION/ECCENTRICITY block */
-  if (goto_block("SITE/ECCENTRICITY"))
+  sinex::details::LineCursor cursor;
+  if (goto_block("SITE/ECCENTRICITY", cursor))
     return 1;
 
-  /* next line to be read should be '+SITE/ECCENTRICITY' */
+  /* cursor is placed at the first line of the block payload */
   char line[sinex::max_sinex_chars];
-  m_stream.getline(line, sinex::max_sinex_chars);
-  if (!m_stream.good() || std::strcmp(line, "+SITE/ECCENTRICITY")) {
-    fprintf(stderr,
-            "[ERROR] Expected \"%s\" line, found: \"%s\" (traceback: %s)\n",
-            "+SITE/ECCENTRICITY", line, __func__);
-    return 1;
-  }
 
   /* read in Eccentricities until end of block */
-  std::size_t ln_count = 0;
-  constexpr const int max_lines_in_block = 5000;
   int error = 0;
   dso::sinex::SiteEccentricity secc;
-  while (m_stream.getline(line, sinex::max_sinex_chars) &&
-         (++ln_count < max_lines_in_block) && (!error)) {
-    /* end of block; break */
-    if (!std::strncmp(line, "-SITE/ECCENTRICITY", 22))
-      break;
+  sinex::QueryStats qstats;
+  while (cursor.getline(line) && (!error)) {
     if (*line != '*') { /* non-comment line */
 
+      /* check the query on the raw line */
+      if (!query.accepts<sinex::details::layout::SiteEccentricity>(
+              line, m_data_start, m_data_stop)) {
+        ++qstats.lines_skipped;
+        continue;
+      }
+      ++qstats.lines_decoded;
+
       /* parse the record line */
-      if (parse_eccentricity_line(line, secc, m_data_start, m_data_stop)) {
+      if (sinex::details::parse_site_eccentricity_line(line, secc, m_data_start,
+                                                       m_data_stop)) {
         fprintf(
             stderr,
             "[ERROR] Failed parsing eccentricity line: [%s] (traceback: %s)\n",
@@ -114,37 +129,20 @@ int dso::Sinex::parse_block_site_eccentricity(
         ++error;
       }
 
-      /* check eccentricity validity interval */
-      if (t >= secc.start &&
-          ((t < secc.stop) ||
-           ((t >= secc.stop) &&
-            (m_data_stop.diff<dso::DateTimeDifferenceType::FractionalSeconds>(
-                 secc.stop) < fsec) &&
-            (allow_extrapolation)))) {
-
-        /* check if the site is of interest, aka included in site_vec */
-        auto it = std::find_if(
-            site_vec.cbegin(), site_vec.cend(), [&](const sinex::SiteId &site) {
-              return !std::strncmp(site.site_code(), secc.site_code(), 4) &&
-                     !std::strncmp(site.point_code(), secc.point_code(), 2);
-            });
-
-        /* the station is in the list and the time interval fits ... */
-        if (it != site_vec.cend()) {
-          out_vec.push_back(secc);
-        }
-      } /* validity interval ok */
+      /* check eccentricity validity interval and site */
+      collect(secc);
     } /* non-comment line */
-
-    ++ln_count;
   } /* end of block */
 
-  /* check for infinite loop */
-  if (ln_count >= max_lines_in_block) {
+  if (stats)
+    *stats += qstats;
+
+  /* check that the whole block was read */
+  if ((!error) && (!cursor.done())) {
     fprintf(stderr,
-            "[ERROR] Read in %8zu lines and no \'%s\' line found .... smthng "
-            "is wrong! (traceback: %s)\n",
-            ln_count, "-SITE/ECCENTRICITY", __func__);
+            "[ERROR] Failed reading block \'%s\' of SINEX file %s "
+            "(traceback: %s)\n",
+            "SITE/ECCENTRICITY", m_filename.c_str(), __func__);
     return 1;
   }
 
@@ -1,52 +1,39 @@
 #include "geodesy/units.hpp"
 #include "sinex.hpp"
-#include <charconv>
+#include "core/sinex_fields.hpp"
+#include "core/sinex_lines.hpp"
+#include "core/sinex_site_key.hpp"
 #include <cstdio>
 #include <cstdlib>
 #include <stdexcept>
 
-using dso::sinex::details::SiteMatchPolicyType;
-
-namespace {
-constexpr int max_lines_in_block = 10000;
-inline const char *skipws(const char *line) noexcept {
-  while (*line && *line == ' ')
-    ++line;
-  return line;
-}
-
-int parse_site_id_line(const char *line, dso::sinex::SiteId &sid) noexcept {
+int dso::sinex::details::parse_site_id_line(const char *line,
+                                            dso::sinex::SiteId &sid) noexcept {
+  using L = layout::SiteId;
+  const int len = std::strlen(line);
   int error = 0;
-  std::memcpy(sid.site_code(), line + 1, 4);
-  std::memcpy(sid.point_code(), line + 6, 2);
-  std::memcpy(sid.domes(), line + 9, 9);
-  try {
-    sid.obscode() = dso::sinex::char_to_SinexObservationCode(line[19]);
-  } catch (std::exception &) {
+  field_chars<L::SiteCode>(line, len, sid.site_code());
+  field_chars<L::PointCode>(line, len, sid.point_code());
+  field_chars<L::Domes>(line, len, sid.domes());
+  if (field_obscode<L::ObsCode>(line, len, sid.obscode())) {
     fprintf(stderr,
             "[ERROR] Erronuous SINEX Observation Code \'%c\' (traceback: %s)\n",
-            line[19], __func__);
+            (len > L::ObsCode::offset) ? line[L::ObsCode::offset] : ' ',
+            __func__);
     ++error;
   }
-  std::memcpy(sid.description(), line + 21, 22);
+  field_chars<L::Description>(line, len, sid.description());
 
   int deg, mm;
   double sec;
 
   /* parse DDD MM SSSS.S */
-  const char *end = line + std::strlen(line);
-  const char *start = line + 44;
+  const char *pos = line;
 
   /* Longitude */
-  auto cv = std::from_chars(skipws(start), end, deg);
-  error += (cv.ec != std::errc());
-  start = cv.ptr;
-  cv = std::from_chars(skipws(start), end, mm);
-  error += (cv.ec != std::errc());
-  start = cv.ptr;
-  cv = std::from_chars(skipws(start), end, sec);
-  error += (cv.ec != std::errc());
-  start = cv.ptr;
+  error += field_number<L::LonDeg>(line, len, deg, pos);
+  error += field_number<L::LonMin>(line, len, mm, pos);
+  error += field_number<L::LonSec>(line, len, sec, pos);
   if (error > 1) {
     fprintf(stderr, "[ERROR] Failed parsing site longitude (traceback: %s)\n",
             __func__);
@@ -55,15 +42,9 @@ int parse_site_id_line(const char *line, dso::sinex::SiteId &sid) noexcept {
   sid.longitude() = dso::hexd2rad(deg, mm, sec, deg);
 
   /* Latitude */
-  cv = std::from_chars(skipws(start), end, deg);
-  error += (cv.ec != std::errc());
-  start = cv.ptr;
-  cv = std::from_chars(skipws(start), end, mm);
-  error += (cv.ec != std::errc());
-  start = cv.ptr;
-  cv = std::from_chars(skipws(start), end, sec);
-  error += (cv.ec != std::errc());
-  start = cv.ptr;
+  error += field_number<L::LatDeg>(line, len, deg, pos);
+  error += field_number<L::LatMin>(line, len, mm, pos);
+  error += field_number<L::LatSec>(line, len, sec, pos);
   if (error > 1) {
     fprintf(stderr, "[ERROR] Failed parsing site latitude (traceback: %s)\n",
             __func__);
@@ -72,8 +53,7 @@ int parse_site_id_line(const char *line, dso::sinex::SiteId &sid) noexcept {
   sid.latitude() = dso::hexd2rad(deg, mm, sec, deg);
 
   /* height */
-  cv = std::from_chars(skipws(start), end, sid.height());
-  error += (cv.ec != std::errc());
+  error += field_number<L::Height>(line, len, sid.height(), pos);
   if (error > 1) {
     fprintf(stderr, "[ERROR] Failed parsing site height (traceback: %s)\n",
             __func__);
@@ -82,43 +62,52 @@ int parse_site_id_line(const char *line, dso::sinex::SiteId &sid) noexcept {
 
   return 0;
 }
-} /* unnamed namespace */
 
 int dso::Sinex::parse_block_site_id(
     const std::vector<const char *> &sites, bool use_domes,
-    std::vector<sinex::SiteId> &site_vec) noexcept {
+    std::vector<sinex::SiteId> &site_vec, const sinex::QueryPredicate &query,
+    sinex::QueryStats *stats) const noexcept {
   /* clear the vector, alocate storage */
   if (!site_vec.empty())
     site_vec.clear();
   if (site_vec.capacity() < sites.size())
     site_vec.reserve(sites.size());
 
+  /* sites of interest */
+  const sinex::details::SiteIdFilter filter(sites, use_domes);
+
+  /* select off the records of a preloaded block, if any */
+  if (const auto *records = preloaded_block<sinex::SiteId>(query)) {
+    for (const auto &site : *records)
+      if (filter.matches(site))
+        site_vec.push_back(site);
+    return 0;
+  }
+
   /* go to SITE/ID block */
-  if (goto_block("SITE/ID"))
+  sinex::details::LineCursor cursor;
+  if (goto_block("SITE/ID", cursor))
     return 1;
 
-  /* next line to be read should be '+SITE/ID' */
+  /* cursor is placed at the first line of the block payload */
   char line[sinex::max_sinex_chars];
-  m_stream.getline(line, sinex::max_sinex_chars);
-  if (!m_stream.good() || std::strcmp(line, "+SITE/ID")) {
-    fprintf(stderr,
-            "[ERROR] Expected \"%s\" line, found: \"%s\" (traceback: %s)\n",
-            "+SITE/ID", line, __func__);
-    return 1;
-  }
 
   /* read in SiteId's untill end of block */
-  std::size_t ln_count = 0;
   sinex::SiteId site;
+  sinex::QueryStats qstats;
   int error = 0;
-  while (m_stream.getline(line, sinex::max_sinex_chars) &&
-         (++ln_count < max_lines_in_block) && (!error)) {
-    /* end of block encountered */
-    if (!std::strncmp(line, "-SITE/ID", 8))
-      break;
+  while (cursor.getline(line) && (!error)) {
     if (*line != '*') { /* non-comment line */
+      /* check the query on the raw line */
+      if (!query.accepts<sinex::details::layout::SiteId>(
+              line, m_data_start, m_data_stop)) {
+        ++qstats.lines_skipped;
+        continue;
+      }
+      ++qstats.lines_decoded;
+
       /* try to parse line */
-      if (parse_site_id_line(line, site)) {
+      if (sinex::details::parse_site_id_line(line, site)) {
         fprintf(stderr,
                 "[ERROR] Failed to parse SITE/ID line from SINEX file %s "
                 "(traceback: %s)\n",
@@ -127,35 +116,22 @@ int dso::Sinex::parse_block_site_id(
                 __func__);
         ++error;
       }
-      /* compare parse site to input ones */
-      bool store_siteid = false;
-      {
-        for (const auto &ptr : sites) {
-          const bool same =
-              (use_domes)
-                  ? (site.issame<SiteMatchPolicyType::USEDOMES>(ptr))
-                  : (site.issame<SiteMatchPolicyType::IGNOREDOMES>(ptr));
-          if (same) {
-            store_siteid = true;
-            break;
-          }
-        }
-      }
-      /* push_back if needed (if site is empty store anyway) */
-      if (store_siteid || (!sites.size()))
+      /* compare parse site to input ones; push_back if needed (if sites is
+       * empty store anyway) */
+      if (filter.matches(site))
         site_vec.push_back(site);
     } /* non-comment line */
-
-    /* augment line count */
-    ++ln_count;
   }
 
-  /* check number of lines read */
-  if (ln_count >= max_lines_in_block) {
+  if (stats)
+    *stats += qstats;
+
+  /* check that the whole block was read */
+  if ((!error) && (!cursor.done())) {
     fprintf(stderr,
-            "[ERROR] Read in %8zu lines and no \'%s\' line found .... smthng "
-            "is wrong! (traceback: %s)\n",
-            ln_count, "-SITE/ID", __func__);
+            "[ERROR] Failed reading block \'%s\' of SINEX file %s "
+            "(traceback: %s)\n",
+            "SITE/ID", m_filename.c_str(), __func__);
     return 1;
   }
 
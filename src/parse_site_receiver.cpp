@@ -1,74 +1,94 @@
 #include "sinex.hpp"
+#include "core/sinex_fields.hpp"
+#include "core/sinex_lines.hpp"
 #include <cstdlib>
 
-constexpr int max_lines_in_block = 10000;
+int dso::sinex::details::parse_site_receiver_line(
+    const char *line, dso::sinex::SiteReceiver &rec,
+    const dso::datetime<dso::nanoseconds> &sinex_data_start,
+    const dso::datetime<dso::nanoseconds> &sinex_data_stop) noexcept {
+  using L = layout::SiteReceiver;
+  const int len = std::strlen(line);
+  int error = 0;
+
+  field_chars<L::SiteCode>(line, len, rec.site_code());
+  field_chars<L::PointCode>(line, len, rec.point_code());
+  field_chars<L::SolnId>(line, len, rec.soln_id());
+  if (field_obscode<L::ObsCode>(line, len, rec.m_obscode)) {
+    fprintf(stderr,
+            "[ERROR] Erronuous SINEX Observation Code \'%c\' (traceback: %s)\n",
+            (len > L::ObsCode::offset) ? line[L::ObsCode::offset] : ' ',
+            __func__);
+    ++error;
+  }
+
+  error += field_dates<L::DataStart, L::DataEnd>(
+      line, len, {&sinex_data_start, &sinex_data_stop},
+      {&rec.m_start, &rec.m_stop});
+  if (error) {
+    fprintf(stderr,
+            "[ERROR] Failed to parse date from line: \"%s\" (traceback: %s)\n",
+            line, __func__);
+  }
+
+  field_chars<L::RecType>(line, len, rec.rec_type());
+  field_chars<L::RecSerial>(line, len, rec.rec_serial());
+  field_chars<L::RecFirmware>(line, len, rec.rec_firmware());
+
+  return error;
+}
 
 int dso::Sinex::parse_block_site_receiver(
-    std::vector<sinex::SiteReceiver> &site_vec) noexcept {
+    std::vector<sinex::SiteReceiver> &site_vec,
+    const sinex::QueryPredicate &query,
+    sinex::QueryStats *stats) const noexcept {
+  using L = sinex::details::layout::SiteReceiver;
+
   /* clear the vector */
   if (!site_vec.empty())
     site_vec.clear();
 
+  /* copy the records of a preloaded block, if any */
+  if (const auto *records = preloaded_block<sinex::SiteReceiver>(query)) {
+    site_vec = *records;
+    return 0;
+  }
+
   /* go to SITE/RECEIVER block */
-  if (goto_block("SITE/RECEIVER"))
+  sinex::details::LineCursor cursor;
+  if (goto_block("SITE/RECEIVER", cursor))
     return 1;
 
-  /* next line to be read should be '+SITE/RECEIVER' */
+  /* cursor is placed at the first line of the block payload */
   char line[sinex::max_sinex_chars];
-  m_stream.getline(line, sinex::max_sinex_chars);
-  if (!m_stream.good() || std::strcmp(line, "+SITE/RECEIVER")) {
-    fprintf(stderr,
-            "[ERROR] Expected \"%s\" line, found: \"%s\" (traceback: %s)\n",
-            "+SITE/RECEIVER", line, __func__);
-    return 1;
-  }
 
   /* read in SiteReceiver's untill end of block */
-  std::size_t ln_count = 0;
+  sinex::QueryStats qstats;
   int error = 0;
-  while (m_stream.getline(line, sinex::max_sinex_chars) &&
-         (++ln_count < max_lines_in_block) && (!error)) {
-    /* end of block; return */
-    if (!std::strncmp(line, "-SITE/RECEIVER", 14))
-      break;
+  while (cursor.getline(line) && (!error)) {
     if (*line != '*') { /* non-comment line */
-      site_vec.emplace_back(sinex::SiteReceiver{});
-      auto vecit = site_vec.end() - 1;
-
-      std::memcpy(vecit->site_code(), line + 1, 4);
-      std::memcpy(vecit->point_code(), line + 6, 2);
-      std::memcpy(vecit->soln_id(), line + 9, 4);
-      try {
-        vecit->m_obscode = dso::sinex::char_to_SinexObservationCode(line[14]);
-      } catch (std::exception &) {
-        fprintf(
-            stderr,
-            "[ERROR] Erronuous SINEX Observation Code \'%c\' (traceback: %s)\n",
-            line[19], __func__);
-        ++error;
+      /* check the query on the raw line */
+      if (!query.accepts<L>(line, m_data_start, m_data_stop)) {
+        ++qstats.lines_skipped;
+        continue;
       }
+      ++qstats.lines_decoded;
 
-      error += sinex::parse_sinex_date(line + 16, m_data_start, vecit->m_start);
-      error += sinex::parse_sinex_date(line + 29, m_data_stop, vecit->m_stop);
-      if (error) {
-        fprintf(
-            stderr,
-            "[ERROR] Failed to parse date from line: \"%s\" (traceback: %s)\n",
-            line, __func__);
-      }
-
-      std::memcpy(vecit->rec_type(), line + 42, 20);
-      std::memcpy(vecit->rec_serial(), line + 63, 5);
-      std::memcpy(vecit->rec_firmware(), line + 69, 11);
+      site_vec.emplace_back(sinex::SiteReceiver{});
+      error += sinex::details::parse_site_receiver_line(
+          line, site_vec.back(), m_data_start, m_data_stop);
     }
   } /* end block (parsing SITE/RECEIVER lines) */
 
-  /* check for internal looping ... */
-  if (ln_count >= max_lines_in_block) {
+  if (stats)
+    *stats += qstats;
+
+  /* check that the whole block was read */
+  if ((!error) && (!cursor.done())) {
     fprintf(stderr,
-            "[ERROR] Read in %8zu lines and no \'%s\' line found .... smthng "
-            "is wrong! (traceback: %s)\n",
-            ln_count, "-SITE/RECEIVER", __func__);
+            "[ERROR] Failed reading block \'%s\' of SINEX file %s "
+            "(traceback: %s)\n",
+            "SITE/RECEIVER", m_filename.c_str(), __func__);
     return 1;
   }
 
@@ -1,31 +1,30 @@
 #include "sinex.hpp"
-
-namespace {
-constexpr int max_lines_in_block = 10000;
-
-int parse_epoch_line(const char *line,
-                     const dso::datetime<dso::nanoseconds> &sinex_data_start,
-                     const dso::datetime<dso::nanoseconds> &sinex_data_end,
-                     dso::sinex::SolutionEpoch &entry) noexcept {
+#include "core/sinex_fields.hpp"
+#include "core/sinex_lines.hpp"
+#include "core/sinex_site_key.hpp"
+
+int dso::sinex::details::parse_epoch_line(
+    const char *line, const dso::datetime<dso::nanoseconds> &sinex_data_start,
+    const dso::datetime<dso::nanoseconds> &sinex_data_end,
+    dso::sinex::SolutionEpoch &entry) noexcept {
+  using L = layout::SolutionEpoch;
+  const int len = std::strlen(line);
   int error = 0;
-  std::memcpy(entry.site_code(), line + 1, dso::sinex::SITE_CODE_CHAR_SIZE);
-  std::memcpy(entry.point_code(), line + 6, dso::sinex::POINT_CODE_CHAR_SIZE);
-  std::memcpy(entry.soln_id(), line + 9, dso::sinex::SOLN_ID_CHAR_SIZE);
-  try {
-    entry.m_obscode = dso::sinex::char_to_SinexObservationCode(line[14]);
-  } catch (std::exception &) {
+  field_chars<L::SiteCode>(line, len, entry.site_code());
+  field_chars<L::PointCode>(line, len, entry.point_code());
+  field_chars<L::SolnId>(line, len, entry.soln_id());
+  if (field_obscode<L::ObsCode>(line, len, entry.m_obscode)) {
     fprintf(stderr,
             "[ERROR] Erronuous SINEX Observation Code \'%c\' (traceback: %s)\n",
-            line[14], __func__);
+            (len > L::ObsCode::offset) ? line[L::ObsCode::offset] : ' ',
+            __func__);
     ++error;
   }
 
-  error +=
-      dso::sinex::parse_sinex_date(line + 16, sinex_data_start, entry.m_start);
-  error +=
-      dso::sinex::parse_sinex_date(line + 29, sinex_data_end, entry.m_stop);
-  error += dso::sinex::parse_sinex_date(
-      line + 42, dso::datetime<dso::nanoseconds>::min(), entry.m_mean);
+  const auto mean_default = dso::datetime<dso::nanoseconds>::min();
+  error += field_dates<L::DataStart, L::DataEnd, L::MeanEpoch>(
+      line, len, {&sinex_data_start, &sinex_data_end, &mean_default},
+      {&entry.m_start, &entry.m_stop, &entry.m_mean});
   if (error) {
     fprintf(stderr,
             "[ERROR] Failed to parse date from line: \"%s\" (traceback: %s)\n",
@@ -34,52 +33,82 @@ int parse_epoch_line(const char *line,
 
   return error;
 }
-} /* anonymous namespace */
+
+int dso::sinex::details::keep_closest_epoch(
+    const dso::datetime<dso::nanoseconds> &t,
+    const dso::sinex::SolutionEpoch &entry,
+    dso::sinex::SolutionEpoch &kept) noexcept {
+  if (t >= entry.m_start && t < entry.m_stop) {
+    kept = entry;
+  } else if (t >= kept.m_start && t < kept.m_stop) {
+    ;
+  } else if (t < kept.m_start && t < entry.m_start) {
+    if (entry.m_start < kept.m_start) {
+      kept = entry;
+    }
+  } else if (t >= kept.m_stop && t >= entry.m_stop) {
+    if (entry.m_stop > kept.m_stop) {
+      kept = entry;
+    }
+  } else {
+    fprintf(stderr,
+            "[ERROR] Cannot decide one valid SOLUTION/EPOCH interval for site "
+            "%s (traceback: %s)\n",
+            entry.site_code(), __func__);
+    return 1;
+  }
+  return 0;
+}
 
 int dso::Sinex::parse_solution_epoch_noextrapolate(
     const std::vector<sinex::SiteId> &site_vec,
     const dso::datetime<dso::nanoseconds> &t,
-    std::vector<dso::sinex::SolutionEpoch> &out_vec) noexcept {
+    std::vector<dso::sinex::SolutionEpoch> &out_vec,
+    const sinex::QueryPredicate &query,
+    sinex::QueryStats *stats) const noexcept {
   /* clear the vector; allocate storage */
   if (!out_vec.empty())
     out_vec.clear();
   out_vec.reserve(site_vec.size());
 
+  /* sites of interest, keyed by SITE CODE and POINT CODE */
+  const auto sites = sinex::details::SiteKeyMap::of_sites(site_vec);
+
+  /* select off the records of a preloaded block, if any */
+  if (const auto *records =
+          preloaded_block<sinex::SolutionEpoch>(query)) {
+    for (const auto &entry : *records)
+      if (sites.contains(sinex::details::site_key(entry.site_code(),
+                                                  entry.point_code())) &&
+          (t >= entry.m_start && t < entry.m_stop))
+        out_vec.push_back(entry);
+    return 0;
+  }
+
   /* go to SOLUTION/EPOCHS block */
-  if (goto_block("SOLUTION/EPOCHS"))
+  sinex::details::LineCursor cursor;
+  if (goto_block("SOLUTION/EPOCHS", cursor))
     return 1;
 
-  /* next line to be read should be '+'SOLUTION/EPOCHS */
+  /* cursor is placed at the first line of the block payload */
   char line[sinex::max_sinex_chars];
-  m_stream.getline(line, sinex::max_sinex_chars);
-  if (!m_stream.good() || std::strcmp(line, "+SOLUTION/EPOCHS")) {
-    fprintf(stderr,
-            "[ERROR] Expected \"%s\" line, found: \"%s\" (traceback: %s)\n",
-            "+SOLUTION/EPOCHS", line, __func__);
-    return 1;
-  }
 
   /* read in SOLUTION/EPOCHS records untill end of block */
-  std::size_t ln_count = 0;
   int error = 0;
   dso::sinex::SolutionEpoch entry;
-  while (m_stream.getline(line, sinex::max_sinex_chars) &&
-         (++ln_count < max_lines_in_block) && (!error)) {
-    /* end of block; return */
-    if (!std::strncmp(line, "-SOLUTION/EPOCHS", 16))
-      break;
+  sinex::QueryStats qstats;
+  while (cursor.getline(line) && (!error)) {
     if (*line != '*') { /* non-comment line */
-      /* check if the site is of interest, aka included in site_vec */
-      auto it = std::find_if(
-          site_vec.cbegin(), site_vec.cend(), [&](const sinex::SiteId &site) {
-            return !std::strncmp(site.site_code(), line + 1,
-                                 dso::sinex::SITE_CODE_CHAR_SIZE) &&
-                   !std::strncmp(site.point_code(), line + 6,
-                                 dso::sinex::POINT_CODE_CHAR_SIZE);
-          });
-      /* site is to be collected; parse line  */
-      if (it != site_vec.cend()) {
-        error = parse_epoch_line(line, m_data_start, m_data_stop, entry);
+      /* check if the site is to be collected (aka included in site_vec),
+       * and the query on the raw line */
+      if (!sites.contains(sinex::details::site_key(line + 1, line + 6)) ||
+          !query.accepts<sinex::details::layout::SolutionEpoch>(
+              line, m_data_start, m_data_stop)) {
+        ++qstats.lines_skipped;
+      } else {
+        ++qstats.lines_decoded;
+        error = sinex::details::parse_epoch_line(line, m_data_start,
+                                                 m_data_stop, entry);
         /* check interval of solution */
         if ((t >= entry.m_start && t < entry.m_stop) && (!error)) {
           /* append epoch solution */
@@ -89,12 +118,15 @@ int dso::Sinex::parse_solution_epoch_noextrapolate(
     } /* non-comment line */
   } /* end parsing block */
 
-  /* check for infinite loop */
-  if (ln_count >= max_lines_in_block) {
+  if (stats)
+    *stats += qstats;
+
+  /* check that the whole block was read */
+  if ((!error) && (!cursor.done())) {
     fprintf(stderr,
-            "[ERROR] Read in %8zu lines and no \'%s\' line found .... smthng "
-            "is wrong! (traceback :%s)\n",
-            ln_count, "-SOLUTION/EPOCHS", __func__);
+            "[ERROR] Failed reading block \'%s\' of SINEX file %s "
+            "(traceback: %s)\n",
+            "SOLUTION/EPOCHS", m_filename.c_str(), __func__);
     return 1;
   }
 
@@ -115,89 +147,85 @@ int dso::Sinex::parse_solution_epoch_noextrapolate(
 int dso::Sinex::parse_solution_epoch_extrapolate(
     const std::vector<sinex::SiteId> &site_vec,
     const dso::datetime<dso::nanoseconds> &t,
-    std::vector<dso::sinex::SolutionEpoch> &out_vec) noexcept {
+    std::vector<dso::sinex::SolutionEpoch> &out_vec,
+    const sinex::QueryPredicate &query,
+    sinex::QueryStats *stats) const noexcept {
   /* clear the vector; allocate storage */
   if (!out_vec.empty())
     out_vec.clear();
   out_vec.reserve(site_vec.size());
 
+  /* sites of interest, keyed by SITE CODE and POINT CODE */
+  const auto sites = sinex::details::SiteKeyMap::of_sites(site_vec);
+  /* solutions collected (indexes into out_vec), keyed likewise */
+  sinex::details::SiteKeyMap collected(site_vec.size());
+
+  /* keep the record of a site with the interval closest to t */
+  auto collect = [&](const sinex::SolutionEpoch &entry) {
+    /* do we have a solution for the site already? */
+    const auto key =
+        sinex::details::site_key(entry.site_code(), entry.point_code());
+    const int idx = collected.find(key);
+    if (idx < 0) {
+      /* no solution for the site yet; append this one */
+      collected.insert(key, (int)out_vec.size());
+      out_vec.push_back(entry);
+      return 0;
+    }
+    /* we already have a solution for this site; check intervals */
+    return sinex::details::keep_closest_epoch(t, entry, out_vec[idx]);
+  };
+
+  /* select off the records of a preloaded block, if any */
+  if (const auto *records =
+          preloaded_block<sinex::SolutionEpoch>(query)) {
+    for (const auto &entry : *records)
+      if (sites.contains(sinex::details::site_key(entry.site_code(),
+                                                  entry.point_code())) &&
+          collect(entry))
+        return 1;
+    return 0;
+  }
+
   /* go to SOLUTION/EPOCHS block */
-  if (goto_block("SOLUTION/EPOCHS"))
+  sinex::details::LineCursor cursor;
+  if (goto_block("SOLUTION/EPOCHS", cursor))
     return 1;
 
-  /* next line to be read should be '+'SOLUTION/EPOCHS */
+  /* cursor is placed at the first line of the block payload */
   char line[sinex::max_sinex_chars];
-  m_stream.getline(line, sinex::max_sinex_chars);
-  if (!m_stream.good() || std::strcmp(line, "+SOLUTION/EPOCHS")) {
-    fprintf(stderr,
-            "[ERROR] Expected \"%s\" line, found: \"%s\" (traceback: %s)\n",
-            "+SOLUTION/EPOCHS", line, __func__);
-    return 1;
-  }
 
   /* read in SOLUTION/EPOCHS records untill end of block */
-  std::size_t ln_count = 0;
   int error = 0;
   dso::sinex::SolutionEpoch entry;
-  while (m_stream.getline(line, sinex::max_sinex_chars) &&
-         (++ln_count < max_lines_in_block) && (!error)) {
-    /* end of block; return */
-    if (!std::strncmp(line, "-SOLUTION/EPOCHS", 16))
-      break;
+  sinex::QueryStats qstats;
+  while (cursor.getline(line) && (!error)) {
     if (*line != '*') { /* non-comment line */
-      /* check if the site is of interest, aka included in site_vec */
-      auto it = std::find_if(
-          site_vec.cbegin(), site_vec.cend(), [&](const sinex::SiteId &site) {
-            return !std::strncmp(site.site_code(), line + 1,
-                                 dso::sinex::SITE_CODE_CHAR_SIZE) &&
-                   !std::strncmp(site.point_code(), line + 6,
-                                 dso::sinex::POINT_CODE_CHAR_SIZE);
-          });
-      /* site is to be collected; parse line  */
-      if (it != site_vec.cend()) {
-        error = parse_epoch_line(line, m_data_start, m_data_stop, entry);
-        if (!error) {
-          /* do we have a solution for the site already? */
-          auto sit = std::find_if(out_vec.begin(), out_vec.end(),
-                                  [&](const sinex::SolutionEpoch &se) {
-                                    return se.match_site(entry);
-                                  });
-          if (sit == out_vec.end()) {
-            /* no solution for the site yet; append this one */
-            out_vec.push_back(entry);
-          } else {
-            /* we already have a solution for this site; check intervals */
-            if (t >= entry.m_start && t < entry.m_stop) {
-              *sit = entry;
-            } else if (t >= sit->m_start && t < sit->m_stop) {
-              ;
-            } else if (t < sit->m_start && t < entry.m_start) {
-              if (entry.m_start < sit->m_start) {
-                *sit = entry;
-              }
-            } else if (t >= sit->m_stop && t >= entry.m_stop) {
-              if (entry.m_stop > sit->m_stop) {
-                *sit = entry;
-              }
-            } else {
-              error = 1;
-              fprintf(stderr,
-                      "[ERROR] Cannot decide one valid SOLUTION/EPOCH interval "
-                      "for site %s (traceback: %s)\n",
-                      entry.site_code(), __func__);
-            }
-          }
-        } /* error while parsing */
+      /* check if the site is to be collected (aka included in site_vec),
+       * and the query on the raw line */
+      if (!sites.contains(sinex::details::site_key(line + 1, line + 6)) ||
+          !query.accepts<sinex::details::layout::SolutionEpoch>(
+              line, m_data_start, m_data_stop)) {
+        ++qstats.lines_skipped;
+      } else {
+        ++qstats.lines_decoded;
+        error = sinex::details::parse_epoch_line(line, m_data_start,
+                                                 m_data_stop, entry);
+        if (!error)
+          error = collect(entry);
       } /* site is in site_vec */
     } /* non-comment line */
   } /* end parsing block */
 
-  /* check for infinite loop */
-  if (ln_count >= max_lines_in_block) {
+  if (stats)
+    *stats += qstats;
+
+  /* check that the whole block was read */
+  if ((!error) && (!cursor.done())) {
     fprintf(stderr,
-            "[ERROR] Read in %8zu lines and no \'%s\' line found .... smthng "
-            "is wrong! (traceback :%s)\n",
-            ln_count, "-SOLUTION/EPOCHS", __func__);
+            "[ERROR] Failed reading block \'%s\' of SINEX file %s "
+            "(traceback: %s)\n",
+            "SOLUTION/EPOCHS", m_filename.c_str(), __func__);
     return 1;
   }
 
@@ -1,4 +1,8 @@
 #include "sinex.hpp"
+#include "core/sinex_fields.hpp"
+#include "core/sinex_lines.hpp"
+#include "core/sinex_site_key.hpp"
+#include <algorithm>
 #include <charconv>
 #include <cstdlib>
 #include <stdexcept>
@@ -6,31 +10,30 @@
 using dso::sinex::details::ParameterMatchPolicyType;
 
 namespace {
-constexpr int max_lines_in_block = 10000;
 const char *skipws(const char *line) noexcept {
   while (*line && *line == ' ')
     ++line;
   return line;
 }
+} /* anonymous namespace */
 
-int parse_solution_estimate_line(
+int dso::sinex::details::parse_solution_estimate_line(
     const char *line, dso::sinex::SolutionEstimate &est,
     const dso::datetime<dso::nanoseconds> &sinex_data_start) noexcept {
 
-  using dso::sinex::details::ltrim_cpy;
-
+  using L = layout::SolutionEstimate;
+  const int len = std::strlen(line);
   int error = 0, j;
-  const char *end = line + std::strlen(line);
 
   /* parameter index */
-  auto cv = std::from_chars(skipws(line), end, est.index());
-  error += (cv.ec != std::errc{});
+  error += field_number<L::Index>(line, len, est.index());
 
   /* parameter type */
   int index;
-  if (dso::sinex::parameter_type_exists<ParameterMatchPolicyType::NonStrict>(
-          skipws(line + 7), index)) {
-    est.set_parameter_type(dso::sinex::parameter_types[index]);
+  if ((len > L::ParameterType::offset) &&
+      dso::sinex::parameter_type_exists<ParameterMatchPolicyType::NonStrict>(
+          skipws(line + L::ParameterType::offset), index)) {
+    est.set_parameter_type_id(index);
   } else {
     fprintf(stderr,
             "[ERROR] Failed matching parameter type in SINEX line \"%s\" "
@@ -39,14 +42,11 @@ int parse_solution_estimate_line(
     ++error;
   }
 
-  std::memcpy(est.site_code(), line + 14, dso::sinex::SITE_CODE_CHAR_SIZE);
-  std::memcpy(est.point_code(), line + 19, dso::sinex::POINT_CODE_CHAR_SIZE);
-  std::memcpy(est.soln_id(), line + 22, dso::sinex::SOLN_ID_CHAR_SIZE);
-  // ltrim_cpy(est.site_code(), line + 14, 4);
-  // ltrim_cpy(est.point_code(), line + 19, 2);
-  // ltrim_cpy(est.soln_id(), line + 22, 4);
+  field_chars<L::SiteCode>(line, len, est.site_code());
+  field_chars<L::PointCode>(line, len, est.point_code());
+  field_chars<L::SolnId>(line, len, est.soln_id());
 
-  j = dso::sinex::parse_sinex_date(line + 27, sinex_data_start, est.epoch());
+  j = field_date<L::RefEpoch>(line, len, sinex_data_start, est.epoch());
   if (j) {
     fprintf(stderr,
             "[ERROR] Failed parsing date in SINEX line \"%s\" "
@@ -55,10 +55,8 @@ int parse_solution_estimate_line(
   }
   error += j;
 
-  std::memcpy(est.units(), line + 40, 4);
-  try {
-    est.constraint() = dso::sinex::char_to_SinexConstraintCode(line[45]);
-  } catch (std::exception &) {
+  field_chars<L::Units>(line, len, est.units());
+  if (field_constraint<L::Constraint>(line, len, est.constraint())) {
     fprintf(stderr,
             "[ERROR] Failed to match SINEX constraint code in line \"%s\" "
             "(traceback: %s)\n",
@@ -66,11 +64,8 @@ int parse_solution_estimate_line(
     ++error;
   }
 
-  j = 0;
-  cv = std::from_chars(skipws(line + 47), end, est.estimate());
-  j += (cv.ec != std::errc{});
-  cv = std::from_chars(skipws(line + 69), end, est.std_deviation());
-  j += (cv.ec != std::errc{});
+  j = field_number<L::Estimate>(line, len, est.estimate());
+  j += field_number<L::StdDeviation>(line, len, est.std_deviation());
   if (j) {
     fprintf(stderr,
             "[ERROR] Failed parsing parameter/std. deviation values from SINEX "
@@ -80,11 +75,12 @@ int parse_solution_estimate_line(
 
   return (error + j);
 }
-} /* anonymous namespace */
 
 int dso::Sinex::parse_block_solution_estimate(
     const std::vector<sinex::SiteId> &site_vec,
-    std::vector<sinex::SolutionEstimate> &est_vec) noexcept {
+    std::vector<sinex::SolutionEstimate> &est_vec,
+    const sinex::QueryPredicate &query, sinex::QueryStats *stats,
+    int num_threads) const noexcept {
 
   /* clear the vector; allocate storage */
   if (!est_vec.empty())
@@ -92,57 +88,76 @@ int dso::Sinex::parse_block_solution_estimate(
   if (est_vec.capacity() < site_vec.size() * 6)
     est_vec.reserve(site_vec.size() * 6);
 
-  /* go to SOLUTION/ESTIMATE block */
-  if (goto_block("SOLUTION/ESTIMATE"))
-    return 1;
+  /* sites of interest, keyed by SITE CODE and POINT CODE */
+  const auto sites = sinex::details::SiteKeyMap::of_sites(site_vec);
 
-  /* next line to be read should be '+SOLUTION/ESTIMATE' */
-  char line[sinex::max_sinex_chars];
-  m_stream.getline(line, sinex::max_sinex_chars);
-  if (!m_stream.good() || std::strcmp(line, "+SOLUTION/ESTIMATE")) {
-    fprintf(stderr,
-            "[ERROR] Expected \"%s\" line, found: \"%s\" (traceback: %s)\n",
-            "+SOLUTION/ESTIMATE", line, __func__);
-    return 1;
+  /* select off the records of a preloaded block, if any */
+  if (const auto *records =
+          preloaded_block<sinex::SolutionEstimate>(query)) {
+    for (const auto &est : *records)
+      if (sites.contains(
+              sinex::details::site_key(est.site_code(), est.point_code())))
+        est_vec.push_back(est);
+    return 0;
   }
 
-  /* read in SolutionEstimates's untill end of block */
-  std::size_t ln_count = 0;
-  int error = 0;
-  while (m_stream.getline(line, sinex::max_sinex_chars) &&
-         (++ln_count < max_lines_in_block) && (!error)) {
-    /* end of block encountered; break */
-    if (!std::strncmp(line, "-SOLUTION/ESTIMATE", 14))
-      break;
-
-    if (*line != '*') { /* non-comment line */
-
-      /* check if the site is of interest, aka included in site_vec */
-      auto it = std::find_if(
-          site_vec.cbegin(), site_vec.cend(), [&](const sinex::SiteId &site) {
-            return !std::strncmp(site.site_code(), line + 14,
-                                 sinex::SITE_CODE_CHAR_SIZE) &&
-                   !std::strncmp(site.point_code(), line + 19,
-                                 sinex::POINT_CODE_CHAR_SIZE);
-          });
-
-      if (it != site_vec.cend()) { /* parse and collect estimate */
-
-        est_vec.emplace_back(sinex::SolutionEstimate{});
-        auto vecit = est_vec.end() - 1;
-
-        error = parse_solution_estimate_line(line, *vecit, m_data_start);
-      }
-    } /* non-comment line */
-    ++ln_count;
-  } /* end of block */
+  /* split the SOLUTION/ESTIMATE block in chunks (one, unless parsing in
+   * parallel) */
+  std::vector<sinex::details::LineCursor> cursors;
+  if (goto_block_chunks("SOLUTION/ESTIMATE", num_threads, cursors))
+    return 1;
 
-  /* check for infinite loop */
-  if (ln_count >= max_lines_in_block) {
+  /* read in SolutionEstimates's untill end of chunk */
+  std::vector<sinex::QueryStats> qstats(cursors.size());
+  auto parse_chunk = [&](std::size_t chunk, sinex::details::LineCursor &cursor,
+                         std::vector<sinex::SolutionEstimate> &out) noexcept {
+    char line[sinex::max_sinex_chars];
+    int error = 0;
+    try {
+      while (cursor.getline(line) && (!error)) {
+        if (*line != '*') { /* non-comment line */
+
+          /* check if the site is of interest, aka included in site_vec, and
+           * the query on the raw line */
+          if (!sites.contains(
+                  sinex::details::site_key(line + 14, line + 19)) ||
+              !query.accepts<sinex::details::layout::SolutionEstimate>(
+                  line, m_data_start, m_data_stop)) {
+            ++qstats[chunk].lines_skipped;
+          } else {
+            ++qstats[chunk].lines_decoded;
+            /* parse and collect estimate */
+            out.emplace_back(sinex::SolutionEstimate{});
+            error = sinex::details::parse_solution_estimate_line(
+                line, out.back(), m_data_start);
+          }
+        } /* non-comment line */
+      } /* end of chunk */
+    } catch (std::exception &) {
+      ++error;
+    }
+    return error;
+  };
+  int error = sinex::details::parse_chunks(
+      cursors, est_vec, parse_chunk,
+      [](std::vector<sinex::SolutionEstimate> &vec,
+         const std::vector<sinex::SolutionEstimate> &part) {
+        vec.insert(vec.end(), part.begin(), part.end());
+      });
+
+  if (stats)
+    for (const auto &qs : qstats)
+      *stats += qs;
+
+  /* check that the whole block was read */
+  if ((!error) && std::any_of(cursors.cbegin(), cursors.cend(),
+                              [](const sinex::details::LineCursor &c) {
+                                return !c.done();
+                              })) {
     fprintf(stderr,
-            "[ERROR] Read in %8zu lines and no \'%s\' line found .... smthng "
-            "is wrong! (traceback: %s)\n",
-            ln_count, "-SOLUTION/ESTIMATE", __func__);
+            "[ERROR] Failed reading block \'%s\' of SINEX file %s "
+            "(traceback: %s)\n",
+            "SOLUTION/ESTIMATE", m_filename.c_str(), __func__);
     return 1;
   }
 
@@ -159,13 +174,16 @@ int dso::Sinex::parse_block_solution_estimate(
 int dso::Sinex::parse_block_solution_estimate(
     const std::vector<sinex::SiteId> &site_vec,
     const dso::datetime<dso::nanoseconds> &t, bool allow_extrapolation,
-    std::vector<sinex::SolutionEstimate> &est_vec) noexcept {
+    std::vector<sinex::SolutionEstimate> &est_vec,
+    const sinex::QueryPredicate &query,
+    sinex::QueryStats *stats) const noexcept {
 
   /* first off, get the solution id's (SOLUTION/EPOCH block) vaild for this
    * date and the given sites
    */
   std::vector<dso::sinex::SolutionEpoch> solns;
-  if (this->parse_solution_epoch(site_vec, t, allow_extrapolation, solns)) {
+  if (this->parse_solution_epoch(site_vec, t, allow_extrapolation, solns,
+                                 query, stats)) {
     fprintf(stderr,
             "[ERROR] Failed to get solution ids; cannot parse "
             "SOLUTION/ESTIMATE (traceback: %s)\n",
@@ -179,62 +197,181 @@ int dso::Sinex::parse_block_solution_estimate(
   if (est_vec.capacity() < site_vec.size() * 6)
     est_vec.reserve(site_vec.size() * 6);
 
+  /* solutions of interest, keyed by SITE CODE and POINT CODE */
+  const auto solns_map = sinex::details::SiteKeyMap::of_sites(solns);
+
+  /* select off the records of a preloaded block, if any; keep the ones of
+   * sites for which we have identified a SOLUTION/EPOCH */
+  if (const auto *records =
+          preloaded_block<sinex::SolutionEstimate>(query)) {
+    for (const auto &e : *records)
+      if (solns_map.find_if(
+              sinex::details::site_key(e.site_code(), e.point_code()),
+              [&](int i) {
+                return !std::strncmp(solns[i].soln_id(), e.soln_id(),
+                                     sinex::SOLN_ID_CHAR_SIZE);
+              }) >= 0)
+        est_vec.push_back(e);
+    return 0;
+  }
+
   /* go to SOLUTION/ESTIMATE block */
-  if (goto_block("SOLUTION/ESTIMATE"))
+  sinex::details::LineCursor cursor;
+  if (goto_block("SOLUTION/ESTIMATE", cursor))
     return 1;
 
-  /* next line to be read should be '+SOLUTION/ESTIMATE' */
+  /* cursor is placed at the first line of the block payload */
   char line[sinex::max_sinex_chars];
-  m_stream.getline(line, sinex::max_sinex_chars);
-  if (!m_stream.good() || std::strcmp(line, "+SOLUTION/ESTIMATE")) {
-    fprintf(stderr,
-            "[ERROR] Expected \"%s\" line, found: \"%s\" (traceback: %s)\n",
-            "+SOLUTION/ESTIMATE", line, __func__);
-    return 1;
-  }
 
   /* read in SOLUTION/ESTIMATES untill end of block */
-  std::size_t ln_count = 0;
   int error = 0;
   dso::sinex::SolutionEstimate est;
-  while (m_stream.getline(line, sinex::max_sinex_chars) &&
-         (++ln_count < max_lines_in_block) && (!error)) {
-    /* end of block encountered; break */
-    if (!std::strncmp(line, "-SOLUTION/ESTIMATE", 14))
-      break;
-
+  sinex::QueryStats qstats;
+  while (cursor.getline(line) && (!error)) {
     if (*line != '*') { /* non-comment line */
 
       /* check if the site is of interest, and we have identified a
-       * SOLUTION/EPOCH for it (aka included in solns)
+       * SOLUTION/EPOCH for it (aka included in solns), and the query on the
+       * raw line
        */
-      auto it = std::find_if(
-          solns.cbegin(), solns.cend(), [&](const sinex::SolutionEpoch &site) {
-            return ((!std::strncmp(site.site_code(), line + 14,
-                                   sinex::SITE_CODE_CHAR_SIZE) &&
-                     !std::strncmp(site.point_code(), line + 19,
-                                   sinex::POINT_CODE_CHAR_SIZE)) &&
-                    !std::strncmp(site.soln_id(), line + 22,
-                                  sinex::SOLN_ID_CHAR_SIZE));
+      const int idx = solns_map.find_if(
+          sinex::details::site_key(line + 14, line + 19), [&](int i) {
+            return !std::strncmp(solns[i].soln_id(), line + 22,
+                                 sinex::SOLN_ID_CHAR_SIZE);
           });
 
-      if (it != solns.cend()) {
+      if (idx < 0 || !query.accepts<sinex::details::layout::SolutionEstimate>(
+                         line, m_data_start, m_data_stop)) {
+        ++qstats.lines_skipped;
+      } else {
+        ++qstats.lines_decoded;
         /* parse estimate record line*/
-        error = parse_solution_estimate_line(line, est, m_data_start);
+        error = sinex::details::parse_solution_estimate_line(line, est,
+                                                             m_data_start);
         /* since site is of interest and the solution id matches, append */
         est_vec.push_back(est);
       }
 
     } /* non-comment line */
-    ++ln_count;
   } /* end of block */
 
-  /* check for infinite loop */
-  if (ln_count >= max_lines_in_block) {
+  if (stats)
+    *stats += qstats;
+
+  /* check that the whole block was read */
+  if ((!error) && (!cursor.done())) {
+    fprintf(stderr,
+            "[ERROR] Failed reading block \'%s\' of SINEX file %s "
+            "(traceback: %s)\n",
+            "SOLUTION/ESTIMATE", m_filename.c_str(), __func__);
+    return 1;
+  }
+
+  /* check for parsing error */
+  if (error) {
+    fprintf(stderr, "[ERROR] Failed paring SINEX file %s (traceback: %s)\n",
+            m_filename.c_str(), __func__);
+    return 1;
+  }
+
+  return 0;
+}
+
+int dso::Sinex::parse_block_solution_estimate(
+    sinex::SolutionEstimateColumns &columns,
+    const sinex::QueryPredicate &query, sinex::QueryStats *stats,
+    int num_threads) const noexcept {
+
+  /* columns off the records of a preloaded block, if any */
+  if (const auto *records =
+          preloaded_block<sinex::SolutionEstimate>(query)) {
+    columns.clear();
+    try {
+      columns.reserve(records->size());
+      for (const auto &est : *records)
+        columns.push_back(est);
+    } catch (std::exception &) {
+      fprintf(stderr,
+              "[ERROR] Failed allocating memory for SOLUTION/ESTIMATE "
+              "records (traceback: %s)\n",
+              __func__);
+      return 1;
+    }
+    return 0;
+  }
+
+  /* split the SOLUTION/ESTIMATE block in chunks (one, unless parsing in
+   * parallel) */
+  std::vector<sinex::details::LineCursor> cursors;
+  if (goto_block_chunks("SOLUTION/ESTIMATE", num_threads, cursors))
+    return 1;
+
+  /* clear the columns; allocate storage (the number of block lines is an
+   * upper bound for the number of records) */
+  columns.clear();
+  try {
+    columns.reserve(find_block("SOLUTION/ESTIMATE")->mlines);
+  } catch (std::exception &) {
     fprintf(stderr,
-            "[ERROR] Read in %8zu lines and no \'%s\' line found .... smthng "
-            "is wrong! (traceback: %s)\n",
-            ln_count, "-SOLUTION/ESTIMATE", __func__);
+            "[ERROR] Failed allocating memory for SOLUTION/ESTIMATE records "
+            "(traceback: %s)\n",
+            __func__);
+    return 1;
+  }
+
+  /* read in all SOLUTION/ESTIMATEs untill end of chunk */
+  std::vector<sinex::QueryStats> qstats(cursors.size());
+  auto parse_chunk = [&](std::size_t chunk, sinex::details::LineCursor &cursor,
+                         sinex::SolutionEstimateColumns &out) noexcept {
+    char line[sinex::max_sinex_chars];
+    dso::sinex::SolutionEstimate est;
+    int error = 0;
+    try {
+      while (cursor.getline(line) && (!error)) {
+        if (*line != '*') { /* non-comment line */
+          /* check the query on the raw line */
+          if (!query.accepts<sinex::details::layout::SolutionEstimate>(
+                  line, m_data_start, m_data_stop)) {
+            ++qstats[chunk].lines_skipped;
+            continue;
+          }
+          ++qstats[chunk].lines_decoded;
+          error = sinex::details::parse_solution_estimate_line(line, est,
+                                                               m_data_start);
+          if (!error)
+            out.push_back(est);
+          else
+            fprintf(stderr, "[ERROR] Line was \"%s\" (traceback: %s)\n",
+                    line, __func__);
+        } /* non-comment line */
+      } /* end of chunk */
+    } catch (std::exception &) {
+      fprintf(stderr,
+              "[ERROR] Failed to store SOLUTION/ESTIMATE record (traceback: "
+              "%s)\n",
+              __func__);
+      ++error;
+    }
+    return error;
+  };
+  int error = sinex::details::parse_chunks(
+      cursors, columns, parse_chunk,
+      [](sinex::SolutionEstimateColumns &cols,
+         const sinex::SolutionEstimateColumns &part) { cols.append(part); });
+
+  if (stats)
+    for (const auto &qs : qstats)
+      *stats += qs;
+
+  /* check that the whole block was read */
+  if ((!error) && std::any_of(cursors.cbegin(), cursors.cend(),
+                              [](const sinex::details::LineCursor &c) {
+                                return !c.done();
+                              })) {
+    fprintf(stderr,
+            "[ERROR] Failed reading block \'%s\' of SINEX file %s "
+            "(traceback: %s)\n",
+            "SOLUTION/ESTIMATE", m_filename.c_str(), __func__);
     return 1;
   }
 
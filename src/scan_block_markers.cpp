@@ -0,0 +1,190 @@
+#include "core/sinex_io.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <thread>
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+using dso::sinex::details::BlockMarker;
+
+namespace {
+/* @brief Min number of bytes per chunk when scanning in parallel */
+constexpr std::size_t min_chunk_bytes = 4 * 1024 * 1024;
+/* @brief Max number of threads to use for scanning */
+constexpr int max_scan_threads = 16;
+
+inline bool is_marker_char(char c) noexcept {
+  return (c == '+') || (c == '-') || (c == '%');
+}
+
+/* @brief Collect markers from a (32 or 16)-byte block, given the bitmasks of
+ * newline characters (nl) and marker characters (sym) in the block.
+ *
+ * A marker is found at bit i if the byte at i is a marker character and the
+ * byte at i-1 is a newline; prev_nl signals that the byte preceding the
+ * block is a newline.
+ */
+inline void collect_from_masks(const char *begin, const char *block,
+                               std::uint32_t nl, std::uint32_t sym,
+                               bool prev_nl, long nls,
+                               std::vector<BlockMarker> &markers) {
+  std::uint32_t hits = ((nl << 1) | (prev_nl ? 1u : 0u)) & sym;
+  while (hits) {
+    const int bit = __builtin_ctz(hits);
+    const std::uint32_t below = (bit) ? (nl & ((1u << bit) - 1u)) : 0u;
+    markers.push_back(BlockMarker{(std::size_t)(block + bit - begin),
+                                  nls + __builtin_popcount(below),
+                                  block[bit]});
+    hits &= hits - 1u;
+  }
+}
+
+/* @brief Scan the chunk [cb, ce) of a buffer starting at begin.
+ *
+ * Markers are collected with line numbers relative to the chunk start (i.e.
+ * the number of newlines in [cb, marker)); nl_count is set to the number of
+ * newline characters in the chunk.
+ */
+void scan_chunk(const char *begin, const char *cb, const char *ce,
+                std::vector<BlockMarker> &markers, long &nl_count) {
+  long nls = 0;
+  bool prev_nl = (cb == begin) || (cb[-1] == '\n');
+  const char *p = cb;
+
+#if defined(__AVX2__)
+  const __m256i vnl = _mm256_set1_epi8('\n');
+  const __m256i vplus = _mm256_set1_epi8('+');
+  const __m256i vminus = _mm256_set1_epi8('-');
+  const __m256i vprcnt = _mm256_set1_epi8('%');
+  for (; p + 32 <= ce; p += 32) {
+    const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+    const std::uint32_t nl =
+        (std::uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, vnl));
+    const std::uint32_t sym = (std::uint32_t)_mm256_movemask_epi8(
+        _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, vplus),
+                                        _mm256_cmpeq_epi8(v, vminus)),
+                        _mm256_cmpeq_epi8(v, vprcnt)));
+    if (sym)
+      collect_from_masks(begin, p, nl, sym, prev_nl, nls, markers);
+    nls += __builtin_popcount(nl);
+    prev_nl = (nl >> 31) & 1u;
+  }
+#elif defined(__SSE2__)
+  const __m128i vnl = _mm_set1_epi8('\n');
+  const __m128i vplus = _mm_set1_epi8('+');
+  const __m128i vminus = _mm_set1_epi8('-');
+  const __m128i vprcnt = _mm_set1_epi8('%');
+  for (; p + 16 <= ce; p += 16) {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    const std::uint32_t nl =
+        (std::uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, vnl));
+    const std::uint32_t sym = (std::uint32_t)_mm_movemask_epi8(
+        _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, vplus),
+                                  _mm_cmpeq_epi8(v, vminus)),
+                     _mm_cmpeq_epi8(v, vprcnt)));
+    if (sym)
+      collect_from_masks(begin, p, nl, sym, prev_nl, nls, markers);
+    nls += __builtin_popcount(nl);
+    prev_nl = (nl >> 15) & 1u;
+  }
+#endif
+
+  /* remaining bytes (or all of them, if no SIMD is available) */
+  for (; p < ce; ++p) {
+    if (prev_nl && is_marker_char(*p))
+      markers.push_back(BlockMarker{(std::size_t)(p - begin), nls, *p});
+    prev_nl = (*p == '\n');
+    nls += prev_nl;
+  }
+
+  nl_count = nls;
+}
+} /* anonymous namespace */
+
+int dso::sinex::details::scan_block_markers(const char *begin,
+                                            const char *end,
+                                            std::vector<BlockMarker> &markers,
+                                            long &num_lines,
+                                            int num_threads) noexcept {
+  markers.clear();
+  num_lines = 0;
+  if (end <= begin)
+    return 0;
+  const std::size_t size = end - begin;
+
+  /* number of chunks/threads to use */
+  int nt = num_threads;
+  if (nt <= 0) {
+    nt = std::max(1u, std::thread::hardware_concurrency());
+    nt = std::min(nt, max_scan_threads);
+  }
+  nt = std::max(1, std::min<int>(nt, (int)(size / min_chunk_bytes)));
+
+  try {
+    std::vector<long> nl_counts(nt, 0);
+    if (nt == 1) {
+      scan_chunk(begin, begin, end, markers, nl_counts[0]);
+    } else {
+      std::vector<std::vector<BlockMarker>> chunk_markers(nt);
+      std::vector<int> errors(nt, 0);
+      std::vector<std::thread> threads;
+      threads.reserve(nt);
+      const std::size_t chunk = size / nt;
+      /* scan chunk i; never throws, so that no exception can leave
+       * joinable threads behind */
+      auto scan = [&](int i) noexcept {
+        const char *cb = begin + i * chunk;
+        const char *ce = (i == nt - 1) ? end : cb + chunk;
+        try {
+          scan_chunk(begin, cb, ce, chunk_markers[i], nl_counts[i]);
+        } catch (std::exception &) {
+          errors[i] = 1;
+        }
+      };
+      int launched = 0;
+      try {
+        for (; launched < nt; launched++)
+          threads.emplace_back(scan, launched);
+      } catch (std::exception &) {
+        /* failed to launch a thread; scan the remaining chunks here */
+      }
+      for (int i = launched; i < nt; i++)
+        scan(i);
+      for (auto &t : threads)
+        t.join();
+      if (std::find(errors.cbegin(), errors.cend(), 1) != errors.cend()) {
+        fprintf(stderr,
+                "[ERROR] Failed scanning SINEX buffer for blocks (traceback: "
+                "%s)\n",
+                __func__);
+        return 1;
+      }
+      /* merge, in order; fix line numbers */
+      long lines_before = 0;
+      for (int i = 0; i < nt; i++) {
+        for (auto m : chunk_markers[i]) {
+          m.mline += lines_before;
+          markers.push_back(m);
+        }
+        lines_before += nl_counts[i];
+      }
+    }
+    for (auto n : nl_counts)
+      num_lines += n;
+  } catch (std::exception &e) {
+    fprintf(stderr,
+            "[ERROR] Failed scanning SINEX buffer for blocks; %s (traceback: "
+            "%s)\n",
+            e.what(), __func__);
+    return 1;
+  }
+
+  /* last line may not end with a newline */
+  if (end[-1] != '\n')
+    ++num_lines;
+
+  return 0;
+}
@@ -1,31 +1,81 @@
 #include "sinex.hpp"
+#include "core/sinex_index.hpp"
 #include <charconv>
+#include <algorithm>
 #include <cstdlib>
 #include <stdexcept>
+#include <thread>
+#include <unistd.h>
+#include <utility>
 #ifdef DEBUG
 #include "datetime/datetime_write.hpp"
 #endif
 
 namespace {
-constexpr long max_sinex_lines = 1'000'000;
+/* @brief Min number of payload bytes per chunk when parsing in parallel */
+constexpr std::size_t min_chunk_bytes = 512 * 1024;
+/* @brief Max number of threads to use for parsing a block */
+constexpr int max_parse_threads = 16;
+
 const char *skipws(const char *line) noexcept {
   while (*line && *line == ' ')
     ++line;
   return line;
 }
-int match_block_header(const char *str) noexcept {
-  for (int i = 0; i < dso::sinex::block_names_size; i++) {
-    auto sz = std::strlen(dso::sinex::block_names[i]);
-    if (!std::strncmp(str, dso::sinex::block_names[i], sz)) {
-      return i;
+} /* anonymous namespace */
+
+dso::Sinex::Sinex(const char *fn, SinexIoMode mode,
+                  SinexIndexPolicy index_policy)
+    : m_filename(std::string(fn)), m_mode(mode) {
+  /* compressed files can only be accessed via a (decompressed) buffer */
+  if (m_mode == SinexIoMode::Stream &&
+      sinex::details::detect_compression(fn) !=
+          sinex::details::Compression::None)
+    m_mode = SinexIoMode::MemoryMap;
+  /* map the file to memory; if this fails, fall back to stream mode */
+  if (m_mode == SinexIoMode::MemoryMap && m_map.map(fn))
+    m_mode = SinexIoMode::Stream;
+  if (m_mode == SinexIoMode::Stream)
+    m_file.open(fn);
+
+  if (parse_first_line()) {
+    throw std::runtime_error(
+        "[ERROR] Failed to parse header line in SINEX file\n");
+  }
+  /* try loading the block index */
+  if (index_policy != SinexIndexPolicy::None) {
+    const std::size_t size =
+        (m_mode == SinexIoMode::MemoryMap) ? m_map.size() : m_file.size();
+    m_index_loaded =
+        !sinex::details::read_block_index(fn, size, m_blocks, m_summaries) &&
+        !check_block_markers();
+  }
+  if (m_index_loaded)
+    return;
+  m_blocks.clear();
+  m_summaries.clear();
+
+  if (this->mark_blocks()) {
+    throw std::runtime_error("[ERROR] Failed to parse blocks in SINEX file\n");
+  }
+
+  /* (re-)write the block index; failing to do so is not an error */
+  if (index_policy == SinexIndexPolicy::ReadWrite) {
+    if (summarize_blocks(m_summaries) ||
+        sinex::details::write_block_index(fn, m_blocks, m_summaries)) {
+#ifdef DEBUG
+      fprintf(stderr, "[DEBUG] Failed to write block index for %s\n", fn);
+#endif
     }
   }
-  return -1;
 }
-} /* anonymous namespace */
 
-dso::Sinex::Sinex(const char *fn)
-    : m_filename(std::string(fn)), m_stream(fn, std::ios::in) {
+dso::Sinex::Sinex(dso::SinexBufferTag, std::string_view data,
+                  const char *name)
+    : m_filename(std::string(name)), m_mode(SinexIoMode::MemoryMap) {
+  if (m_map.view(data.data(), data.size())) {
+    throw std::runtime_error("[ERROR] Failed to access SINEX content\n");
+  }
   if (parse_first_line()) {
     throw std::runtime_error(
         "[ERROR] Failed to parse header line in SINEX file\n");
@@ -35,84 +85,293 @@ dso::Sinex::Sinex(const char *fn)
   }
 }
 
+dso::Sinex::Sinex(dso::SinexBufferTag, std::string &&data,
+                  const char *name)
+    : m_filename(std::string(name)), m_mode(SinexIoMode::MemoryMap) {
+  if (m_map.adopt(std::move(data))) {
+    throw std::runtime_error("[ERROR] Failed to access SINEX content\n");
+  }
+  if (parse_first_line()) {
+    throw std::runtime_error(
+        "[ERROR] Failed to parse header line in SINEX file\n");
+  }
+  if (this->mark_blocks()) {
+    throw std::runtime_error("[ERROR] Failed to parse blocks in SINEX file\n");
+  }
+}
+
+int dso::Sinex::summarize_blocks(
+    std::vector<sinex::SinexBlockSummary> &summaries) const noexcept {
+  summaries.clear();
+  try {
+    summaries.resize(m_blocks.size());
+  } catch (std::exception &) {
+    return 1;
+  }
+
+  for (std::size_t i = 0; i < m_blocks.size(); i++) {
+    sinex::details::LineCursor cursor;
+    if (block_cursor(m_blocks[i], cursor) ||
+        sinex::details::summarize_block(cursor, m_blocks[i], summaries[i])) {
+      summaries.clear();
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+int dso::Sinex::block_summary(
+    const char *block, long &num_records,
+    dso::datetime<dso::nanoseconds> &first,
+    dso::datetime<dso::nanoseconds> &last) const noexcept {
+  {
+    /* compute summaries on first call; once computed, they are never
+     * modified again and can be read without locking */
+    std::lock_guard<std::mutex> lock(m_summaries_mtx);
+    if (m_summaries.size() != m_blocks.size() &&
+        summarize_blocks(m_summaries))
+      return 1;
+  }
+
+  auto it = find_block(block);
+  if (it == m_blocks.cend()) {
+    fprintf(stderr, "[ERROR] Failed to locate block \'%s\' in parsed list\n",
+            block);
+    return 1;
+  }
+  const auto &summary = m_summaries[it - m_blocks.cbegin()];
+
+  num_records = summary.mrecords;
+  first = dso::datetime<dso::nanoseconds>::min();
+  last = dso::datetime<dso::nanoseconds>::max();
+  int error = 0;
+  if (*summary.mfirst)
+    error += sinex::parse_sinex_date(summary.mfirst, first, first);
+  if (*summary.mlast)
+    error += sinex::parse_sinex_date(summary.mlast, last, last);
+  return error;
+}
+
 int dso::Sinex::mark_blocks() noexcept {
-  if (!m_stream.is_open())
+  return (m_mode == SinexIoMode::MemoryMap) ? mark_blocks_mapped()
+                                            : mark_blocks_stream();
+}
+
+int dso::Sinex::mark_blocks_mapped() noexcept {
+  /* clear blocks and allocate storage */
+  m_blocks.clear();
+  m_blocks.reserve(10);
+
+  const char *const begin = m_map.begin();
+  const char *const end = m_map.end();
+
+  /* collect all lines starting with '+', '-' or '%' */
+  std::vector<sinex::details::BlockMarker> markers;
+  long num_lines = 0;
+  if (sinex::details::scan_block_markers(begin, end, markers, num_lines))
+    return 1;
+
+  char line[sinex::max_sinex_chars];
+  int error = 0;
+  bool eof_marker = false;
+  /* index of currently open block in m_blocks (or -1) */
+  long open_block = -1;
+  long open_line = 0;
+  for (const auto &m : markers) {
+    if (error)
+      break;
+    const char *str = begin + m.moffset;
+    const char *nl =
+        static_cast<const char *>(std::memchr(str, '\n', end - str));
+    const char *eol = nl ? nl : end;
+    /* copy (null-terminated) marker line */
+    const std::size_t sz =
+        std::min<std::size_t>(eol - str, sinex::max_sinex_chars - 1);
+    std::memcpy(line, str, sz);
+    line[sz] = '\0';
+
+    if (m.mtype == '%') {
+      /* end of file; break */
+      if (!std::strncmp(line, "%ENDSNX", 7)) {
+        eof_marker = true;
+        break;
+      }
+    } else if (m.mtype == '+') {
+      /* encounter start of block; match it to a valid SINEX block */
+      int idx = sinex::details::match_block_header(line + 1);
+      if (idx < 0) {
+        fprintf(
+            stderr,
+            "[ERROR] Could not match block with title \'%s\' (traceback: %s)\n",
+            line + 1, __func__);
+        ++error;
+      } else if (open_block >= 0) {
+        fprintf(stderr,
+                "[ERROR] Block \'%s\' starts before \'%s\' ends (traceback: "
+                "%s)\n",
+                line + 1, m_blocks[open_block].mtype, __func__);
+        ++error;
+      } else {
+        /* add start of block line to m_blocks; payload starts at next line */
+        const std::size_t data = nl ? (nl + 1 - begin) : (end - begin);
+        m_blocks.emplace_back(sinex::SinexBlockPosition{
+            pos_t(m.moffset), sinex::block_names[idx], pos_t(data), pos_t(data),
+            0});
+        open_block = m_blocks.size() - 1;
+        open_line = m.mline;
+      }
+    } else {
+      /* encounter end of block; must match the currently open block */
+      if ((open_block < 0) ||
+          std::strncmp(line + 1, m_blocks[open_block].mtype,
+                       std::strlen(m_blocks[open_block].mtype))) {
+        fprintf(stderr,
+                "[ERROR] Unexpected end of block \'%s\' (traceback: %s)\n",
+                line + 1, __func__);
+        ++error;
+      } else {
+        m_blocks[open_block].mend = pos_t(m.moffset);
+        m_blocks[open_block].mlines = m.mline - open_line - 1;
+        open_block = -1;
+      }
+    }
+  }
+
+  /* check for errors */
+  if ((!eof_marker) || error || (open_block >= 0)) {
+    if (!eof_marker) {
+      fprintf(stderr,
+              "[ERROR] Seems SINEX was not read till EOF! (traceback: %s)\n",
+              __func__);
+    }
+    if (error || (open_block >= 0)) {
+      fprintf(
+          stderr,
+          "[ERROR] Error occured while parsing SINEX file (traceback: %s)\n",
+          __func__);
+    }
+    ++error;
+  }
+
+  return error;
+}
+
+int dso::Sinex::mark_blocks_stream() noexcept {
+  if (!m_file.is_open())
     return 1;
   /* clear blocks and allocate storage */
   m_blocks.clear();
   m_blocks.reserve(10);
 
+  sinex::details::LineCursor cursor(m_file, 0, m_file.size());
   char line[sinex::max_sinex_chars];
-  pos_t pos = m_stream.tellg();
+  pos_t pos = 0;
   int error = 0;
   long linec = 0;
+  long open_line = 0;
+  bool block_open = false;
+  bool eof_marker = false;
   /* read SINEX lines through untill we reach '%ENDSNX' */
-  while (m_stream.getline(line, sinex::max_sinex_chars) &&
-         (linec++ < max_sinex_lines) && (!error)) {
+  while (cursor.getline(line) && (!error)) {
+    ++linec;
     /* end of file; break */
-    if (!std::strncmp(line, "%ENDSNX", 7))
+    if (!std::strncmp(line, "%ENDSNX", 7)) {
+      eof_marker = true;
       break;
+    }
     /* encounter start of block */
     if (*line == '+') {
       /* match it to a valid SINEX block */
-      int idx = match_block_header(line + 1);
+      int idx = sinex::details::match_block_header(line + 1);
       if (idx < 0) {
         fprintf(
             stderr,
             "[ERROR] Could not match block with title \'%s\' (traceback: %s)\n",
             line + 1, __func__);
         ++error;
+      } else if (block_open) {
+        fprintf(stderr,
+                "[ERROR] Block \'%s\' starts before \'%s\' ends (traceback: "
+                "%s)\n",
+                line + 1, m_blocks.back().mtype, __func__);
+        ++error;
+      } else {
+        /* add end of previous line to m_blocks; payload starts at next line */
+        const pos_t data = pos_t(cursor.offset());
+        m_blocks.emplace_back(sinex::SinexBlockPosition{
+            pos, sinex::block_names[idx], data, data, 0});
+        open_line = linec;
+        block_open = true;
+      }
+    } else if (*line == '-') {
+      /* encounter end of block; must match the last block opened */
+      if ((!block_open) || std::strncmp(line + 1, m_blocks.back().mtype,
+                                        std::strlen(m_blocks.back().mtype))) {
+        fprintf(stderr,
+                "[ERROR] Unexpected end of block \'%s\' (traceback: %s)\n",
+                line + 1, __func__);
+        ++error;
+      } else {
+        m_blocks.back().mend = pos;
+        m_blocks.back().mlines = linec - open_line - 1;
+        block_open = false;
       }
-      /* add end of previous line to m_blocks */
-#if __cplusplus > 201703L
-      m_blocks.emplace_back(sinex::SinexBlockPosition{
-          .mpos = pos, .mtype = sinex::block_names[idx]});
-#else
-      m_blocks.emplace_back(
-          sinex::SinexBlockPosition{pos, sinex::block_names[idx]});
-#endif
     }
     /* update pos to be at the end of last line read */
-    pos = m_stream.tellg();
+    pos = pos_t(cursor.offset());
   }
 
   /* check for errors */
-  if ((!m_stream.good()) || error || (linec >= max_sinex_lines)) {
-    if (!m_stream.good()) {
+  if ((!eof_marker) || error || block_open) {
+    if (!eof_marker) {
       fprintf(stderr,
               "[ERROR] Seems SINEX was not read till EOF! (traceback: %s)\n",
               __func__);
     }
-    if (error) {
+    if (error || block_open) {
       fprintf(
           stderr,
           "[ERROR] Error occured while parsing SINEX file (traceback: %s)\n",
           __func__);
     }
-    if (linec >= max_sinex_lines) {
-      fprintf(stderr,
-              "[ERROR] SINEX file has too many lines! (traceback: %s)\n",
-              __func__);
-    }
     ++error;
   }
 
-  /* clear the stream and return */
-  m_stream.clear();
   return error;
 }
 
 int dso::Sinex::parse_first_line() noexcept {
   char line[sinex::max_sinex_chars];
 
-  if (!m_stream.is_open())
+  /* go to start of file, read in line */
+  sinex::details::LineCursor cursor;
+  if (m_mode == SinexIoMode::MemoryMap) {
+    cursor = sinex::details::LineCursor(m_map.begin(), m_map.end());
+  } else {
+    if (!m_file.is_open())
+      return 1;
+    cursor = sinex::details::LineCursor(m_file, 0, m_file.size());
+  }
+  if (!cursor.getline(line)) {
+    fprintf(stderr,
+            "[ERROR] Failed reading first SINEX line from %s (traceback: %s)\n",
+            m_filename.c_str(), __func__);
     return 1;
+  }
+  /* header fields are read at fixed columns, up to (and including) the
+   * first solution contents character, i.e. line[68] */
+  constexpr std::size_t min_chars = 69;
+  const std::size_t len = std::strlen(line);
+  if (len < min_chars) {
+    fprintf(stderr,
+            "[ERROR] First SINEX line from %s too short (%zu characters, "
+            "expected at least %zu) (traceback: %s)\n",
+            m_filename.c_str(), len, min_chars, __func__);
+    return 1;
+  }
   int error = 0;
-
-  /* go to start of file, read in line */
-  m_stream.seekg(0);
-  m_stream.getline(line, sinex::max_sinex_chars);
-  char *end = line + 80;
+  char *end = line + len;
 
   if (std::strncmp(line, "%=SNX", 5)) {
     fprintf(stderr,
@@ -202,7 +461,7 @@ int dso::Sinex::parse_first_line() noexcept {
   *m_sol_contents = line[68];
   /* up to 6 available solution contents chars */
   std::size_t lidx = 70, aidx = 1;
-  while (lidx < std::strlen(line)) {
+  while (lidx < len) {
     m_sol_contents[aidx] = line[lidx];
     lidx += 2;
   }
@@ -210,7 +469,8 @@ int dso::Sinex::parse_first_line() noexcept {
   return error;
 }
 
-int dso::Sinex::goto_block(const char *block) noexcept {
+int dso::Sinex::goto_block(const char *block,
+                           sinex::details::LineCursor &cursor) const noexcept {
   /* find block by comparing strings */
   auto block_info_it = find_block(block);
   if (block_info_it == m_blocks.cend()) {
@@ -218,9 +478,136 @@ int dso::Sinex::goto_block(const char *block) noexcept {
             block);
     return 1;
   }
-  /* rewind */
-  m_stream.seekg(0);
-  /* place the input stream at startt of previous line */
-  m_stream.seekg(block_info_it->mpos, std::ios::beg);
+  return block_cursor(*block_info_it, cursor);
+}
+
+int dso::Sinex::goto_block_chunks(
+    const char *block, int num_threads,
+    std::vector<sinex::details::LineCursor> &cursors) const noexcept {
+  cursors.clear();
+  auto it = find_block(block);
+  if (it == m_blocks.cend()) {
+    fprintf(stderr, "[ERROR] Failed to locate block \'%s\' in parsed list\n",
+            block);
+    return 1;
+  }
+  const std::size_t data = (std::streamoff)it->mdata;
+  const std::size_t end = (std::streamoff)it->mend;
+
+  /* number of chunks */
+  int nt = num_threads;
+  if (nt <= 0) {
+    nt = std::max(1u, std::thread::hardware_concurrency());
+    nt = std::min(nt, max_parse_threads);
+  }
+  nt = std::max(1, std::min<int>(nt, (int)((end - data) / min_chunk_bytes)));
+
+  try {
+    cursors.reserve(nt);
+    /* chunk boundaries, moved forward to the start of the next line */
+    std::size_t cb = data;
+    for (int i = 1; i <= nt && cb < end; i++) {
+      std::size_t ce = (i == nt) ? end : data + i * ((end - data) / nt);
+      if (ce > cb && ce < end) {
+        if (m_mode == SinexIoMode::MemoryMap) {
+          const char *nl = static_cast<const char *>(std::memchr(
+              m_map.begin() + ce - 1, '\n', end - ce + 1));
+          ce = nl ? (std::size_t)(nl + 1 - m_map.begin()) : end;
+        } else {
+          /* read the rest of the line holding byte ce-1 */
+          char line[sinex::max_sinex_chars];
+          sinex::details::LineCursor cursor(m_file, ce - 1, end);
+          if (!cursor.getline(line))
+            return 1;
+          ce = cursor.offset();
+        }
+      }
+      if (ce <= cb)
+        continue;
+      sinex::SinexBlockPosition chunk = *it;
+      chunk.mdata = (std::streamoff)cb;
+      chunk.mend = (std::streamoff)ce;
+      cursors.emplace_back();
+      if (block_cursor(chunk, cursors.back()))
+        return 1;
+      cb = ce;
+    }
+    /* empty payload */
+    if (cursors.empty()) {
+      cursors.emplace_back();
+      return block_cursor(*it, cursors.back());
+    }
+  } catch (std::exception &) {
+    fprintf(stderr,
+            "[ERROR] Failed splitting block %s of SINEX file %s (traceback: "
+            "%s)\n",
+            block, m_filename.c_str(), __func__);
+    return 1;
+  }
+
+  return 0;
+}
+
+int dso::Sinex::check_block_markers() const noexcept {
+  /* the byte at offset off of the SINEX content, or '\0' if unavailable */
+  auto byte_at = [this](std::streamoff off) -> char {
+    if (m_mode == SinexIoMode::MemoryMap)
+      return ((std::size_t)off < m_map.size()) ? m_map.begin()[off] : '\0';
+    char c;
+    return (m_file.is_open() && (::pread(m_file.fd(), &c, 1, off) == 1))
+               ? c
+               : '\0';
+  };
+  for (const auto &blk : m_blocks) {
+    if ((byte_at(blk.mpos) != '+') || (byte_at(blk.mend) != '-')) {
+#ifdef DEBUG
+      fprintf(stderr,
+              "[DEBUG] Block index of %s does not match block %s "
+              "(traceback: %s)\n",
+              m_filename.c_str(), blk.mtype, __func__);
+#endif
+      return 1;
+    }
+  }
+  return 0;
+}
+
+int dso::Sinex::block_cursor(
+    const sinex::SinexBlockPosition &blk,
+    sinex::details::LineCursor &cursor) const noexcept {
+  const std::size_t data = (std::streamoff)blk.mdata;
+  const std::size_t end = (std::streamoff)blk.mend;
+  if (m_mode == SinexIoMode::MemoryMap) {
+    /* cursor over mapped bytes of the block payload */
+    cursor =
+        sinex::details::LineCursor(m_map.begin() + data, m_map.begin() + end);
+    return 0;
+  }
+  /* cursor over the file's byte range of the block payload */
+  if (!m_file.is_open())
+    return 1;
+  cursor = sinex::details::LineCursor(m_file, data, end);
+  return 0;
+}
+
+int dso::Sinex::block_bytes(const char *block, const char *&begin,
+                            const char *&end) const noexcept {
+  if (m_mode != SinexIoMode::MemoryMap) {
+    fprintf(stderr,
+            "[ERROR] Block bytes of SINEX file %s are only available in "
+            "MemoryMap mode (traceback: %s)\n",
+            m_filename.c_str(), __func__);
+    return 1;
+  }
+  auto it = find_block(block);
+  if (it == m_blocks.cend()) {
+    fprintf(stderr,
+            "[ERROR] Failed to locate block \'%s\' in SINEX file %s "
+            "(traceback: %s)\n",
+            block, m_filename.c_str(), __func__);
+    return 1;
+  }
+  begin = m_map.begin() + (std::streamoff)it->mdata;
+  end = m_map.begin() + (std::streamoff)it->mend;
   return 0;
 }
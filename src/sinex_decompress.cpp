@@ -0,0 +1,218 @@
+#include "core/sinex_io.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <zlib.h>
+
+namespace {
+/* @brief Size of output chunks appended while inflating */
+constexpr std::size_t inflate_chunk = 1024 * 1024;
+/* @brief Max code size (in bits) for Unix compress */
+constexpr int lzw_max_bits = 16;
+/* @brief Flags in the third byte of a Unix compress header */
+constexpr int lzw_bits_mask = 0x1f;
+constexpr int lzw_block_mode = 0x80;
+/* @brief Code signaling a table reset (in block mode) */
+constexpr unsigned lzw_clear = 256;
+} /* anonymous namespace */
+
+int dso::sinex::details::gunzip(const char *begin, const char *end,
+                                std::vector<char> &out) noexcept {
+  out.clear();
+  z_stream strm{};
+  /* 15 + 32: max window, automatic zlib/gzip header detection */
+  if (inflateInit2(&strm, 15 + 32) != Z_OK)
+    return 1;
+
+  std::size_t in_left = end - begin;
+  strm.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(begin));
+  int ret = Z_OK;
+  try {
+    /* the last 4 bytes of a gzip member hold the (modulo 2^32) size of
+     * the uncompressed data; use it (if sensible) to size the buffer.
+     */
+    std::uint32_t isize = 0;
+    for (int i = 1; i <= 4 && in_left >= 4; i++)
+      isize = (isize << 8) | (unsigned char)end[-i];
+    out.resize((isize >= in_left) ? (std::size_t)isize + 1 : in_left * 8);
+    std::size_t written = 0;
+    while (true) {
+      /* feed input in pieces that fit in uInt */
+      if (strm.avail_in == 0 && in_left) {
+        strm.avail_in = (uInt)std::min<std::size_t>(
+            in_left, std::numeric_limits<uInt>::max());
+        in_left -= strm.avail_in;
+      }
+      if (out.size() == written)
+        out.resize(written + std::max(inflate_chunk, written / 2));
+      strm.next_out = reinterpret_cast<Bytef *>(out.data() + written);
+      strm.avail_out = (uInt)(out.size() - written);
+      ret = inflate(&strm, Z_NO_FLUSH);
+      written = out.size() - strm.avail_out;
+      if (ret == Z_STREAM_END) {
+        /* concatenated gzip members; continue with the next one */
+        if (strm.avail_in || in_left) {
+          if (inflateReset(&strm) != Z_OK)
+            break;
+          ret = Z_OK;
+          continue;
+        }
+        break;
+      }
+      if (ret != Z_OK)
+        break;
+      /* no progress and no more input; truncated stream */
+      if (strm.avail_in == 0 && in_left == 0 && strm.avail_out) {
+        ret = Z_BUF_ERROR;
+        break;
+      }
+    }
+    out.resize(written);
+  } catch (std::exception &) {
+    ret = Z_MEM_ERROR;
+  }
+  inflateEnd(&strm);
+
+  if (ret != Z_STREAM_END) {
+    fprintf(stderr, "[ERROR] Failed to inflate gzip data (traceback: %s)\n",
+            __func__);
+    out.clear();
+    return 1;
+  }
+  return 0;
+}
+
+int dso::sinex::details::unlzw(const char *begin, const char *end,
+                               std::vector<char> &out) noexcept {
+  out.clear();
+  const unsigned char *in = reinterpret_cast<const unsigned char *>(begin);
+  const std::size_t in_size = end - begin;
+
+  /* header: magic bytes and flags */
+  if (in_size < 3 || in[0] != 0x1f || in[1] != 0x9d)
+    return 1;
+  const int max_bits = in[2] & lzw_bits_mask;
+  const bool block_mode = in[2] & lzw_block_mode;
+  if (max_bits < 9 || max_bits > lzw_max_bits) {
+    fprintf(stderr,
+            "[ERROR] Invalid max code size (%d) in compressed data "
+            "(traceback: %s)\n",
+            max_bits, __func__);
+    return 1;
+  }
+
+  try {
+    out.reserve(in_size * 3);
+    std::vector<std::uint16_t> prefix(1u << lzw_max_bits);
+    std::vector<unsigned char> suffix(1u << lzw_max_bits);
+    std::vector<unsigned char> stack((1u << lzw_max_bits) + 1);
+
+    std::size_t pos = 3;  /* next input byte */
+    std::size_t mark = 3; /* start of current group of codes */
+    std::uint32_t buf = 0;
+    int left = 0;
+    int bits = 9;
+    unsigned mask = 0x1ff;
+
+    /* read next code of (current) size bits; false at end of input */
+    auto next_code = [&](unsigned &code) -> bool {
+      while (left < bits) {
+        if (pos >= in_size)
+          return false;
+        buf |= (std::uint32_t)in[pos++] << left;
+        left += 8;
+      }
+      code = buf & mask;
+      buf >>= bits;
+      left -= bits;
+      return true;
+    };
+    /* codes are written in groups of 8 (i.e. of bits bytes); when the code
+     * size changes, skip the rest of the current group.
+     */
+    auto flush_group = [&]() {
+      const std::size_t rem = (pos - mark) % bits;
+      if (rem)
+        pos = std::min(in_size, pos + bits - rem);
+      buf = 0;
+      left = 0;
+      mark = pos;
+    };
+
+    /* first code is a literal; no table entry is created for it */
+    unsigned code;
+    if (!next_code(code))
+      return 0;
+    if (code > 255)
+      return 1;
+    unsigned prev = code;
+    unsigned char final = (unsigned char)code;
+    out.push_back((char)final);
+    /* last code in use */
+    unsigned last = block_mode ? 256 : 255;
+
+    while (true) {
+      /* table full for current code size; increase it */
+      if (last >= mask && bits < max_bits) {
+        flush_group();
+        ++bits;
+        mask = (mask << 1) | 1u;
+      }
+
+      if (!next_code(code))
+        break;
+
+      /* clear code; reset table */
+      if (code == lzw_clear && block_mode) {
+        flush_group();
+        bits = 9;
+        mask = 0x1ff;
+        last = 255;
+        continue;
+      }
+
+      const unsigned temp = code;
+      std::size_t sp = 0;
+      /* code not yet in table (KwKwK case) */
+      if (code > last) {
+        if (code != last + 1 || prev > last) {
+          fprintf(stderr,
+                  "[ERROR] Invalid code in compressed data (traceback: %s)\n",
+                  __func__);
+          out.clear();
+          return 1;
+        }
+        stack[sp++] = final;
+        code = prev;
+      }
+
+      /* walk the chain, collecting bytes in reverse order */
+      while (code >= 256) {
+        stack[sp++] = suffix[code];
+        code = prefix[code];
+      }
+      stack[sp++] = (unsigned char)code;
+      final = (unsigned char)code;
+
+      /* add new table entry */
+      if (last < mask) {
+        ++last;
+        prefix[last] = (std::uint16_t)prev;
+        suffix[last] = final;
+      }
+      prev = temp;
+
+      while (sp)
+        out.push_back((char)stack[--sp]);
+    }
+  } catch (std::exception &) {
+    fprintf(stderr,
+            "[ERROR] Failed to decompress LZW data (traceback: %s)\n",
+            __func__);
+    out.clear();
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,375 @@
+#include "core/sinex_index.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using dso::sinex::SinexBlockPosition;
+using dso::sinex::SinexBlockSummary;
+
+namespace {
+/* @brief Magic bytes at the start of an index file */
+constexpr char index_magic[8] = {'S', 'N', 'X', 'I', 'D', 'X', '\0', '\0'};
+/* @brief Index file format version; bump when the layout changes */
+constexpr std::uint32_t index_version = 1;
+/* @brief Used to detect index files written on a different byte order */
+constexpr std::uint32_t index_byte_order = 0x01020304;
+/* @brief Number of bytes hashed at the start and end of the SINEX file */
+constexpr std::size_t hashed_bytes = 64 * 1024;
+/* @brief Size of a SINEX date field, i.e. 'YY:DOY:SSSSS' */
+constexpr int date_chars = 12;
+
+/* @brief Blocks with epoch fields and the start index of these fields; for
+ * blocks with a single epoch field, both indexes are the same.
+ */
+struct BlockEpochFields {
+  const char *block;
+  int first;
+  int second;
+};
+constexpr BlockEpochFields block_epoch_fields[] = {
+    {"SITE/RECEIVER", 16, 29},        {"SITE/ANTENNA", 16, 29},
+    {"SITE/ECCENTRICITY", 16, 29},    {"SOLUTION/EPOCHS", 16, 29},
+    {"BIAS/EPOCHS", 16, 29},          {"SOLUTION/DATA_REJECT", 16, 29},
+    {"SOLUTION/ESTIMATE", 27, 27},    {"SOLUTION/APRIORI", 27, 27}};
+
+/* @brief FNV-1a style hash (64-bit), consuming 8 bytes at a time */
+std::uint64_t fnv1a(const char *data, std::size_t sz,
+                    std::uint64_t h = 14695981039346656037ULL) noexcept {
+  constexpr std::uint64_t prime = 1099511628211ULL;
+  std::size_t i = 0;
+  for (; i + 8 <= sz; i += 8) {
+    std::uint64_t w;
+    std::memcpy(&w, data + i, 8);
+    h = (h ^ w) * prime;
+  }
+  for (; i < sz; i++)
+    h = (h ^ (unsigned char)data[i]) * prime;
+  return h;
+}
+
+/* @brief Identity of a SINEX file, used to validate an index */
+struct FileStamp {
+  std::uint64_t msize;
+  std::int64_t mmtime_sec;
+  std::int64_t mmtime_nsec;
+  std::uint64_t mhash;
+  bool operator==(const FileStamp &o) const noexcept {
+    return (msize == o.msize) && (mmtime_sec == o.mmtime_sec) &&
+           (mmtime_nsec == o.mmtime_nsec) && (mhash == o.mhash);
+  }
+}; /* FileStamp */
+
+/* @brief Get size, modification time and content hash of a file */
+int file_stamp(const char *fn, FileStamp &stamp) noexcept {
+  const int fd = ::open(fn, O_RDONLY);
+  if (fd < 0)
+    return 1;
+  struct stat st;
+  if (::fstat(fd, &st) || (!S_ISREG(st.st_mode))) {
+    ::close(fd);
+    return 1;
+  }
+  stamp.msize = (std::uint64_t)st.st_size;
+  stamp.mmtime_sec = (std::int64_t)st.st_mtim.tv_sec;
+  stamp.mmtime_nsec = (std::int64_t)st.st_mtim.tv_nsec;
+
+  /* hash first and last bytes of file */
+  char buf[hashed_bytes];
+  std::uint64_t h = fnv1a(reinterpret_cast<const char *>(&stamp.msize),
+                          sizeof(stamp.msize));
+  const std::size_t head = std::min<std::size_t>(hashed_bytes, st.st_size);
+  int error = (::pread(fd, buf, head, 0) != (ssize_t)head);
+  h = fnv1a(buf, head, h);
+  const std::size_t tail = std::min<std::size_t>(hashed_bytes, st.st_size);
+  error += (::pread(fd, buf, tail, st.st_size - tail) != (ssize_t)tail);
+  h = fnv1a(buf, tail, h);
+  ::close(fd);
+
+  stamp.mhash = h;
+  return error;
+}
+
+/* @brief Append the bytes of a (trivial) value to a buffer */
+template <typename T> void put(std::vector<char> &buf, const T &val) {
+  const char *p = reinterpret_cast<const char *>(&val);
+  buf.insert(buf.end(), p, p + sizeof(T));
+}
+
+/* @brief Sequentially extract (trivial) values from a buffer */
+class Reader {
+  const char *m_cur;
+  const char *m_end;
+
+public:
+  Reader(const char *begin, const char *end) noexcept
+      : m_cur(begin), m_end(end) {}
+  template <typename T> bool get(T &val) noexcept {
+    if (m_end - m_cur < (std::ptrdiff_t)sizeof(T))
+      return false;
+    std::memcpy(&val, m_cur, sizeof(T));
+    m_cur += sizeof(T);
+    return true;
+  }
+  bool get(char *dest, std::size_t sz) noexcept {
+    if (m_end - m_cur < (std::ptrdiff_t)sz)
+      return false;
+    std::memcpy(dest, m_cur, sz);
+    m_cur += sz;
+    return true;
+  }
+}; /* Reader */
+
+/* @brief Resolve a SINEX date field ('YY:DOY:SSSSS') to a sortable integer
+ * key; returns a negative value if the field is not a valid date or if it is
+ * '00:000:00000' (i.e. the SINEX 'undefined' date).
+ */
+long long date_key(const char *str) noexcept {
+  int v[7];
+  const int at[] = {0, 1, 3, 4, 5, 7, 8};
+  for (int i = 0; i < 7; i++) {
+    if (str[at[i]] < '0' || str[at[i]] > '9')
+      return -1;
+    v[i] = str[at[i]] - '0';
+  }
+  if ((str[2] != ':') || (str[6] != ':'))
+    return -1;
+  int yr = v[0] * 10 + v[1];
+  const int doy = v[2] * 100 + v[3] * 10 + v[4];
+  long sec = 0;
+  for (int i = 9; i < date_chars; i++) {
+    if (str[i] < '0' || str[i] > '9')
+      return -1;
+    sec = sec * 10 + (str[i] - '0');
+  }
+  sec = sec + (v[5] * 10 + v[6]) * 1000;
+  if ((yr == 0) && (doy == 0) && (sec == 0))
+    return -1;
+  yr += (yr <= 50) ? 2000 : 1900;
+  return ((long long)yr * 1000 + doy) * 100000 + sec;
+}
+
+/* @brief Index of a block name in dso::sinex::block_names (or -1) */
+int block_name_index(const char *block) noexcept {
+  return dso::sinex::block_name_id(block, std::strlen(block));
+}
+} /* anonymous namespace */
+
+int dso::sinex::details::summarize_block(LineCursor &cursor,
+                                         const SinexBlockPosition &blk,
+                                         SinexBlockSummary &summary) noexcept {
+  summary.mrecords = 0;
+  summary.mfirst[0] = summary.mlast[0] = '\0';
+
+  /* epoch fields for this block type (if any) */
+  const BlockEpochFields *fields = nullptr;
+  for (const auto &f : block_epoch_fields)
+    if (!std::strcmp(f.block, blk.mtype))
+      fields = &f;
+
+  char line[sinex::max_sinex_chars];
+  long long kmin = -1, kmax = -1;
+  for (long i = 0; i < blk.mlines; i++) {
+    if (!cursor.getline(line)) {
+      fprintf(stderr,
+              "[ERROR] Failed reading line of block %s (traceback: %s)\n",
+              blk.mtype, __func__);
+      return 1;
+    }
+    /* skip comment lines */
+    if (*line == '*')
+      continue;
+    ++summary.mrecords;
+    if (fields) {
+      const int sz = std::strlen(line);
+      const int at[] = {fields->first, fields->second};
+      for (int j : at) {
+        if (sz < j + date_chars)
+          continue;
+        const long long k = date_key(line + j);
+        if (k < 0)
+          continue;
+        if (kmin < 0 || k < kmin) {
+          kmin = k;
+          std::memcpy(summary.mfirst, line + j, date_chars);
+          summary.mfirst[date_chars] = '\0';
+        }
+        if (k > kmax) {
+          kmax = k;
+          std::memcpy(summary.mlast, line + j, date_chars);
+          summary.mlast[date_chars] = '\0';
+        }
+      }
+    }
+  }
+
+  return 0;
+}
+
+int dso::sinex::details::read_block_index(
+    const char *snx_fn, std::size_t size,
+    std::vector<SinexBlockPosition> &blocks,
+    std::vector<SinexBlockSummary> &summaries) noexcept {
+  blocks.clear();
+  summaries.clear();
+
+  /* stamp of the SINEX file, as it is now */
+  FileStamp stamp;
+  if (file_stamp(snx_fn, stamp))
+    return 1;
+
+  /* read the whole index file */
+  std::vector<char> buf;
+  FILE *fp = nullptr;
+  try {
+    fp = std::fopen(block_index_filename(snx_fn).c_str(), "rb");
+    if (!fp)
+      return 1;
+    char tmp[4096];
+    std::size_t n;
+    while ((n = std::fread(tmp, 1, sizeof(tmp), fp)) > 0)
+      buf.insert(buf.end(), tmp, tmp + n);
+  } catch (std::exception &) {
+    buf.clear();
+  }
+  if (fp)
+    std::fclose(fp);
+
+  /* last 8 bytes hold a checksum of everything preceding */
+  std::uint64_t checksum;
+  if (buf.size() < sizeof(checksum))
+    return 1;
+  std::memcpy(&checksum, buf.data() + buf.size() - sizeof(checksum),
+              sizeof(checksum));
+  if (checksum != fnv1a(buf.data(), buf.size() - sizeof(checksum)))
+    return 1;
+
+  /* header */
+  Reader rdr(buf.data(), buf.data() + buf.size() - sizeof(checksum));
+  char magic[sizeof(index_magic)];
+  std::uint32_t version, byte_order;
+  FileStamp istamp;
+  std::uint64_t num_blocks;
+  if (!(rdr.get(magic, sizeof(magic)) && rdr.get(version) &&
+        rdr.get(byte_order) && rdr.get(istamp.msize) &&
+        rdr.get(istamp.mmtime_sec) && rdr.get(istamp.mmtime_nsec) &&
+        rdr.get(istamp.mhash) && rdr.get(num_blocks)))
+    return 1;
+  if (std::memcmp(magic, index_magic, sizeof(magic)) ||
+      (version != index_version) || (byte_order != index_byte_order) ||
+      !(istamp == stamp))
+    return 1;
+
+  /* block table */
+  try {
+    blocks.reserve(num_blocks);
+    summaries.reserve(num_blocks);
+    /* end of the previous block; blocks should not overlap */
+    std::int64_t prev_end = -1;
+    for (std::uint64_t i = 0; i < num_blocks; i++) {
+      std::int32_t type;
+      std::int64_t pos, data, end, lines, records;
+      SinexBlockSummary s;
+      if (!(rdr.get(type) && rdr.get(pos) && rdr.get(data) && rdr.get(end) &&
+            rdr.get(lines) && rdr.get(records) &&
+            rdr.get(s.mfirst, sizeof(s.mfirst)) &&
+            rdr.get(s.mlast, sizeof(s.mlast))) ||
+          (type < 0) || (type >= sinex::block_names_size) ||
+          (pos <= prev_end) || (pos >= data) || (data > end) ||
+          ((std::uint64_t)end > size) || (lines < 0) || (records < 0)) {
+        blocks.clear();
+        summaries.clear();
+        return 1;
+      }
+      prev_end = end;
+      s.mrecords = records;
+      s.mfirst[date_chars] = s.mlast[date_chars] = '\0';
+      blocks.emplace_back(SinexBlockPosition{
+          std::ifstream::pos_type(pos), sinex::block_names[type],
+          std::ifstream::pos_type(data), std::ifstream::pos_type(end),
+          (long)lines});
+      summaries.emplace_back(s);
+    }
+  } catch (std::exception &) {
+    blocks.clear();
+    summaries.clear();
+    return 1;
+  }
+
+  return 0;
+}
+
+int dso::sinex::details::write_block_index(
+    const char *snx_fn, const std::vector<SinexBlockPosition> &blocks,
+    const std::vector<SinexBlockSummary> &summaries) noexcept {
+  if (blocks.size() != summaries.size())
+    return 1;
+
+  FileStamp stamp;
+  if (file_stamp(snx_fn, stamp))
+    return 1;
+
+  std::string idx_fn, tmp_fn;
+  std::vector<char> buf;
+  try {
+    idx_fn = block_index_filename(snx_fn);
+    tmp_fn = idx_fn + ".XXXXXX";
+
+    /* serialize header and block table */
+    buf.insert(buf.end(), index_magic, index_magic + sizeof(index_magic));
+    put(buf, index_version);
+    put(buf, index_byte_order);
+    put(buf, stamp.msize);
+    put(buf, stamp.mmtime_sec);
+    put(buf, stamp.mmtime_nsec);
+    put(buf, stamp.mhash);
+    put(buf, (std::uint64_t)blocks.size());
+    for (std::size_t i = 0; i < blocks.size(); i++) {
+      const int type = block_name_index(blocks[i].mtype);
+      if (type < 0)
+        return 1;
+      put(buf, (std::int32_t)type);
+      put(buf, (std::int64_t)blocks[i].mpos);
+      put(buf, (std::int64_t)blocks[i].mdata);
+      put(buf, (std::int64_t)blocks[i].mend);
+      put(buf, (std::int64_t)blocks[i].mlines);
+      put(buf, (std::int64_t)summaries[i].mrecords);
+      buf.insert(buf.end(), summaries[i].mfirst,
+                 summaries[i].mfirst + sizeof(summaries[i].mfirst));
+      buf.insert(buf.end(), summaries[i].mlast,
+                 summaries[i].mlast + sizeof(summaries[i].mlast));
+    }
+    put(buf, fnv1a(buf.data(), buf.size()));
+  } catch (std::exception &) {
+    return 1;
+  }
+
+  /* write to a unique temporary file, then rename to the final name; rename
+   * is atomic, so readers will either see a complete index or none at all.
+   */
+  const int fd = ::mkstemp(tmp_fn.data());
+  if (fd < 0)
+    return 1;
+  std::size_t written = 0;
+  while (written < buf.size()) {
+    const ssize_t n = ::write(fd, buf.data() + written, buf.size() - written);
+    if (n <= 0)
+      break;
+    written += n;
+  }
+  int error = (written != buf.size());
+  /* mkstemp creates the file with mode 0600; use the usual permissions */
+  error += (::fchmod(fd, 0644) != 0);
+  error += (::close(fd) != 0);
+  if (!error)
+    error += (std::rename(tmp_fn.c_str(), idx_fn.c_str()) != 0);
+  if (error) {
+    ::unlink(tmp_fn.c_str());
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,192 @@
+#include "core/sinex_io.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <exception>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+/* @brief Size of chunks read in by LineCursor (positional reads) */
+constexpr std::size_t pread_chunk = 64 * 1024;
+} /* anonymous namespace */
+
+int dso::sinex::details::MappedFile::map(const char *fn) noexcept {
+  unmap();
+
+  const int fd = ::open(fn, O_RDONLY);
+  if (fd < 0)
+    return 1;
+
+  struct stat st;
+  if (::fstat(fd, &st) || (!S_ISREG(st.st_mode)) || (st.st_size <= 0)) {
+    ::close(fd);
+    return 1;
+  }
+
+  void *ptr =
+      ::mmap(nullptr, (std::size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  /* the mapping stays valid after closing the descriptor */
+  ::close(fd);
+  if (ptr == MAP_FAILED) {
+    fprintf(stderr, "[ERROR] Failed to memory-map file %s (traceback: %s)\n",
+            fn, __func__);
+    return 1;
+  }
+
+  m_mapping = ptr;
+  m_mapping_size = (std::size_t)st.st_size;
+  if (attach(static_cast<const char *>(ptr), m_mapping_size)) {
+    fprintf(stderr, "[ERROR] Failed to decompress file %s (traceback: %s)\n",
+            fn, __func__);
+    unmap();
+    return 1;
+  }
+  /* compressed file; only the decompressed bytes are needed */
+  if (m_compression != Compression::None) {
+    ::munmap(m_mapping, m_mapping_size);
+    m_mapping = nullptr;
+    m_mapping_size = 0;
+  }
+  return 0;
+}
+
+int dso::sinex::details::MappedFile::view(const char *data,
+                                          std::size_t size) noexcept {
+  unmap();
+  if (attach(data, size)) {
+    fprintf(stderr,
+            "[ERROR] Failed to decompress in-memory data (traceback: %s)\n",
+            __func__);
+    unmap();
+    return 1;
+  }
+  return 0;
+}
+
+int dso::sinex::details::MappedFile::adopt(std::string &&bytes) noexcept {
+  unmap();
+  m_owned = std::move(bytes);
+  if (attach(m_owned.data(), m_owned.size())) {
+    fprintf(stderr,
+            "[ERROR] Failed to decompress in-memory data (traceback: %s)\n",
+            __func__);
+    unmap();
+    return 1;
+  }
+  /* compressed data; only the decompressed bytes are needed */
+  if (m_compression != Compression::None) {
+    m_owned.clear();
+    m_owned.shrink_to_fit();
+  }
+  return 0;
+}
+
+int dso::sinex::details::MappedFile::attach(const char *data,
+                                            std::size_t size) noexcept {
+  m_compression = detect_compression(data, data + size);
+  if (m_compression == Compression::None) {
+    m_data = data;
+    m_size = size;
+    return 0;
+  }
+
+  const int error = (m_compression == Compression::Gzip)
+                        ? gunzip(data, data + size, m_buffer)
+                        : unlzw(data, data + size, m_buffer);
+  if (error || m_buffer.empty())
+    return 1;
+  m_data = m_buffer.data();
+  m_size = m_buffer.size();
+  return 0;
+}
+
+void dso::sinex::details::MappedFile::unmap() noexcept {
+  if (m_mapping)
+    ::munmap(m_mapping, m_mapping_size);
+  m_mapping = nullptr;
+  m_mapping_size = 0;
+  m_owned.clear();
+  m_owned.shrink_to_fit();
+  m_buffer.clear();
+  m_buffer.shrink_to_fit();
+  m_data = nullptr;
+  m_size = 0;
+  m_compression = Compression::None;
+}
+
+dso::sinex::details::Compression
+dso::sinex::details::detect_compression(const char *fn) noexcept {
+  char magic[2];
+  const int fd = ::open(fn, O_RDONLY);
+  if (fd < 0)
+    return Compression::None;
+  const ssize_t n = ::read(fd, magic, sizeof(magic));
+  ::close(fd);
+  return (n == (ssize_t)sizeof(magic))
+             ? detect_compression(magic, magic + sizeof(magic))
+             : Compression::None;
+}
+
+int dso::sinex::details::InputFile::open(const char *fn) noexcept {
+  close();
+
+  const int fd = ::open(fn, O_RDONLY);
+  if (fd < 0)
+    return 1;
+
+  struct stat st;
+  if (::fstat(fd, &st) || (!S_ISREG(st.st_mode))) {
+    ::close(fd);
+    return 1;
+  }
+  m_fd = fd;
+  m_size = (std::size_t)st.st_size;
+  return 0;
+}
+
+void dso::sinex::details::InputFile::close() noexcept {
+  if (m_fd >= 0)
+    ::close(m_fd);
+  m_fd = -1;
+  m_size = 0;
+}
+
+int dso::sinex::details::LineCursor::fill() noexcept {
+  if (m_buffer.empty()) {
+    try {
+      m_buffer.resize(pread_chunk);
+    } catch (std::exception &) {
+      return 1;
+    }
+    m_cur = m_end = m_buffer.data();
+  }
+
+  /* keep the (incomplete) line left in buffer */
+  const std::size_t left = m_end - m_cur;
+  std::memmove(m_buffer.data(), m_cur, left);
+  m_cur = m_buffer.data();
+  m_end = m_cur + left;
+
+  const std::size_t count =
+      std::min(m_buffer.size() - left, m_offset_end - m_offset);
+  std::size_t done = 0;
+  while (done < count) {
+    const ssize_t n = ::pread(m_fd, m_buffer.data() + left + done,
+                              count - done, (off_t)(m_offset + done));
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0) {
+      fprintf(stderr,
+              "[ERROR] Failed reading file at offset %zu (traceback: %s)\n",
+              m_offset + done, __func__);
+      return 1;
+    }
+    done += (std::size_t)n;
+  }
+  m_offset += done;
+  m_end += done;
+  return 0;
+}
@@ -0,0 +1,71 @@
+#include "sinex_matrix.hpp"
+
+const char *
+dso::sinex::matrix_estimate_block_name(dso::sinex::MatrixTriangle triangle,
+                                       dso::sinex::MatrixType type) noexcept {
+  constexpr const char *names[2][3] = {{"SOLUTION/MATRIX_ESTIMATE L CORR",
+                                        "SOLUTION/MATRIX_ESTIMATE L COVA",
+                                        "SOLUTION/MATRIX_ESTIMATE L INFO"},
+                                       {"SOLUTION/MATRIX_ESTIMATE U CORR",
+                                        "SOLUTION/MATRIX_ESTIMATE U COVA",
+                                        "SOLUTION/MATRIX_ESTIMATE U INFO"}};
+  return names[(int)triangle][(int)type];
+}
+
+void dso::sinex::SymmetricMatrix::to_dense(Eigen::MatrixXd &dense) const {
+  dense.resize(m_dim, m_dim);
+  const double *p = m_data.data();
+  for (int i = 0; i < m_dim; i++) {
+    /* packed row i of the lower triangle, i.e. elements (i,0)...(i,i) */
+    for (int j = 0; j <= i; j++) {
+      dense(i, j) = p[j];
+      dense(j, i) = p[j];
+    }
+    p += i + 1;
+  }
+}
+
+void dso::sinex::SymmetricMatrix::to_dense(const std::vector<int> &idx,
+                                           Eigen::MatrixXd &dense) const {
+  const int n = idx.size();
+  dense.resize(n, n);
+  for (int k = 0; k < n; k++) {
+    for (int l = 0; l <= k; l++) {
+      const double v = (*this)(idx[k], idx[l]);
+      dense(k, l) = v;
+      dense(l, k) = v;
+    }
+  }
+}
+
+void dso::sinex::propagate_sta_vel_covariance(
+    int n, const double *__restrict__ sta_vel, const double *__restrict__ dt,
+    double *__restrict__ xyz) noexcept {
+  /* element (a,b) of J C J^T, with J = [I, diag(dt)] and C partitioned in
+   * 3x3 blocks S (STA), M (STA/VEL) and V (VEL):
+   * S(a,b) + dt_b M(a,b) + dt_a M(b,a) + dt_a dt_b V(a,b) */
+  using Sym = SymmetricMatrix;
+  constexpr int batch = 8;
+  for (int a = 0; a < 3; a++) {
+    for (int b = 0; b <= a; b++) {
+      const double *s = sta_vel + Sym::packed_index(a, b) * n;
+      const double *mab = sta_vel + Sym::packed_index(a, b + 3) * n;
+      const double *mba = sta_vel + Sym::packed_index(b, a + 3) * n;
+      const double *v = sta_vel + Sym::packed_index(a + 3, b + 3) * n;
+      const double *dta = dt + a * n;
+      const double *dtb = dt + b * n;
+      double *out = xyz + Sym::packed_index(a, b) * n;
+      /* sites in fixed-width batches (vectorized even at -O2), then the
+       * remaining ones */
+      int k = 0;
+      for (; k + batch <= n; k += batch)
+        for (int l = 0; l < batch; l++)
+          out[k + l] = s[k + l] + dtb[k + l] * mab[k + l] +
+                       dta[k + l] * mba[k + l] +
+                       dta[k + l] * dtb[k + l] * v[k + l];
+      for (; k < n; k++)
+        out[k] = s[k] + dtb[k] * mab[k] + dta[k] * mba[k] +
+                 dta[k] * dtb[k] * v[k];
+    }
+  }
+}
@@ -25,35 +25,17 @@ char dso::sinex::SinexObservationCode_to_char(
 /* char to SinexObservationCode (may throw) */
 dso::sinex::SinexObservationCode
 dso::sinex::char_to_SinexObservationCode(char c) {
-  switch (c) {
-  case 'C':
-    return dso::sinex::SinexObservationCode::COMBINED;
-  case 'D':
-    return dso::sinex::SinexObservationCode::DORIS;
-  case 'L':
-    return dso::sinex::SinexObservationCode::SLR;
-  case 'M':
-    return dso::sinex::SinexObservationCode::LLR;
-  case 'P':
-    return dso::sinex::SinexObservationCode::GNSS;
-  case 'R':
-    return dso::sinex::SinexObservationCode::VLBI;
-  default:
+  dso::sinex::SinexObservationCode code;
+  if (char_to_SinexObservationCode(c, code))
     throw std::runtime_error("[ERROR] Invalid SINEX Observation Code!\n");
-  }
+  return code;
 }
 
 /* char to SinexConstraintCode (may throw) */
 dso::sinex::SinexConstraintCode
 dso::sinex::char_to_SinexConstraintCode(char c) {
-  switch (c) {
-  case '0':
-    return dso::sinex::SinexConstraintCode::FIXED;
-  case '1':
-    return dso::sinex::SinexConstraintCode::SIGNIFICANT;
-  case '2':
-    return dso::sinex::SinexConstraintCode::UNCONSTRAINED;
-  default:
+  dso::sinex::SinexConstraintCode code;
+  if (char_to_SinexConstraintCode(c, code))
     throw std::runtime_error("[ERROR] Invalid SINEX Constraint Code!\n");
-  }
+  return code;
 }
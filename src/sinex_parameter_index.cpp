@@ -0,0 +1,172 @@
+#include "sinex_parameter_index.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <exception>
+
+namespace {
+/* @brief Max number of distinct solution ids (16 bits of the key) */
+constexpr std::size_t max_solns = 0xffff;
+
+/* @brief Ids of the STAX, STAY, STAZ, VELX, VELY and VELZ parameter types */
+struct StaVelTypes {
+  int id[6];
+  StaVelTypes() noexcept {
+    const char *types[] = {"STAX", "STAY", "STAZ", "VELX", "VELY", "VELZ"};
+    for (int i = 0; i < 6; i++)
+      id[i] = dso::sinex::parameter_type_id(types[i], 4);
+  }
+};
+} /* anonymous namespace */
+
+std::uint64_t dso::sinex::ParameterIndex::key(
+    const char *site_code, const char *point_code,
+    const char *soln_id) const noexcept {
+  /* distinct solution ids are few; find the solution's ordinal */
+  const std::uint32_t soln =
+      (std::uint32_t)details::pack_chars(soln_id, SOLN_ID_CHAR_SIZE);
+  const auto it = std::find(m_solns.cbegin(), m_solns.cend(), soln);
+  if (it == m_solns.cend())
+    return 0;
+  /* site keys take 48 bits */
+  return details::site_key(site_code, point_code) |
+         ((std::uint64_t)(it - m_solns.cbegin() + 1) << 48);
+}
+
+const dso::sinex::ParameterIndex::Entry *
+dso::sinex::ParameterIndex::entry(const char *site_code,
+                                  const char *point_code,
+                                  const char *soln_id) const noexcept {
+  const std::uint64_t k = key(site_code, point_code, soln_id);
+  const int e = k ? m_map.find(k) : -1;
+  return (e >= 0) ? &m_entries[e] : nullptr;
+}
+
+int dso::sinex::ParameterIndex::build(
+    const std::vector<SolutionEstimate> &estimates) noexcept {
+  static const StaVelTypes sta_vel_types;
+  m_solns.clear();
+  m_entries.clear();
+  m_params.clear();
+  m_records.clear();
+  m_by_index.clear();
+
+  const int k = estimates.size();
+  try {
+    m_map = details::SiteKeyMap(k / 6 + 1);
+    m_records = estimates;
+    int max_index = 0;
+    for (const auto &e : estimates) {
+      if (e.index() <= 0) {
+        fprintf(stderr,
+                "[ERROR] Invalid parameter index %d of site %s (traceback: "
+                "%s)\n",
+                e.index(), e.site_code(), __func__);
+        return 1;
+      }
+      max_index = std::max(max_index, e.index());
+    }
+    m_by_index.assign(max_index + 1, -1);
+
+    /* group records per (site, solution) */
+    std::vector<int> entry_of(k);
+    for (int a = 0; a < k; a++) {
+      const auto &e = estimates[a];
+      const std::uint32_t soln =
+          (std::uint32_t)details::pack_chars(e.soln_id(), SOLN_ID_CHAR_SIZE);
+      if (std::find(m_solns.cbegin(), m_solns.cend(), soln) ==
+          m_solns.cend()) {
+        if (m_solns.size() >= max_solns) {
+          fprintf(stderr,
+                  "[ERROR] Too many distinct solution ids (traceback: %s)\n",
+                  __func__);
+          return 1;
+        }
+        m_solns.push_back(soln);
+      }
+      const std::uint64_t ek = key(e.site_code(), e.point_code(), e.soln_id());
+      int ei = m_map.find(ek);
+      if (ei < 0) {
+        ei = m_entries.size();
+        m_entries.push_back(Entry{{0, 0, 0, 0, 0, 0}, 0, 0});
+        m_map.insert(ek, ei);
+      }
+      entry_of[a] = ei;
+      ++m_entries[ei].end; /* count; turned to a range below */
+
+      /* the first record of each STA/VEL parameter */
+      for (int c = 0; c < 6; c++)
+        if (e.parameter_type_id() == sta_vel_types.id[c] &&
+            !m_entries[ei].sta_vel[c])
+          m_entries[ei].sta_vel[c] = e.index();
+      if (m_by_index[e.index()] < 0)
+        m_by_index[e.index()] = a;
+    }
+
+    /* parameters of each entry, contiguous in m_params */
+    int begin = 0;
+    for (auto &entry : m_entries) {
+      const int count = entry.end;
+      entry.begin = entry.end = begin;
+      begin += count;
+    }
+    m_params.resize(k);
+    for (int a = 0; a < k; a++) {
+      auto &entry = m_entries[entry_of[a]];
+      m_params[entry.end++] =
+          Parameter{estimates[a].parameter_type_id(), estimates[a].index()};
+    }
+  } catch (std::exception &e) {
+    fprintf(stderr,
+            "[ERROR] Failed building parameter index; %s (traceback: %s)\n",
+            e.what(), __func__);
+    return 1;
+  }
+  return 0;
+}
+
+int dso::sinex::ParameterIndex::index(const char *site_code,
+                                      const char *point_code,
+                                      const char *soln_id,
+                                      int parameter_type_id) const noexcept {
+  const Entry *e = entry(site_code, point_code, soln_id);
+  if (!e)
+    return -1;
+  for (int i = e->begin; i < e->end; i++)
+    if (m_params[i].parameter_type_id == parameter_type_id)
+      return m_params[i].index;
+  return -1;
+}
+
+const int *dso::sinex::ParameterIndex::sta_vel_indexes(
+    const char *site_code, const char *point_code,
+    const char *soln_id) const noexcept {
+  const Entry *e = entry(site_code, point_code, soln_id);
+  if (!e || std::find(e->sta_vel, e->sta_vel + 6, 0) != e->sta_vel + 6)
+    return nullptr;
+  return e->sta_vel;
+}
+
+int dso::sinex::ParameterIndex::sta_vel_covariance(
+    const SiteId &site, const char *soln_id, const SymmetricMatrix &matrix,
+    Eigen::Matrix<double, 6, 6> &cov) const noexcept {
+  const int *idx = sta_vel_indexes(site, soln_id);
+  if (!idx) {
+    fprintf(stderr,
+            "[ERROR] No STA/VEL parameters for site %s %s, solution %s "
+            "(traceback: %s)\n",
+            site.site_code(), site.point_code(), soln_id, __func__);
+    return 1;
+  }
+  if (*std::max_element(idx, idx + 6) > matrix.rows()) {
+    fprintf(stderr,
+            "[ERROR] Parameters of site %s %s not in %dx%d matrix "
+            "(traceback: %s)\n",
+            site.site_code(), site.point_code(), matrix.rows(), matrix.cols(),
+            __func__);
+    return 1;
+  }
+  for (int c = 0; c < 6; c++)
+    for (int r = 0; r < 6; r++)
+      cov(r, c) = matrix(idx[r] - 1, idx[c] - 1);
+  return 0;
+}
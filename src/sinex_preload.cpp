@@ -0,0 +1,93 @@
+#include "sinex.hpp"
+#include "core/sinex_lines.hpp"
+
+namespace {
+/* Parse all records of the block of record type T off from snx */
+template <typename T>
+dso::sinex::details::PreloadedBlock<T>
+parse_whole_block(const dso::Sinex *snx, long num_lines) noexcept {
+  dso::sinex::details::PreloadedBlock<T> block;
+  bool alloc_error = false;
+  try {
+    block.records.reserve(num_lines);
+  } catch (std::exception &) {
+    alloc_error = true;
+  }
+  if (!alloc_error)
+    block.error = snx->visit_block<T>([&](const T &rec) {
+      try {
+        block.records.push_back(rec);
+      } catch (std::exception &) {
+        alloc_error = true;
+        return dso::sinex::VisitAction::Stop;
+      }
+      return dso::sinex::VisitAction::Continue;
+    });
+  if (alloc_error) {
+    fprintf(stderr,
+            "[ERROR] Failed allocating memory for %s records (traceback: "
+            "%s)\n",
+            dso::sinex::details::record_traits<T>::block_name, __func__);
+    ++block.error;
+  }
+  return block;
+}
+} /* anonymous namespace */
+
+template <typename T>
+bool dso::Sinex::launch_preload(const char *block, bool launch) noexcept {
+  using Traits = sinex::details::record_traits<T>;
+  if (std::strcmp(block, Traits::block_name))
+    return false;
+
+  auto &future =
+      std::get<std::shared_future<sinex::details::PreloadedBlock<T>>>(
+          m_preloaded);
+  if ((!launch) || future.valid())
+    return true;
+
+  const long num_lines = find_block(Traits::block_name)->mlines;
+  auto task = [this, num_lines]() {
+    return parse_whole_block<T>(this, num_lines);
+  };
+  try {
+    future = std::async(std::launch::async, task).share();
+  } catch (std::exception &) {
+    /* failed to launch a thread; parse the block on first use instead */
+    try {
+      future = std::async(std::launch::deferred, task).share();
+    } catch (std::exception &) {
+      /* not preloaded; queries parse the block on demand */
+    }
+  }
+  return true;
+}
+
+int dso::Sinex::preload(const std::vector<const char *> &blocks) noexcept {
+  /* check all blocks first (launch = false), then start the tasks */
+  for (int launch = 0; launch < 2; launch++) {
+    for (const char *block : blocks) {
+      if (find_block(block) == m_blocks.cend()) {
+        fprintf(stderr,
+                "[ERROR] Cannot preload block %s; no such block in SINEX "
+                "file %s (traceback: %s)\n",
+                block, m_filename.c_str(), __func__);
+        return 1;
+      }
+      if (!(launch_preload<sinex::SiteId>(block, launch) ||
+            launch_preload<sinex::SiteReceiver>(block, launch) ||
+            launch_preload<sinex::SiteAntenna>(block, launch) ||
+            launch_preload<sinex::SiteEccentricity>(block, launch) ||
+            launch_preload<sinex::SolutionEpoch>(block, launch) ||
+            launch_preload<sinex::SolutionEstimate>(block, launch) ||
+            launch_preload<sinex::DataReject>(block, launch))) {
+        fprintf(stderr,
+                "[ERROR] Block %s cannot be preloaded (traceback: %s)\n",
+                block, __func__);
+        return 1;
+      }
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,204 @@
+#include "sinex_stream.hpp"
+#include "core/sinex_io.hpp"
+#include "core/sinex_lines.hpp"
+#include <fstream>
+#include <iostream>
+
+namespace {
+/* @brief Blocks that can be collected, and the matching SinexStreamBlock */
+struct StreamBlock {
+  const char *mname;
+  dso::SinexStreamBlock mblock;
+};
+constexpr StreamBlock stream_blocks[] = {
+    {"SITE/ID", dso::SinexStreamBlock::SiteId},
+    {"SOLUTION/EPOCHS", dso::SinexStreamBlock::SolutionEpochs},
+    {"SOLUTION/ESTIMATE", dso::SinexStreamBlock::SolutionEstimate}};
+} /* anonymous namespace */
+
+dso::SinexStreamReader::SinexStreamReader(
+    const std::vector<const char *> &sites, bool use_domes)
+    : m_filter(sites, use_domes), m_site_codes(sites.size()) {
+  m_sites.reserve(sites.size());
+  for (const char *site : sites) {
+    m_sites.emplace_back(site);
+    m_site_codes.insert(sinex::details::pack_chars(site, 4), 0);
+  }
+}
+
+int dso::SinexStreamReader::parse_header(const char *line) noexcept {
+  if (std::strncmp(line, "%=SNX", 5)) {
+    fprintf(stderr, "[ERROR] Expected field \'%%=SNX\' found \'%.5s\'\n",
+            line);
+    return 1;
+  }
+  if (std::strlen(line) < 56) {
+    fprintf(stderr, "[ERROR] Invalid SINEX header line \"%s\"\n", line);
+    return 1;
+  }
+  int error = 0;
+  error += sinex::parse_sinex_date(
+      line + 31, dso::datetime<dso::nanoseconds>::min(), m_data_start);
+  error += sinex::parse_sinex_date(
+      line + 44, dso::datetime<dso::nanoseconds>::max(), m_data_stop);
+  return error;
+}
+
+bool dso::SinexStreamReader::site_of_interest(
+    const char *site) const noexcept {
+  /* match against collected SITE/ID records (SITE CODE and POINT CODE) */
+  if (m_blocks_read & static_cast<unsigned>(SinexStreamBlock::SiteId))
+    return m_site_id_keys.contains(sinex::details::site_key(site, site + 5));
+  /* match against SITE CODEs of the sites of interest */
+  if (m_sites.empty())
+    return true;
+  return m_site_codes.contains(sinex::details::pack_chars(site, 4));
+}
+
+int dso::SinexStreamReader::parse_line(SinexStreamBlock block,
+                                       const char *line) noexcept {
+  try {
+    switch (block) {
+    case SinexStreamBlock::SiteId: {
+      sinex::SiteId site;
+      if (sinex::details::parse_site_id_line(line, site))
+        return 1;
+      if (m_filter.matches(site)) {
+        m_site_id_keys.insert(
+            sinex::details::site_key(site.site_code(), site.point_code()),
+            (int)m_site_ids.size());
+        m_site_ids.push_back(site);
+      }
+      return 0;
+    }
+    case SinexStreamBlock::SolutionEpochs: {
+      if (!site_of_interest(line + 1))
+        return 0;
+      sinex::SolutionEpoch entry;
+      if (sinex::details::parse_epoch_line(line, m_data_start, m_data_stop,
+                                           entry))
+        return 1;
+      m_epochs.push_back(entry);
+      return 0;
+    }
+    case SinexStreamBlock::SolutionEstimate: {
+      if (!site_of_interest(line + 14))
+        return 0;
+      sinex::SolutionEstimate est;
+      if (sinex::details::parse_solution_estimate_line(line, est,
+                                                       m_data_start))
+        return 1;
+      m_estimates.push_back(est);
+      return 0;
+    }
+    }
+  } catch (std::exception &) {
+    fprintf(stderr, "[ERROR] Failed to store SINEX record (traceback: %s)\n",
+            __func__);
+  }
+  return 1;
+}
+
+int dso::SinexStreamReader::read(std::istream &is, const char *name) noexcept {
+  m_site_ids.clear();
+  m_epochs.clear();
+  m_estimates.clear();
+  m_site_id_keys = sinex::details::SiteKeyMap();
+  m_blocks_read = 0;
+
+  sinex::details::LineCursor cursor(is);
+  char line[sinex::max_sinex_chars];
+
+  /* header line */
+  if ((!cursor.getline(line)) || parse_header(line)) {
+    fprintf(stderr,
+            "[ERROR] Failed reading SINEX header line from %s (traceback: "
+            "%s)\n",
+            name, __func__);
+    return 1;
+  }
+
+  int error = 0;
+  bool eof_marker = false;
+  /* currently open block (or nullptr) and the block of interest it
+   * corresponds to (if any) */
+  const char *open_block = nullptr;
+  const StreamBlock *open_of_interest = nullptr;
+  while (cursor.getline(line) && (!error)) {
+    if (*line == '+') {
+      /* start of block; match it to a valid SINEX block */
+      const int idx = sinex::details::match_block_header(line + 1);
+      const char *blk = (idx >= 0) ? sinex::block_names[idx] : nullptr;
+      if ((!blk) || open_block) {
+        fprintf(stderr,
+                "[ERROR] Unexpected start of block \'%s\' (traceback: %s)\n",
+                line + 1, __func__);
+        ++error;
+      } else {
+        open_block = blk;
+        open_of_interest = nullptr;
+        for (const auto &sb : stream_blocks) {
+          if ((m_blocks & static_cast<unsigned>(sb.mblock)) &&
+              (!std::strcmp(sb.mname, blk)))
+            open_of_interest = &sb;
+        }
+      }
+    } else if (*line == '-') {
+      /* end of block; must match the currently open block */
+      if ((!open_block) ||
+          std::strncmp(line + 1, open_block, std::strlen(open_block))) {
+        fprintf(stderr,
+                "[ERROR] Unexpected end of block \'%s\' (traceback: %s)\n",
+                line + 1, __func__);
+        ++error;
+      } else {
+        if (open_of_interest)
+          m_blocks_read |= static_cast<unsigned>(open_of_interest->mblock);
+        open_block = nullptr;
+        open_of_interest = nullptr;
+      }
+    } else if (*line == '%') {
+      /* end of file; break */
+      if (!std::strncmp(line, "%ENDSNX", 7)) {
+        eof_marker = true;
+        break;
+      }
+    } else if (open_of_interest && (*line != '*')) {
+      /* data line of a block of interest */
+      if (parse_line(open_of_interest->mblock, line)) {
+        fprintf(stderr,
+                "[ERROR] Failed to parse %s line from SINEX %s (traceback: "
+                "%s)\n",
+                open_of_interest->mname, name, __func__);
+        fprintf(stderr, "[ERROR] Line was \"%s\" (traceback: %s)\n", line,
+                __func__);
+        ++error;
+      }
+    }
+  }
+
+  if ((!eof_marker) || open_block || error) {
+    if (!eof_marker) {
+      fprintf(stderr,
+              "[ERROR] Seems SINEX %s was not read till EOF! (traceback: "
+              "%s)\n",
+              name, __func__);
+    }
+    return 1;
+  }
+
+  return 0;
+}
+
+int dso::SinexStreamReader::read(const char *fn) noexcept {
+  if (!std::strcmp(fn, "-"))
+    return read(std::cin, "(stdin)");
+
+  std::ifstream fin(fn);
+  if (!fin.is_open()) {
+    fprintf(stderr, "[ERROR] Failed opening SINEX file %s (traceback: %s)\n",
+            fn, __func__);
+    return 1;
+  }
+  return read(fin, fn);
+}
@@ -0,0 +1,396 @@
+#include "sinex_tiled_matrix.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <fcntl.h>
+#include <numeric>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+/* @brief Header of a tile file; written at the start of the first page */
+struct TileFileHeader {
+  char magic[8];
+  std::int64_t dim;
+  std::int64_t tile_size;
+  std::int64_t tile_bytes;
+  std::int64_t data_offset;
+};
+constexpr char tile_file_magic[8] = {'S', 'N', 'X', 'T', 'I', 'L', 'E', '1'};
+
+std::size_t round_up(std::size_t bytes, std::size_t multiple) noexcept {
+  return (bytes + multiple - 1) / multiple * multiple;
+}
+
+std::size_t page_size() noexcept {
+  const long ps = ::sysconf(_SC_PAGESIZE);
+  return (ps > 0) ? (std::size_t)ps : 4096;
+}
+} /* anonymous namespace */
+
+void dso::sinex::TiledSymmetricMatrix::set_budget(
+    std::size_t ram_budget) noexcept {
+  m_max_cached = std::max<std::size_t>(1, ram_budget / m_tile_bytes);
+}
+
+int dso::sinex::TiledSymmetricMatrix::create(const char *fn, int n,
+                                             int tile_size,
+                                             std::size_t ram_budget) noexcept {
+  close();
+  if (n <= 0 || tile_size <= 0) {
+    fprintf(stderr,
+            "[ERROR] Invalid dimension (%d) or tile size (%d) for tile file "
+            "%s (traceback: %s)\n",
+            n, tile_size, fn, __func__);
+    return 1;
+  }
+
+  const int num_tiles = (n + tile_size - 1) / tile_size;
+  const std::size_t tile_bytes =
+      round_up((std::size_t)tile_size * tile_size * sizeof(double),
+               page_size());
+  const std::size_t data_offset = round_up(sizeof(TileFileHeader), page_size());
+  const std::size_t file_size =
+      data_offset + packed_tiles(num_tiles) * tile_bytes;
+
+  const int fd = ::open(fn, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    fprintf(stderr, "[ERROR] Failed to create tile file %s (traceback: %s)\n",
+            fn, __func__);
+    return 1;
+  }
+
+  /* the file is sparse; tiles not written read as zeros */
+  TileFileHeader header;
+  std::memcpy(header.magic, tile_file_magic, sizeof(header.magic));
+  header.dim = n;
+  header.tile_size = tile_size;
+  header.tile_bytes = tile_bytes;
+  header.data_offset = data_offset;
+  if (::ftruncate(fd, (off_t)file_size) ||
+      ::pwrite(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header)) {
+    fprintf(stderr,
+            "[ERROR] Failed to allocate %zu bytes for tile file %s "
+            "(traceback: %s)\n",
+            file_size, fn, __func__);
+    ::close(fd);
+    return 1;
+  }
+
+  try {
+    m_filename = fn;
+  } catch (std::exception &) {
+    ::close(fd);
+    return 1;
+  }
+  m_fd = fd;
+  m_writable = true;
+  m_dim = n;
+  m_tile_size = tile_size;
+  m_num_tiles = num_tiles;
+  m_tile_bytes = tile_bytes;
+  m_data_offset = data_offset;
+  set_budget(ram_budget);
+  return 0;
+}
+
+int dso::sinex::TiledSymmetricMatrix::open(const char *fn,
+                                           std::size_t ram_budget,
+                                           bool writable) noexcept {
+  close();
+  const int fd = ::open(fn, writable ? O_RDWR : O_RDONLY);
+  if (fd < 0) {
+    fprintf(stderr, "[ERROR] Failed to open tile file %s (traceback: %s)\n",
+            fn, __func__);
+    return 1;
+  }
+
+  /* validate header, against the file size and the system's page size */
+  TileFileHeader header;
+  struct stat st;
+  int error = (::pread(fd, &header, sizeof(header), 0) !=
+               (ssize_t)sizeof(header)) ||
+              ::fstat(fd, &st);
+  if (!error) {
+    const std::int64_t t = header.tile_size;
+    const std::int64_t nt = (t > 0) ? (header.dim + t - 1) / t : 0;
+    error = std::memcmp(header.magic, tile_file_magic, sizeof(header.magic)) ||
+            (header.dim <= 0) || (t <= 0) || (header.dim > INT32_MAX) ||
+            (header.tile_bytes < t * t * (std::int64_t)sizeof(double)) ||
+            (header.tile_bytes % page_size()) ||
+            (header.data_offset < (std::int64_t)sizeof(header)) ||
+            (header.data_offset % page_size()) ||
+            ((std::size_t)st.st_size <
+             header.data_offset + packed_tiles(nt) * header.tile_bytes);
+  }
+  if (error) {
+    fprintf(stderr,
+            "[ERROR] Invalid or corrupt tile file %s (traceback: %s)\n", fn,
+            __func__);
+    ::close(fd);
+    return 1;
+  }
+
+  try {
+    m_filename = fn;
+  } catch (std::exception &) {
+    ::close(fd);
+    return 1;
+  }
+  m_fd = fd;
+  m_writable = writable;
+  m_dim = header.dim;
+  m_tile_size = header.tile_size;
+  m_num_tiles = (m_dim + m_tile_size - 1) / m_tile_size;
+  m_tile_bytes = header.tile_bytes;
+  m_data_offset = header.data_offset;
+  set_budget(ram_budget);
+  return 0;
+}
+
+void dso::sinex::TiledSymmetricMatrix::evict_all() const noexcept {
+  for (const auto &t : m_lru)
+    ::munmap(t.data, m_tile_bytes);
+  m_lru.clear();
+  m_cached.clear();
+}
+
+void dso::sinex::TiledSymmetricMatrix::close() noexcept {
+  /* (shared) mappings of modified tiles are written back by the system */
+  evict_all();
+  if (m_fd >= 0)
+    ::close(m_fd);
+  m_fd = -1;
+  m_filename.clear();
+  m_writable = false;
+  m_dim = m_tile_size = m_num_tiles = 0;
+  m_tile_bytes = m_data_offset = 0;
+  m_max_cached = 1;
+}
+
+int dso::sinex::TiledSymmetricMatrix::flush() const noexcept {
+  int error = 0;
+  if (m_writable)
+    for (const auto &t : m_lru)
+      error += (::msync(t.data, m_tile_bytes, MS_SYNC) != 0);
+  if (error)
+    fprintf(stderr, "[ERROR] Failed to write tile file %s (traceback: %s)\n",
+            m_filename.c_str(), __func__);
+  return error;
+}
+
+double *
+dso::sinex::TiledSymmetricMatrix::tile_data(std::size_t idx) const noexcept {
+  /* cached; move to the front of the LRU list */
+  if (const auto it = m_cached.find(idx); it != m_cached.end()) {
+    m_lru.splice(m_lru.begin(), m_lru, it->second);
+    return it->second->data;
+  }
+
+  /* evict the least recently used tile(s) */
+  while (!m_lru.empty() && m_lru.size() >= m_max_cached) {
+    ::munmap(m_lru.back().data, m_tile_bytes);
+    m_cached.erase(m_lru.back().index);
+    m_lru.pop_back();
+  }
+
+  const off_t offset = (off_t)(m_data_offset + idx * m_tile_bytes);
+  void *ptr = ::mmap(nullptr, m_tile_bytes,
+                     m_writable ? (PROT_READ | PROT_WRITE) : PROT_READ,
+                     MAP_SHARED, m_fd, offset);
+  if (ptr == MAP_FAILED) {
+    fprintf(stderr,
+            "[ERROR] Failed to map tile %zu of file %s (traceback: %s)\n", idx,
+            m_filename.c_str(), __func__);
+    return nullptr;
+  }
+
+  try {
+    m_lru.push_front(CachedTile{idx, static_cast<double *>(ptr)});
+    m_cached.emplace(idx, m_lru.begin());
+  } catch (std::exception &) {
+    if (!m_lru.empty() && m_lru.front().data == ptr)
+      m_lru.pop_front();
+    ::munmap(ptr, m_tile_bytes);
+    return nullptr;
+  }
+  return static_cast<double *>(ptr);
+}
+
+const double *dso::sinex::TiledSymmetricMatrix::tile(int I,
+                                                     int J) const noexcept {
+  if (m_fd < 0 || J < 0 || I < J || I >= m_num_tiles)
+    return nullptr;
+  return tile_data(packed_tile_index(I, J));
+}
+
+double *dso::sinex::TiledSymmetricMatrix::tile(int I, int J) noexcept {
+  if (!m_writable || J < 0 || I < J || I >= m_num_tiles)
+    return nullptr;
+  return tile_data(packed_tile_index(I, J));
+}
+
+int dso::sinex::TiledSymmetricMatrix::write_tile(int I, int J,
+                                                 const double *data) noexcept {
+  if (!m_writable || J < 0 || I < J || I >= m_num_tiles)
+    return 1;
+  /* (shared) mappings of the file see the data written */
+  const std::size_t bytes =
+      (std::size_t)m_tile_size * m_tile_size * sizeof(double);
+  const off_t offset =
+      (off_t)(m_data_offset + packed_tile_index(I, J) * m_tile_bytes);
+  std::size_t done = 0;
+  while (done < bytes) {
+    const ssize_t n =
+        ::pwrite(m_fd, reinterpret_cast<const char *>(data) + done,
+                 bytes - done, offset + (off_t)done);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0) {
+      fprintf(stderr,
+              "[ERROR] Failed writing tile (%d,%d) to file %s (traceback: "
+              "%s)\n",
+              I, J, m_filename.c_str(), __func__);
+      return 1;
+    }
+    done += (std::size_t)n;
+  }
+  return 0;
+}
+
+int dso::sinex::TiledSymmetricMatrix::get(int i, int j,
+                                          double &val) const noexcept {
+  if (i < j)
+    std::swap(i, j);
+  if (j < 0 || i >= m_dim)
+    return 1;
+  const int t = m_tile_size;
+  const double *p = tile(i / t, j / t);
+  if (!p)
+    return 1;
+  val = p[(j % t) * t + i % t];
+  return 0;
+}
+
+int dso::sinex::TiledSymmetricMatrix::set(int i, int j, double val) noexcept {
+  if (i < j)
+    std::swap(i, j);
+  if (j < 0 || i >= m_dim)
+    return 1;
+  const int t = m_tile_size;
+  double *p = tile(i / t, j / t);
+  if (!p)
+    return 1;
+  p[(j % t) * t + i % t] = val;
+  /* tiles on the diagonal hold both triangles */
+  if (i / t == j / t)
+    p[(i % t) * t + j % t] = val;
+  return 0;
+}
+
+int dso::sinex::TiledSymmetricMatrix::to_dense(
+    const std::vector<int> &idx, Eigen::MatrixXd &dense) const noexcept {
+  const int n = idx.size();
+  const int t = m_tile_size;
+  if (std::any_of(idx.cbegin(), idx.cend(),
+                  [this](int i) { return i < 0 || i >= m_dim; })) {
+    fprintf(stderr,
+            "[ERROR] Invalid index for %dx%d matrix of tile file %s "
+            "(traceback: %s)\n",
+            m_dim, m_dim, m_filename.c_str(), __func__);
+    return 1;
+  }
+
+  try {
+    dense.resize(n, n);
+    /* positions in idx, grouped by tile; groups are in tile order */
+    std::vector<int> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(),
+              [&](int a, int b) { return idx[a] < idx[b]; });
+    std::vector<int> groups; /* start of each group in order (+ end) */
+    for (int k = 0; k < n; k++)
+      if (!k || idx[order[k]] / t != idx[order[k - 1]] / t)
+        groups.push_back(k);
+    groups.push_back(n);
+
+    /* one tile per pair of groups */
+    for (std::size_t g1 = 0; g1 + 1 < groups.size(); g1++) {
+      for (std::size_t g2 = 0; g2 <= g1; g2++) {
+        const double *p = tile(idx[order[groups[g1]]] / t,
+                               idx[order[groups[g2]]] / t);
+        if (!p)
+          return 1;
+        for (int a = groups[g1]; a < groups[g1 + 1]; a++) {
+          const int k = order[a];
+          for (int b = groups[g2]; b < groups[g2 + 1]; b++) {
+            const int l = order[b];
+            const double v = p[(idx[l] % t) * t + idx[k] % t];
+            dense(k, l) = v;
+            dense(l, k) = v;
+          }
+        }
+      }
+    }
+  } catch (std::exception &e) {
+    fprintf(stderr,
+            "[ERROR] Failed extracting sub-matrix; %s (traceback: %s)\n",
+            e.what(), __func__);
+    return 1;
+  }
+  return 0;
+}
+
+int dso::sinex::TiledSymmetricMatrix::multiply(
+    const Eigen::MatrixXd &x, Eigen::MatrixXd &y) const noexcept {
+  if (x.rows() != m_dim) {
+    fprintf(stderr,
+            "[ERROR] Cannot multiply %dx%d matrix with %ldx%ld matrix "
+            "(traceback: %s)\n",
+            m_dim, m_dim, (long)x.rows(), (long)x.cols(), __func__);
+    return 1;
+  }
+
+  const int t = m_tile_size;
+  try {
+    y.setZero(m_dim, x.cols());
+    for (int I = 0; I < m_num_tiles; I++) {
+      const int ri = tile_rows(I);
+      for (int J = 0; J <= I; J++) {
+        const double *p = tile(I, J);
+        if (!p)
+          return 1;
+        const int rj = tile_rows(J);
+        /* each column of x, while the tile is at hand */
+        for (int c = 0; c < x.cols(); c++) {
+          const double *xi = &x(I * t, c);
+          const double *xj = &x(J * t, c);
+          double *yi = &y(I * t, c);
+          double *yj = &y(J * t, c);
+          for (int l = 0; l < rj; l++) {
+            const double *a = p + (std::size_t)l * t; /* column l of tile */
+            /* y_I += A * x_J */
+            for (int k = 0; k < ri; k++)
+              yi[k] += a[k] * xj[l];
+            /* y_J += A^T * x_I, i.e. the upper triangle tile (J,I) */
+            if (I != J) {
+              double s = 0e0;
+              for (int k = 0; k < ri; k++)
+                s += a[k] * xi[k];
+              yj[l] += s;
+            }
+          }
+        }
+      }
+    }
+  } catch (std::exception &e) {
+    fprintf(stderr, "[ERROR] Failed multiplying matrices; %s (traceback: %s)\n",
+            e.what(), __func__);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,68 @@
+#include "sinex_views.hpp"
+#include "geodesy/units.hpp"
+#include "core/sinex_lines.hpp"
+#include <cstdio>
+
+namespace {
+/* @brief Copy a view's line to a (null-terminated) buffer of
+ * max_sinex_chars characters, so that it can be handed to the line parsers.
+ */
+int copy_line(std::string_view line, char *buf) noexcept {
+  if (line.size() >= (std::size_t)dso::sinex::max_sinex_chars) {
+    fprintf(stderr,
+            "[ERROR] SINEX line too long (%zu characters) (traceback: %s)\n",
+            line.size(), __func__);
+    return 1;
+  }
+  std::memcpy(buf, line.data(), line.size());
+  buf[line.size()] = '\0';
+  return 0;
+}
+
+/* @brief Decode a DDD MM SS.S angle (fields D, M and S) to [rad] */
+template <typename D, typename M, typename S>
+int angle(const char *line, int len, double &rad) noexcept {
+  using namespace dso::sinex::details;
+  int deg, mm;
+  double sec;
+  const char *pos = line;
+  if (field_number<D>(line, len, deg, pos) +
+      field_number<M>(line, len, mm, pos) +
+      field_number<S>(line, len, sec, pos))
+    return 1;
+  rad = dso::hexd2rad(deg, mm, sec, deg);
+  return 0;
+}
+} /* anonymous namespace */
+
+int dso::sinex::SiteIdView::longitude(double &lon) const noexcept {
+  return angle<L::LonDeg, L::LonMin, L::LonSec>(m_line, m_len, lon);
+}
+
+int dso::sinex::SiteIdView::latitude(double &lat) const noexcept {
+  return angle<L::LatDeg, L::LatMin, L::LatSec>(m_line, m_len, lat);
+}
+
+int dso::sinex::SiteIdView::materialize(
+    dso::sinex::SiteId &sid) const noexcept {
+  char buf[max_sinex_chars];
+  return copy_line(line(), buf) || details::parse_site_id_line(buf, sid);
+}
+
+int dso::sinex::SolutionEstimateView::parameter_type_id() const noexcept {
+  /* the field, without leading/trailing whitespaces */
+  std::string_view type = parameter_type();
+  while (!type.empty() && type.front() == ' ')
+    type.remove_prefix(1);
+  while (!type.empty() && type.back() == ' ')
+    type.remove_suffix(1);
+  return sinex::parameter_type_id(type.data(), type.size());
+}
+
+int dso::sinex::SolutionEstimateView::materialize(
+    const dso::datetime<dso::nanoseconds> &sinex_data_start,
+    dso::sinex::SolutionEstimate &est) const noexcept {
+  char buf[max_sinex_chars];
+  return copy_line(line(), buf) ||
+         details::parse_solution_estimate_line(buf, est, sinex_data_start);
+}
@@ -0,0 +1,117 @@
+#include "sinex_estimate_columns.hpp"
+
+namespace {
+/* @brief Unpack (at most) n characters packed via pack_chars */
+void unpack_chars(std::uint64_t key, int n, char *str) noexcept {
+  for (int i = 0; i < n; i++)
+    str[i] = (char)((key >> (8 * i)) & 0xff);
+}
+} /* anonymous namespace */
+
+void dso::sinex::SolutionEstimateColumns::clear() noexcept {
+  m_site_key.clear();
+  m_parameter_type.clear();
+  m_soln_id.clear();
+  m_epoch_mjd.clear();
+  m_epoch_nsec.clear();
+  m_estimate.clear();
+  m_std_deviation.clear();
+  m_index.clear();
+  m_soln_id_chars.clear();
+  m_units.clear();
+  m_constraint.clear();
+}
+
+void dso::sinex::SolutionEstimateColumns::reserve(std::size_t n) {
+  m_site_key.reserve(n);
+  m_parameter_type.reserve(n);
+  m_soln_id.reserve(n);
+  m_epoch_mjd.reserve(n);
+  m_epoch_nsec.reserve(n);
+  m_estimate.reserve(n);
+  m_std_deviation.reserve(n);
+  m_index.reserve(n);
+  m_soln_id_chars.reserve(n);
+  m_units.reserve(n);
+  m_constraint.reserve(n);
+}
+
+void dso::sinex::SolutionEstimateColumns::push_back(
+    const SolutionEstimate &est) {
+  m_site_key.push_back(details::site_key(est.site_code(), est.point_code()));
+  m_parameter_type.push_back((std::int16_t)est.parameter_type_id());
+  m_soln_id.push_back(est.soln_id_int());
+  m_epoch_mjd.push_back(est.epoch().imjd().as_underlying_type());
+  m_epoch_nsec.push_back(est.epoch().sec().as_underlying_type());
+  m_estimate.push_back(est.estimate());
+  m_std_deviation.push_back(est.std_deviation());
+  m_index.push_back(est.index());
+  m_soln_id_chars.push_back(
+      (std::uint32_t)details::pack_chars(est.soln_id(), SOLN_ID_CHAR_SIZE));
+  m_units.push_back((std::uint32_t)details::pack_chars(est.units(), 4));
+  m_constraint.push_back(est.constraint());
+}
+
+void dso::sinex::SolutionEstimateColumns::append(
+    const SolutionEstimateColumns &other) {
+  auto cat = [](auto &column, const auto &other_column) {
+    column.insert(column.end(), other_column.begin(), other_column.end());
+  };
+  cat(m_site_key, other.m_site_key);
+  cat(m_parameter_type, other.m_parameter_type);
+  cat(m_soln_id, other.m_soln_id);
+  cat(m_epoch_mjd, other.m_epoch_mjd);
+  cat(m_epoch_nsec, other.m_epoch_nsec);
+  cat(m_estimate, other.m_estimate);
+  cat(m_std_deviation, other.m_std_deviation);
+  cat(m_index, other.m_index);
+  cat(m_soln_id_chars, other.m_soln_id_chars);
+  cat(m_units, other.m_units);
+  cat(m_constraint, other.m_constraint);
+}
+
+dso::sinex::SolutionEstimate
+dso::sinex::SolutionEstimateColumns::record(std::size_t i) const noexcept {
+  SolutionEstimate est;
+  unpack_chars(m_site_key[i], SITE_CODE_CHAR_SIZE, est.site_code());
+  unpack_chars(m_site_key[i] >> 32, POINT_CODE_CHAR_SIZE, est.point_code());
+  unpack_chars(m_soln_id_chars[i], SOLN_ID_CHAR_SIZE, est.soln_id());
+  unpack_chars(m_units[i], 4, est.units());
+  est.set_parameter_type_id(m_parameter_type[i]);
+  est.index() = m_index[i];
+  est.constraint() = m_constraint[i];
+  est.estimate() = m_estimate[i];
+  est.std_deviation() = m_std_deviation[i];
+  est.epoch() = epoch(i);
+  return est;
+}
+
+void dso::sinex::SolutionEstimateColumns::to_records(
+    std::vector<SolutionEstimate> &records) const {
+  records.clear();
+  records.reserve(size());
+  for (std::size_t i = 0; i < size(); i++)
+    records.push_back(record(i));
+}
+
+std::size_t dso::sinex::SolutionEstimateColumns::select(
+    std::uint64_t site_key, int parameter_type,
+    std::vector<std::uint32_t> &rows) const {
+  const std::size_t n = size();
+  rows.resize(n);
+  /* branch-free scan of the two key columns: every row index is written,
+   * but the output position only advances for matching rows */
+  const bool all_sites = (site_key == any_site);
+  const bool all_types = (parameter_type == any_parameter_type);
+  const std::uint64_t *keys = m_site_key.data();
+  const std::int16_t *types = m_parameter_type.data();
+  std::uint32_t *out = rows.data();
+  std::size_t k = 0;
+  for (std::size_t i = 0; i < n; i++) {
+    out[k] = (std::uint32_t)i;
+    k += (all_sites | (keys[i] == site_key)) &
+         (all_types | (types[i] == parameter_type));
+  }
+  rows.resize(k);
+  return k;
+}
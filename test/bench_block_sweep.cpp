@@ -0,0 +1,125 @@
+#include "sinex.hpp"
+#include "synthetic_sinex.hpp"
+#include "core/sinex_site_key.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+/* Benchmark: Coordinate extrapolation, two scans vs one sweep
+ *
+ * Extrapolate the coordinates of all sites of a synthetic SINEX file. This
+ * is done by collecting the SOLUTION/ESTIMATE records valid at the epoch
+ * (which scans SOLUTION/EPOCHS and then SOLUTION/ESTIMATE) and looking up
+ * the six parameters of each site in the results, and via
+ * dso::Sinex::linear_extrapolate_coordinates (one sweep over both blocks,
+ * collecting parameters in a per-site index).
+ */
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+/* best (min) time of a number of runs of f; f returns non-zero on error */
+template <typename F> double best_time(int repeats, F &&f) {
+  double best = 1e99;
+  for (int r = 0; r < repeats; r++) {
+    auto t0 = Clock::now();
+    if (f())
+      return -1e0;
+    auto t1 = Clock::now();
+    best = std::min(best, std::chrono::duration<double>(t1 - t0).count());
+  }
+  return best;
+}
+} /* anonymous namespace */
+
+int main(int argc, char *argv[]) {
+  const int num_sites = (argc > 1) ? std::atoi(argv[1]) : 20000;
+  const int num_solns = (argc > 2) ? std::atoi(argv[2]) : 5;
+  const int repeats = (argc > 3) ? std::atoi(argv[3]) : 10;
+  const char *fn = "bench_block_sweep.snx";
+
+  if (dso::sinex::test::write_synthetic_sinex(fn, num_sites, num_solns)) {
+    fprintf(stderr, "ERROR. Failed creating synthetic SINEX %s\n", fn);
+    return 1;
+  }
+
+  int error = 0;
+  try {
+    for (auto mode : {dso::SinexIoMode::MemoryMap, dso::SinexIoMode::Stream}) {
+      dso::Sinex snx(fn, mode);
+      std::vector<dso::sinex::SiteId> sites;
+      if (snx.parse_block_site_id(sites)) {
+        fprintf(stderr, "ERROR. Failed parsing SITE/ID\n");
+        ++error;
+        break;
+      }
+      const auto t = dso::datetime<dso::nanoseconds>(
+          dso::year(2005), dso::day_of_year(1), dso::nanoseconds(0));
+
+      int pid[6];
+      const char *p[] = {"STAX", "VELX", "STAY", "VELY", "STAZ", "VELZ"};
+      for (int i = 0; i < 6; i++)
+        pid[i] = dso::sinex::parameter_type_id(p[i], 4);
+      std::vector<double> xyz1;
+      const double t1 = best_time(repeats, [&]() {
+        std::vector<dso::sinex::SolutionEstimate> sols;
+        if (snx.parse_block_solution_estimate(sites, t, true, sols))
+          return 1;
+        const auto map = dso::sinex::details::SiteKeyMap::of_sites(sols);
+        xyz1.clear();
+        for (const auto &site : sites) {
+          const auto key = dso::sinex::details::site_key(site.site_code(),
+                                                         site.point_code());
+          for (int c = 0; c < 6; c += 2) {
+            const int x = map.find_if(key, [&](int i) {
+              return sols[i].parameter_type_id() == pid[c];
+            });
+            const int v = map.find_if(key, [&](int i) {
+              return sols[i].parameter_type_id() == pid[c + 1];
+            });
+            if (x < 0 || v < 0)
+              return 1;
+            const auto dt =
+                t.diff<dso::DateTimeDifferenceType::FractionalYears>(
+                    sols[x].epoch());
+            xyz1.push_back(sols[x].estimate() +
+                           sols[v].estimate() * dt.years());
+          }
+        }
+        return 0;
+      });
+
+      std::vector<dso::Sinex::SiteCoordinateResults> crd;
+      const double t2 = best_time(repeats, [&]() {
+        return snx.linear_extrapolate_coordinates(sites, t, crd);
+      });
+
+      if (crd.size() * 3 != xyz1.size() || crd.size() != sites.size() ||
+          t1 < 0 || t2 < 0) {
+        fprintf(stderr, "ERROR. Results differ\n");
+        ++error;
+      } else {
+        for (std::size_t i = 0; i < crd.size(); i++)
+          if (crd[i].x != xyz1[3 * i] || crd[i].y != xyz1[3 * i + 1] ||
+              crd[i].z != xyz1[3 * i + 2])
+            ++error;
+      }
+
+      printf("%s\n", (mode == dso::SinexIoMode::Stream) ? "Stream"
+                                                         : "MemoryMap");
+      printf("%-32s %12s\n", "Extrapolation", "[ms]");
+      printf("%-32s %12.3f\n", "two scans + lookups", t1 * 1e3);
+      printf("%-32s %12.3f\n", "one sweep, per-site index", t2 * 1e3);
+    }
+  } catch (std::exception &e) {
+    fprintf(stderr, "ERROR. %s\n", e.what());
+    ++error;
+  }
+
+  std::remove(fn);
+  return error;
+}
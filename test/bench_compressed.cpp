@@ -0,0 +1,128 @@
+#include "sinex.hpp"
+#include "synthetic_sinex.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <zlib.h>
+
+/* Benchmark: Open a gzip-compressed SINEX file directly vs decompressing it
+ * to a temporary file first.
+ *
+ * A synthetic SINEX file is created and gzip-compressed. We time (a) the
+ * construction of a dso::Sinex instance off from the compressed file and
+ * (b) decompressing the file to a temporary (uncompressed) file and
+ * constructing a dso::Sinex instance off from it. In both cases, a number of
+ * queries on the SOLUTION/ESTIMATE block follows.
+ */
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+int gzip_file(const char *src, const char *dest) {
+  FILE *fin = std::fopen(src, "rb");
+  gzFile gz = gzopen(dest, "wb");
+  if (!fin || !gz)
+    return 1;
+  char buf[64 * 1024];
+  std::size_t n;
+  while ((n = std::fread(buf, 1, sizeof(buf), fin)) > 0)
+    gzwrite(gz, buf, (unsigned)n);
+  std::fclose(fin);
+  return gzclose(gz) != Z_OK;
+}
+
+int gunzip_file(const char *src, const char *dest) {
+  gzFile gz = gzopen(src, "rb");
+  FILE *fout = std::fopen(dest, "wb");
+  if (!fout || !gz)
+    return 1;
+  char buf[64 * 1024];
+  int n;
+  while ((n = gzread(gz, buf, sizeof(buf))) > 0)
+    std::fwrite(buf, 1, n, fout);
+  gzclose(gz);
+  return std::fclose(fout) != 0;
+}
+
+int query(dso::Sinex &snx, const std::vector<const char *> &sites,
+          int repeats, std::size_t &num_estimates) {
+  std::vector<dso::sinex::SiteId> siteids;
+  if (snx.parse_block_site_id(sites, false, siteids))
+    return 1;
+  std::vector<dso::sinex::SolutionEstimate> estimates;
+  for (int i = 0; i < repeats; i++)
+    if (snx.parse_block_solution_estimate(siteids, estimates))
+      return 1;
+  num_estimates = estimates.size();
+  return 0;
+}
+} /* anonymous namespace */
+
+int main(int argc, char *argv[]) {
+  const int num_sites = (argc > 1) ? std::atoi(argv[1]) : 5000;
+  const int repeats = (argc > 2) ? std::atoi(argv[2]) : 20;
+  const char *fn = "bench_compressed.snx";
+  const char *gz_fn = "bench_compressed.snx.gz";
+  const char *tmp_fn = "bench_compressed.tmp.snx";
+
+  if (dso::sinex::test::write_synthetic_sinex(fn, num_sites, 4) ||
+      gzip_file(fn, gz_fn)) {
+    fprintf(stderr, "ERROR. Failed creating synthetic SINEX %s\n", gz_fn);
+    return 1;
+  }
+  std::remove(fn);
+
+  /* query a few sites, spread over the block */
+  char code[5];
+  std::vector<std::string> names;
+  for (int i = 0; i < num_sites; i += num_sites / 8 + 1)
+    names.emplace_back(dso::sinex::test::synthetic_site_code(i, code));
+  std::vector<const char *> sites;
+  for (const auto &s : names)
+    sites.push_back(s.c_str());
+
+  printf("%-16s %12s %12s %12s\n", "Method", "Open [ms]", "Query [ms]",
+         "Estimates");
+
+  /* (a) open the compressed file */
+  {
+    std::size_t n = 0;
+    auto t0 = Clock::now();
+    dso::Sinex snx(gz_fn);
+    auto t1 = Clock::now();
+    if (query(snx, sites, repeats, n)) {
+      fprintf(stderr, "ERROR. Failed querying SINEX %s\n", gz_fn);
+      return 1;
+    }
+    auto t2 = Clock::now();
+    printf("%-16s %12.3f %12.3f %12zu\n", "Direct",
+           std::chrono::duration<double, std::milli>(t1 - t0).count(),
+           std::chrono::duration<double, std::milli>(t2 - t1).count(), n);
+  }
+
+  /* (b) decompress to a temporary file, then open */
+  {
+    std::size_t n = 0;
+    auto t0 = Clock::now();
+    if (gunzip_file(gz_fn, tmp_fn)) {
+      fprintf(stderr, "ERROR. Failed decompressing SINEX %s\n", gz_fn);
+      return 1;
+    }
+    dso::Sinex snx(tmp_fn);
+    auto t1 = Clock::now();
+    if (query(snx, sites, repeats, n)) {
+      fprintf(stderr, "ERROR. Failed querying SINEX %s\n", tmp_fn);
+      return 1;
+    }
+    auto t2 = Clock::now();
+    printf("%-16s %12.3f %12.3f %12zu\n", "Tmp file",
+           std::chrono::duration<double, std::milli>(t1 - t0).count(),
+           std::chrono::duration<double, std::milli>(t2 - t1).count(), n);
+  }
+
+  std::remove(gz_fn);
+  std::remove(tmp_fn);
+  return 0;
+}
@@ -0,0 +1,151 @@
+#include "sinex.hpp"
+#include "synthetic_sinex.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <vector>
+
+/* Benchmark: Covariance propagation for extrapolated coordinates
+ *
+ * Extrapolate the coordinates of all sites of a synthetic SINEX file to a
+ * number of epochs, without covariances, with covariances propagated per
+ * site (6x6 STA/VEL covariance matrix off from a dso::sinex::ParameterIndex
+ * and J C J^T), and with covariances propagated in one batch (see
+ * dso::Sinex::linear_extrapolate_coordinates). The covariance matrix is
+ * parsed once, beforehand.
+ */
+
+using Clock = std::chrono::steady_clock;
+using Epoch = dso::datetime<dso::nanoseconds>;
+
+namespace {
+/* best (min) time of a number of runs of f; f returns non-zero on error */
+template <typename F> double best_time(int repeats, F &&f) {
+  double best = 1e99;
+  for (int r = 0; r < repeats; r++) {
+    auto t0 = Clock::now();
+    if (f())
+      return -1e0;
+    auto t1 = Clock::now();
+    best = std::min(best, std::chrono::duration<double>(t1 - t0).count());
+  }
+  return best;
+}
+} /* anonymous namespace */
+
+int main(int argc, char *argv[]) {
+  const int num_sites = (argc > 1) ? std::atoi(argv[1]) : 2000;
+  const int num_epochs = (argc > 2) ? std::atoi(argv[2]) : 10;
+  const int repeats = (argc > 3) ? std::atoi(argv[3]) : 3;
+  const char *fn = "bench_extrapolate_covariance.snx";
+
+  if (dso::sinex::test::write_synthetic_sinex(fn, num_sites, 1, true)) {
+    fprintf(stderr, "ERROR. Failed creating synthetic SINEX %s\n", fn);
+    return 1;
+  }
+
+  int error = 0;
+  try {
+    dso::Sinex snx(fn);
+    dso::sinex::SymmetricMatrix packed;
+    std::vector<dso::sinex::SiteId> sites;
+    std::vector<dso::sinex::SolutionEstimate> estimates;
+    dso::sinex::ParameterIndex pidx;
+    if (snx.parse_block_matrix_estimate(dso::sinex::MatrixType::Covariance,
+                                        packed) ||
+        snx.parse_block_site_id(sites) ||
+        snx.parse_block_solution_estimate(sites, estimates) ||
+        pidx.build(estimates)) {
+      fprintf(stderr, "ERROR. Failed parsing SINEX\n");
+      std::remove(fn);
+      return 1;
+    }
+    std::vector<Epoch> epochs;
+    for (int e = 0; e < num_epochs; e++)
+      epochs.emplace_back(dso::year(1995 + (30 * e) / num_epochs),
+                          dso::day_of_year(1 + e % 365),
+                          dso::nanoseconds(0));
+
+    std::vector<dso::Sinex::SiteCoordinateResults> crd;
+    const double t1 = best_time(repeats, [&]() {
+      for (const auto &t : epochs)
+        if (snx.linear_extrapolate_coordinates(sites, t, crd))
+          return 1;
+      return 0;
+    });
+
+    /* per site: J C J^T, J = [I, dt I] */
+    std::vector<double> per_site;
+    const double t2 = best_time(repeats, [&]() {
+      per_site.clear();
+      Eigen::Matrix<double, 6, 6> c;
+      for (const auto &t : epochs) {
+        if (snx.linear_extrapolate_coordinates(sites, t, crd))
+          return 1;
+        for (std::size_t i = 0; i < crd.size(); i++) {
+          if (pidx.sta_vel_covariance(crd[i].msite, crd[i].soln_id(), packed,
+                                      c))
+            return 1;
+          const double dt =
+              t.diff<dso::DateTimeDifferenceType::FractionalYears>(
+                   estimates[6 * i].epoch())
+                  .years();
+          double j[3][6] = {};
+          for (int a = 0; a < 3; a++) {
+            j[a][a] = 1e0;
+            j[a][a + 3] = dt;
+          }
+          for (int a = 0; a < 3; a++) {
+            double s = 0e0;
+            for (int p = 0; p < 6; p++)
+              for (int q = 0; q < 6; q++)
+                s += j[a][p] * c(p, q) * j[a][q];
+            per_site.push_back(std::sqrt(s));
+          }
+        }
+      }
+      return 0;
+    });
+
+    std::vector<double> batched;
+    const double t3 = best_time(repeats, [&]() {
+      batched.clear();
+      for (const auto &t : epochs) {
+        if (snx.linear_extrapolate_coordinates(sites, t, packed, crd))
+          return 1;
+        for (const auto &c : crd) {
+          batched.push_back(c.sx);
+          batched.push_back(c.sy);
+          batched.push_back(c.sz);
+        }
+      }
+      return 0;
+    });
+
+    if (t1 < 0 || t2 < 0 || t3 < 0 || per_site.size() != batched.size()) {
+      fprintf(stderr, "ERROR. Results differ\n");
+      ++error;
+    }
+    for (std::size_t i = 0; i < batched.size() && !error; i++) {
+      if (std::abs(per_site[i] - batched[i]) > 1e-12 * batched[i]) {
+        fprintf(stderr, "ERROR. Results differ\n");
+        ++error;
+      }
+    }
+
+    printf("%d sites, %d epochs\n", (int)sites.size(), num_epochs);
+    printf("%-36s %12s\n", "Extrapolation", "[ms]");
+    printf("%-36s %12.3f\n", "coordinates only", t1 * 1e3);
+    printf("%-36s %12.3f\n", "+ per-site covariance", t2 * 1e3);
+    printf("%-36s %12.3f\n", "+ batched covariance", t3 * 1e3);
+  } catch (std::exception &e) {
+    fprintf(stderr, "ERROR. %s\n", e.what());
+    ++error;
+  }
+
+  std::remove(fn);
+  return error;
+}
@@ -0,0 +1,88 @@
+#include "core/sinex_float.hpp"
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+
+/* Benchmark: Fixed-format float decoding, from_chars_fixed vs from_chars
+ *
+ * Random values are written in the Fortran formats of SOLUTION/ESTIMATE
+ * (E21.15 estimates and E11.6 standard deviations) and of matrix blocks
+ * (E21.14), one after the other as in a SINEX line, and decoded by both
+ * std::from_chars and from_chars_fixed. Results of both are checked to
+ * match; reported is the best time (of a number of repeats) per value.
+ */
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+/* decode all values in buffer; returns ns per value or -1 on error */
+template <typename F>
+double ns_per_value(const std::string &buffer, int num_values, int repeats,
+                    double &sum, F &&decode) {
+  double best = 1e15;
+  for (int r = 0; r < repeats; r++) {
+    const char *p = buffer.data();
+    const char *e = p + buffer.size();
+    auto t0 = Clock::now();
+    for (int i = 0; i < num_values; i++) {
+      double val;
+      while (*p == ' ')
+        ++p;
+      const auto res = decode(p, e, val);
+      if (res.ec != std::errc{})
+        return -1e0;
+      p = res.ptr;
+      sum += val;
+    }
+    auto t1 = Clock::now();
+    const double ns =
+        std::chrono::duration<double, std::nano>(t1 - t0).count() / num_values;
+    best = (ns < best) ? ns : best;
+  }
+  return best;
+}
+} /* anonymous namespace */
+
+int main(int argc, char *argv[]) {
+  const int num_values = (argc > 1) ? std::atoi(argv[1]) : 200000;
+  const int repeats = (argc > 2) ? std::atoi(argv[2]) : 20;
+
+  std::mt19937_64 rng(42);
+  std::uniform_real_distribution<double> mantissa(-1e1, 1e1);
+  std::uniform_int_distribution<int> exponent(-8, 7);
+
+  const char *formats[] = {"%22.15E", "%12.6E", "%22.14E"};
+  const char *names[] = {"E21.15", "E11.6", "E21.14"};
+  printf("%-8s %16s %16s\n", "Format", "from_chars [ns]", "fixed [ns]");
+  for (int f = 0; f < 3; f++) {
+    std::string buffer;
+    char str[64];
+    for (int i = 0; i < num_values; i++) {
+      const double x = mantissa(rng) * std::pow(1e1, exponent(rng));
+      buffer.append(str, std::snprintf(str, sizeof(str), formats[f], x));
+    }
+
+    double s1 = 0e0, s2 = 0e0;
+    const double t1 = ns_per_value(
+        buffer, num_values, repeats, s1,
+        [](const char *p, const char *e, double &val) {
+          return std::from_chars(p, e, val);
+        });
+    const double t2 = ns_per_value(
+        buffer, num_values, repeats, s2,
+        [](const char *p, const char *e, double &val) {
+          return dso::sinex::details::from_chars_fixed(p, e, val);
+        });
+    if (t1 < 0e0 || t2 < 0e0 || s1 != s2) {
+      fprintf(stderr, "ERROR. Decoders disagree for format %s\n", names[f]);
+      return 1;
+    }
+    printf("%-8s %16.1f %16.1f\n", names[f], t1, t2);
+  }
+
+  return 0;
+}
@@ -0,0 +1,82 @@
+#include "sinex.hpp"
+#include "core/sinex_index.hpp"
+#include "synthetic_sinex.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+/* Benchmark: SinexIoMode::Stream vs SinexIoMode::MemoryMap
+ *
+ * A synthetic SINEX file is created, holding a large SOLUTION/ESTIMATE block.
+ * For each I/O mode, we time the construction of the dso::Sinex instance
+ * (i.e. header parsing and block indexing) and a number of repeated queries
+ * on the SOLUTION/ESTIMATE block. The last row re-opens the file using a
+ * (previously written) persistent block index.
+ */
+
+using Clock = std::chrono::steady_clock;
+
+int main(int argc, char *argv[]) {
+  const int num_sites = (argc > 1) ? std::atoi(argv[1]) : 5000;
+  const int repeats = (argc > 2) ? std::atoi(argv[2]) : 200;
+  const char *fn = "bench_io_backend.snx";
+
+  if (dso::sinex::test::write_synthetic_sinex(fn, num_sites, 1)) {
+    fprintf(stderr, "ERROR. Failed creating synthetic SINEX %s\n", fn);
+    return 1;
+  }
+
+  /* query a few sites, spread over the block */
+  char code[5];
+  std::vector<std::string> names;
+  for (int i = 0; i < num_sites; i += num_sites / 8 + 1)
+    names.emplace_back(dso::sinex::test::synthetic_site_code(i, code));
+  std::vector<const char *> sites;
+  for (const auto &s : names)
+    sites.push_back(s.c_str());
+
+  printf("%-10s %12s %12s %12s\n", "Mode", "Open [ms]", "Query [us]",
+         "Estimates");
+  const dso::SinexIoMode modes[] = {dso::SinexIoMode::Stream,
+                                    dso::SinexIoMode::MemoryMap,
+                                    dso::SinexIoMode::MemoryMap};
+  const dso::SinexIndexPolicy policies[] = {dso::SinexIndexPolicy::None,
+                                            dso::SinexIndexPolicy::None,
+                                            dso::SinexIndexPolicy::ReadOnly};
+  const char *mode_names[] = {"Stream", "MemoryMap", "Indexed"};
+  /* write the block index, used by the last run */
+  dso::Sinex(fn, dso::SinexIoMode::MemoryMap,
+             dso::SinexIndexPolicy::ReadWrite);
+  for (int m = 0; m < 3; m++) {
+    auto t0 = Clock::now();
+    dso::Sinex snx(fn, modes[m], policies[m]);
+    auto t1 = Clock::now();
+
+    std::vector<dso::sinex::SiteId> siteids;
+    if (snx.parse_block_site_id(sites, false, siteids)) {
+      fprintf(stderr, "ERROR. Failed matching sites in SINEX file\n");
+      return 1;
+    }
+
+    std::vector<dso::sinex::SolutionEstimate> estimates;
+    auto t2 = Clock::now();
+    for (int i = 0; i < repeats; i++) {
+      if (snx.parse_block_solution_estimate(siteids, estimates)) {
+        fprintf(stderr, "ERROR Failed parsing SOLUTION/ESTIMATES block\n");
+        return 1;
+      }
+    }
+    auto t3 = Clock::now();
+
+    printf("%-10s %12.3f %12.3f %12zu\n", mode_names[m],
+           std::chrono::duration<double, std::milli>(t1 - t0).count(),
+           std::chrono::duration<double, std::micro>(t3 - t2).count() /
+               repeats,
+           estimates.size());
+  }
+
+  std::remove(fn);
+  std::remove(dso::sinex::details::block_index_filename(fn).c_str());
+  return 0;
+}
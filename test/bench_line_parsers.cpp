@@ -0,0 +1,189 @@
+#include "sinex.hpp"
+#include "core/sinex_lines.hpp"
+#include "synthetic_sinex.hpp"
+#include "geodesy/units.hpp"
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/* Benchmark: Line parsers, layout-driven vs hand-coded
+ *
+ * SOLUTION/ESTIMATE and SITE/ID lines of a synthetic SINEX file are parsed
+ * repeatedly, using the (layout-driven) parsers of the library and the
+ * previous, hand-coded ones (kept here as a reference: strlen plus
+ * skip-whitespace/std::from_chars per field, exception-based code
+ * conversions). Results of both are checked to match.
+ */
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+const char *skipws(const char *line) noexcept {
+  while (*line && *line == ' ')
+    ++line;
+  return line;
+}
+
+/* hand-coded SOLUTION/ESTIMATE line parser (reference) */
+int legacy_estimate_line(
+    const char *line, dso::sinex::SolutionEstimate &est,
+    const dso::datetime<dso::nanoseconds> &sinex_data_start) noexcept {
+  int error = 0;
+  const char *end = line + std::strlen(line);
+  auto cv = std::from_chars(skipws(line), end, est.index());
+  error += (cv.ec != std::errc{});
+  int index;
+  if (dso::sinex::parameter_type_exists<
+          dso::sinex::details::ParameterMatchPolicyType::NonStrict>(
+          skipws(line + 7), index))
+    est.set_parameter_type(dso::sinex::parameter_types[index]);
+  else
+    ++error;
+  std::memcpy(est.site_code(), line + 14, 4);
+  std::memcpy(est.point_code(), line + 19, 2);
+  std::memcpy(est.soln_id(), line + 22, 4);
+  error += dso::sinex::parse_sinex_date(line + 27, sinex_data_start,
+                                        est.epoch());
+  std::memcpy(est.units(), line + 40, 4);
+  try {
+    est.constraint() = dso::sinex::char_to_SinexConstraintCode(line[45]);
+  } catch (std::exception &) {
+    ++error;
+  }
+  cv = std::from_chars(skipws(line + 47), end, est.estimate());
+  error += (cv.ec != std::errc{});
+  cv = std::from_chars(skipws(line + 69), end, est.std_deviation());
+  error += (cv.ec != std::errc{});
+  return error;
+}
+
+/* hand-coded SITE/ID line parser (reference) */
+int legacy_site_id_line(const char *line, dso::sinex::SiteId &sid) noexcept {
+  int error = 0;
+  std::memcpy(sid.site_code(), line + 1, 4);
+  std::memcpy(sid.point_code(), line + 6, 2);
+  std::memcpy(sid.domes(), line + 9, 9);
+  try {
+    sid.obscode() = dso::sinex::char_to_SinexObservationCode(line[19]);
+  } catch (std::exception &) {
+    ++error;
+  }
+  std::memcpy(sid.description(), line + 21, 22);
+  int deg, mm;
+  double sec;
+  const char *end = line + std::strlen(line);
+  const char *start = line + 44;
+  for (int k = 0; k < 2; k++) {
+    auto cv = std::from_chars(skipws(start), end, deg);
+    error += (cv.ec != std::errc());
+    cv = std::from_chars(skipws(cv.ptr), end, mm);
+    error += (cv.ec != std::errc());
+    cv = std::from_chars(skipws(cv.ptr), end, sec);
+    error += (cv.ec != std::errc());
+    start = cv.ptr;
+    ((k) ? sid.latitude() : sid.longitude()) =
+        dso::hexd2rad(deg, mm, sec, deg);
+  }
+  auto cv = std::from_chars(skipws(start), end, sid.height());
+  error += (cv.ec != std::errc());
+  return error;
+}
+
+/* collect the data lines of a block */
+std::vector<std::string> block_lines(const char *fn, const char *block) {
+  std::ifstream fin(fn);
+  std::vector<std::string> lines;
+  std::string line;
+  bool in_block = false;
+  while (std::getline(fin, line)) {
+    if (line[0] == '+')
+      in_block = !std::strcmp(line.c_str() + 1, block);
+    else if (line[0] == '-')
+      in_block = false;
+    else if (in_block && line[0] != '*')
+      lines.push_back(line);
+  }
+  return lines;
+}
+
+/* time a line parser; returns lines per second */
+template <typename F>
+double lines_per_sec(const std::vector<std::string> &lines, int repeats,
+                     F &&parse) {
+  auto t0 = Clock::now();
+  for (int r = 0; r < repeats; r++)
+    for (const auto &l : lines)
+      if (parse(l.c_str()))
+        return -1e0;
+  auto t1 = Clock::now();
+  return (double)lines.size() * repeats /
+         std::chrono::duration<double>(t1 - t0).count();
+}
+} /* anonymous namespace */
+
+int main(int argc, char *argv[]) {
+  const int num_sites = (argc > 1) ? std::atoi(argv[1]) : 2000;
+  const int repeats = (argc > 2) ? std::atoi(argv[2]) : 50;
+  const char *fn = "bench_line_parsers.snx";
+
+  if (dso::sinex::test::write_synthetic_sinex(fn, num_sites, 1)) {
+    fprintf(stderr, "ERROR. Failed creating synthetic SINEX %s\n", fn);
+    return 1;
+  }
+  const auto estimate_lines = block_lines(fn, "SOLUTION/ESTIMATE");
+  const auto site_lines = block_lines(fn, "SITE/ID");
+  std::remove(fn);
+
+  const auto t0 = dso::datetime<dso::nanoseconds>::min();
+  dso::sinex::SolutionEstimate e1, e2;
+  dso::sinex::SiteId s1, s2;
+
+  /* check that both parsers agree */
+  for (const auto &l : estimate_lines) {
+    if (legacy_estimate_line(l.c_str(), e1, t0) ||
+        dso::sinex::details::parse_solution_estimate_line(l.c_str(), e2,
+                                                          t0) ||
+        (e1.estimate() != e2.estimate()) ||
+        (e1.std_deviation() != e2.std_deviation()) ||
+        (e1.index() != e2.index()) || (e1.epoch() != e2.epoch())) {
+      fprintf(stderr, "ERROR. Parsers disagree on line \"%s\"\n", l.c_str());
+      return 1;
+    }
+  }
+  for (const auto &l : site_lines) {
+    if (legacy_site_id_line(l.c_str(), s1) ||
+        dso::sinex::details::parse_site_id_line(l.c_str(), s2) ||
+        (s1.longitude() != s2.longitude()) ||
+        (s1.latitude() != s2.latitude()) || (s1.height() != s2.height())) {
+      fprintf(stderr, "ERROR. Parsers disagree on line \"%s\"\n", l.c_str());
+      return 1;
+    }
+  }
+
+  printf("%-20s %16s %16s\n", "Block", "Hand-coded [l/s]", "Layout [l/s]");
+  printf("%-20s %16.0f %16.0f\n", "SOLUTION/ESTIMATE",
+         lines_per_sec(estimate_lines, repeats,
+                       [&](const char *l) {
+                         return legacy_estimate_line(l, e1, t0);
+                       }),
+         lines_per_sec(estimate_lines, repeats, [&](const char *l) {
+           return dso::sinex::details::parse_solution_estimate_line(l, e2,
+                                                                    t0);
+         }));
+  printf("%-20s %16.0f %16.0f\n", "SITE/ID",
+         lines_per_sec(site_lines, repeats * 6,
+                       [&](const char *l) {
+                         return legacy_site_id_line(l, s1);
+                       }),
+         lines_per_sec(site_lines, repeats * 6, [&](const char *l) {
+           return dso::sinex::details::parse_site_id_line(l, s2);
+         }));
+
+  return 0;
+}
@@ -0,0 +1,83 @@
+#include "sinex.hpp"
+#include "synthetic_sinex.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+
+/* Benchmark: Parsing SOLUTION/MATRIX_ESTIMATE into packed storage
+ *
+ * Parse the covariance matrix of a synthetic SINEX file (see
+ * dso::Sinex::parse_block_matrix_estimate), using one thread and as many
+ * threads as the hardware allows, and report the memory of the packed
+ * matrix against a dense one.
+ */
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+/* best (min) time of a number of runs of f; f returns non-zero on error */
+template <typename F> double best_time(int repeats, F &&f) {
+  double best = 1e99;
+  for (int r = 0; r < repeats; r++) {
+    auto t0 = Clock::now();
+    if (f())
+      return -1e0;
+    auto t1 = Clock::now();
+    best = std::min(best, std::chrono::duration<double>(t1 - t0).count());
+  }
+  return best;
+}
+} /* anonymous namespace */
+
+int main(int argc, char *argv[]) {
+  const int num_sites = (argc > 1) ? std::atoi(argv[1]) : 100;
+  const int num_solns = (argc > 2) ? std::atoi(argv[2]) : 3;
+  const int repeats = (argc > 3) ? std::atoi(argv[3]) : 5;
+  const char *fn = "bench_matrix_estimate.snx";
+
+  if (dso::sinex::test::write_synthetic_sinex(fn, num_sites, num_solns,
+                                               true)) {
+    fprintf(stderr, "ERROR. Failed creating synthetic SINEX %s\n", fn);
+    return 1;
+  }
+
+  int error = 0;
+  try {
+    for (auto mode : {dso::SinexIoMode::MemoryMap, dso::SinexIoMode::Stream}) {
+      dso::Sinex snx(fn, mode);
+      dso::sinex::SymmetricMatrix m;
+      const auto type = dso::sinex::MatrixType::Covariance;
+      const double t1 = best_time(repeats, [&]() {
+        return snx.parse_block_matrix_estimate(type, m, 1);
+      });
+      const double t2 = best_time(repeats, [&]() {
+        return snx.parse_block_matrix_estimate(type, m, 0);
+      });
+      if (t1 < 0 || t2 < 0) {
+        fprintf(stderr, "ERROR. Failed parsing matrix\n");
+        ++error;
+        break;
+      }
+
+      const double n = m.rows();
+      printf("%s, %d x %d matrix\n",
+             (mode == dso::SinexIoMode::Stream) ? "Stream" : "MemoryMap",
+             m.rows(), m.cols());
+      printf("%-32s %12s %12s\n", "Parsing", "[ms]", "[MB]");
+      printf("%-32s %12.3f %12.3f\n", "packed, one thread", t1 * 1e3,
+             m.size() * sizeof(double) / 1e6);
+      printf("%-32s %12.3f %12.3f\n", "packed, all threads", t2 * 1e3,
+             m.size() * sizeof(double) / 1e6);
+      printf("%-32s %12s %12.3f\n", "(dense)", "-",
+             n * n * sizeof(double) / 1e6);
+    }
+  } catch (std::exception &e) {
+    fprintf(stderr, "ERROR. %s\n", e.what());
+    ++error;
+  }
+
+  std::remove(fn);
+  return error;
+}
@@ -0,0 +1,104 @@
+#include "sinex.hpp"
+#include "synthetic_sinex.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <vector>
+
+/* Benchmark: Covariance matrix of a subset of sites
+ *
+ * Get the covariance matrix of the parameters of some sites of a synthetic
+ * SINEX file, by parsing the whole matrix (packed storage) and extracting
+ * the sub-matrix, and by streaming extraction of the sub-matrix (see
+ * dso::Sinex::parse_block_matrix_estimate).
+ */
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+/* best (min) time of a number of runs of f; f returns non-zero on error */
+template <typename F> double best_time(int repeats, F &&f) {
+  double best = 1e99;
+  for (int r = 0; r < repeats; r++) {
+    auto t0 = Clock::now();
+    if (f())
+      return -1e0;
+    auto t1 = Clock::now();
+    best = std::min(best, std::chrono::duration<double>(t1 - t0).count());
+  }
+  return best;
+}
+} /* anonymous namespace */
+
+int main(int argc, char *argv[]) {
+  const int num_sites = (argc > 1) ? std::atoi(argv[1]) : 400;
+  const int num_subset = (argc > 2) ? std::atoi(argv[2]) : 40;
+  const int repeats = (argc > 3) ? std::atoi(argv[3]) : 5;
+  const char *fn = "bench_matrix_subset.snx";
+
+  if (dso::sinex::test::write_synthetic_sinex(fn, num_sites, 1, true)) {
+    fprintf(stderr, "ERROR. Failed creating synthetic SINEX %s\n", fn);
+    return 1;
+  }
+
+  int error = 0;
+  try {
+    for (auto mode : {dso::SinexIoMode::MemoryMap, dso::SinexIoMode::Stream}) {
+      dso::Sinex snx(fn, mode);
+      std::vector<dso::sinex::SiteId> sites, subset;
+      std::vector<dso::sinex::SolutionEstimate> estimates;
+      if (snx.parse_block_site_id(sites)) {
+        fprintf(stderr, "ERROR. Failed parsing SITE/ID\n");
+        ++error;
+        break;
+      }
+      const int step = std::max(1, num_sites / std::max(1, num_subset));
+      for (std::size_t i = 0; i < sites.size(); i += step)
+        subset.push_back(sites[i]);
+      if (snx.parse_block_solution_estimate(subset, estimates)) {
+        fprintf(stderr, "ERROR. Failed parsing SOLUTION/ESTIMATE\n");
+        ++error;
+        break;
+      }
+      std::vector<int> idx;
+      for (const auto &e : estimates)
+        idx.push_back(e.index() - 1);
+
+      const auto type = dso::sinex::MatrixType::Covariance;
+      Eigen::MatrixXd sub1, sub2;
+      const double t1 = best_time(repeats, [&]() {
+        dso::sinex::SymmetricMatrix packed;
+        if (snx.parse_block_matrix_estimate(type, packed))
+          return 1;
+        packed.to_dense(idx, sub1);
+        return 0;
+      });
+      const double t2 = best_time(repeats, [&]() {
+        return snx.parse_block_matrix_estimate(type, estimates, sub2);
+      });
+
+      if (t1 < 0 || t2 < 0 || sub1 != sub2) {
+        fprintf(stderr, "ERROR. Results differ\n");
+        ++error;
+      }
+
+      const double n = 6 * num_sites;
+      printf("%s, %d x %d sub-matrix of %.0f x %.0f matrix\n",
+             (mode == dso::SinexIoMode::Stream) ? "Stream" : "MemoryMap",
+             (int)idx.size(), (int)idx.size(), n, n);
+      printf("%-32s %12s %12s\n", "Sub-matrix", "[ms]", "[MB]");
+      printf("%-32s %12.3f %12.3f\n", "full matrix + extraction", t1 * 1e3,
+             n * (n + 1) / 2 * sizeof(double) / 1e6);
+      printf("%-32s %12.3f %12.3f\n", "streaming extraction", t2 * 1e3,
+             (double)sub2.size() * sizeof(double) / 1e6);
+    }
+  } catch (std::exception &e) {
+    fprintf(stderr, "ERROR. %s\n", e.what());
+    ++error;
+  }
+
+  std::remove(fn);
+  return error;
+}
@@ -0,0 +1,103 @@
+#include "sinex.hpp"
+#include "synthetic_sinex.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+/* Benchmark: Parallel (chunked) parsing of SOLUTION/ESTIMATE
+ *
+ * Parse the SOLUTION/ESTIMATE block of a synthetic SINEX file, for all
+ * sites, using 1 up to N threads (N defaults to the number of hardware
+ * threads), both to records and to columns. Results are checked against
+ * the serial path; throughput and speedup are reported per thread count.
+ */
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+/* best (min) time of a number of runs of f; f returns non-zero on error */
+template <typename F> double best_time(int repeats, F &&f) {
+  double best = 1e99;
+  for (int r = 0; r < repeats; r++) {
+    auto t0 = Clock::now();
+    if (f())
+      return -1e0;
+    auto t1 = Clock::now();
+    best = std::min(best, std::chrono::duration<double>(t1 - t0).count());
+  }
+  return best;
+}
+} /* anonymous namespace */
+
+int main(int argc, char *argv[]) {
+  const int num_sites = (argc > 1) ? std::atoi(argv[1]) : 20000;
+  const int num_solns = (argc > 2) ? std::atoi(argv[2]) : 5;
+  const int repeats = (argc > 3) ? std::atoi(argv[3]) : 5;
+  const int max_threads =
+      (argc > 4) ? std::atoi(argv[4])
+                 : std::max(1, (int)std::thread::hardware_concurrency());
+  const char *fn = "bench_parallel_parse.snx";
+
+  if (dso::sinex::test::write_synthetic_sinex(fn, num_sites, num_solns)) {
+    fprintf(stderr, "ERROR. Failed creating synthetic SINEX %s\n", fn);
+    return 1;
+  }
+
+  int error = 0;
+  try {
+    dso::Sinex snx(fn);
+    std::vector<dso::sinex::SiteId> sites;
+    std::vector<dso::sinex::SolutionEstimate> serial, estimates;
+    if (snx.parse_block_site_id(sites) ||
+        snx.parse_block_solution_estimate(sites, serial)) {
+      fprintf(stderr, "ERROR. Failed parsing SINEX %s\n", fn);
+      std::remove(fn);
+      return 1;
+    }
+
+    const double num_params = 6e0 * num_sites * num_solns;
+    printf("%-8s %14s %8s %14s %8s\n", "Threads", "[records/s]", "speedup",
+           "[columns/s]", "speedup");
+    double t1 = 0e0, c1 = 0e0;
+    for (int nt = 1; nt <= max_threads; nt++) {
+      const double t = best_time(repeats, [&]() {
+        return snx.parse_block_solution_estimate(
+            sites, estimates, dso::sinex::QueryPredicate(), nullptr, nt);
+      });
+      dso::sinex::SolutionEstimateColumns columns;
+      const double c = best_time(repeats, [&]() {
+        return snx.parse_block_solution_estimate(
+            columns, dso::sinex::QueryPredicate(), nullptr, nt);
+      });
+      if (t < 0e0 || c < 0e0 || estimates.size() != serial.size() ||
+          columns.size() != serial.size()) {
+        fprintf(stderr, "ERROR. Parsing with %d threads failed\n", nt);
+        ++error;
+        break;
+      }
+      for (std::size_t i = 0; i < serial.size(); i++)
+        if (estimates[i].estimate() != serial[i].estimate() ||
+            columns.estimates()[i] != serial[i].estimate()) {
+          fprintf(stderr, "ERROR. Results with %d threads differ\n", nt);
+          ++error;
+          break;
+        }
+      if (nt == 1) {
+        t1 = t;
+        c1 = c;
+      }
+      printf("%-8d %14.0f %8.2f %14.0f %8.2f\n", nt, num_params / t, t1 / t,
+             num_params / c, c1 / c);
+    }
+  } catch (std::exception &e) {
+    fprintf(stderr, "ERROR. %s\n", e.what());
+    ++error;
+  }
+
+  std::remove(fn);
+  return error;
+}
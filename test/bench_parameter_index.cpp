@@ -0,0 +1,114 @@
+#include "sinex.hpp"
+#include "synthetic_sinex.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+/* Benchmark: Per-site 6x6 STA/VEL covariance lookup
+ *
+ * Fetch the 6x6 STA/VEL covariance matrix of every site of a synthetic
+ * SINEX file off from the parsed (packed) matrix, by searching the
+ * SOLUTION/ESTIMATE records for the site's parameters, and via a
+ * dso::sinex::ParameterIndex.
+ */
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+/* best (min) time of a number of runs of f; f returns non-zero on error */
+template <typename F> double best_time(int repeats, F &&f) {
+  double best = 1e99;
+  for (int r = 0; r < repeats; r++) {
+    auto t0 = Clock::now();
+    if (f())
+      return -1e0;
+    auto t1 = Clock::now();
+    best = std::min(best, std::chrono::duration<double>(t1 - t0).count());
+  }
+  return best;
+}
+} /* anonymous namespace */
+
+int main(int argc, char *argv[]) {
+  const int num_sites = (argc > 1) ? std::atoi(argv[1]) : 400;
+  const int repeats = (argc > 2) ? std::atoi(argv[2]) : 5;
+  const char *fn = "bench_parameter_index.snx";
+  const char *soln = "   1";
+
+  if (dso::sinex::test::write_synthetic_sinex(fn, num_sites, 1, true)) {
+    fprintf(stderr, "ERROR. Failed creating synthetic SINEX %s\n", fn);
+    return 1;
+  }
+
+  int error = 0;
+  try {
+    dso::Sinex snx(fn);
+    dso::sinex::SymmetricMatrix packed;
+    std::vector<dso::sinex::SiteId> sites;
+    std::vector<dso::sinex::SolutionEstimate> estimates;
+    if (snx.parse_block_matrix_estimate(dso::sinex::MatrixType::Covariance,
+                                        packed) ||
+        snx.parse_block_site_id(sites) ||
+        snx.parse_block_solution_estimate(sites, estimates)) {
+      fprintf(stderr, "ERROR. Failed parsing SINEX\n");
+      std::remove(fn);
+      return 1;
+    }
+    int types[6];
+    const char *ptypes[] = {"STAX", "STAY", "STAZ", "VELX", "VELY", "VELZ"};
+    for (int p = 0; p < 6; p++)
+      types[p] = dso::sinex::parameter_type_id(ptypes[p], 4);
+
+    std::vector<Eigen::Matrix<double, 6, 6>> cov1(sites.size()),
+        cov2(sites.size());
+    const double t1 = best_time(repeats, [&]() {
+      for (std::size_t i = 0; i < sites.size(); i++) {
+        int idx[6] = {0, 0, 0, 0, 0, 0};
+        for (const auto &e : estimates) {
+          if (!std::strncmp(e.site_code(), sites[i].site_code(), 4) &&
+              !std::strncmp(e.point_code(), sites[i].point_code(), 2) &&
+              !std::strncmp(e.soln_id(), soln, 4)) {
+            for (int p = 0; p < 6; p++)
+              if (e.parameter_type_id() == types[p])
+                idx[p] = e.index();
+          }
+        }
+        for (int c = 0; c < 6; c++)
+          for (int r = 0; r < 6; r++)
+            cov1[i](r, c) = packed(idx[r] - 1, idx[c] - 1);
+      }
+      return 0;
+    });
+
+    dso::sinex::ParameterIndex pidx;
+    const double tb =
+        best_time(repeats, [&]() { return pidx.build(estimates); });
+    const double t2 = best_time(repeats, [&]() {
+      for (std::size_t i = 0; i < sites.size(); i++)
+        if (pidx.sta_vel_covariance(sites[i], soln, packed, cov2[i]))
+          return 1;
+      return 0;
+    });
+
+    if (t1 < 0 || tb < 0 || t2 < 0 || cov1 != cov2) {
+      fprintf(stderr, "ERROR. Results differ\n");
+      ++error;
+    }
+
+    printf("6x6 STA/VEL covariance of %d sites\n", (int)sites.size());
+    printf("%-32s %12s\n", "Lookup", "[ms]");
+    printf("%-32s %12.3f\n", "search estimates", t1 * 1e3);
+    printf("%-32s %12.3f\n", "parameter index (build)", tb * 1e3);
+    printf("%-32s %12.3f\n", "parameter index (lookup)", t2 * 1e3);
+  } catch (std::exception &e) {
+    fprintf(stderr, "ERROR. %s\n", e.what());
+    ++error;
+  }
+
+  std::remove(fn);
+  return error;
+}
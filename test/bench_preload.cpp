@@ -0,0 +1,93 @@
+#include "sinex.hpp"
+#include "synthetic_sinex.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <vector>
+
+/* Benchmark: Preloading blocks vs parsing on demand
+ *
+ * Open a synthetic SINEX file and answer a fixed sequence of queries
+ * (SITE/ID, SOLUTION/EPOCHS, SOLUTION/ESTIMATE and SITE/ECCENTRICITY for
+ * all sites), either parsing each block on demand or preloading all four
+ * blocks in the background right after construction. Reported are the
+ * time to the first answer (SITE/ID) and to the last one, from the start of
+ * construction.
+ */
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+struct Timing {
+  double first = 1e99;
+  double total = 1e99;
+};
+
+int run(const char *fn, bool preload, Timing &timing) {
+  const auto t0 = Clock::now();
+  dso::Sinex snx(fn);
+  if (preload && snx.preload({"SITE/ID", "SOLUTION/EPOCHS",
+                              "SOLUTION/ESTIMATE", "SITE/ECCENTRICITY"}))
+    return 1;
+
+  std::vector<dso::sinex::SiteId> sites;
+  if (snx.parse_block_site_id(sites))
+    return 1;
+  const auto t1 = Clock::now();
+
+  const auto t = dso::datetime<dso::nanoseconds>(
+      dso::year(2005), dso::day_of_year(1), dso::nanoseconds(0));
+  std::vector<dso::sinex::SolutionEpoch> epochs;
+  std::vector<dso::sinex::SolutionEstimate> estimates;
+  std::vector<dso::sinex::SiteEccentricity> eccs;
+  if (snx.parse_solution_epoch(sites, t, true, epochs) ||
+      snx.parse_block_solution_estimate(sites, estimates) ||
+      snx.parse_block_site_eccentricity(sites, t, eccs))
+    return 1;
+  const auto t2 = Clock::now();
+
+  timing.first = std::min(
+      timing.first, std::chrono::duration<double>(t1 - t0).count());
+  timing.total = std::min(
+      timing.total, std::chrono::duration<double>(t2 - t0).count());
+  return 0;
+}
+} /* anonymous namespace */
+
+int main(int argc, char *argv[]) {
+  const int num_sites = (argc > 1) ? std::atoi(argv[1]) : 20000;
+  const int num_solns = (argc > 2) ? std::atoi(argv[2]) : 5;
+  const int repeats = (argc > 3) ? std::atoi(argv[3]) : 10;
+  const char *fn = "bench_preload.snx";
+
+  if (dso::sinex::test::write_synthetic_sinex(fn, num_sites, num_solns)) {
+    fprintf(stderr, "ERROR. Failed creating synthetic SINEX %s\n", fn);
+    return 1;
+  }
+
+  int error = 0;
+  try {
+    Timing on_demand, preloaded;
+    for (int r = 0; r < repeats && !error; r++) {
+      error += run(fn, false, on_demand);
+      error += run(fn, true, preloaded);
+    }
+    if (error) {
+      fprintf(stderr, "ERROR. Failed querying SINEX %s\n", fn);
+    } else {
+      printf("%-24s %14s %14s\n", "Mode", "first [ms]", "all [ms]");
+      printf("%-24s %14.3f %14.3f\n", "on demand", on_demand.first * 1e3,
+             on_demand.total * 1e3);
+      printf("%-24s %14.3f %14.3f\n", "preload", preloaded.first * 1e3,
+             preloaded.total * 1e3);
+    }
+  } catch (std::exception &e) {
+    fprintf(stderr, "ERROR. %s\n", e.what());
+    ++error;
+  }
+
+  std::remove(fn);
+  return error;
+}
@@ -0,0 +1,101 @@
+#include "sinex.hpp"
+#include "synthetic_sinex.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+/* Benchmark: Query predicates vs parse-then-filter
+ *
+ * Collect the STAX and STAY estimates of solution 1 for all sites off the
+ * SOLUTION/ESTIMATE block of a synthetic SINEX file. This is done by
+ * parsing the block and filtering the decoded records afterwards, and by
+ * passing the same conditions to the block parser as a
+ * sinex::QueryPredicate (so that rejected lines are never decoded).
+ */
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+/* best (min) time of a number of runs of f; f returns non-zero on error */
+template <typename F> double best_time(int repeats, F &&f) {
+  double best = 1e99;
+  for (int r = 0; r < repeats; r++) {
+    auto t0 = Clock::now();
+    if (f())
+      return -1e0;
+    auto t1 = Clock::now();
+    best = std::min(best, std::chrono::duration<double>(t1 - t0).count());
+  }
+  return best;
+}
+} /* anonymous namespace */
+
+int main(int argc, char *argv[]) {
+  const int num_sites = (argc > 1) ? std::atoi(argv[1]) : 20000;
+  const int num_solns = (argc > 2) ? std::atoi(argv[2]) : 5;
+  const int repeats = (argc > 3) ? std::atoi(argv[3]) : 10;
+  const char *fn = "bench_query_predicate.snx";
+
+  if (dso::sinex::test::write_synthetic_sinex(fn, num_sites, num_solns)) {
+    fprintf(stderr, "ERROR. Failed creating synthetic SINEX %s\n", fn);
+    return 1;
+  }
+
+  int error = 0;
+  try {
+    dso::Sinex snx(fn);
+
+    std::vector<dso::sinex::SiteId> sites;
+    if (snx.parse_block_site_id(sites)) {
+      fprintf(stderr, "ERROR. Failed parsing SITE/ID\n");
+      std::remove(fn);
+      return 1;
+    }
+
+    const int stax = dso::sinex::parameter_type_id("STAX", 4);
+    const int stay = dso::sinex::parameter_type_id("STAY", 4);
+    std::vector<dso::sinex::SolutionEstimate> estimates, x1, x2;
+    const double t1 = best_time(repeats, [&]() {
+      x1.clear();
+      if (snx.parse_block_solution_estimate(sites, estimates))
+        return 1;
+      for (const auto &e : estimates)
+        if ((e.parameter_type_id() == stax ||
+             e.parameter_type_id() == stay) &&
+            e.soln_id_int() == 1)
+          x1.push_back(e);
+      return 0;
+    });
+
+    const auto query = dso::sinex::QueryPredicate()
+                           .parameter_types({"STAX", "STAY"})
+                           .soln_ids({"1"});
+    dso::sinex::QueryStats stats;
+    const double t2 = best_time(repeats, [&]() {
+      stats = dso::sinex::QueryStats();
+      return snx.parse_block_solution_estimate(sites, x2, query, &stats);
+    });
+
+    if (x1.size() != x2.size() || x1.size() != 2 * sites.size()) {
+      fprintf(stderr, "ERROR. Results differ (%zu vs %zu records)\n",
+              x1.size(), x2.size());
+      ++error;
+    }
+
+    printf("%-32s %12s\n", "Scan", "[ms]");
+    printf("%-32s %12.3f\n", "parse, then filter", t1 * 1e3);
+    printf("%-32s %12.3f\n", "query predicate", t2 * 1e3);
+    printf("lines skipped: %ld, decoded: %ld\n", stats.lines_skipped,
+           stats.lines_decoded);
+  } catch (std::exception &e) {
+    fprintf(stderr, "ERROR. %s\n", e.what());
+    ++error;
+  }
+
+  std::remove(fn);
+  return error;
+}
@@ -0,0 +1,135 @@
+#include "sinex.hpp"
+#include "synthetic_sinex.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/* Benchmark: Record views vs block parsers
+ *
+ * Scan the SITE/ID and SOLUTION/ESTIMATE blocks of a synthetic SINEX file
+ * for a few fields only: site codes plus DOMES, and the STAX estimates of
+ * all sites. Each scan is done via the block parsers (decoding every field
+ * of every record) and via record views (decoding only the fields needed).
+ * Results of both are checked to match; throughput is reported in records
+ * and in block megabytes per second.
+ */
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+/* best (min) time of a number of runs of f; f returns non-zero on error */
+template <typename F> double best_time(int repeats, F &&f) {
+  double best = 1e99;
+  for (int r = 0; r < repeats; r++) {
+    auto t0 = Clock::now();
+    if (f())
+      return -1e0;
+    auto t1 = Clock::now();
+    best = std::min(best, std::chrono::duration<double>(t1 - t0).count());
+  }
+  return best;
+}
+
+void report(const char *what, long records, double mbytes, double sec) {
+  printf("%-32s %12.0f %12.1f\n", what, records / sec, mbytes / sec);
+}
+} /* anonymous namespace */
+
+int main(int argc, char *argv[]) {
+  const int num_sites = (argc > 1) ? std::atoi(argv[1]) : 20000;
+  const int num_solns = (argc > 2) ? std::atoi(argv[2]) : 5;
+  const int repeats = (argc > 3) ? std::atoi(argv[3]) : 10;
+  const char *fn = "bench_record_views.snx";
+
+  if (dso::sinex::test::write_synthetic_sinex(fn, num_sites, num_solns)) {
+    fprintf(stderr, "ERROR. Failed creating synthetic SINEX %s\n", fn);
+    return 1;
+  }
+
+  int error = 0;
+  try {
+    dso::Sinex snx(fn);
+    double site_mb = 0e0, est_mb = 0e0;
+    for (const auto &blk : snx.blocks()) {
+      if (!std::strcmp(blk.mtype, "SITE/ID"))
+        site_mb = (blk.mend - blk.mdata) * 1e-6;
+      else if (!std::strcmp(blk.mtype, "SOLUTION/ESTIMATE"))
+        est_mb = (blk.mend - blk.mdata) * 1e-6;
+    }
+
+    /* site codes plus DOMES */
+    std::vector<dso::sinex::SiteId> sites;
+    std::vector<std::string> ids1, ids2;
+    const double t1 = best_time(repeats, [&]() {
+      ids1.clear();
+      if (snx.parse_block_site_id(sites))
+        return 1;
+      for (const auto &s : sites)
+        ids1.emplace_back(std::string(s.site_code()) + s.domes());
+      return 0;
+    });
+    const double t2 = best_time(repeats, [&]() {
+      ids2.clear();
+      dso::sinex::RecordRange<dso::sinex::SiteIdView> views;
+      if (snx.view_block(views))
+        return 1;
+      for (const auto v : views)
+        ids2.emplace_back(std::string(v.site_code()).append(v.domes()));
+      return 0;
+    });
+    if (ids1 != ids2 || ids1.size() != (std::size_t)num_sites) {
+      fprintf(stderr, "ERROR. SITE/ID scans differ\n");
+      ++error;
+    }
+
+    /* STAX estimates */
+    const int stax = dso::sinex::parameter_type_id("STAX", 4);
+    std::vector<dso::sinex::SolutionEstimate> estimates;
+    std::vector<double> x1, x2;
+    const double t3 = best_time(repeats, [&]() {
+      x1.clear();
+      if (snx.parse_block_solution_estimate(sites, estimates))
+        return 1;
+      for (const auto &est : estimates)
+        if (est.parameter_type_id() == stax)
+          x1.push_back(est.estimate());
+      return 0;
+    });
+    const double t4 = best_time(repeats, [&]() {
+      x2.clear();
+      dso::sinex::RecordRange<dso::sinex::SolutionEstimateView> views;
+      if (snx.view_block(views))
+        return 1;
+      double x;
+      for (const auto v : views)
+        if (v.parameter_type_id() == stax) {
+          if (v.estimate(x))
+            return 1;
+          x2.push_back(x);
+        }
+      return 0;
+    });
+    if (x1 != x2 || x1.size() != (std::size_t)num_sites * num_solns) {
+      fprintf(stderr, "ERROR. SOLUTION/ESTIMATE scans differ\n");
+      ++error;
+    }
+
+    const long num_params = 6L * num_sites * num_solns;
+    printf("%-32s %12s %12s\n", "Scan", "[records/s]", "[MB/s]");
+    report("SITE/ID, block parser", num_sites, site_mb, t1);
+    report("SITE/ID, views", num_sites, site_mb, t2);
+    report("SOLUTION/ESTIMATE, block parser", num_params, est_mb, t3);
+    report("SOLUTION/ESTIMATE, views", num_params, est_mb, t4);
+  } catch (std::exception &e) {
+    fprintf(stderr, "ERROR. %s\n", e.what());
+    ++error;
+  }
+
+  std::remove(fn);
+  return error;
+}
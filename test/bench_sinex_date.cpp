@@ -0,0 +1,125 @@
+#include "sinex.hpp"
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/* Benchmark: SINEX datetime strings
+ *
+ * Lines holding two dates ("YY:DDD:SSSSS YY:DDD:SSSSS", as in the
+ * DATA_START/DATA_END columns of most blocks) are resolved repeatedly,
+ * using: the previous, generic parser (kept here as a reference: strlen,
+ * std::from_chars per value, and a datetime constructed off year/day of
+ * year inside a try/catch block), parse_sinex_date and parse_sinex_dates
+ * (i.e. both dates at once). Results of all are checked to match.
+ */
+
+using Clock = std::chrono::steady_clock;
+using Datetime = dso::datetime<dso::nanoseconds>;
+
+namespace {
+/* generic SINEX date parser (reference) */
+int legacy_sinex_date(const char *str, const Datetime &tdefault,
+                      Datetime &t) noexcept {
+  int yr, doy;
+  long sec = 0;
+  int error = 0;
+  while (*str && *str == ' ')
+    ++str;
+  const char *end = str + std::strlen(str);
+  auto cr = std::from_chars(str, end, yr);
+  error += (cr.ec != std::errc{});
+  str = cr.ptr + 1;
+  cr = std::from_chars(str, end, doy);
+  error += (cr.ec != std::errc{});
+  str = cr.ptr + 1;
+  cr = std::from_chars(str, end, sec);
+  error += (cr.ec != std::errc{});
+  if (error)
+    return error;
+  t = tdefault;
+  if (!((yr == 0) && (doy == 0) && (sec == 0))) {
+    yr += (yr <= 50) ? 2000 : 1900;
+    try {
+      t = Datetime(dso::year(yr), dso::day_of_year(doy),
+                   dso::nanoseconds(sec * 1000000000L));
+    } catch (std::exception &) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/* time a date parser; returns dates per second */
+template <typename F>
+double dates_per_sec(const std::vector<std::string> &lines, int repeats,
+                     F &&parse) {
+  auto t0 = Clock::now();
+  for (int r = 0; r < repeats; r++)
+    for (const auto &l : lines)
+      if (parse(l.c_str()))
+        return -1e0;
+  auto t1 = Clock::now();
+  return 2e0 * lines.size() * repeats /
+         std::chrono::duration<double>(t1 - t0).count();
+}
+} /* anonymous namespace */
+
+int main(int argc, char *argv[]) {
+  const int num_lines = (argc > 1) ? std::atoi(argv[1]) : 100000;
+  const int repeats = (argc > 2) ? std::atoi(argv[2]) : 20;
+
+  /* random dates in [1951, 2050] */
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<int> yy(0, 99), doy(1, 365), sec(0, 86399);
+  std::vector<std::string> lines;
+  char buf[64];
+  for (int i = 0; i < num_lines; i++) {
+    std::snprintf(buf, sizeof(buf), "%02d:%03d:%05d %02d:%03d:%05d", yy(rng),
+                  doy(rng), sec(rng), yy(rng), doy(rng), sec(rng));
+    lines.emplace_back(buf);
+  }
+
+  const Datetime tmin = Datetime::min(), tmax = Datetime::max();
+  const Datetime *defaults[] = {&tmin, &tmax};
+  Datetime t1, t2, s1, s2;
+  Datetime *t[] = {&s1, &s2};
+
+  /* check that all parsers agree (needs a datetime library that resolves
+   * year/day of year to a proper MJD) */
+  for (const auto &l : lines) {
+    const char *dtstrs[] = {l.c_str(), l.c_str() + 13};
+    if (legacy_sinex_date(dtstrs[0], tmin, t1) ||
+        legacy_sinex_date(dtstrs[1], tmax, t2) ||
+        dso::sinex::parse_sinex_dates(2, dtstrs, defaults, t) || (t1 != s1) ||
+        (t2 != s2) || dso::sinex::parse_sinex_date(dtstrs[0], tmin, s1) ||
+        (t1 != s1)) {
+      fprintf(stderr, "ERROR. Parsers disagree on line \"%s\"\n", l.c_str());
+      return 1;
+    }
+  }
+
+  printf("%16s %16s %16s\n", "Generic [d/s]", "Single [d/s]", "Batch [d/s]");
+  printf("%16.0f %16.0f %16.0f\n",
+         dates_per_sec(lines, repeats,
+                       [&](const char *l) {
+                         return legacy_sinex_date(l, tmin, t1) +
+                                legacy_sinex_date(l + 13, tmax, t2);
+                       }),
+         dates_per_sec(lines, repeats,
+                       [&](const char *l) {
+                         return dso::sinex::parse_sinex_date(l, tmin, t1) +
+                                dso::sinex::parse_sinex_date(l + 13, tmax, t2);
+                       }),
+         dates_per_sec(lines, repeats, [&](const char *l) {
+           const char *dtstrs[] = {l, l + 13};
+           return dso::sinex::parse_sinex_dates(2, dtstrs, defaults, t);
+         }));
+
+  return 0;
+}
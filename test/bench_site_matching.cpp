@@ -0,0 +1,117 @@
+#include "sinex.hpp"
+#include "core/sinex_site_key.hpp"
+#include "synthetic_sinex.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+/* Benchmark: Site matching, as the number of sites of interest grows
+ *
+ * For a growing number of sites N, a synthetic SINEX file of N sites is
+ * created and all of them are queried (SITE/ID, SOLUTION/EPOCHS and
+ * SOLUTION/ESTIMATE blocks). Block parsing is linear in the number of
+ * records, since each record line is matched against the sites of interest
+ * in constant time. The last two columns time the matching alone: packed
+ * keys in a sinex::details::SiteKeyMap vs a linear scan (std::find_if) over
+ * the sites, for one lookup per site; the latter grows as O(N^2).
+ */
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+/* match each site against the vector of sites, using a linear scan */
+long match_linear(const std::vector<dso::sinex::SiteId> &siteids) {
+  long found = 0;
+  for (const auto &s : siteids) {
+    auto it = std::find_if(siteids.cbegin(), siteids.cend(),
+                           [&](const dso::sinex::SiteId &site) {
+                             return !std::strncmp(site.site_code(),
+                                                  s.site_code(), 4) &&
+                                    !std::strncmp(site.point_code(),
+                                                  s.point_code(), 2);
+                           });
+    found += (it != siteids.cend());
+  }
+  return found;
+}
+
+/* match each site against the vector of sites, using packed keys */
+long match_hashed(const std::vector<dso::sinex::SiteId> &siteids) {
+  const auto map = dso::sinex::details::SiteKeyMap::of_sites(siteids);
+  long found = 0;
+  for (const auto &s : siteids)
+    found += map.contains(
+        dso::sinex::details::site_key(s.site_code(), s.point_code()));
+  return found;
+}
+} /* anonymous namespace */
+
+int main(int argc, char *argv[]) {
+  const int max_sites = (argc > 1) ? std::atoi(argv[1]) : 20000;
+  const char *fn = "bench_site_matching.snx";
+  const auto t = dso::datetime<dso::nanoseconds>(
+      dso::year(2007), dso::day_of_year(304), dso::nanoseconds(0));
+
+  printf("%8s %12s %12s %12s %12s %12s\n", "Sites", "SITE/ID [ms]",
+         "EPOCHS [ms]", "ESTIM. [ms]", "Hashed [us]", "Linear [us]");
+  for (int num_sites = 100; num_sites <= max_sites; num_sites *= 2) {
+    if (dso::sinex::test::write_synthetic_sinex(fn, num_sites, 1)) {
+      fprintf(stderr, "ERROR. Failed creating synthetic SINEX %s\n", fn);
+      return 1;
+    }
+
+    /* query all sites */
+    char code[5];
+    std::vector<std::string> names;
+    for (int i = 0; i < num_sites; i++)
+      names.emplace_back(dso::sinex::test::synthetic_site_code(i, code));
+    std::vector<const char *> sites;
+    for (const auto &s : names)
+      sites.push_back(s.c_str());
+
+    dso::Sinex snx(fn);
+    std::vector<dso::sinex::SiteId> siteids;
+    std::vector<dso::sinex::SolutionEpoch> epochs;
+    std::vector<dso::sinex::SolutionEstimate> estimates;
+
+    auto t0 = Clock::now();
+    if (snx.parse_block_site_id(sites, false, siteids) ||
+        ((int)siteids.size() != num_sites)) {
+      fprintf(stderr, "ERROR. Failed matching sites in SINEX file\n");
+      return 1;
+    }
+    auto t1 = Clock::now();
+    if (snx.parse_solution_epoch(siteids, t, true, epochs)) {
+      fprintf(stderr, "ERROR. Failed parsing SOLUTION/EPOCHS block\n");
+      return 1;
+    }
+    auto t2 = Clock::now();
+    if (snx.parse_block_solution_estimate(siteids, estimates)) {
+      fprintf(stderr, "ERROR. Failed parsing SOLUTION/ESTIMATE block\n");
+      return 1;
+    }
+    auto t3 = Clock::now();
+    const long nh = match_hashed(siteids);
+    auto t4 = Clock::now();
+    const long nl = match_linear(siteids);
+    auto t5 = Clock::now();
+    if ((nh != num_sites) || (nl != num_sites)) {
+      fprintf(stderr, "ERROR. Site matching results differ\n");
+      return 1;
+    }
+
+    printf("%8d %12.3f %12.3f %12.3f %12.1f %12.1f\n", num_sites,
+           std::chrono::duration<double, std::milli>(t1 - t0).count(),
+           std::chrono::duration<double, std::milli>(t2 - t1).count(),
+           std::chrono::duration<double, std::milli>(t3 - t2).count(),
+           std::chrono::duration<double, std::micro>(t4 - t3).count(),
+           std::chrono::duration<double, std::micro>(t5 - t4).count());
+  }
+
+  std::remove(fn);
+  return 0;
+}
@@ -0,0 +1,109 @@
+#include "sinex.hpp"
+#include "synthetic_sinex.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <vector>
+
+/* Benchmark: Tiled (out-of-core) vs packed covariance matrix
+ *
+ * Parse the covariance matrix of a synthetic SINEX file into packed storage
+ * and into a tile file, with a tile cache of a fraction of the matrix size,
+ * then extract the sub-matrix of every tenth parameter and multiply the
+ * matrix with a vector.
+ */
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+/* time of a single run of f; f returns non-zero on error */
+template <typename F> double run_time(F &&f) {
+  auto t0 = Clock::now();
+  if (f())
+    return -1e0;
+  return std::chrono::duration<double>(Clock::now() - t0).count();
+}
+} /* anonymous namespace */
+
+int main(int argc, char *argv[]) {
+  const int num_sites = (argc > 1) ? std::atoi(argv[1]) : 250;
+  const int num_solns = (argc > 2) ? std::atoi(argv[2]) : 2;
+  const int budget_fraction = (argc > 3) ? std::atoi(argv[3]) : 8;
+  const char *fn = "bench_tiled_matrix.snx";
+  const char *tile_fn = "bench_tiled_matrix.tiles";
+
+  if (dso::sinex::test::write_synthetic_sinex(fn, num_sites, num_solns,
+                                               true)) {
+    fprintf(stderr, "ERROR. Failed creating synthetic SINEX %s\n", fn);
+    return 1;
+  }
+
+  int error = 0;
+  try {
+    dso::Sinex snx(fn);
+    const auto type = dso::sinex::MatrixType::Covariance;
+    dso::sinex::SymmetricMatrix packed;
+    dso::sinex::TiledSymmetricMatrix tiled;
+
+    const double tp = run_time(
+        [&]() { return snx.parse_block_matrix_estimate(type, packed); });
+    const int n = packed.rows();
+    const std::size_t budget =
+        packed.size() * sizeof(double) / std::max(1, budget_fraction);
+    const double tt = run_time([&]() {
+      return snx.parse_block_matrix_estimate(
+          type, tile_fn, tiled, dso::sinex::default_tile_size, budget);
+    });
+
+    std::vector<int> idx;
+    for (int i = 0; i < n; i += 10)
+      idx.push_back(i);
+    Eigen::MatrixXd sp, st;
+    const double tsp = run_time([&]() {
+      packed.to_dense(idx, sp);
+      return 0;
+    });
+    const double tst = run_time([&]() { return tiled.to_dense(idx, st); });
+
+    const Eigen::MatrixXd x = Eigen::MatrixXd::Ones(n, 1);
+    Eigen::MatrixXd yp, yt;
+    const double tmp = run_time([&]() {
+      yp.setZero(n, 1);
+      for (int i = 0; i < n; i++)
+        for (int k = 0; k < n; k++)
+          yp(i, 0) += packed(i, k) * x(k, 0);
+      return 0;
+    });
+    const double tmt = run_time([&]() { return tiled.multiply(x, yt); });
+
+    if (tp < 0 || tt < 0 || tst < 0 || tmt < 0 || sp != st) {
+      fprintf(stderr, "ERROR. Results differ\n");
+      ++error;
+    }
+    for (int i = 0; i < n && !error; i++) {
+      if (std::abs(yp(i, 0) - yt(i, 0)) > 1e-12 * std::abs(yp(i, 0))) {
+        fprintf(stderr, "ERROR. Products differ\n");
+        ++error;
+      }
+    }
+
+    printf("%d x %d matrix, tile cache of %zu tiles (%.1f MB)\n", n, n,
+           tiled.max_cached_tiles(), budget / 1e6);
+    printf("%-32s %12s %12s\n", "", "packed [ms]", "tiled [ms]");
+    printf("%-32s %12.3f %12.3f\n", "parse", tp * 1e3, tt * 1e3);
+    printf("%-32s %12.3f %12.3f\n", "sub-matrix (every 10th)", tsp * 1e3,
+           tst * 1e3);
+    printf("%-32s %12.3f %12.3f\n", "matrix-vector product", tmp * 1e3,
+           tmt * 1e3);
+  } catch (std::exception &e) {
+    fprintf(stderr, "ERROR. %s\n", e.what());
+    ++error;
+  }
+
+  std::remove(fn);
+  std::remove(tile_fn);
+  return error;
+}
@@ -0,0 +1,216 @@
+/** @file
+ * Write synthetic (but format-compliant) SINEX files, to be used by test and
+ * benchmark programs that need large inputs, run checks on them and compare
+ * the records parsed off from them.
+ */
+
+#ifndef __SINEX_TEST_SYNTHETIC_SINEX_HPP__
+#define __SINEX_TEST_SYNTHETIC_SINEX_HPP__
+
+#include "sinex.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+
+namespace dso::sinex::test {
+
+/** @brief 4-char site code for the i-th synthetic site, e.g. "S00A" */
+inline const char *synthetic_site_code(int i, char *buf) noexcept {
+  static const char *digits = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+  buf[0] = 'S';
+  buf[1] = digits[(i / (36 * 36)) % 36];
+  buf[2] = digits[(i / 36) % 36];
+  buf[3] = digits[i % 36];
+  buf[4] = '\0';
+  return buf;
+}
+
+/** @brief Write a synthetic SINEX file.
+ *
+ * The file holds the blocks SITE/ID, SITE/ECCENTRICITY, SOLUTION/EPOCHS,
+ * SOLUTION/ESTIMATE and (optionally) SOLUTION/MATRIX_ESTIMATE L COVA. Each
+ * of the num_sites sites has num_solns solutions (i.e. SOLN_ID's), each with
+ * STAX, STAY, STAZ, VELX, VELY and VELZ estimates. Parameter indexes are
+ * written in a I5 field (as per the format specification), so they wrap
+ * around for more than 99999 parameters.
+ *
+ * @param[in] fn Filename of the SINEX file to create
+ * @param[in] num_sites Number of sites (at most 36^3)
+ * @param[in] num_solns Number of solutions per site
+ * @param[in] with_matrix If true, a lower-triangular covariance matrix block
+ *            is written for all parameters (size grows as O(n^2)!)
+ * @return Anything other than zero denotes an error
+ */
+inline int write_synthetic_sinex(const char *fn, int num_sites, int num_solns,
+                                 bool with_matrix = false) noexcept {
+  FILE *fp = std::fopen(fn, "w");
+  if (!fp)
+    return 1;
+  char code[5];
+  const int num_params = num_sites * num_solns * 6;
+  const char *ptypes[] = {"STAX", "STAY", "STAZ", "VELX", "VELY", "VELZ"};
+  const char *units[] = {"m", "m", "m", "m/y", "m/y", "m/y"};
+
+  std::fprintf(fp,
+               "%%=SNX 2.02 IGN 23:045:00000 IGN 93:003:00000 22:365:86399 D "
+               "%05d 2 S E\n",
+               num_params % 100000);
+  std::fprintf(fp, "+FILE/REFERENCE\n DESCRIPTION        synthetic SINEX\n"
+                   "-FILE/REFERENCE\n");
+
+  std::fprintf(fp, "+SITE/ID\n*CODE PT __DOMES__ T _STATION DESCRIPTION__ "
+                   "APPROX_LON_ APPROX_LAT_ _APP_H_\n");
+  for (int i = 0; i < num_sites; i++)
+    std::fprintf(fp,
+                 " %4s  A %05dS%03d D %-22s %3d %2d %4.1f %3d %2d %4.1f "
+                 "%7.1f\n",
+                 synthetic_site_code(i, code), 10000 + i % 90000, i % 1000,
+                 "SYNTHETIC SITE", i % 360, i % 60, (i % 600) * .1,
+                 (i % 180) - 89, (3 * i) % 60, (i % 599) * .1, 10. + i % 1000);
+  std::fprintf(fp, "-SITE/ID\n");
+
+  std::fprintf(fp, "+SITE/ECCENTRICITY\n*Code PT SOLN T Data_start__ "
+                   "Data_end____ AXE Up______ North___ East____\n");
+  for (int i = 0; i < num_sites; i++)
+    std::fprintf(fp,
+                 " %4s  A    1 D 93:003:00000 00:000:00000 UNE   0.5100   "
+                 "0.0000   0.0000\n",
+                 synthetic_site_code(i, code));
+  std::fprintf(fp, "-SITE/ECCENTRICITY\n");
+
+  /* solution intervals: split [1993, 2022] in num_solns parts */
+  std::fprintf(fp, "+SOLUTION/EPOCHS\n*CODE PT SOLN T _DATA_START_ "
+                   "__DATA_END__ _MEAN_EPOC_\n");
+  for (int i = 0; i < num_sites; i++) {
+    for (int s = 0; s < num_solns; s++) {
+      const int y0 = 93 + (s * 30) / num_solns;
+      const int y1 = 93 + ((s + 1) * 30) / num_solns - 1;
+      std::fprintf(fp,
+                   " %4s  A %4d D %02d:001:00000 %02d:365:86399 "
+                   "%02d:182:00000\n",
+                   synthetic_site_code(i, code), s + 1, y0 % 100, y1 % 100,
+                   ((y0 + y1) / 2) % 100);
+    }
+  }
+  std::fprintf(fp, "-SOLUTION/EPOCHS\n");
+
+  std::fprintf(fp, "+SOLUTION/ESTIMATE\n*INDEX TYPE__ CODE PT SOLN "
+                   "_REF_EPOCH__ UNIT S __ESTIMATED VALUE____ _STD_DEV___\n");
+  int idx = 1;
+  unsigned seed = 1u;
+  for (int i = 0; i < num_sites; i++) {
+    for (int s = 0; s < num_solns; s++) {
+      for (int p = 0; p < 6; p++, idx++) {
+        seed = seed * 1103515245u + 12345u;
+        const double r = (seed >> 8) / 16777216e0 - .5;
+        const double val = (p < 3) ? r * 1.2e7 : r * 1e-1;
+        std::fprintf(fp, " %5d %-6s %4s  A %4d 10:001:00000 %-4s 2 %21.15e "
+                         "%11.5e\n",
+                     idx % 100000, ptypes[p], synthetic_site_code(i, code),
+                     s + 1, units[p], val, 1e-3 + (idx % 7) * 1e-4);
+      }
+    }
+  }
+  std::fprintf(fp, "-SOLUTION/ESTIMATE\n");
+
+  if (with_matrix) {
+    std::fprintf(fp, "+SOLUTION/MATRIX_ESTIMATE L COVA\n*PARA1 PARA2 "
+                     "____PARA2+0__________ ____PARA2+1__________ "
+                     "____PARA2+2__________\n");
+    for (int i = 1; i <= num_params; i++) {
+      for (int j = 1; j <= i; j += 3) {
+        std::fprintf(fp, " %5d %5d", i, j);
+        for (int k = j; k <= std::min(i, j + 2); k++)
+          std::fprintf(fp, " %21.14e",
+                       (k == i) ? 1e-4 * (1 + i % 5) : 1e-7 * ((i + k) % 9));
+        std::fprintf(fp, "\n");
+      }
+    }
+    std::fprintf(fp, "-SOLUTION/MATRIX_ESTIMATE L COVA\n");
+  }
+
+  std::fprintf(fp, "%%ENDSNX\n");
+  return std::fclose(fp) != 0;
+}
+
+/** @brief Write a synthetic SINEX file (see write_synthetic_sinex), run a
+ *         check on an instance of it opened in each I/O mode (MemoryMap,
+ *         then Stream) and remove the file.
+ *
+ * @param[in] fn Filename of the SINEX file to create
+ * @param[in] num_sites Number of sites (at most 36^3)
+ * @param[in] num_solns Number of solutions per site
+ * @param[in] with_matrix If true, a covariance matrix block is written
+ * @param[in] check Callable taking a dso::Sinex instance (reference) and
+ *            returning its number of errors; the file exists while it runs
+ * @return Number of errors, i.e. the sum of the check results plus one for
+ *         failing to create the file or an instance off from it
+ */
+template <typename F>
+int run_on_synthetic(const char *fn, int num_sites, int num_solns,
+                     bool with_matrix, F &&check) {
+  if (write_synthetic_sinex(fn, num_sites, num_solns, with_matrix)) {
+    std::fprintf(stderr, "ERROR. Failed creating synthetic SINEX %s\n", fn);
+    return 1;
+  }
+
+  int error = 0;
+  for (auto mode : {dso::SinexIoMode::MemoryMap, dso::SinexIoMode::Stream}) {
+    try {
+      dso::Sinex snx(fn, mode);
+      error += check(snx);
+    } catch (std::exception &e) {
+      std::fprintf(stderr,
+                   "ERROR. Failed to create SINEX instance from file %s\n",
+                   fn);
+      std::fprintf(stderr, "%s\n", e.what());
+      ++error;
+    }
+  }
+
+  std::remove(fn);
+  return error;
+}
+
+using Epoch = dso::datetime<dso::nanoseconds>;
+
+/** @brief Epoch at the start of the given day of year */
+inline Epoch doy(int year, int day) {
+  return Epoch(dso::year(year), dso::day_of_year(day), dso::nanoseconds(0));
+}
+
+/** @brief Compare all fields of two SOLUTION/ESTIMATE records */
+inline bool same_estimate(const SolutionEstimate &a,
+                          const SolutionEstimate &b) noexcept {
+  return !std::strcmp(a.site_code(), b.site_code()) &&
+         !std::strcmp(a.point_code(), b.point_code()) &&
+         !std::strcmp(a.soln_id(), b.soln_id()) &&
+         !std::strcmp(a.units(), b.units()) &&
+         (a.parameter_type_id() == b.parameter_type_id()) &&
+         (a.index() == b.index()) && (a.constraint() == b.constraint()) &&
+         (a.estimate() == b.estimate()) &&
+         (a.std_deviation() == b.std_deviation()) && (a.epoch() == b.epoch());
+}
+
+/** @brief Compare the SITE CODE, POINT CODE and DOMES of two SITE/ID
+ *         records */
+inline bool same_site(const SiteId &a, const SiteId &b) noexcept {
+  return !std::strcmp(a.site_code(), b.site_code()) &&
+         !std::strcmp(a.point_code(), b.point_code()) &&
+         !std::strcmp(a.domes(), b.domes());
+}
+
+/** @brief Compare all fields of two SOLUTION/EPOCHS records */
+inline bool same_epoch(const SolutionEpoch &a,
+                       const SolutionEpoch &b) noexcept {
+  return !std::strcmp(a.site_code(), b.site_code()) &&
+         !std::strcmp(a.point_code(), b.point_code()) &&
+         !std::strcmp(a.soln_id(), b.soln_id()) && (a.m_start == b.m_start) &&
+         (a.m_stop == b.m_stop) && (a.m_mean == b.m_mean);
+}
+
+} /* namespace dso::sinex::test */
+
+#endif
@@ -0,0 +1,230 @@
+#include "core/sinex_index.hpp"
+#include "sinex.hpp"
+#include "synthetic_sinex.hpp"
+#include <atomic>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+/* Test program: Persistent block index (SinexIndexPolicy)
+ *
+ * A synthetic SINEX file is created and opened with a block index. We check
+ * that the index is written, re-loaded (in both I/O modes) and yields the
+ * same block table and summaries as marking the blocks, and that stale or
+ * corrupt indexes (including ones with valid checksums but invalid block
+ * positions) are not used.
+ */
+
+namespace {
+const char *fn = "test_block_index.snx";
+const char *idx_fn = "test_block_index.snx.idx";
+
+bool same_blocks(const dso::Sinex &s1, const dso::Sinex &s2) {
+  const auto &b1 = s1.blocks();
+  const auto &b2 = s2.blocks();
+  if (b1.size() != b2.size())
+    return false;
+  for (std::size_t i = 0; i < b1.size(); i++) {
+    if ((b1[i].mpos != b2[i].mpos) || (b1[i].mdata != b2[i].mdata) ||
+        (b1[i].mend != b2[i].mend) || (b1[i].mlines != b2[i].mlines) ||
+        std::strcmp(b1[i].mtype, b2[i].mtype))
+      return false;
+  }
+  return true;
+}
+
+int check_summary(dso::Sinex &snx, const char *block, long records,
+                  const char *first, const char *last) {
+  long n;
+  dso::datetime<dso::nanoseconds> t1, t2, e1, e2;
+  if (snx.block_summary(block, n, t1, t2))
+    return 1;
+  dso::sinex::parse_sinex_date(first, dso::datetime<dso::nanoseconds>::min(),
+                               e1);
+  dso::sinex::parse_sinex_date(last, dso::datetime<dso::nanoseconds>::max(),
+                               e2);
+  if ((n != records) || (t1 != e1) || (t2 != e2)) {
+    fprintf(stderr, "ERROR. Wrong summary for block %s\n", block);
+    return 1;
+  }
+  return 0;
+}
+
+/* Write an index (with a valid checksum) holding the blocks of ref, with
+ * the positions of the block at index i altered via the callable f; then
+ * check that the index is not loaded (in either I/O mode).
+ */
+template <typename F>
+int check_corrupt_positions(const dso::Sinex &ref, std::size_t i, F &&f,
+                            const char *what) {
+  auto blocks = ref.blocks();
+  f(blocks, i);
+  const std::vector<dso::sinex::SinexBlockSummary> summaries(
+      blocks.size(), dso::sinex::SinexBlockSummary{0, "", ""});
+  if (dso::sinex::details::write_block_index(fn, blocks, summaries)) {
+    fprintf(stderr, "ERROR. Failed writing block index\n");
+    return 1;
+  }
+  for (auto mode : {dso::SinexIoMode::MemoryMap, dso::SinexIoMode::Stream}) {
+    dso::Sinex snx(fn, mode, dso::SinexIndexPolicy::ReadOnly);
+    std::vector<dso::sinex::SiteId> sites;
+    if (snx.block_index_loaded() || (!same_blocks(ref, snx)) ||
+        snx.parse_block_site_id(sites) || sites.empty()) {
+      fprintf(stderr, "ERROR. Block index with %s loaded\n", what);
+      return 1;
+    }
+  }
+  return 0;
+}
+} /* anonymous namespace */
+
+int main() {
+  const int num_sites = 50, num_solns = 3;
+  std::remove(idx_fn);
+  if (dso::sinex::test::write_synthetic_sinex(fn, num_sites, num_solns)) {
+    fprintf(stderr, "ERROR. Failed creating synthetic SINEX %s\n", fn);
+    return 1;
+  }
+
+  try {
+    /* reference instance; no index */
+    dso::Sinex ref(fn, dso::SinexIoMode::MemoryMap);
+    if (ref.block_index_loaded() || (!access(idx_fn, F_OK))) {
+      fprintf(stderr, "ERROR. Index used with SinexIndexPolicy::None\n");
+      return 1;
+    }
+    if (check_summary(ref, "SOLUTION/ESTIMATE", num_sites * num_solns * 6,
+                      "10:001:00000", "10:001:00000") ||
+        check_summary(ref, "SOLUTION/EPOCHS", num_sites * num_solns,
+                      "93:001:00000", "22:365:86399") ||
+        check_summary(ref, "SITE/ID", num_sites, "00:000:00000",
+                      "00:000:00000"))
+      return 1;
+
+    /* first open writes the index; second one loads it */
+    {
+      dso::Sinex s1(fn, dso::SinexIoMode::MemoryMap,
+                    dso::SinexIndexPolicy::ReadWrite);
+      if (s1.block_index_loaded() || access(idx_fn, F_OK)) {
+        fprintf(stderr, "ERROR. Block index not written\n");
+        return 1;
+      }
+    }
+    const dso::SinexIoMode modes[] = {dso::SinexIoMode::MemoryMap,
+                                      dso::SinexIoMode::Stream};
+    for (auto mode : modes) {
+      dso::Sinex s2(fn, mode, dso::SinexIndexPolicy::ReadOnly);
+      if ((!s2.block_index_loaded()) || (!same_blocks(ref, s2))) {
+        fprintf(stderr, "ERROR. Block index not loaded or invalid\n");
+        return 1;
+      }
+      if (check_summary(s2, "SOLUTION/ESTIMATE", num_sites * num_solns * 6,
+                        "10:001:00000", "10:001:00000") ||
+          check_summary(s2, "SOLUTION/EPOCHS", num_sites * num_solns,
+                        "93:001:00000", "22:365:86399"))
+        return 1;
+      /* parsing through the index gives the same results */
+      std::vector<dso::sinex::SiteId> sites;
+      std::vector<dso::sinex::SolutionEstimate> est;
+      if (s2.parse_block_site_id(sites) ||
+          s2.parse_block_solution_estimate(sites, est) ||
+          ((int)est.size() != num_sites * num_solns * 6)) {
+        fprintf(stderr, "ERROR. Failed parsing blocks via block index\n");
+        return 1;
+      }
+    }
+
+    /* modify the SINEX file; index is stale and should not be used */
+    if (dso::sinex::test::write_synthetic_sinex(fn, num_sites + 1,
+                                                num_solns)) {
+      fprintf(stderr, "ERROR. Failed creating synthetic SINEX %s\n", fn);
+      return 1;
+    }
+    {
+      dso::Sinex s3(fn, dso::SinexIoMode::MemoryMap,
+                    dso::SinexIndexPolicy::ReadOnly);
+      if (s3.block_index_loaded()) {
+        fprintf(stderr, "ERROR. Stale block index loaded\n");
+        return 1;
+      }
+    }
+
+    /* many writers at the same time; all should see a valid state */
+    std::vector<std::thread> threads;
+    std::atomic<int> failed = 0;
+    for (int i = 0; i < 8; i++)
+      threads.emplace_back([&failed]() {
+        try {
+          dso::Sinex s(fn, dso::SinexIoMode::MemoryMap,
+                       dso::SinexIndexPolicy::ReadWrite);
+        } catch (std::exception &) {
+          ++failed;
+        }
+      });
+    for (auto &t : threads)
+      t.join();
+    dso::Sinex s4(fn, dso::SinexIoMode::MemoryMap,
+                  dso::SinexIndexPolicy::ReadOnly);
+    dso::Sinex ref4(fn);
+    if (failed || (!s4.block_index_loaded()) || (!same_blocks(ref4, s4))) {
+      fprintf(stderr, "ERROR. Block index invalid after concurrent writes\n");
+      return 1;
+    }
+
+    /* corrupt (truncated) index should not be used */
+    if (truncate(idx_fn, 64)) {
+      fprintf(stderr, "ERROR. Failed truncating block index\n");
+      return 1;
+    }
+    dso::Sinex s5(fn, dso::SinexIoMode::MemoryMap,
+                  dso::SinexIndexPolicy::ReadOnly);
+    if (s5.block_index_loaded() || (!same_blocks(ref4, s5))) {
+      fprintf(stderr, "ERROR. Corrupt block index loaded\n");
+      return 1;
+    }
+
+    /* valid checksum, invalid block positions */
+    using Blocks = std::vector<dso::sinex::SinexBlockPosition>;
+    const std::size_t last = ref4.blocks().size() - 1;
+    if (check_corrupt_positions(
+            ref4, 1,
+            [](Blocks &b, std::size_t j) {
+              b[j].mpos += 1;
+              b[j].mend += 1;
+            },
+            "shifted offsets") ||
+        check_corrupt_positions(
+            ref4, last,
+            [](Blocks &b, std::size_t j) { b[j].mend += (1L << 30); },
+            "offset past end of file") ||
+        check_corrupt_positions(
+            ref4, 1,
+            [](Blocks &b, std::size_t j) { std::swap(b[j - 1], b[j]); },
+            "unsorted blocks") ||
+        check_corrupt_positions(
+            ref4, 1,
+            [](Blocks &b, std::size_t j) { b[j].mdata = b[j].mpos; },
+            "empty header line") ||
+        check_corrupt_positions(
+            ref4, 0,
+            [](Blocks &b, std::size_t j) {
+              b[j].mpos = std::streamoff(-1);
+            },
+            "negative offset"))
+      return 1;
+  } catch (std::exception &e) {
+    fprintf(stderr, "ERROR. Failed to create SINEX instance from file %s\n",
+            fn);
+    fprintf(stderr, "%s\n", e.what());
+    return 1;
+  }
+
+  std::remove(fn);
+  std::remove(idx_fn);
+  /* all done */
+  return 0;
+}
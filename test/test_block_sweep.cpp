@@ -0,0 +1,130 @@
+#include "sinex.hpp"
+#include "synthetic_sinex.hpp"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/* Test program: Coordinate extrapolation off one sweep of the blocks
+ *
+ * A synthetic SINEX file is created and coordinates are extrapolated (see
+ * dso::Sinex::linear_extrapolate_coordinates) for a number of epochs.
+ * Results should match the ones computed off from the SOLUTION/ESTIMATE
+ * records of the block parsers (parameters collected per site). The same
+ * should hold for the file's content with SOLUTION/ESTIMATE placed before
+ * SOLUTION/EPOCHS, since blocks are swept in file order.
+ */
+
+namespace {
+const char *fn = "test_block_sweep.snx";
+constexpr int num_sites = 50;
+constexpr int num_solns = 3;
+using dso::sinex::test::Epoch;
+using dso::sinex::test::doy;
+
+/* expected coordinates, off from the block parsers */
+int expected_coordinates(const dso::Sinex &snx,
+                         const std::vector<dso::sinex::SiteId> &sites,
+                         const Epoch &t, std::vector<double> &xyz) {
+  std::vector<dso::sinex::SolutionEstimate> estimates;
+  if (snx.parse_block_solution_estimate(sites, t, true, estimates))
+    return 1;
+  const char *p[] = {"STAX", "VELX", "STAY", "VELY", "STAZ", "VELZ"};
+  xyz.clear();
+  for (const auto &site : sites) {
+    for (int c = 0; c < 6; c += 2) {
+      const dso::sinex::SolutionEstimate *x = nullptr, *v = nullptr;
+      for (const auto &e : estimates) {
+        if (std::strcmp(e.site_code(), site.site_code()))
+          continue;
+        if (!std::strcmp(e.parameter_type(), p[c]))
+          x = &e;
+        if (!std::strcmp(e.parameter_type(), p[c + 1]))
+          v = &e;
+      }
+      if (!x || !v)
+        return 1;
+      const auto dt =
+          t.diff<dso::DateTimeDifferenceType::FractionalYears>(x->epoch());
+      xyz.push_back(x->estimate() + v->estimate() * dt.years());
+    }
+  }
+  return 0;
+}
+
+int check_snx(const dso::Sinex &snx) {
+  int error = 0;
+  std::vector<dso::sinex::SiteId> sites, subset;
+  if (snx.parse_block_site_id(sites) ||
+      (sites.size() != (std::size_t)num_sites)) {
+    fprintf(stderr, "ERROR. Failed parsing SITE/ID\n");
+    return 1;
+  }
+  for (std::size_t i = 0; i < sites.size(); i += 3)
+    subset.push_back(sites[i]);
+
+  for (const auto &t : {doy(1990, 10), doy(2000, 100), doy(2030, 1)}) {
+    std::vector<dso::Sinex::SiteCoordinateResults> crd;
+    std::vector<double> xyz;
+    if (snx.linear_extrapolate_coordinates(subset, t, crd) ||
+        expected_coordinates(snx, subset, t, xyz) ||
+        (crd.size() != subset.size())) {
+      fprintf(stderr, "ERROR. Failed extrapolating coordinates\n");
+      ++error;
+      continue;
+    }
+    for (std::size_t i = 0; i < crd.size(); i++) {
+      if (std::strcmp(crd[i].msite.site_code(), subset[i].site_code()) ||
+          (crd[i].x != xyz[3 * i]) || (crd[i].y != xyz[3 * i + 1]) ||
+          (crd[i].z != xyz[3 * i + 2])) {
+        fprintf(stderr, "ERROR. Coordinates of site %s differ\n",
+                subset[i].site_code());
+        ++error;
+      }
+    }
+  }
+
+  /* an unknown site is an error */
+  std::vector<dso::Sinex::SiteCoordinateResults> crd;
+  dso::sinex::SiteId unknown;
+  std::strcpy(unknown.site_code(), "XXXX");
+  std::strcpy(unknown.point_code(), " A");
+  subset.push_back(unknown);
+  if (!snx.linear_extrapolate_coordinates(subset, doy(2000, 1), crd)) {
+    fprintf(stderr, "ERROR. Expected failure for unknown site\n");
+    ++error;
+  }
+
+  return error;
+}
+
+/* move block SOLUTION/ESTIMATE before SOLUTION/EPOCHS */
+std::string swap_blocks(const std::string &content) {
+  const auto eb = content.find("+SOLUTION/EPOCHS");
+  const auto ee = content.find("-SOLUTION/EPOCHS\n") + 17;
+  const auto sb = content.find("+SOLUTION/ESTIMATE");
+  const auto se = content.find("-SOLUTION/ESTIMATE\n") + 19;
+  return content.substr(0, eb) + content.substr(sb, se - sb) +
+         content.substr(ee, sb - ee) + content.substr(eb, ee - eb) +
+         content.substr(se);
+}
+} /* anonymous namespace */
+
+int main() {
+  return dso::sinex::test::run_on_synthetic(
+      fn, num_sites, num_solns, false, [](const dso::Sinex &snx) {
+        int error = check_snx(snx);
+        /* blocks in a different order, off from a buffer (checked once) */
+        if (snx.io_mode() == dso::SinexIoMode::MemoryMap) {
+          std::ifstream fin(fn);
+          std::stringstream ss;
+          ss << fin.rdbuf();
+          const dso::Sinex swapped =
+              dso::Sinex::from_buffer(swap_blocks(ss.str()), "swapped");
+          error += check_snx(swapped);
+        }
+        return error;
+      });
+}
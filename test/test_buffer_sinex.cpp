@@ -0,0 +1,146 @@
+#include "sinex.hpp"
+#include "synthetic_sinex.hpp"
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include <zlib.h>
+
+/* Test program: Construct dso::Sinex instances off from in-memory content
+ *
+ * A synthetic SINEX file is created and read into memory. Instances are
+ * then constructed off from (a) a view of the content, (b) an (owned) copy
+ * of the content and (c) the gzip-compressed content, and compared against
+ * an instance constructed off from the file.
+ */
+
+/* a filename held in an std::string (e.g. a temporary built off from a
+ * directory) should never be taken for SINEX content */
+static_assert(!std::is_constructible_v<dso::Sinex, std::string>);
+static_assert(!std::is_constructible_v<dso::Sinex, const std::string &>);
+static_assert(
+    !std::is_constructible_v<dso::Sinex, std::string, const char *>);
+
+namespace {
+const char *fn = "test_buffer_sinex.snx";
+
+int read_file(const char *fname, std::string &bytes) {
+  FILE *fp = std::fopen(fname, "rb");
+  if (!fp)
+    return 1;
+  char buf[4096];
+  std::size_t n;
+  bytes.clear();
+  while ((n = std::fread(buf, 1, sizeof(buf), fp)) > 0)
+    bytes.append(buf, n);
+  std::fclose(fp);
+  return 0;
+}
+
+int gzip_bytes(const std::string &bytes, std::string &gz) {
+  z_stream strm{};
+  /* 15 + 16: max window, gzip wrapper */
+  if (deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8,
+                   Z_DEFAULT_STRATEGY) != Z_OK)
+    return 1;
+  gz.resize(deflateBound(&strm, bytes.size()));
+  strm.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(bytes.data()));
+  strm.avail_in = bytes.size();
+  strm.next_out = reinterpret_cast<Bytef *>(gz.data());
+  strm.avail_out = gz.size();
+  const int ret = deflate(&strm, Z_FINISH);
+  gz.resize(strm.total_out);
+  deflateEnd(&strm);
+  return ret != Z_STREAM_END;
+}
+
+bool same_contents(const dso::Sinex &s1, const dso::Sinex &s2) {
+  const auto &b1 = s1.blocks();
+  const auto &b2 = s2.blocks();
+  if (b1.size() != b2.size())
+    return false;
+  for (std::size_t i = 0; i < b1.size(); i++) {
+    if ((b1[i].mpos != b2[i].mpos) || (b1[i].mend != b2[i].mend) ||
+        (b1[i].mlines != b2[i].mlines) || std::strcmp(b1[i].mtype, b2[i].mtype))
+      return false;
+  }
+  std::vector<dso::sinex::SiteId> sites1, sites2;
+  std::vector<dso::sinex::SolutionEstimate> est1, est2;
+  if (s1.parse_block_site_id(sites1) || s2.parse_block_site_id(sites2) ||
+      s1.parse_block_solution_estimate(sites1, est1) ||
+      s2.parse_block_solution_estimate(sites2, est2))
+    return false;
+  if ((sites1.size() != sites2.size()) || (est1.size() != est2.size()))
+    return false;
+  for (std::size_t i = 0; i < est1.size(); i++) {
+    if ((est1[i].estimate() != est2[i].estimate()) ||
+        std::strcmp(est1[i].site_code(), est2[i].site_code()))
+      return false;
+  }
+  return true;
+}
+} /* anonymous namespace */
+
+int main() {
+  std::string bytes, gz;
+  if (dso::sinex::test::write_synthetic_sinex(fn, 200, 2) ||
+      read_file(fn, bytes) || gzip_bytes(bytes, gz)) {
+    fprintf(stderr, "ERROR. Failed creating synthetic SINEX %s\n", fn);
+    return 1;
+  }
+
+  int error = 0;
+  try {
+    const dso::Sinex ref(fn);
+
+    /* (a) view of the content */
+    const dso::Sinex s1 = dso::Sinex::from_buffer(bytes, "view");
+    if ((s1.filename() != "view") || (!same_contents(ref, s1))) {
+      fprintf(stderr, "ERROR. Failed reading SINEX off from a view\n");
+      ++error;
+    }
+
+    /* (b) owned buffer; the original goes out of scope */
+    std::unique_ptr<dso::Sinex> s2;
+    {
+      std::string copy(bytes);
+      s2 = std::make_unique<dso::Sinex>(dso::sinex_buffer, std::move(copy));
+    }
+    if (!same_contents(ref, *s2)) {
+      fprintf(stderr, "ERROR. Failed reading SINEX off from a buffer\n");
+      ++error;
+    }
+
+    /* (c) compressed content */
+    const dso::Sinex s3 = dso::Sinex::from_buffer(gz);
+    if (!same_contents(ref, s3)) {
+      fprintf(stderr, "ERROR. Failed reading compressed SINEX content\n");
+      ++error;
+    }
+  } catch (std::exception &e) {
+    fprintf(stderr, "ERROR. Failed to create SINEX instance\n");
+    fprintf(stderr, "%s\n", e.what());
+    ++error;
+  }
+
+  /* invalid content should not be accepted */
+  const char *invalid[] = {"", "not a SINEX file\n",
+                           "%=SNX 2.02 IGN 23:045:00000\n+SITE/ID\n",
+                           "%=SNX 2.02 IGN 23:045:00000 IGN 93:003:00000 "
+                           "22:365:86399 D 00001 2 S E\n+SITE/ID\n"};
+  for (const char *content : invalid) {
+    try {
+      const dso::Sinex snx = dso::Sinex::from_buffer(content);
+      fprintf(stderr, "ERROR. Invalid SINEX content accepted\n");
+      ++error;
+    } catch (std::exception &) {
+      ;
+    }
+  }
+
+  std::remove(fn);
+  return error;
+}
@@ -0,0 +1,204 @@
+#include "sinex.hpp"
+#include "synthetic_sinex.hpp"
+#include <cstdio>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <zlib.h>
+
+/* Test program: Open gzip (.gz) and Unix compress (.Z) SINEX files
+ *
+ * A synthetic SINEX file is created and then compressed, (a) with gzip, as
+ * two concatenated gzip members and (b) with Unix compress (LZW), using
+ * different max code sizes. Each compressed file is opened (in both I/O
+ * modes) and compared against the uncompressed one.
+ */
+
+namespace {
+const char *fn = "test_compressed_sinex.snx";
+const char *gz_fn = "test_compressed_sinex.snx.gz";
+const char *z_fn = "test_compressed_sinex.snx.Z";
+
+int read_file(const char *fname, std::string &bytes) {
+  FILE *fp = std::fopen(fname, "rb");
+  if (!fp)
+    return 1;
+  char buf[4096];
+  std::size_t n;
+  bytes.clear();
+  while ((n = std::fread(buf, 1, sizeof(buf), fp)) > 0)
+    bytes.append(buf, n);
+  std::fclose(fp);
+  return 0;
+}
+
+/* write bytes as two concatenated gzip members */
+int write_gzip(const std::string &bytes, const char *fname) {
+  std::remove(fname);
+  const std::size_t half = bytes.size() / 2;
+  const char *modes[] = {"wb", "ab"};
+  const std::size_t from[] = {0, half};
+  const std::size_t to[] = {half, bytes.size()};
+  for (int i = 0; i < 2; i++) {
+    gzFile gz = gzopen(fname, modes[i]);
+    if (!gz)
+      return 1;
+    if (gzwrite(gz, bytes.data() + from[i], (unsigned)(to[i] - from[i])) <= 0)
+      return 1;
+    gzclose(gz);
+  }
+  return 0;
+}
+
+/* Unix compress (LZW, block mode) encoder; no clear codes are emitted */
+int write_compress(const std::string &bytes, const char *fname,
+                   int max_bits) {
+  std::string out = {'\x1f', '\x9d', (char)(0x80 | max_bits)};
+  std::size_t mark = out.size();
+  unsigned long buf = 0;
+  int left = 0, bits = 9;
+  unsigned free_ent = 257, maxcode = 511;
+  auto output = [&](unsigned code) {
+    buf |= (unsigned long)code << left;
+    left += bits;
+    while (left >= 8) {
+      out.push_back((char)(buf & 0xff));
+      buf >>= 8;
+      left -= 8;
+    }
+  };
+  auto next_bits = [&]() {
+    /* flush partial byte and pad group to a multiple of bits bytes */
+    if (left)
+      out.push_back((char)(buf & 0xff));
+    buf = 0;
+    left = 0;
+    while ((out.size() - mark) % bits)
+      out.push_back('\0');
+    mark = out.size();
+    ++bits;
+    maxcode = (1u << bits) - 1;
+  };
+
+  std::map<std::pair<unsigned, unsigned char>, unsigned> table;
+  unsigned ent = (unsigned char)bytes[0];
+  for (std::size_t i = 1; i < bytes.size(); i++) {
+    const unsigned char c = bytes[i];
+    auto it = table.find({ent, c});
+    if (it != table.end()) {
+      ent = it->second;
+      continue;
+    }
+    output(ent);
+    if (free_ent > maxcode && bits < max_bits)
+      next_bits();
+    if (free_ent < (1u << max_bits))
+      table[{ent, c}] = free_ent++;
+    ent = c;
+  }
+  output(ent);
+  if (left)
+    out.push_back((char)(buf & 0xff));
+
+  FILE *fp = std::fopen(fname, "wb");
+  if (!fp)
+    return 1;
+  std::fwrite(out.data(), 1, out.size(), fp);
+  return std::fclose(fp) != 0;
+}
+
+bool same_contents(dso::Sinex &s1, dso::Sinex &s2) {
+  const auto &b1 = s1.blocks();
+  const auto &b2 = s2.blocks();
+  if (b1.size() != b2.size())
+    return false;
+  for (std::size_t i = 0; i < b1.size(); i++) {
+    if ((b1[i].mpos != b2[i].mpos) || (b1[i].mend != b2[i].mend) ||
+        (b1[i].mlines != b2[i].mlines) || std::strcmp(b1[i].mtype, b2[i].mtype))
+      return false;
+  }
+  std::vector<dso::sinex::SiteId> sites1, sites2;
+  std::vector<dso::sinex::SolutionEstimate> est1, est2;
+  if (s1.parse_block_site_id(sites1) || s2.parse_block_site_id(sites2) ||
+      s1.parse_block_solution_estimate(sites1, est1) ||
+      s2.parse_block_solution_estimate(sites2, est2))
+    return false;
+  if ((sites1.size() != sites2.size()) || (est1.size() != est2.size()))
+    return false;
+  for (std::size_t i = 0; i < est1.size(); i++) {
+    if ((est1[i].estimate() != est2[i].estimate()) ||
+        std::strcmp(est1[i].site_code(), est2[i].site_code()))
+      return false;
+  }
+  return true;
+}
+} /* anonymous namespace */
+
+int main() {
+  if (dso::sinex::test::write_synthetic_sinex(fn, 300, 2)) {
+    fprintf(stderr, "ERROR. Failed creating synthetic SINEX %s\n", fn);
+    return 1;
+  }
+  std::string bytes;
+  if (read_file(fn, bytes) || write_gzip(bytes, gz_fn)) {
+    fprintf(stderr, "ERROR. Failed creating compressed SINEX\n");
+    return 1;
+  }
+
+  int error = 0;
+  try {
+    dso::Sinex ref(fn);
+    const dso::SinexIoMode modes[] = {dso::SinexIoMode::Stream,
+                                      dso::SinexIoMode::MemoryMap};
+    for (auto mode : modes) {
+      dso::Sinex snx(gz_fn, mode);
+      if ((snx.io_mode() != dso::SinexIoMode::MemoryMap) ||
+          (!same_contents(ref, snx))) {
+        fprintf(stderr, "ERROR. Failed reading gzip SINEX %s\n", gz_fn);
+        ++error;
+      }
+    }
+
+    /* 12 bits fill up the table; 16 bits do not */
+    for (int max_bits : {12, 16}) {
+      if (write_compress(bytes, z_fn, max_bits)) {
+        fprintf(stderr, "ERROR. Failed creating compressed SINEX\n");
+        return 1;
+      }
+      for (auto mode : modes) {
+        dso::Sinex snx(z_fn, mode);
+        if (!same_contents(ref, snx)) {
+          fprintf(stderr, "ERROR. Failed reading .Z SINEX %s (%d bits)\n",
+                  z_fn, max_bits);
+          ++error;
+        }
+      }
+    }
+  } catch (std::exception &e) {
+    fprintf(stderr, "ERROR. Failed to create SINEX instance\n");
+    fprintf(stderr, "%s\n", e.what());
+    ++error;
+  }
+
+  /* truncated compressed file should not be accepted */
+  if (FILE *fp = std::fopen(gz_fn, "wb")) {
+    std::string gz;
+    write_gzip(bytes, z_fn);
+    read_file(z_fn, gz);
+    std::fwrite(gz.data(), 1, gz.size() / 3, fp);
+    std::fclose(fp);
+    try {
+      dso::Sinex snx(gz_fn);
+      fprintf(stderr, "ERROR. Truncated gzip SINEX accepted\n");
+      ++error;
+    } catch (std::exception &) {
+      ;
+    }
+  }
+
+  std::remove(fn);
+  std::remove(gz_fn);
+  std::remove(z_fn);
+  return error;
+}
@@ -0,0 +1,97 @@
+#include "sinex.hpp"
+#include "synthetic_sinex.hpp"
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+/* Test program: Concurrent queries on a single dso::Sinex instance
+ *
+ * A synthetic SINEX file is created and opened (in both I/O modes). A number
+ * of threads then query the same (const) instance concurrently, each one for
+ * a different subset of sites, and results are checked against the ones
+ * obtained by querying the instance serially.
+ */
+
+namespace {
+const char *fn = "test_concurrent_queries.snx";
+constexpr int num_sites = 400;
+constexpr int num_solns = 3;
+constexpr int num_threads = 8;
+
+/* query SITE/ID, SOLUTION/ESTIMATE and coordinates for a subset of sites */
+int query(const dso::Sinex &snx, int thread, std::vector<double> &result) {
+  char code[5];
+  std::vector<std::string> names;
+  for (int i = thread; i < num_sites; i += num_threads)
+    names.emplace_back(dso::sinex::test::synthetic_site_code(i, code));
+  std::vector<const char *> sites;
+  for (const auto &s : names)
+    sites.push_back(s.c_str());
+
+  std::vector<dso::sinex::SiteId> siteids;
+  std::vector<dso::sinex::SolutionEstimate> estimates;
+  std::vector<dso::Sinex::SiteCoordinateResults> crd;
+  const auto t = dso::datetime<dso::nanoseconds>(
+      dso::year(2007), dso::day_of_year(304), dso::nanoseconds(0));
+  long num_records;
+  dso::datetime<dso::nanoseconds> first, last;
+  if (snx.parse_block_site_id(sites, false, siteids) ||
+      (siteids.size() != sites.size()) ||
+      snx.parse_block_solution_estimate(siteids, estimates) ||
+      snx.linear_extrapolate_coordinates(siteids, t, crd) ||
+      snx.block_summary("SOLUTION/ESTIMATE", num_records, first, last))
+    return 1;
+
+  result.clear();
+  for (const auto &e : estimates)
+    result.push_back(e.estimate());
+  for (const auto &c : crd) {
+    result.push_back(c.x);
+    result.push_back(c.y);
+    result.push_back(c.z);
+  }
+  result.push_back(num_records);
+  return 0;
+}
+
+int check_snx(const dso::Sinex &snx) {
+  /* reference results, queried serially */
+  std::vector<std::vector<double>> expected(num_threads);
+  for (int i = 0; i < num_threads; i++) {
+    if (query(snx, i, expected[i]) || expected[i].empty()) {
+      fprintf(stderr, "ERROR. Failed querying SINEX %s\n", fn);
+      return 1;
+    }
+  }
+
+  /* same queries, all threads at the same time (and repeatedly) */
+  std::atomic<int> failed = 0;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_threads; i++)
+    threads.emplace_back([&, i]() {
+      std::vector<double> result;
+      for (int k = 0; k < 10; k++) {
+        if (query(snx, i, result) || (result != expected[i]))
+          ++failed;
+      }
+    });
+  for (auto &t : threads)
+    t.join();
+
+  if (failed) {
+    fprintf(stderr, "ERROR. %d concurrent queries failed (mode: %s)\n",
+            failed.load(),
+            (snx.io_mode() == dso::SinexIoMode::Stream) ? "Stream"
+                                                         : "MemoryMap");
+    return 1;
+  }
+  return 0;
+}
+} /* anonymous namespace */
+
+int main() {
+  return dso::sinex::test::run_on_synthetic(fn, num_sites, num_solns, false,
+                                            check_snx);
+}
@@ -0,0 +1,109 @@
+#include "sinex.hpp"
+#include "synthetic_sinex.hpp"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+/* Test program: Columnar SOLUTION/ESTIMATE records
+ *
+ * A synthetic SINEX file is created and its SOLUTION/ESTIMATE block is
+ * parsed both as a vector of records and in columnar form. Records
+ * re-constructed from the columns should be the same as the ones parsed,
+ * and selecting by site and/or parameter type should match a plain scan of
+ * the records.
+ */
+
+namespace {
+const char *fn = "test_estimate_columns.snx";
+constexpr int num_sites = 50;
+constexpr int num_solns = 2;
+
+bool same_record(const dso::sinex::SolutionEstimate &a,
+                 const dso::sinex::SolutionEstimate &b) {
+  return !std::strcmp(a.site_code(), b.site_code()) &&
+         !std::strcmp(a.point_code(), b.point_code()) &&
+         !std::strcmp(a.soln_id(), b.soln_id()) &&
+         !std::strcmp(a.units(), b.units()) &&
+         !std::strcmp(a.parameter_type(), b.parameter_type()) &&
+         (a.index() == b.index()) && (a.constraint() == b.constraint()) &&
+         (a.estimate() == b.estimate()) &&
+         (a.std_deviation() == b.std_deviation()) && (a.epoch() == b.epoch());
+}
+
+int check_snx(const dso::Sinex &snx) {
+  int error = 0;
+  /* all records, as a vector */
+  std::vector<dso::sinex::SiteId> siteids;
+  std::vector<dso::sinex::SolutionEstimate> estimates;
+  if (snx.parse_block_site_id(std::vector<const char *>{}, false, siteids) ||
+      snx.parse_block_solution_estimate(siteids, estimates)) {
+    fprintf(stderr, "ERROR. Failed parsing SINEX %s\n", fn);
+    return 1;
+  }
+
+  /* all records, in columns */
+  dso::sinex::SolutionEstimateColumns columns;
+  if (snx.parse_block_solution_estimate(columns)) {
+    fprintf(stderr, "ERROR. Failed parsing SINEX %s in columns\n", fn);
+    return 1;
+  }
+
+  if ((columns.size() != estimates.size()) ||
+      (columns.size() != (std::size_t)num_sites * num_solns * 6)) {
+    fprintf(stderr, "ERROR. Expected %zu records, found %zu\n",
+            estimates.size(), columns.size());
+    return 1;
+  }
+
+  /* re-construct records */
+  std::vector<dso::sinex::SolutionEstimate> records;
+  columns.to_records(records);
+  for (std::size_t i = 0; i < records.size(); i++) {
+    if (!same_record(records[i], estimates[i])) {
+      fprintf(stderr, "ERROR. Record %zu differs\n", i);
+      ++error;
+    }
+  }
+
+  /* select by site and parameter type */
+  const int stax = columns.parameter_type_index("STAX");
+  std::vector<std::uint32_t> rows;
+  std::vector<double> values;
+  for (const auto &site : siteids) {
+    const auto key =
+        dso::sinex::details::site_key(site.site_code(), site.point_code());
+    const int types[] = {stax,
+                         dso::sinex::SolutionEstimateColumns::
+                             any_parameter_type};
+    for (int type : types) {
+      columns.select(key, type, rows);
+      columns.gather(columns.estimates(), rows, values);
+      std::vector<double> expected;
+      for (const auto &e : estimates) {
+        if (!std::strcmp(e.site_code(), site.site_code()) &&
+            !std::strcmp(e.point_code(), site.point_code()) &&
+            ((type < 0) || !std::strcmp(e.parameter_type(), "STAX")))
+          expected.push_back(e.estimate());
+      }
+      if (expected.empty() || (values != expected)) {
+        fprintf(stderr, "ERROR. Selection for site %s differs\n",
+                site.site_code());
+        ++error;
+      }
+    }
+  }
+
+  /* select by parameter type only */
+  if (columns.select(dso::sinex::SolutionEstimateColumns::any_site, stax,
+                     rows) != (std::size_t)num_sites * num_solns) {
+    fprintf(stderr, "ERROR. Selection for parameter STAX differs\n");
+    ++error;
+  }
+  return error;
+}
+} /* anonymous namespace */
+
+int main() {
+  return dso::sinex::test::run_on_synthetic(fn, num_sites, num_solns, false,
+                                            check_snx);
+}
@@ -0,0 +1,129 @@
+#include "sinex.hpp"
+#include "synthetic_sinex.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+/* Test program: Covariance propagation for extrapolated coordinates
+ *
+ * A synthetic SINEX file with a SOLUTION/MATRIX_ESTIMATE L COVA block is
+ * created and coordinates are extrapolated along with their covariance
+ * matrices (see dso::Sinex::linear_extrapolate_coordinates) for a number of
+ * epochs. Coordinates should match the ones extrapolated without
+ * covariances, and covariance matrices the product J C J^T computed off from
+ * the 6x6 STA/VEL covariance matrix of each site (see
+ * dso::sinex::ParameterIndex).
+ */
+
+namespace {
+const char *fn = "test_extrapolate_covariance.snx";
+constexpr int num_sites = 40;
+constexpr int num_solns = 3;
+using dso::sinex::test::Epoch;
+using dso::sinex::test::doy;
+
+/* expected covariance matrix of the coordinates of a site: J C J^T, with
+ * J = [I, dt I] */
+int expected_covariance(const dso::sinex::ParameterIndex &pidx,
+                        const dso::sinex::SymmetricMatrix &packed,
+                        const dso::Sinex::SiteCoordinateResults &c,
+                        const Epoch &t, double cov[3][3]) {
+  Eigen::Matrix<double, 6, 6> sv;
+  if (pidx.sta_vel_covariance(c.msite, c.soln_id(), packed, sv))
+    return 1;
+  const int stax = dso::sinex::parameter_type_id("STAX", 4);
+  const auto *e = pidx.parameter(pidx.index(c.msite, c.soln_id(), stax));
+  const double dt =
+      t.diff<dso::DateTimeDifferenceType::FractionalYears>(e->epoch())
+          .years();
+  double j[3][6] = {};
+  for (int a = 0; a < 3; a++) {
+    j[a][a] = 1e0;
+    j[a][a + 3] = dt;
+  }
+  for (int a = 0; a < 3; a++) {
+    for (int b = 0; b < 3; b++) {
+      cov[a][b] = 0e0;
+      for (int p = 0; p < 6; p++)
+        for (int q = 0; q < 6; q++)
+          cov[a][b] += j[a][p] * sv(p, q) * j[b][q];
+    }
+  }
+  return 0;
+}
+
+bool differ(double a, double b) noexcept {
+  return std::abs(a - b) > 1e-12 * std::max(std::abs(a), std::abs(b));
+}
+
+int check_snx(const dso::Sinex &snx) {
+  int error = 0;
+  dso::sinex::SymmetricMatrix packed;
+  std::vector<dso::sinex::SiteId> sites, subset;
+  std::vector<dso::sinex::SolutionEstimate> estimates;
+  if (snx.parse_block_matrix_estimate(dso::sinex::MatrixType::Covariance,
+                                      packed) ||
+      snx.parse_block_site_id(sites) ||
+      snx.parse_block_solution_estimate(sites, estimates)) {
+    fprintf(stderr, "ERROR. Failed parsing SINEX\n");
+    return 1;
+  }
+  dso::sinex::ParameterIndex pidx;
+  if (pidx.build(estimates)) {
+    fprintf(stderr, "ERROR. Failed building parameter index\n");
+    return 1;
+  }
+  for (std::size_t i = 0; i < sites.size(); i += 3)
+    subset.push_back(sites[i]);
+
+  for (const auto &t : {doy(1990, 10), doy(2000, 100), doy(2030, 1)}) {
+    std::vector<dso::Sinex::SiteCoordinateResults> crd, crd_cov;
+    if (snx.linear_extrapolate_coordinates(subset, t, crd) ||
+        snx.linear_extrapolate_coordinates(subset, t, packed, crd_cov) ||
+        (crd_cov.size() != subset.size())) {
+      fprintf(stderr, "ERROR. Failed extrapolating coordinates\n");
+      ++error;
+      continue;
+    }
+    for (std::size_t i = 0; i < crd.size(); i++) {
+      const auto &c = crd_cov[i];
+      double cov[3][3];
+      if (std::strcmp(c.soln_id(), crd[i].soln_id()) || (c.x != crd[i].x) ||
+          (c.y != crd[i].y) || (c.z != crd[i].z) ||
+          expected_covariance(pidx, packed, c, t, cov)) {
+        fprintf(stderr, "ERROR. Coordinates of site %s differ\n",
+                subset[i].site_code());
+        ++error;
+        continue;
+      }
+      int bad = 0;
+      for (int a = 0; a < 3; a++)
+        for (int b = 0; b < 3; b++)
+          bad += differ(c.cov(a, b), cov[a][b]);
+      bad += differ(c.sx, std::sqrt(cov[0][0])) +
+             differ(c.sy, std::sqrt(cov[1][1])) +
+             differ(c.sz, std::sqrt(cov[2][2]));
+      if (bad) {
+        fprintf(stderr, "ERROR. Covariance of site %s differs\n",
+                subset[i].site_code());
+        ++error;
+      }
+    }
+  }
+
+  /* parameters outside the matrix are an error */
+  std::vector<dso::Sinex::SiteCoordinateResults> crd;
+  dso::sinex::SymmetricMatrix small(6);
+  if (!snx.linear_extrapolate_coordinates(subset, doy(2000, 1), small, crd)) {
+    fprintf(stderr, "ERROR. Expected failure for small matrix\n");
+    ++error;
+  }
+  return error;
+}
+} /* anonymous namespace */
+
+int main() {
+  return dso::sinex::test::run_on_synthetic(fn, num_sites, num_solns, true,
+                                            check_snx);
+}
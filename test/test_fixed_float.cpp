@@ -0,0 +1,169 @@
+#include "core/sinex_float.hpp"
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+
+/* Test program: Fixed-format float decoding
+ *
+ * from_chars_fixed should be bit-exact with std::from_chars, for both the
+ * value decoded and the position/error reported. Numbers are written in the
+ * Fortran formats used in SINEX (E21.15, E11.6, E21.14, F8.4, ...), in
+ * random formats and as random character sequences, and decoded by both.
+ */
+
+namespace {
+int num_errors = 0;
+
+void compare(const char *str, int len) {
+  double v1 = -1e0, v2 = -1e0;
+  const auto r1 = std::from_chars(str, str + len, v1);
+  const auto r2 = dso::sinex::details::from_chars_fixed(str, str + len, v2);
+  std::uint64_t b1, b2;
+  std::memcpy(&b1, &v1, sizeof(double));
+  std::memcpy(&b2, &v2, sizeof(double));
+  if ((r1.ec != r2.ec) || (r1.ptr != r2.ptr) ||
+      ((r1.ec == std::errc{}) && (b1 != b2))) {
+    if (++num_errors < 20)
+      fprintf(stderr, "ERROR. Decoding \"%.*s\" gave %.17e (%+d) vs %.17e "
+                      "(%+d)\n",
+              len, str, v1, (int)(r1.ptr - str), v2, (int)(r2.ptr - str));
+  }
+}
+
+/* decode str as is (i.e. near the end of a range), and followed by more
+ * fields (i.e. mid-line) */
+void check(const char *str, int len) {
+  compare(str, len);
+  char line[128];
+  std::memcpy(line, str, len);
+  const char *tail = "  0.123456789012345E+01 -0.5E-03";
+  std::memcpy(line + len, tail, std::strlen(tail));
+  compare(line, len + std::strlen(tail));
+}
+
+void check(const char *str) { check(str, std::strlen(str)); }
+} /* anonymous namespace */
+
+int main() {
+  /* edge cases */
+  const char *edge[] = {"",
+                        "-",
+                        ".",
+                        "-.",
+                        "0.",
+                        ".5",
+                        "5.",
+                        "0.0",
+                        "-0.0",
+                        "-0.000000000000000E+00",
+                        "0.100000000000000E+01",
+                        "1.0E",
+                        "1.0E+",
+                        "1.0E-",
+                        "1.0e5x",
+                        "1.0E+0005",
+                        "1.0E+22",
+                        "1.0E+23",
+                        "1.0E-22",
+                        "1.0E-23",
+                        "1.0E+308",
+                        "1.0E+309",
+                        "1.0E-320",
+                        "1.0E-400",
+                        "+1.0",
+                        "1",
+                        "12345",
+                        "inf",
+                        "-nan",
+                        "9007199254740992.0",
+                        "9007199254740993.0",
+                        "9007199254740994.0",
+                        "0.9007199254740993",
+                        "1234567890123456789.0",
+                        "12345678901234567890.0",
+                        "0.12345678901234567890123456789",
+                        "0.1234567890123456789E+10",
+                        "00000000000000000000001.5",
+                        "1.5  2.5",
+                        "1.5-2.5",
+                        "1..5",
+                        "1.5.5",
+                        " 1.5"};
+  for (const char *s : edge)
+    check(s);
+
+  std::mt19937_64 rng(12345);
+  std::uniform_real_distribution<double> mantissa(-1e1, 1e1);
+  std::uniform_int_distribution<int> exponent(-30, 30);
+  std::uniform_int_distribution<int> precision(0, 18);
+  std::uniform_int_distribution<std::uint64_t> bits;
+
+  /* SINEX formats */
+  const char *formats[] = {"%21.15E", "%22.15E", "%11.6E", "%21.14E",
+                           "%12.5E",  "%8.4f",   "%7.1f",  "%.17g"};
+  char buf[128];
+  for (int i = 0; i < 200000; i++) {
+    const double x = mantissa(rng) * std::pow(1e1, exponent(rng));
+    for (const char *fmt : formats) {
+      const int len = std::snprintf(buf, sizeof(buf), fmt, x);
+      const char *s = buf;
+      while (*s == ' ')
+        ++s;
+      check(s, len - (s - buf));
+    }
+  }
+
+  /* random precision, including any (finite) bit pattern */
+  for (int i = 0; i < 200000; i++) {
+    double x;
+    const std::uint64_t b = bits(rng);
+    std::memcpy(&x, &b, sizeof(double));
+    if (!std::isfinite(x))
+      continue;
+    const int len = std::snprintf(buf, sizeof(buf), "%.*E", precision(rng), x);
+    check(buf, len);
+    const int len2 =
+        std::snprintf(buf, sizeof(buf), "%.*f", precision(rng),
+                      mantissa(rng) * std::pow(1e1, exponent(rng) / 3));
+    check(buf, len2);
+  }
+
+  /* random character sequences off a small alphabet */
+  const char alphabet[] = "0123456789.-+eE 9";
+  std::uniform_int_distribution<int> chr(0, sizeof(alphabet) - 2);
+  std::uniform_int_distribution<int> length(1, 30);
+  for (int i = 0; i < 500000; i++) {
+    const int len = length(rng);
+    for (int k = 0; k < len; k++)
+      buf[k] = alphabet[chr(rng)];
+    check(buf, len);
+  }
+
+  /* consecutive fields */
+  const char *line = "  0.100000000000000E+01 -0.250000000000000E-03"
+                     "  0.333333333333333E+02";
+  const char *end = line + std::strlen(line);
+  double vals[3];
+  if (dso::sinex::details::from_chars_fixed(line, end, vals, 3) != 3 ||
+      line != end || vals[0] != 1e0 || vals[1] != -0.25e-3 ||
+      vals[2] != 0.333333333333333e+02) {
+    fprintf(stderr, "ERROR. Failed decoding consecutive fields\n");
+    ++num_errors;
+  }
+
+  /* fewer fields than requested; decoding stops at the first failure */
+  const char *partial = "  0.100000000000000E+01 -0.25E-03  x";
+  const char *p = partial;
+  if (dso::sinex::details::from_chars_fixed(
+          p, partial + std::strlen(partial), vals, 3) != 2 ||
+      p != partial + 33 || vals[1] != -0.25e-3) {
+    fprintf(stderr, "ERROR. Failed decoding partial consecutive fields\n");
+    ++num_errors;
+  }
+
+  return num_errors;
+}
@@ -0,0 +1,102 @@
+#include "sinex.hpp"
+#include "synthetic_sinex.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+/* Test program: Parse a large (multi-million line) SINEX file
+ *
+ * A synthetic SINEX file is created, with (by default) more than two million
+ * SOLUTION/ESTIMATE lines (~200 MB). For each I/O mode, we open the file and
+ * parse the SITE/ID and SOLUTION/ESTIMATE blocks, checking the number of
+ * records collected; throughput numbers are reported for each step. The
+ * file is removed when done.
+ *
+ * As part of the test-suite, this runs on a smaller (~10 MB) file; the
+ * full-size run is only registered if SINEX_LARGE_TESTS is ON (see
+ * 'ctest -L large').
+ *
+ * Usage: test_large_sinex [NUM_SITES] [NUM_SOLUTIONS_PER_SITE]
+ */
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+double secs(Clock::time_point t0, Clock::time_point t1) {
+  return std::chrono::duration<double>(t1 - t0).count();
+}
+} /* anonymous namespace */
+
+int main(int argc, char *argv[]) {
+  const int num_sites = (argc > 1) ? std::atoi(argv[1]) : 40000;
+  const int num_solns = (argc > 2) ? std::atoi(argv[2]) : 9;
+  const char *fn = "test_large_sinex.snx";
+  const long num_estimates = (long)num_sites * num_solns * 6;
+
+  /* query a few sites, spread over the blocks */
+  char code[5];
+  std::vector<std::string> names;
+  for (int i = 0; i < num_sites; i += num_sites / 16 + 1)
+    names.emplace_back(dso::sinex::test::synthetic_site_code(i, code));
+  std::vector<const char *> sites;
+  for (const auto &s : names)
+    sites.push_back(s.c_str());
+
+  double mbytes = 0;
+  auto check = [&](const dso::Sinex &snx) {
+    /* on the first call, report the file size */
+    if (!mbytes) {
+      if (FILE *fp = std::fopen(fn, "rb")) {
+        std::fseek(fp, 0, SEEK_END);
+        mbytes = std::ftell(fp) / 1e6;
+        std::fclose(fp);
+      }
+      printf("SINEX file: %.1f MB, %ld SOLUTION/ESTIMATE lines\n", mbytes,
+             num_estimates);
+      printf("%-10s %10s %10s %14s %14s\n", "Mode", "Open [s]", "Open[MB/s]",
+             "SITE/ID [s]", "ESTIMATE [Ml/s]");
+    }
+
+    /* time opening the file (again) */
+    auto t0 = Clock::now();
+    const dso::Sinex timed(fn, snx.io_mode());
+    auto t1 = Clock::now();
+
+    /* all sites */
+    std::vector<dso::sinex::SiteId> all_sites;
+    if (snx.parse_block_site_id(all_sites) ||
+        ((int)all_sites.size() != num_sites)) {
+      fprintf(stderr, "ERROR. Failed parsing SITE/ID block\n");
+      return 1;
+    }
+    auto t2 = Clock::now();
+
+    /* estimates for a few sites */
+    std::vector<dso::sinex::SiteId> siteids;
+    std::vector<dso::sinex::SolutionEstimate> estimates;
+    if (snx.parse_block_site_id(sites, false, siteids) ||
+        (siteids.size() != sites.size())) {
+      fprintf(stderr, "ERROR. Failed matching sites in SINEX file\n");
+      return 1;
+    }
+    auto t3 = Clock::now();
+    if (snx.parse_block_solution_estimate(siteids, estimates) ||
+        ((long)estimates.size() != (long)sites.size() * num_solns * 6)) {
+      fprintf(stderr, "ERROR. Failed parsing SOLUTION/ESTIMATE block\n");
+      return 1;
+    }
+    auto t4 = Clock::now();
+
+    printf("%-10s %10.3f %10.1f %14.3f %14.2f\n",
+           (snx.io_mode() == dso::SinexIoMode::Stream) ? "Stream"
+                                                        : "MemoryMap",
+           secs(t0, t1), mbytes / secs(t0, t1), secs(t1, t2),
+           num_estimates / secs(t3, t4) / 1e6);
+    return 0;
+  };
+
+  return dso::sinex::test::run_on_synthetic(fn, num_sites, num_solns, false,
+                                            check);
+}
@@ -0,0 +1,107 @@
+#include "sinex.hpp"
+#include "synthetic_sinex.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+/* Test program: Parse SOLUTION/MATRIX_ESTIMATE into packed storage
+ *
+ * A synthetic SINEX file with a SOLUTION/MATRIX_ESTIMATE L COVA block is
+ * created and the matrix is parsed (see
+ * dso::Sinex::parse_block_matrix_estimate), serially and in parallel. All
+ * elements should match the ones written, in either order of indexes, and
+ * the dense (Eigen) copy should match the packed matrix. The same should
+ * hold for the upper triangle of the matrix written in a
+ * SOLUTION/MATRIX_ESTIMATE U COVA block instead.
+ */
+
+namespace {
+const char *fn = "test_matrix_estimate.snx";
+constexpr int num_sites = 30;
+constexpr int num_solns = 2;
+constexpr int num_params = num_sites * num_solns * 6;
+
+/* element (i,k) of the synthetic matrix, 1-based (written with 15
+ * significant digits) */
+double expected(int i, int k) {
+  if (i < k)
+    std::swap(i, k);
+  return (k == i) ? 1e-4 * (1 + i % 5) : 1e-7 * ((i + k) % 9);
+}
+
+int check_matrix(const dso::Sinex &snx) {
+  int error = 0;
+  for (int nt : {1, 2, 0}) {
+    dso::sinex::SymmetricMatrix m;
+    if (snx.parse_block_matrix_estimate(dso::sinex::MatrixType::Covariance, m,
+                                        nt) ||
+        (m.rows() != num_params) ||
+        (m.size() != (std::size_t)num_params * (num_params + 1) / 2)) {
+      fprintf(stderr, "ERROR. Failed parsing matrix (threads: %d)\n", nt);
+      ++error;
+      continue;
+    }
+    const Eigen::MatrixXd dense = m.dense();
+    const auto packed = m.packed();
+    for (int i = 0; i < num_params; i++) {
+      for (int k = 0; k < num_params; k++) {
+        if ((std::abs(m(i, k) - expected(i + 1, k + 1)) > 1e-17) ||
+            (dense(i, k) != m(i, k)) ||
+            (packed(dso::sinex::SymmetricMatrix::packed_index(i, k)) !=
+             m(i, k))) {
+          fprintf(stderr, "ERROR. Element (%d,%d) differs\n", i, k);
+          ++error;
+        }
+      }
+    }
+  }
+
+  /* no such block */
+  dso::sinex::SymmetricMatrix m;
+  if (!snx.parse_block_matrix_estimate(dso::sinex::MatrixType::Correlation,
+                                       m)) {
+    fprintf(stderr, "ERROR. Expected failure for missing block\n");
+    ++error;
+  }
+
+  return error;
+}
+
+/* replace the lower triangle block with the upper triangle one */
+std::string to_upper(const std::string &content) {
+  const auto b = content.find("+SOLUTION/MATRIX_ESTIMATE L COVA");
+  const auto e = content.find("-SOLUTION/MATRIX_ESTIMATE L COVA\n") + 33;
+  std::string blk = "+SOLUTION/MATRIX_ESTIMATE U COVA\n";
+  char buf[128];
+  for (int i = 1; i <= num_params; i++) {
+    for (int j = i; j <= num_params; j += 3) {
+      int len = std::snprintf(buf, sizeof(buf), " %5d %5d", i, j);
+      for (int k = j; k <= std::min(num_params, j + 2); k++)
+        len += std::snprintf(buf + len, sizeof(buf) - len, " %21.14e",
+                             expected(i, k));
+      blk += std::string(buf) + "\n";
+    }
+  }
+  blk += "-SOLUTION/MATRIX_ESTIMATE U COVA\n";
+  return content.substr(0, b) + blk + content.substr(e);
+}
+} /* anonymous namespace */
+
+int main() {
+  return dso::sinex::test::run_on_synthetic(
+      fn, num_sites, num_solns, true, [](const dso::Sinex &snx) {
+        int error = check_matrix(snx);
+        /* upper triangle, off from a buffer (checked once) */
+        if (snx.io_mode() == dso::SinexIoMode::MemoryMap) {
+          std::ifstream fin(fn);
+          std::stringstream ss;
+          ss << fin.rdbuf();
+          dso::Sinex upper(dso::sinex_buffer, to_upper(ss.str()), "upper");
+          error += check_matrix(upper);
+        }
+        return error;
+      });
+}
@@ -0,0 +1,122 @@
+#include "sinex.hpp"
+#include "synthetic_sinex.hpp"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/* Test program: Covariance matrix of a subset of sites
+ *
+ * A synthetic SINEX file with a SOLUTION/MATRIX_ESTIMATE L COVA block is
+ * created. The SOLUTION/ESTIMATE records of some of its sites are collected
+ * and their covariance matrix is extracted (see
+ * dso::Sinex::parse_block_matrix_estimate), serially and in parallel. It
+ * should match the corresponding sub-matrix of the full (packed) matrix,
+ * also when records are given in a different order or repeated. Lines of
+ * rows off the matrix should be reported, even if not requested.
+ */
+
+namespace {
+const char *fn = "test_matrix_subset.snx";
+constexpr int num_sites = 40;
+constexpr int num_solns = 2;
+
+int check_subset(const dso::Sinex &snx,
+                 const std::vector<dso::sinex::SolutionEstimate> &estimates,
+                 const dso::sinex::SymmetricMatrix &packed) {
+  int error = 0;
+  std::vector<int> idx;
+  for (const auto &e : estimates)
+    idx.push_back(e.index() - 1);
+  Eigen::MatrixXd expected;
+  packed.to_dense(idx, expected);
+
+  for (int nt : {1, 3, 0}) {
+    Eigen::MatrixXd sub;
+    if (snx.parse_block_matrix_estimate(dso::sinex::MatrixType::Covariance,
+                                        estimates, sub, nt)) {
+      fprintf(stderr, "ERROR. Failed extracting sub-matrix (threads: %d)\n",
+              nt);
+      ++error;
+    } else if (sub != expected) {
+      fprintf(stderr, "ERROR. Sub-matrices differ (threads: %d)\n", nt);
+      ++error;
+    }
+  }
+  return error;
+}
+
+/* lines of rows off the matrix (i.e. 0 or n+1) are errors */
+int check_invalid_rows(
+    int n, const std::vector<dso::sinex::SolutionEstimate> &estimates) {
+  std::ifstream fin(fn);
+  std::stringstream ss;
+  ss << fin.rdbuf();
+  const std::string content = ss.str();
+  const auto pos = content.find("-SOLUTION/MATRIX_ESTIMATE L COVA");
+  int error = 0;
+  for (int row : {0, n + 1}) {
+    char line[64];
+    std::snprintf(line, sizeof(line), " %5d %5d %21.14e\n", row, 1, 1e0);
+    dso::Sinex snx(dso::sinex_buffer,
+                   content.substr(0, pos) + line + content.substr(pos),
+                   "invalid");
+    Eigen::MatrixXd sub;
+    if (!snx.parse_block_matrix_estimate(dso::sinex::MatrixType::Covariance,
+                                         estimates, sub)) {
+      fprintf(stderr, "ERROR. Expected failure for matrix row %d\n", row);
+      ++error;
+    }
+  }
+  return error;
+}
+
+int check_snx(const dso::Sinex &snx) {
+  int error = 0;
+  dso::sinex::SymmetricMatrix packed;
+  std::vector<dso::sinex::SiteId> sites, subset;
+  if (snx.parse_block_matrix_estimate(dso::sinex::MatrixType::Covariance,
+                                      packed) ||
+      snx.parse_block_site_id(sites)) {
+    fprintf(stderr, "ERROR. Failed parsing SINEX\n");
+    return 1;
+  }
+  for (std::size_t i = 1; i < sites.size(); i += 6)
+    subset.push_back(sites[i]);
+
+  std::vector<dso::sinex::SolutionEstimate> estimates;
+  if (snx.parse_block_solution_estimate(subset, estimates) ||
+      estimates.size() != subset.size() * num_solns * 6) {
+    fprintf(stderr, "ERROR. Failed parsing SOLUTION/ESTIMATE\n");
+    return 1;
+  }
+  error += check_subset(snx, estimates, packed);
+
+  /* reversed, with a repeated record */
+  std::vector<dso::sinex::SolutionEstimate> reversed(estimates.rbegin(),
+                                                     estimates.rend());
+  reversed.push_back(estimates[3]);
+  error += check_subset(snx, reversed, packed);
+
+  /* no records */
+  error += check_subset(snx, {}, packed);
+
+  /* an index out of range is an error */
+  Eigen::MatrixXd sub;
+  reversed.back().index() = packed.rows() + 1;
+  if (!snx.parse_block_matrix_estimate(dso::sinex::MatrixType::Covariance,
+                                       reversed, sub)) {
+    fprintf(stderr, "ERROR. Expected failure for invalid index\n");
+    ++error;
+  }
+
+  error += check_invalid_rows(packed.rows(), estimates);
+  return error;
+}
+} /* anonymous namespace */
+
+int main() {
+  return dso::sinex::test::run_on_synthetic(fn, num_sites, num_solns, true,
+                                            check_snx);
+}
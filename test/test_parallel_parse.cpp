@@ -0,0 +1,97 @@
+#include "sinex.hpp"
+#include "synthetic_sinex.hpp"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+/* Test program: Parallel (chunked) block parsing
+ *
+ * A synthetic SINEX file (large enough for its SOLUTION/ESTIMATE block to
+ * be split in chunks) is created and the block is parsed using different
+ * numbers of threads, in both I/O modes. Results (records, columns and
+ * query stats) should be identical to the ones of the serial path.
+ */
+
+namespace {
+const char *fn = "test_parallel_parse.snx";
+constexpr int num_sites = 3000;
+constexpr int num_solns = 2;
+using dso::sinex::test::same_estimate;
+
+bool same_estimates(const std::vector<dso::sinex::SolutionEstimate> &a,
+                    const std::vector<dso::sinex::SolutionEstimate> &b) {
+  if (a.size() != b.size())
+    return false;
+  for (std::size_t i = 0; i < a.size(); i++)
+    if (!same_estimate(a[i], b[i]))
+      return false;
+  return true;
+}
+
+int check_snx(const dso::Sinex &snx) {
+  int error = 0;
+
+  /* serial path */
+  std::vector<dso::sinex::SiteId> sites, subset;
+  std::vector<dso::sinex::SolutionEstimate> serial, serial_subset;
+  dso::sinex::SolutionEstimateColumns serial_columns;
+  dso::sinex::QueryStats serial_stats;
+  const auto query =
+      dso::sinex::QueryPredicate().parameter_types({"STAX", "VELY"});
+  if (snx.parse_block_site_id(sites)) {
+    fprintf(stderr, "ERROR. Failed parsing SITE/ID\n");
+    return 1;
+  }
+  for (std::size_t i = 0; i < sites.size(); i += 7)
+    subset.push_back(sites[i]);
+  if (snx.parse_block_solution_estimate(sites, serial) ||
+      snx.parse_block_solution_estimate(subset, serial_subset, query,
+                                        &serial_stats) ||
+      snx.parse_block_solution_estimate(serial_columns) ||
+      (serial.size() != 6UL * num_sites * num_solns)) {
+    fprintf(stderr, "ERROR. Failed parsing SOLUTION/ESTIMATE\n");
+    return 1;
+  }
+  std::vector<dso::sinex::SolutionEstimate> serial_records;
+  serial_columns.to_records(serial_records);
+
+  for (int nt : {2, 3, 4, 8, 0}) {
+    std::vector<dso::sinex::SolutionEstimate> estimates, records;
+    dso::sinex::SolutionEstimateColumns columns;
+    dso::sinex::QueryStats stats;
+    if (snx.parse_block_solution_estimate(sites, estimates,
+                                          dso::sinex::QueryPredicate(),
+                                          nullptr, nt) ||
+        !same_estimates(estimates, serial)) {
+      fprintf(stderr, "ERROR. Parsing with %d threads differs\n", nt);
+      ++error;
+    }
+    if (snx.parse_block_solution_estimate(subset, estimates, query, &stats,
+                                          nt) ||
+        !same_estimates(estimates, serial_subset) ||
+        (stats.lines_skipped != serial_stats.lines_skipped) ||
+        (stats.lines_decoded != serial_stats.lines_decoded)) {
+      fprintf(stderr, "ERROR. Querying with %d threads differs\n", nt);
+      ++error;
+    }
+    if (snx.parse_block_solution_estimate(columns, dso::sinex::QueryPredicate(),
+                                          nullptr, nt)) {
+      fprintf(stderr, "ERROR. Failed parsing columns with %d threads\n", nt);
+      ++error;
+    } else {
+      columns.to_records(records);
+      if (!same_estimates(records, serial_records)) {
+        fprintf(stderr, "ERROR. Columns with %d threads differ\n", nt);
+        ++error;
+      }
+    }
+  }
+
+  return error;
+}
+} /* anonymous namespace */
+
+int main() {
+  return dso::sinex::test::run_on_synthetic(fn, num_sites, num_solns, false,
+                                            check_snx);
+}
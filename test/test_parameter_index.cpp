@@ -0,0 +1,127 @@
+#include "sinex.hpp"
+#include "synthetic_sinex.hpp"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+/* Test program: Parameter index
+ *
+ * A synthetic SINEX file with a SOLUTION/MATRIX_ESTIMATE L COVA block is
+ * created, and a dso::sinex::ParameterIndex is built off from its
+ * SOLUTION/ESTIMATE records. Parameter indexes are checked against the
+ * (known) layout of the file, in both directions, and the 6x6 STA/VEL
+ * covariance matrices of the sites against the full (packed) matrix.
+ */
+
+namespace {
+const char *fn = "test_parameter_index.snx";
+constexpr int num_sites = 30;
+constexpr int num_solns = 3;
+const char *ptypes[] = {"STAX", "STAY", "STAZ", "VELX", "VELY", "VELZ"};
+
+/* index of parameter p of solution s (0-based) of site i, as written by
+ * write_synthetic_sinex */
+int expected_index(int i, int s, int p) noexcept {
+  return (i * num_solns + s) * 6 + p + 1;
+}
+
+int check_snx(const dso::Sinex &snx) {
+  int error = 0;
+  dso::sinex::SymmetricMatrix packed;
+  std::vector<dso::sinex::SiteId> sites;
+  std::vector<dso::sinex::SolutionEstimate> estimates;
+  if (snx.parse_block_matrix_estimate(dso::sinex::MatrixType::Covariance,
+                                      packed) ||
+      snx.parse_block_site_id(sites) ||
+      snx.parse_block_solution_estimate(sites, estimates)) {
+    fprintf(stderr, "ERROR. Failed parsing SINEX\n");
+    return 1;
+  }
+
+  dso::sinex::ParameterIndex pidx;
+  if (pidx.build(estimates) || pidx.size() != estimates.size()) {
+    fprintf(stderr, "ERROR. Failed building parameter index\n");
+    return 1;
+  }
+
+  char soln[16];
+  for (int i = 0; i < (int)sites.size(); i++) {
+    for (int s = 0; s < num_solns; s++) {
+      std::snprintf(soln, sizeof(soln), "%4d", s + 1);
+      for (int p = 0; p < 6; p++) {
+        const int ptype = dso::sinex::parameter_type_id(ptypes[p], 4);
+        const int index = pidx.index(sites[i], soln, ptype);
+        const auto *e = pidx.parameter(index);
+        if (index != expected_index(i, s, p) || !e ||
+            e->parameter_type_id() != ptype ||
+            std::strncmp(e->site_code(), sites[i].site_code(), 4)) {
+          fprintf(stderr, "ERROR. Wrong index for site %s, parameter %s\n",
+                  sites[i].site_code(), ptypes[p]);
+          ++error;
+        }
+      }
+
+      Eigen::Matrix<double, 6, 6> cov;
+      if (pidx.sta_vel_covariance(sites[i], soln, packed, cov)) {
+        fprintf(stderr, "ERROR. No covariance matrix for site %s\n",
+                sites[i].site_code());
+        ++error;
+        continue;
+      }
+      for (int r = 0; r < 6; r++)
+        for (int c = 0; c < 6; c++)
+          if (cov(r, c) != packed(expected_index(i, s, r) - 1,
+                                  expected_index(i, s, c) - 1)) {
+            fprintf(stderr, "ERROR. Wrong covariance for site %s\n",
+                    sites[i].site_code());
+            ++error;
+          }
+    }
+  }
+
+  /* unknown solution, site or parameter type */
+  const int stax = dso::sinex::parameter_type_id("STAX", 4);
+  if (pidx.index(sites[0], "  99", stax) != -1 ||
+      pidx.index("XXXX", "A", "   1", stax) != -1 ||
+      pidx.index(sites[0], "   1", dso::sinex::parameter_type_id("UT", 2)) !=
+          -1 ||
+      pidx.parameter(0) || pidx.parameter(packed.rows() + 1) ||
+      pidx.sta_vel_indexes(sites[0], "  99")) {
+    fprintf(stderr, "ERROR. Found unknown parameter\n");
+    ++error;
+  }
+
+  /* a site missing VELZ has no STA/VEL covariance */
+  std::vector<dso::sinex::SolutionEstimate> partial;
+  for (const auto &e : estimates)
+    if (e.index() != expected_index(0, 0, 5))
+      partial.push_back(e);
+  Eigen::Matrix<double, 6, 6> cov;
+  if (pidx.build(partial) || pidx.sta_vel_indexes(sites[0], "   1") ||
+      !pidx.sta_vel_indexes(sites[0], "   2") ||
+      !pidx.sta_vel_covariance(sites[0], "   1", packed, cov)) {
+    fprintf(stderr, "ERROR. Wrong handling of missing parameters\n");
+    ++error;
+  }
+
+  /* parameters outside the matrix */
+  dso::sinex::SymmetricMatrix small(6);
+  if (!pidx.sta_vel_covariance(sites[1], "   1", small, cov)) {
+    fprintf(stderr, "ERROR. Expected failure for small matrix\n");
+    ++error;
+  }
+
+  /* invalid parameter index */
+  partial[0].index() = 0;
+  if (!pidx.build(partial)) {
+    fprintf(stderr, "ERROR. Expected failure for invalid index\n");
+    ++error;
+  }
+  return error;
+}
+} /* anonymous namespace */
+
+int main() {
+  return dso::sinex::test::run_on_synthetic(fn, num_sites, num_solns, true,
+                                            check_snx);
+}
@@ -0,0 +1,166 @@
+#include "sinex.hpp"
+#include "synthetic_sinex.hpp"
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+/* Test program: Preloading blocks in the background
+ *
+ * A synthetic SINEX file is created and its blocks are preloaded (see
+ * dso::Sinex::preload), in both I/O modes. Queries on the preloaded
+ * instance (issued concurrently) should return the same records as the
+ * ones of an instance parsing blocks on demand. Preloading a block that
+ * does not exist should fail and preload nothing.
+ */
+
+namespace {
+const char *fn = "test_preload.snx";
+constexpr int num_sites = 120;
+constexpr int num_solns = 3;
+using dso::sinex::test::Epoch;
+using dso::sinex::test::doy;
+using dso::sinex::test::same_estimate;
+using dso::sinex::test::same_site;
+using dso::sinex::test::same_epoch;
+
+bool same_eccentricity(const dso::sinex::SiteEccentricity &a,
+                       const dso::sinex::SiteEccentricity &b) {
+  return !std::strcmp(a.site_code(), b.site_code()) &&
+         (a.start == b.start) && (a.stop == b.stop);
+}
+
+template <typename T, typename Cmp>
+int compare(const char *what, const std::vector<T> &a,
+            const std::vector<T> &b, Cmp &&same) {
+  bool ok = (a.size() == b.size());
+  for (std::size_t i = 0; ok && i < a.size(); i++)
+    ok = same(a[i], b[i]);
+  if (!ok) {
+    fprintf(stderr, "ERROR. %s differ (%zu vs %zu records)\n", what,
+            a.size(), b.size());
+    return 1;
+  }
+  return 0;
+}
+
+/* run all queries on snx; results are compared against the ones of ref */
+int check_queries(const dso::Sinex &snx, const dso::Sinex &ref) {
+  int error = 0;
+  std::vector<dso::sinex::SiteId> all, sites, rsites, subset;
+  if (snx.parse_block_site_id(sites) || ref.parse_block_site_id(rsites) ||
+      (sites.size() != (std::size_t)num_sites))
+    return 1;
+  error += compare("SITE/ID", sites, rsites, same_site);
+  all = rsites;
+  for (std::size_t i = 0; i < all.size(); i += 5)
+    subset.push_back(all[i]);
+  if (snx.parse_block_site_id({"S001", "S00A"}, false, sites) ||
+      ref.parse_block_site_id({"S001", "S00A"}, false, rsites))
+    return 1;
+  error += compare("SITE/ID subset", sites, rsites, same_site);
+
+  std::vector<dso::sinex::SolutionEpoch> epochs, repochs;
+  for (bool extrapolate : {false, true}) {
+    for (const auto &t : {doy(2000, 100), doy(2012, 1)}) {
+      if (snx.parse_solution_epoch(subset, t, extrapolate, epochs) ||
+          ref.parse_solution_epoch(subset, t, extrapolate, repochs))
+        return 1;
+      error += compare("SOLUTION/EPOCHS", epochs, repochs, same_epoch);
+    }
+  }
+
+  std::vector<dso::sinex::SolutionEstimate> estimates, restimates;
+  if (snx.parse_block_solution_estimate(subset, estimates) ||
+      ref.parse_block_solution_estimate(subset, restimates))
+    return 1;
+  error += compare("SOLUTION/ESTIMATE", estimates, restimates, same_estimate);
+  if (snx.parse_block_solution_estimate(subset, doy(2000, 100), true,
+                                        estimates) ||
+      ref.parse_block_solution_estimate(subset, doy(2000, 100), true,
+                                        restimates))
+    return 1;
+  error += compare("SOLUTION/ESTIMATE at epoch", estimates, restimates,
+                   same_estimate);
+  dso::sinex::SolutionEstimateColumns columns;
+  if (snx.parse_block_solution_estimate(columns) ||
+      ref.parse_block_solution_estimate(all, restimates))
+    return 1;
+  columns.to_records(estimates);
+  error += compare("SOLUTION/ESTIMATE columns", estimates, restimates,
+                   same_estimate);
+
+  /* a query predicate reads the block, preloaded or not */
+  dso::sinex::QueryStats stats;
+  if (snx.parse_block_solution_estimate(
+          subset, estimates,
+          dso::sinex::QueryPredicate().parameter_types({"VELZ"}), &stats) ||
+      (estimates.size() != (std::size_t)num_solns * subset.size()) ||
+      (stats.lines_decoded != (long)estimates.size())) {
+    fprintf(stderr, "ERROR. Query on a preloaded block failed\n");
+    ++error;
+  }
+
+  std::vector<dso::sinex::SiteEccentricity> eccs, reccs;
+  if (snx.parse_block_site_eccentricity(subset, doy(2005, 1), eccs) ||
+      ref.parse_block_site_eccentricity(subset, doy(2005, 1), reccs))
+    return 1;
+  error += compare("SITE/ECCENTRICITY", eccs, reccs, same_eccentricity);
+
+  return error;
+}
+
+/* ref is an instance parsing blocks on demand */
+int check_snx(const dso::Sinex &ref) {
+  int error = 0;
+  const dso::SinexIoMode mode = ref.io_mode();
+
+  /* SOLUTION/DATA_REJECT does not exist; nothing is preloaded */
+  dso::Sinex failed(fn, mode);
+  const std::vector<dso::sinex::SiteId> *none;
+  if (!failed.preload({"SITE/ID", "SOLUTION/DATA_REJECT"}) ||
+      !failed.preloaded_records(none) || !failed.preload({"SITE/DOMES"})) {
+    fprintf(stderr, "ERROR. Expected preloading to fail\n");
+    ++error;
+  }
+
+  dso::Sinex snx(fn, mode);
+  if (snx.preload({"SITE/ID", "SOLUTION/EPOCHS", "SOLUTION/ESTIMATE",
+                   "SITE/ECCENTRICITY"}) ||
+      snx.preload({"SITE/ID"})) {
+    fprintf(stderr, "ERROR. Failed preloading blocks\n");
+    return error + 1;
+  }
+
+  /* all records of the preloaded blocks */
+  const std::vector<dso::sinex::SolutionEstimate> *estimates;
+  const std::vector<dso::sinex::SiteReceiver> *receivers;
+  if (snx.preloaded_records(estimates) ||
+      (estimates->size() != 6UL * num_sites * num_solns) ||
+      !snx.preloaded_records(receivers)) {
+    fprintf(stderr, "ERROR. Unexpected preloaded records\n");
+    ++error;
+  }
+
+  /* concurrent queries on the preloaded instance */
+  std::vector<int> errors(4, 0);
+  std::vector<std::thread> threads;
+  for (std::size_t i = 0; i < errors.size(); i++)
+    threads.emplace_back([&, i]() { errors[i] = check_queries(snx, ref); });
+  for (auto &t : threads)
+    t.join();
+  for (int e : errors)
+    error += e;
+
+  /* destroyed right after preloading; must wait for the tasks */
+  dso::Sinex dropped(fn, mode);
+  error += dropped.preload({"SOLUTION/ESTIMATE", "SOLUTION/EPOCHS"});
+
+  return error;
+}
+} /* anonymous namespace */
+
+int main() {
+  return dso::sinex::test::run_on_synthetic(fn, num_sites, num_solns, false,
+                                            check_snx);
+}
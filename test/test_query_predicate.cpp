@@ -0,0 +1,205 @@
+#include "sinex.hpp"
+#include "synthetic_sinex.hpp"
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+/* Test program: Query predicates
+ *
+ * A synthetic SINEX file is created and its blocks are parsed with query
+ * predicates (sinex::QueryPredicate). Collected records should match the
+ * ones of an unfiltered parse, filtered after decoding; the number of
+ * lines skipped plus the ones decoded should equal the number of records
+ * in the block. Unknown parameter types should be rejected when building
+ * a predicate, and lines with an undecodable parameter type accepted (so
+ * that the block parser reports them).
+ */
+
+namespace {
+const char *fn = "test_query_predicate.snx";
+constexpr int num_sites = 40;
+constexpr int num_solns = 3;
+using dso::sinex::test::Epoch;
+using dso::sinex::test::doy;
+using dso::sinex::test::same_estimate;
+
+int check_stats(const char *what, const dso::sinex::QueryStats &stats,
+                long records, long decoded) {
+  if ((stats.lines_skipped + stats.lines_decoded != records) ||
+      (stats.lines_decoded != decoded)) {
+    fprintf(stderr,
+            "ERROR. %s: skipped %ld + decoded %ld lines, expected %ld "
+            "decoded out of %ld\n",
+            what, stats.lines_skipped, stats.lines_decoded, decoded, records);
+    return 1;
+  }
+  return 0;
+}
+
+/* SOLUTION/ESTIMATE line of the given parameter type */
+void estimate_line(const char *ptype, char *line) {
+  std::sprintf(line,
+               " %5d %-6s %4s  A %4d 10:001:00000 %-4s 2 %21.15e %11.5e", 1,
+               ptype, "S001", 1, "m", 1e0, 1e-3);
+}
+
+int check_parameter_types() {
+  using L = dso::sinex::details::layout::SolutionEstimate;
+  int error = 0;
+  const Epoch t0 = doy(1993, 3), t1 = doy(2022, 365);
+  char line[128];
+
+  /* unknown types are an error, leaving the predicate unchanged */
+  dso::sinex::QueryPredicate query;
+  for (const auto &types : std::vector<std::vector<const char *>>{
+           {"FOO"}, {"STAX", "FOO"}, {""}, {"STAXX"}}) {
+    try {
+      query.parameter_types(types);
+      fprintf(stderr, "ERROR. Accepted invalid parameter type %s\n",
+              types.back());
+      ++error;
+    } catch (std::invalid_argument &) {
+      ;
+    }
+  }
+  if (!query.accepts_all()) {
+    fprintf(stderr, "ERROR. Predicate changed by invalid parameter types\n");
+    ++error;
+  }
+
+  /* whitespaces are not considered */
+  query.parameter_types({" STAX "});
+  const char *expected[][2] = {{"STAX", "1"},   {"STAY", "0"},
+                               {"FOOBAR", "1"}, {"STAXfo", "1"},
+                               {"STAYfo", "0"}, {"", "1"}};
+  for (const auto &e : expected) {
+    estimate_line(e[0], line);
+    const bool accepted = query.accepts<L>(line, std::strlen(line), t0, t1);
+    if (accepted != (e[1][0] == '1')) {
+      fprintf(stderr, "ERROR. Parameter type \"%s\" %s\n", e[0],
+              accepted ? "accepted" : "rejected");
+      ++error;
+    }
+  }
+  return error;
+}
+
+int check_snx(const dso::Sinex &snx) {
+  int error = 0;
+  const long num_params = 6L * num_sites * num_solns;
+
+  /* unfiltered */
+  std::vector<dso::sinex::SiteId> siteids;
+  std::vector<dso::sinex::SolutionEstimate> all;
+  dso::sinex::QueryStats stats;
+  if (snx.parse_block_site_id(siteids) ||
+      snx.parse_block_solution_estimate(siteids, all,
+                                        dso::sinex::QueryPredicate(), &stats)) {
+    fprintf(stderr, "ERROR. Failed parsing SINEX %s\n", fn);
+    return 1;
+  }
+  error += check_stats("no query", stats, num_params, num_params);
+
+  /* sites, parameter types and solution ids */
+  const auto query = dso::sinex::QueryPredicate()
+                         .sites({"S001", "S00A", "XXXX"})
+                         .parameter_types({"STAX", "VELZ"})
+                         .soln_ids({" 2"});
+  std::vector<dso::sinex::SolutionEstimate> estimates, expected;
+  for (const auto &e : all)
+    if ((!std::strcmp(e.site_code(), "S001") ||
+         !std::strcmp(e.site_code(), "S00A")) &&
+        (!std::strcmp(e.parameter_type(), "STAX") ||
+         !std::strcmp(e.parameter_type(), "VELZ")) &&
+        (e.soln_id_int() == 2))
+      expected.push_back(e);
+  stats = dso::sinex::QueryStats();
+  if (snx.parse_block_solution_estimate(siteids, estimates, query, &stats) ||
+      (estimates.size() != expected.size()) || expected.empty()) {
+    fprintf(stderr, "ERROR. Expected %zu filtered estimates, got %zu\n",
+            expected.size(), estimates.size());
+    ++error;
+  } else {
+    for (std::size_t i = 0; i < expected.size(); i++)
+      if (!same_estimate(estimates[i], expected[i])) {
+        fprintf(stderr, "ERROR. Filtered estimate %zu differs\n", i);
+        ++error;
+      }
+  }
+  error += check_stats("estimates", stats, num_params, expected.size());
+
+  /* same query, columnar form */
+  dso::sinex::SolutionEstimateColumns columns;
+  stats = dso::sinex::QueryStats();
+  if (snx.parse_block_solution_estimate(columns, query, &stats) ||
+      (columns.size() != expected.size())) {
+    fprintf(stderr, "ERROR. Expected %zu filtered columns, got %zu\n",
+            expected.size(), columns.size());
+    ++error;
+  }
+  error += check_stats("columns", stats, num_params, expected.size());
+
+  /* time window on the estimates epoch (10:001 for all) */
+  stats = dso::sinex::QueryStats();
+  if (snx.parse_block_solution_estimate(
+          siteids, estimates,
+          dso::sinex::QueryPredicate().window(doy(2010, 2), doy(2011, 1)),
+          &stats) ||
+      !estimates.empty()) {
+    fprintf(stderr, "ERROR. Expected no estimates off the window\n");
+    ++error;
+  }
+  error += check_stats("window", stats, num_params, 0);
+
+  /* time window on SOLUTION/EPOCHS; only solution 1 spans 2000 */
+  std::vector<dso::sinex::SolutionEpoch> epochs;
+  stats = dso::sinex::QueryStats();
+  if (snx.parse_solution_epoch(
+          siteids, doy(2000, 100), true, epochs,
+          dso::sinex::QueryPredicate().window(doy(2000, 1), doy(2000, 2)),
+          &stats) ||
+      (epochs.size() != siteids.size())) {
+    fprintf(stderr, "ERROR. Expected %zu solution epochs, got %zu\n",
+            siteids.size(), epochs.size());
+    ++error;
+  } else {
+    for (const auto &e : epochs)
+      if (e.soln_id_int() != 1) {
+        fprintf(stderr, "ERROR. Collected solution %s for site %s\n",
+                e.soln_id(), e.site_code());
+        ++error;
+      }
+  }
+  error += check_stats("epochs", stats, (long)num_sites * num_solns, num_sites);
+
+  /* observation codes; all sites are DORIS */
+  std::vector<dso::sinex::SiteId> sites;
+  stats = dso::sinex::QueryStats();
+  if (snx.parse_block_site_id(
+          sites, dso::sinex::QueryPredicate().techniques(
+                     {dso::sinex::SinexObservationCode::GNSS}),
+          &stats) ||
+      !sites.empty()) {
+    fprintf(stderr, "ERROR. Expected no GNSS sites\n");
+    ++error;
+  }
+  error += check_stats("GNSS sites", stats, num_sites, 0);
+  if (snx.parse_block_site_id(
+          sites, dso::sinex::QueryPredicate().techniques(
+                     {dso::sinex::SinexObservationCode::GNSS,
+                      dso::sinex::SinexObservationCode::DORIS})) ||
+      (sites.size() != (std::size_t)num_sites)) {
+    fprintf(stderr, "ERROR. Expected %d DORIS sites, got %zu\n", num_sites,
+            sites.size());
+    ++error;
+  }
+  return error;
+}
+} /* anonymous namespace */
+
+int main() {
+  return check_parameter_types() +
+         dso::sinex::test::run_on_synthetic(fn, num_sites, num_solns, false,
+                                            check_snx);
+}
@@ -0,0 +1,138 @@
+#include "sinex.hpp"
+#include "synthetic_sinex.hpp"
+#include <cstdio>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+/* Test program: Record views
+ *
+ * A synthetic SINEX file is created and its SITE/ID and SOLUTION/ESTIMATE
+ * blocks are accessed both via the (eager) block parsers and via record
+ * views. Fields decoded off the views, as well as materialized records,
+ * should match the parsed records. Views are not available in Stream mode.
+ */
+
+namespace {
+const char *fn = "test_record_views.snx";
+constexpr int num_sites = 50;
+constexpr int num_solns = 2;
+using dso::sinex::test::same_estimate;
+
+/* compare a (whitespace-padded) view field to a record's field; the
+ * latter is not always null-terminated (e.g. a full-width description) */
+bool same_chars(std::string_view view, const char *str) {
+  const char *nul =
+      static_cast<const char *>(std::memchr(str, '\0', view.size()));
+  return view == std::string_view(str, nul ? nul - str : view.size());
+}
+
+int check_site(const dso::sinex::SiteIdView &view,
+               const dso::sinex::SiteId &site) {
+  double lon, lat, hgt;
+  dso::sinex::SinexObservationCode code;
+  dso::sinex::SiteId m;
+  return !same_chars(view.site_code(), site.site_code()) ||
+         !same_chars(view.point_code(), site.point_code()) ||
+         !same_chars(view.domes(), site.domes()) ||
+         !same_chars(view.description(), site.description()) ||
+         view.obscode(code) || (code != site.obscode()) ||
+         view.longitude(lon) || (lon != site.longitude()) ||
+         view.latitude(lat) || (lat != site.latitude()) ||
+         view.height(hgt) || (hgt != site.height()) || view.materialize(m) ||
+         std::strcmp(m.site_code(), site.site_code()) ||
+         std::strcmp(m.domes(), site.domes()) ||
+         (m.longitude() != site.longitude()) ||
+         (m.latitude() != site.latitude()) || (m.height() != site.height());
+}
+
+int check_estimate(const dso::sinex::SolutionEstimateView &view,
+                   const dso::sinex::SolutionEstimate &est,
+                   const dso::datetime<dso::nanoseconds> &data_start) {
+  int index;
+  double val, sdev;
+  dso::sinex::SinexConstraintCode code;
+  dso::datetime<dso::nanoseconds> t;
+  dso::sinex::SolutionEstimate m;
+  return view.index(index) || (index != est.index()) ||
+         (view.parameter_type_id() != est.parameter_type_id()) ||
+         (view.site_key() != dso::sinex::details::site_key(
+                                 est.site_code(), est.point_code())) ||
+         !same_chars(view.soln_id(), est.soln_id()) ||
+         !same_chars(view.units(), est.units()) ||
+         view.epoch(data_start, t) || (t != est.epoch()) ||
+         view.constraint(code) || (code != est.constraint()) ||
+         view.estimate(val) || (val != est.estimate()) ||
+         view.std_deviation(sdev) || (sdev != est.std_deviation()) ||
+         view.materialize(data_start, m) || !same_estimate(m, est);
+}
+
+int check_snx(const dso::Sinex &snx) {
+  /* views need a memory mapping */
+  if (snx.io_mode() == dso::SinexIoMode::Stream) {
+    dso::sinex::RecordRange<dso::sinex::SiteIdView> sites;
+    if (!snx.view_block(sites)) {
+      fprintf(stderr, "ERROR. Got views in Stream mode\n");
+      return 1;
+    }
+    return 0;
+  }
+
+  int error = 0;
+  /* parsed records */
+  std::vector<dso::sinex::SiteId> siteids;
+  std::vector<dso::sinex::SolutionEstimate> estimates;
+  if (snx.parse_block_site_id(siteids) ||
+      snx.parse_block_solution_estimate(siteids, estimates)) {
+    fprintf(stderr, "ERROR. Failed parsing SINEX %s\n", fn);
+    return 1;
+  }
+
+  /* SITE/ID views */
+  dso::sinex::RecordRange<dso::sinex::SiteIdView> sites;
+  if (snx.view_block(sites)) {
+    fprintf(stderr, "ERROR. Failed viewing SITE/ID block\n");
+    return 1;
+  }
+  std::size_t i = 0;
+  for (const auto view : sites) {
+    if ((i >= siteids.size()) || check_site(view, siteids[i])) {
+      fprintf(stderr, "ERROR. SITE/ID view %zu differs\n", i);
+      ++error;
+    }
+    ++i;
+  }
+  if (i != siteids.size()) {
+    fprintf(stderr, "ERROR. Expected %zu SITE/ID views, found %zu\n",
+            siteids.size(), i);
+    ++error;
+  }
+
+  /* SOLUTION/ESTIMATE views */
+  dso::sinex::RecordRange<dso::sinex::SolutionEstimateView> ests;
+  if (snx.view_block(ests)) {
+    fprintf(stderr, "ERROR. Failed viewing SOLUTION/ESTIMATE block\n");
+    return 1;
+  }
+  i = 0;
+  for (auto it = ests.begin(); it != ests.end(); ++it, ++i) {
+    if ((i >= estimates.size()) ||
+        check_estimate(*it, estimates[i], snx.data_start())) {
+      fprintf(stderr, "ERROR. SOLUTION/ESTIMATE view %zu differs\n", i);
+      ++error;
+    }
+  }
+  if (i != estimates.size()) {
+    fprintf(stderr, "ERROR. Expected %zu SOLUTION/ESTIMATE views, found "
+                    "%zu\n",
+            estimates.size(), i);
+    ++error;
+  }
+  return error;
+}
+} /* anonymous namespace */
+
+int main() {
+  return dso::sinex::test::run_on_synthetic(fn, num_sites, num_solns, false,
+                                            check_snx);
+}
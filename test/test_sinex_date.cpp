@@ -0,0 +1,107 @@
+#include "sinex.hpp"
+#include <cstdio>
+
+/* Test program: SINEX datetime strings
+ *
+ * Resolve SINEX datetime strings ("YY:DDD:SSSSS") and check against known
+ * MJD/seconds of day. Fixed-width strings (resolved arithmetically) should
+ * give the same results as the same dates written without leading zeros
+ * (resolved off the generic path), and the batch version should give the
+ * same results as resolving one string at a time.
+ */
+
+namespace {
+using Datetime = dso::datetime<dso::nanoseconds>;
+constexpr long S2NS = 1000000000L;
+
+int check(const char *str, long mjd, long sec) {
+  Datetime t;
+  if (dso::sinex::parse_sinex_date(str, Datetime::min(), t) ||
+      (t.imjd().as_underlying_type() != mjd) ||
+      (t.sec().as_underlying_type() != sec * S2NS)) {
+    fprintf(stderr, "ERROR. Failed resolving date \"%s\"\n", str);
+    return 1;
+  }
+  return 0;
+}
+} /* anonymous namespace */
+
+int main() {
+  int error = 0;
+
+  /* known dates */
+  error += check("00:001:00000", 51544, 0);
+  error += check("05:349:00000", 53719, 0);
+  error += check("99:365:86399", 51543, 86399);
+  error += check("51:001:00000", 33647, 0);
+  error += check("50:365:00000", 70171, 0);
+  error += check("04:366:43200", 53370, 43200);
+  error += check("  04:366:43200", 53370, 43200);
+  error += check("05:349:00000 07:001:00000", 53719, 0);
+  error += check("5:349:0", 53719, 0);
+
+  /* invalid dates */
+  const char *invalid[] = {"05:366:00000", "05:000:00100", "05:xyz:00000",
+                           "abc"};
+  for (const char *str : invalid) {
+    Datetime t;
+    if (!dso::sinex::parse_sinex_date(str, Datetime::min(), t)) {
+      fprintf(stderr, "ERROR. Resolved invalid date \"%s\"\n", str);
+      ++error;
+    }
+  }
+
+  /* default value */
+  {
+    Datetime t;
+    if (dso::sinex::parse_sinex_date("00:000:00000", Datetime::max(), t) ||
+        (t != Datetime::max())) {
+      fprintf(stderr, "ERROR. Failed resolving default date\n");
+      ++error;
+    }
+  }
+
+  /* fixed-width vs generic path */
+  char fixed[32], generic[32];
+  for (int yy = 0; yy < 100; yy++) {
+    for (int doy = 1; doy <= 366; doy += 7) {
+      const int sec = (yy * 997 + doy * 13) % 86400;
+      std::snprintf(fixed, sizeof(fixed), "%02d:%03d:%05d", yy, doy, sec);
+      std::snprintf(generic, sizeof(generic), "%d:%d:%d", yy, doy, sec);
+      Datetime t1, t2;
+      const int e1 = dso::sinex::parse_sinex_date(fixed, Datetime::min(), t1);
+      const int e2 =
+          dso::sinex::parse_sinex_date(generic, Datetime::min(), t2);
+      if ((e1 != e2) || (!e1 && (t1 != t2))) {
+        fprintf(stderr, "ERROR. Dates \"%s\" and \"%s\" differ\n", fixed,
+                generic);
+        ++error;
+      }
+    }
+  }
+
+  /* batch version */
+  {
+    const char *line = "05:349:00000 00:000:00000 5:350:3600";
+    const char *dtstrs[] = {line, line + 13, line + 26};
+    const Datetime tmin = Datetime::min(), tmax = Datetime::max();
+    const Datetime *defaults[] = {&tmin, &tmax, &tmin};
+    Datetime t1, t2, t3;
+    Datetime *t[] = {&t1, &t2, &t3};
+    Datetime s1, s3;
+    dso::sinex::parse_sinex_date(dtstrs[0], tmin, s1);
+    dso::sinex::parse_sinex_date(dtstrs[2], tmin, s3);
+    if (dso::sinex::parse_sinex_dates(3, dtstrs, defaults, t) ||
+        (t1 != s1) || (t2 != tmax) || (t3 != s3)) {
+      fprintf(stderr, "ERROR. Failed resolving dates in batch\n");
+      ++error;
+    }
+    const char *bad[] = {"05:366:00000", line, "abc"};
+    if (dso::sinex::parse_sinex_dates(3, bad, defaults, t) != 2) {
+      fprintf(stderr, "ERROR. Expected two invalid dates in batch\n");
+      ++error;
+    }
+  }
+
+  return error;
+}
@@ -0,0 +1,133 @@
+#include "sinex.hpp"
+#include "sinex_stream.hpp"
+#include "synthetic_sinex.hpp"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <vector>
+
+/* Test program: Forward-only, single-pass reading (dso::SinexStreamReader)
+ *
+ * A synthetic SINEX file is created and read through a dso::SinexStreamReader
+ * (a) off from the file and (b) off from a named pipe (i.e. a non-seekable
+ * input). Records collected are compared against the ones parsed by a
+ * dso::Sinex instance.
+ */
+
+namespace {
+const char *fn = "test_stream_reader.snx";
+const char *fifo_fn = "test_stream_reader.fifo";
+constexpr int num_sites = 120;
+constexpr int num_solns = 3;
+
+int check(const dso::SinexStreamReader &reader,
+          const std::vector<dso::sinex::SiteId> &sites,
+          const std::vector<dso::sinex::SolutionEstimate> &estimates) {
+  if ((!reader.block_read(dso::SinexStreamBlock::SiteId)) ||
+      (!reader.block_read(dso::SinexStreamBlock::SolutionEpochs)) ||
+      (!reader.block_read(dso::SinexStreamBlock::SolutionEstimate)))
+    return 1;
+  if ((reader.site_ids().size() != sites.size()) ||
+      (reader.solution_epochs().size() != sites.size() * num_solns) ||
+      (reader.solution_estimates().size() != estimates.size()))
+    return 1;
+  for (std::size_t i = 0; i < sites.size(); i++) {
+    if (std::strcmp(reader.site_ids()[i].site_code(), sites[i].site_code()) ||
+        std::strcmp(reader.site_ids()[i].domes(), sites[i].domes()))
+      return 1;
+  }
+  for (std::size_t i = 0; i < estimates.size(); i++) {
+    const auto &e = reader.solution_estimates()[i];
+    if ((e.estimate() != estimates[i].estimate()) ||
+        (e.epoch() != estimates[i].epoch()) ||
+        std::strcmp(e.site_code(), estimates[i].site_code()) ||
+        std::strcmp(e.soln_id(), estimates[i].soln_id()))
+      return 1;
+  }
+  return 0;
+}
+} /* anonymous namespace */
+
+int main() {
+  if (dso::sinex::test::write_synthetic_sinex(fn, num_sites, num_solns)) {
+    fprintf(stderr, "ERROR. Failed creating synthetic SINEX %s\n", fn);
+    return 1;
+  }
+
+  /* sites of interest */
+  char code[5];
+  std::vector<std::string> names;
+  for (int i = 0; i < num_sites; i += 7)
+    names.emplace_back(dso::sinex::test::synthetic_site_code(i, code));
+  std::vector<const char *> site_names;
+  for (const auto &s : names)
+    site_names.push_back(s.c_str());
+
+  /* reference results */
+  std::vector<dso::sinex::SiteId> sites;
+  std::vector<dso::sinex::SolutionEstimate> estimates;
+  try {
+    dso::Sinex snx(fn);
+    if (snx.parse_block_site_id(site_names, false, sites) ||
+        snx.parse_block_solution_estimate(sites, estimates)) {
+      fprintf(stderr, "ERROR. Failed parsing SINEX %s\n", fn);
+      return 1;
+    }
+  } catch (std::exception &e) {
+    fprintf(stderr, "ERROR. Failed to create SINEX instance from file %s\n",
+            fn);
+    fprintf(stderr, "%s\n", e.what());
+    return 1;
+  }
+
+  int error = 0;
+  dso::SinexStreamReader reader(site_names);
+  reader.collect(dso::SinexStreamBlock::SiteId)
+      .collect(dso::SinexStreamBlock::SolutionEpochs)
+      .collect(dso::SinexStreamBlock::SolutionEstimate);
+
+  /* (a) off from the file */
+  if (reader.read(fn) || check(reader, sites, estimates)) {
+    fprintf(stderr, "ERROR. Failed reading SINEX %s as a stream\n", fn);
+    ++error;
+  }
+
+  /* (b) off from a named pipe; the writer feeds the file in small pieces */
+  std::remove(fifo_fn);
+  if (mkfifo(fifo_fn, 0600)) {
+    fprintf(stderr, "ERROR. Failed creating named pipe %s\n", fifo_fn);
+    return 1;
+  }
+  std::thread writer([]() {
+    std::ifstream fin(fn, std::ios::binary);
+    std::ofstream fout(fifo_fn, std::ios::binary);
+    char buf[1000];
+    while (fin.read(buf, sizeof(buf)) || fin.gcount())
+      fout.write(buf, fin.gcount());
+  });
+  if (reader.read(fifo_fn) || check(reader, sites, estimates)) {
+    fprintf(stderr, "ERROR. Failed reading SINEX off from a pipe\n");
+    ++error;
+  }
+  writer.join();
+
+  /* truncated input (no '%ENDSNX') should not be accepted */
+  {
+    std::ifstream fin(fn);
+    std::string contents((std::istreambuf_iterator<char>(fin)),
+                         std::istreambuf_iterator<char>());
+    std::istringstream iss(contents.substr(0, contents.size() / 2));
+    if (!reader.read(iss)) {
+      fprintf(stderr, "ERROR. Truncated SINEX stream accepted\n");
+      ++error;
+    }
+  }
+
+  std::remove(fn);
+  std::remove(fifo_fn);
+  return error;
+}
@@ -0,0 +1,210 @@
+#include "sinex.hpp"
+#include "synthetic_sinex.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/* Test program: Out-of-core (tiled) covariance matrix
+ *
+ * A synthetic SINEX file with a SOLUTION/MATRIX_ESTIMATE L COVA block is
+ * created and the matrix is parsed both into packed storage and into a tile
+ * file (see dso::Sinex::parse_block_matrix_estimate), using a tile cache
+ * much smaller than the matrix, or one that holds the row of tiles filled
+ * while parsing. Elements, sub-matrices and products should match the
+ * ones off from the packed matrix, and the cache should never exceed its
+ * budget. The same should hold after re-opening the tile file,
+ * and for the upper triangle of the matrix written in a
+ * SOLUTION/MATRIX_ESTIMATE U COVA block instead, with the lines of the
+ * first row moved to the end of the block.
+ */
+
+namespace {
+const char *fn = "test_tiled_matrix.snx";
+const char *tile_fn = "test_tiled_matrix.tiles";
+constexpr int num_sites = 30;
+constexpr int num_solns = 2;
+constexpr int tile_size = 64;
+constexpr std::size_t budget = 3 * tile_size * tile_size * sizeof(double);
+
+int check_matrix(const dso::sinex::TiledSymmetricMatrix &tiled,
+                 const dso::sinex::SymmetricMatrix &packed) {
+  int error = 0;
+  const int n = packed.rows();
+  if (tiled.rows() != n ||
+      tiled.num_tiles() != (n + tile_size - 1) / tile_size) {
+    fprintf(stderr, "ERROR. Invalid tiled matrix dimensions\n");
+    return 1;
+  }
+
+  /* elements, in either order of indexes */
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < n; j += 7) {
+      double v;
+      if (tiled.get(i, j, v) || v != packed(i, j) ||
+          tiled.cached_tiles() > tiled.max_cached_tiles()) {
+        fprintf(stderr, "ERROR. Element (%d,%d) differs\n", i, j);
+        ++error;
+      }
+    }
+  }
+  double v;
+  if (!tiled.get(n, 0, v) || !tiled.get(0, -1, v)) {
+    fprintf(stderr, "ERROR. Expected failure for invalid index\n");
+    ++error;
+  }
+
+  /* a sub-matrix of scattered (unordered, repeated) indexes */
+  std::vector<int> idx;
+  for (int i = n - 1; i >= 0; i -= 5)
+    idx.push_back(i);
+  idx.push_back(3);
+  idx.push_back(n - 1);
+  Eigen::MatrixXd sub, expected;
+  packed.to_dense(idx, expected);
+  if (tiled.to_dense(idx, sub) || sub != expected) {
+    fprintf(stderr, "ERROR. Sub-matrices differ\n");
+    ++error;
+  }
+
+  /* blocked product */
+  Eigen::MatrixXd x(n, 2), y;
+  for (int i = 0; i < n; i++) {
+    x(i, 0) = 1e0 + i % 7;
+    x(i, 1) = -1e0 + i % 3;
+  }
+  Eigen::MatrixXd ye = Eigen::MatrixXd::Zero(n, 2);
+  for (int i = 0; i < n; i++)
+    for (int k = 0; k < n; k++)
+      ye.row(i) += packed(i, k) * x.row(k);
+  if (tiled.multiply(x, y) || y.rows() != n || y.cols() != 2) {
+    fprintf(stderr, "ERROR. Failed multiplying matrices\n");
+    ++error;
+  } else {
+    for (int i = 0; i < n; i++) {
+      for (int c = 0; c < 2; c++) {
+        if (std::abs(y(i, c) - ye(i, c)) > 1e-12 * std::abs(ye(i, c))) {
+          fprintf(stderr, "ERROR. Products differ\n");
+          ++error;
+        }
+      }
+    }
+  }
+
+  if (tiled.cached_tiles() > tiled.max_cached_tiles()) {
+    fprintf(stderr, "ERROR. Tile cache exceeds budget\n");
+    ++error;
+  }
+  return error;
+}
+
+/* replace the lower triangle block with the upper triangle one, writing
+ * the first row last */
+std::string to_upper(const std::string &content,
+                     const dso::sinex::SymmetricMatrix &packed) {
+  const int n = packed.rows();
+  const auto b = content.find("+SOLUTION/MATRIX_ESTIMATE L COVA");
+  const auto e = content.find("-SOLUTION/MATRIX_ESTIMATE L COVA\n") + 33;
+  std::string blk, first;
+  char buf[128];
+  for (int i = 0; i < n; i++) {
+    for (int j = i; j < n; j += 3) {
+      int len = std::snprintf(buf, sizeof(buf), " %5d %5d", i + 1, j + 1);
+      for (int k = j; k < std::min(n, j + 3); k++)
+        len += std::snprintf(buf + len, sizeof(buf) - len, " %21.14e",
+                             packed(i, k));
+      (i ? blk : first) += std::string(buf) + "\n";
+    }
+  }
+  return content.substr(0, b) + "+SOLUTION/MATRIX_ESTIMATE U COVA\n" + blk +
+         first + "-SOLUTION/MATRIX_ESTIMATE U COVA\n" + content.substr(e);
+}
+
+int check_snx(const dso::Sinex &snx) {
+  int error = 0;
+  const auto type = dso::sinex::MatrixType::Covariance;
+  dso::sinex::SymmetricMatrix packed;
+  dso::sinex::TiledSymmetricMatrix tiled;
+  if (snx.parse_block_matrix_estimate(type, packed) ||
+      snx.parse_block_matrix_estimate(type, tile_fn, tiled, tile_size,
+                                      budget) ||
+      (tiled.max_cached_tiles() != 3)) {
+    fprintf(stderr, "ERROR. Failed parsing matrix\n");
+    ++error;
+  } else {
+    error += check_matrix(tiled, packed);
+
+    /* writing */
+    double v;
+    if (tiled.set(1, 70, 5e0) || tiled.get(70, 1, v) || v != 5e0) {
+      fprintf(stderr, "ERROR. Failed setting element\n");
+      ++error;
+    }
+    tiled.set(1, 70, packed(1, 70));
+    tiled.close();
+
+    /* re-open (read-only), with a single cached tile */
+    dso::sinex::TiledSymmetricMatrix reopened;
+    if (reopened.open(tile_fn, 1) || reopened.max_cached_tiles() != 1) {
+      fprintf(stderr, "ERROR. Failed opening tile file\n");
+      ++error;
+    } else {
+      error += check_matrix(reopened, packed);
+      if (!reopened.set(0, 0, 1e0)) {
+        fprintf(stderr, "ERROR. Expected failure writing read-only file\n");
+        ++error;
+      }
+    }
+
+    /* upper triangle */
+    std::ifstream fin(fn);
+    std::stringstream ss;
+    ss << fin.rdbuf();
+    const dso::Sinex upper(dso::sinex_buffer, to_upper(ss.str(), packed),
+                           "upper");
+    dso::sinex::TiledSymmetricMatrix tiled_upper;
+    if (upper.parse_block_matrix_estimate(type, tile_fn, tiled_upper,
+                                          tile_size, budget)) {
+      fprintf(stderr, "ERROR. Failed parsing upper triangle matrix\n");
+      ++error;
+    } else {
+      error += check_matrix(tiled_upper, packed);
+    }
+
+    /* budget holding a band of tiles (plus two cached tiles); once
+     * parsed, the cache gets the whole budget */
+    const int nt = (packed.rows() + tile_size - 1) / tile_size;
+    const std::size_t band_budget =
+        (nt + 2) * tile_size * tile_size * sizeof(double);
+    for (const dso::Sinex *s : {&snx, &upper}) {
+      dso::sinex::TiledSymmetricMatrix banded;
+      if (s->parse_block_matrix_estimate(type, tile_fn, banded, tile_size,
+                                         band_budget) ||
+          (banded.max_cached_tiles() != (std::size_t)nt + 2)) {
+        fprintf(stderr, "ERROR. Failed parsing matrix via band\n");
+        ++error;
+      } else {
+        error += check_matrix(banded, packed);
+      }
+    }
+  }
+
+  /* not a tile file */
+  dso::sinex::TiledSymmetricMatrix invalid;
+  if (!invalid.open(fn)) {
+    fprintf(stderr, "ERROR. Expected failure opening non-tile file\n");
+    ++error;
+  }
+  return error;
+}
+} /* anonymous namespace */
+
+int main() {
+  const int error = dso::sinex::test::run_on_synthetic(
+      fn, num_sites, num_solns, true, check_snx);
+  std::remove(tile_fn);
+  return error;
+}
@@ -0,0 +1,133 @@
+#include "sinex.hpp"
+#include "synthetic_sinex.hpp"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+/* Test program: Block visitors
+ *
+ * A synthetic SINEX file is created and its blocks are scanned via
+ * dso::Sinex::visit_block, for records and views, with and without query
+ * predicates. Visited records should match the ones of the block parsers;
+ * a visitor returning Stop should end the scan at once.
+ */
+
+namespace {
+const char *fn = "test_visit_block.snx";
+constexpr int num_sites = 30;
+constexpr int num_solns = 3;
+using dso::sinex::VisitAction;
+using dso::sinex::test::same_estimate;
+
+int check_snx(const dso::Sinex &snx) {
+  int error = 0;
+  const long num_params = 6L * num_sites * num_solns;
+
+  /* block parsers */
+  std::vector<dso::sinex::SiteId> siteids;
+  std::vector<dso::sinex::SolutionEstimate> estimates;
+  if (snx.parse_block_site_id(siteids) ||
+      snx.parse_block_solution_estimate(siteids, estimates)) {
+    fprintf(stderr, "ERROR. Failed parsing SINEX %s\n", fn);
+    return 1;
+  }
+
+  /* visit all estimates */
+  std::size_t i = 0;
+  if (snx.visit_block<dso::sinex::SolutionEstimate>(
+          [&](const dso::sinex::SolutionEstimate &est) {
+            if (i >= estimates.size() || !same_estimate(est, estimates[i]))
+              ++error;
+            ++i;
+            return VisitAction::Continue;
+          }) ||
+      (i != estimates.size())) {
+    fprintf(stderr, "ERROR. Visited %zu out of %zu estimates\n", i,
+            estimates.size());
+    ++error;
+  }
+
+  /* stop at the VELZ of site S001, solution 3 */
+  dso::sinex::QueryStats stats;
+  dso::sinex::SolutionEstimate found;
+  int visited = 0;
+  if (snx.visit_block<dso::sinex::SolutionEstimate>(
+          [&](const dso::sinex::SolutionEstimate &est) {
+            ++visited;
+            if (!std::strcmp(est.parameter_type(), "VELZ")) {
+              found = est;
+              return VisitAction::Stop;
+            }
+            return VisitAction::Continue;
+          },
+          dso::sinex::QueryPredicate().sites({"S001"}).soln_ids({"3"}),
+          &stats) ||
+      std::strcmp(found.site_code(), "S001") || (found.soln_id_int() != 3) ||
+      (visited != 6) || (stats.lines_decoded != 6) ||
+      (stats.lines_skipped + stats.lines_decoded >= num_params)) {
+    fprintf(stderr,
+            "ERROR. Early stop failed (visited %d, skipped %ld, decoded "
+            "%ld)\n",
+            visited, stats.lines_skipped, stats.lines_decoded);
+    ++error;
+  }
+
+  /* other blocks */
+  int count = 0;
+  if (snx.visit_block<dso::sinex::SiteEccentricity>(
+          [&](const dso::sinex::SiteEccentricity &) {
+            ++count;
+            return VisitAction::Continue;
+          }) ||
+      (count != num_sites)) {
+    fprintf(stderr, "ERROR. Visited %d eccentricities\n", count);
+    ++error;
+  }
+  count = 0;
+  if (snx.visit_block<dso::sinex::SolutionEpoch>(
+          [&](const dso::sinex::SolutionEpoch &e) {
+            count += (e.soln_id_int() == 2);
+            return VisitAction::Continue;
+          },
+          dso::sinex::QueryPredicate().soln_ids({"2"})) ||
+      (count != num_sites)) {
+    fprintf(stderr, "ERROR. Visited %d solution epochs\n", count);
+    ++error;
+  }
+
+  /* missing block */
+  if (!snx.visit_block<dso::sinex::SiteReceiver>(
+          [](const dso::sinex::SiteReceiver &) {
+            return VisitAction::Continue;
+          })) {
+    fprintf(stderr, "ERROR. Visited a missing block\n");
+    ++error;
+  }
+
+  /* views (need a memory mapping) */
+  if (snx.io_mode() == dso::SinexIoMode::MemoryMap) {
+    count = 0;
+    stats = dso::sinex::QueryStats();
+    if (snx.visit_block<dso::sinex::SiteIdView>(
+            [&](const dso::sinex::SiteIdView &v) {
+              ++count;
+              return (v.site_code() == "S00A") ? VisitAction::Stop
+                                                : VisitAction::Continue;
+            },
+            dso::sinex::QueryPredicate().sites({"S003", "S00A", "S00B"}),
+            &stats) ||
+        (count != 2) || (stats.lines_decoded != 2) ||
+        (stats.lines_skipped != 9)) {
+      fprintf(stderr, "ERROR. Visited %d SITE/ID views\n", count);
+      ++error;
+    }
+  }
+
+  return error;
+}
+} /* anonymous namespace */
+
+int main() {
+  return dso::sinex::test::run_on_synthetic(fn, num_sites, num_solns, false,
+                                            check_snx);
+}
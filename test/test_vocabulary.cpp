@@ -0,0 +1,97 @@
+#include "sinex.hpp"
+#include <cstdio>
+#include <cstring>
+
+/* Test program: Parameter type and block name lookups
+ *
+ * Every parameter type and block name should be found (via the perfect hash
+ * tables) at its index, while words not in the vocabularies (including
+ * prefixes and extensions of valid words) should not. Parameter type
+ * matching policies and block header matching are checked too.
+ */
+
+int main() {
+  int error = 0;
+
+  /* every word is found at its index */
+  for (int i = 0; i < dso::sinex::parameter_types_size; i++) {
+    const char *p = dso::sinex::parameter_types[i];
+    if (dso::sinex::parameter_type_id(p, std::strlen(p)) != i) {
+      fprintf(stderr, "ERROR. Parameter type %s not found\n", p);
+      ++error;
+    }
+  }
+  for (int i = 0; i < dso::sinex::block_names_size; i++) {
+    const char *b = dso::sinex::block_names[i];
+    if (dso::sinex::block_name_id(b, std::strlen(b)) != i) {
+      fprintf(stderr, "ERROR. Block name %s not found\n", b);
+      ++error;
+    }
+  }
+
+  /* words not in the vocabularies */
+  const char *not_parameters[] = {"",     "S",      "STA",     "STAXX",
+                                  "stax", "SAT__W", "AEXP_NN", "TROTOTAL"};
+  for (const char *p : not_parameters) {
+    if (dso::sinex::parameter_type_id(p, std::strlen(p)) >= 0) {
+      fprintf(stderr, "ERROR. Found invalid parameter type %s\n", p);
+      ++error;
+    }
+  }
+  const char *not_blocks[] = {"", "SITE", "SITE/IDS", "SITE/GLO_PHASE_CENTER",
+                              "SOLUTION/MATRIX_ESTIMATE L CORX",
+                              "SOLUTION/ESTIMATE/"};
+  for (const char *b : not_blocks) {
+    if (dso::sinex::block_name_id(b, std::strlen(b)) >= 0) {
+      fprintf(stderr, "ERROR. Found invalid block name %s\n", b);
+      ++error;
+    }
+  }
+
+  /* matching policies */
+  using dso::sinex::details::ParameterMatchPolicyType;
+  int index;
+  if (!dso::sinex::parameter_type_exists("STAX", index) ||
+      std::strcmp(dso::sinex::parameter_types[index], "STAX") ||
+      dso::sinex::parameter_type_exists("STAX ", index) ||
+      dso::sinex::parameter_type_exists("STAXfoobar", index)) {
+    fprintf(stderr, "ERROR. Strict parameter type matching failed\n");
+    ++error;
+  }
+  const char *non_strict[][2] = {{"STAX", "STAX"},
+                                 {"STAX   ABMB", "STAX"},
+                                 {"STAXfoobar", "STAX"},
+                                 {"XPOR  ----", "XPOR"},
+                                 {"XPO   ----", "XPO"},
+                                 {"RS_RAR ---", "RS_RAR"}};
+  for (const auto &p : non_strict) {
+    if (!dso::sinex::parameter_type_exists<ParameterMatchPolicyType::NonStrict>(
+            p[0], index) ||
+        std::strcmp(dso::sinex::parameter_types[index], p[1])) {
+      fprintf(stderr, "ERROR. Failed matching \"%s\" to %s\n", p[0], p[1]);
+      ++error;
+    }
+  }
+
+  /* block headers */
+  const char *headers[][2] = {
+      {"SOLUTION/ESTIMATE", "SOLUTION/ESTIMATE"},
+      {"SOLUTION/ESTIMATE   \r", "SOLUTION/ESTIMATE"},
+      {"SITE/GAL_PHASE_CENTER", "SITE/GAL_PHASE_CENTER"},
+      {"SOLUTION/MATRIX_ESTIMATE U COVA", "SOLUTION/MATRIX_ESTIMATE U COVA"},
+      {"SITE/ID (extra text)", "SITE/ID"}};
+  for (const auto &h : headers) {
+    const int idx = dso::sinex::details::match_block_header(h[0]);
+    if ((idx < 0) || std::strcmp(dso::sinex::block_names[idx], h[1])) {
+      fprintf(stderr, "ERROR. Failed matching header \"%s\" to %s\n", h[0],
+              h[1]);
+      ++error;
+    }
+  }
+  if (dso::sinex::details::match_block_header("FOO/BAR") >= 0) {
+    fprintf(stderr, "ERROR. Matched invalid header\n");
+    ++error;
+  }
+
+  return error;
+}